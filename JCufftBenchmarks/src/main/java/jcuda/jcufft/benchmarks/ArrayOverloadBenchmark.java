@@ -0,0 +1,136 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+
+import jcuda.jcufft.JCufft;
+import jcuda.jcufft.cufftHandle;
+import jcuda.jcufft.cufftType;
+
+/**
+ * Benchmarks for the <code>cufftExec*</code> overloads that receive
+ * Java arrays, which include the allocation of device memory and the
+ * memory transfers.<br>
+ * <br>
+ * These overloads always allocate device memory with the CUDA runtime,
+ * so unlike the other benchmarks, they require a CUDA capable device,
+ * and are not supported by the CPU stand-in for CUFFT.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+public class ArrayOverloadBenchmark
+{
+    /**
+     * The size of the 1D transform
+     */
+    @Param({"256", "4096", "65536", "1048576"})
+    public int size;
+
+    /**
+     * The single precision plan
+     */
+    private cufftHandle floatPlan;
+
+    /**
+     * The double precision plan
+     */
+    private cufftHandle doublePlan;
+
+    /**
+     * The single precision data
+     */
+    private float floatData[];
+
+    /**
+     * The double precision data
+     */
+    private double doubleData[];
+
+    /**
+     * Create the plans and the data
+     */
+    @Setup(Level.Trial)
+    public void setup()
+    {
+        JCufft.setExceptionsEnabled(true);
+        floatPlan = new cufftHandle();
+        JCufft.cufftPlan1d(floatPlan, size, cufftType.CUFFT_C2C, 1);
+        doublePlan = new cufftHandle();
+        JCufft.cufftPlan1d(doublePlan, size, cufftType.CUFFT_Z2Z, 1);
+        floatData = new float[size * 2];
+        doubleData = new double[size * 2];
+    }
+
+    /**
+     * Destroy the plans
+     */
+    @TearDown(Level.Trial)
+    public void tearDown()
+    {
+        JCufft.cufftDestroy(floatPlan);
+        JCufft.cufftDestroy(doublePlan);
+    }
+
+    /**
+     * In-place single precision complex-to-complex transform
+     *
+     * @return The cufftResult
+     */
+    @Benchmark
+    public int execC2C()
+    {
+        return JCufft.cufftExecC2C(floatPlan, floatData, floatData,
+            JCufft.CUFFT_FORWARD);
+    }
+
+    /**
+     * In-place double precision complex-to-complex transform
+     *
+     * @return The cufftResult
+     */
+    @Benchmark
+    public int execZ2Z()
+    {
+        return JCufft.cufftExecZ2Z(doublePlan, doubleData, doubleData,
+            JCufft.CUFFT_FORWARD);
+    }
+}
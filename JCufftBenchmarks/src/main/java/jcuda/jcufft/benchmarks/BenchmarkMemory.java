@@ -0,0 +1,95 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft.benchmarks;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+
+/**
+ * Allocation of the memory that is passed to the exec functions in
+ * the benchmarks.<br>
+ * <br>
+ * By default, the benchmarks are intended to run against the CPU
+ * stand-in for CUFFT (see the JCUFFT_STUB_BACKEND CMake option of
+ * JCufftJNI), which operates on host memory. In this case, the memory
+ * is allocated as direct buffers. When the system property
+ * <code>jcufft.benchmarks.device</code> is <code>true</code>, the
+ * memory is allocated on the device instead, for running the same
+ * benchmarks against the real CUFFT library.
+ */
+class BenchmarkMemory
+{
+    /**
+     * Whether device memory should be allocated
+     */
+    static final boolean DEVICE =
+        Boolean.getBoolean("jcufft.benchmarks.device");
+
+    /**
+     * Allocate the given number of bytes
+     *
+     * @param bytes The number of bytes
+     * @return The pointer to the memory
+     */
+    static Pointer allocate(long bytes)
+    {
+        if (DEVICE)
+        {
+            Pointer pointer = new Pointer();
+            JCuda.cudaMalloc(pointer, bytes);
+            return pointer;
+        }
+        ByteBuffer buffer = ByteBuffer.allocateDirect((int)bytes);
+        buffer.order(ByteOrder.nativeOrder());
+        return Pointer.to(buffer);
+    }
+
+    /**
+     * Free the given memory
+     *
+     * @param pointer The pointer to the memory
+     */
+    static void free(Pointer pointer)
+    {
+        if (DEVICE)
+        {
+            JCuda.cudaFree(pointer);
+        }
+    }
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private BenchmarkMemory()
+    {
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft.benchmarks;
+
+import jcuda.Sizeof;
+import jcuda.jcufft.cufftType;
+
+/**
+ * Utility methods for the benchmarks
+ */
+class BenchmarkUtils
+{
+    /**
+     * All cufftType constants
+     */
+    private static final int TYPES[] =
+    {
+        cufftType.CUFFT_R2C, cufftType.CUFFT_C2R, cufftType.CUFFT_C2C,
+        cufftType.CUFFT_D2Z, cufftType.CUFFT_Z2D, cufftType.CUFFT_Z2Z
+    };
+
+    /**
+     * Returns the cufftType constant for the given name, as returned
+     * by cufftType#stringFor
+     *
+     * @param name The name
+     * @return The cufftType constant
+     * @throws IllegalArgumentException If the name is not valid
+     */
+    static int parseType(String name)
+    {
+        for (int type : TYPES)
+        {
+            if (cufftType.stringFor(type).equals(name))
+            {
+                return type;
+            }
+        }
+        throw new IllegalArgumentException("Invalid cufftType: " + name);
+    }
+
+    /**
+     * Returns the size of a single real value for the given cufftType
+     *
+     * @param type The cufftType
+     * @return The size, in bytes
+     */
+    static int elementSize(int type)
+    {
+        switch (type)
+        {
+            case cufftType.CUFFT_D2Z:
+            case cufftType.CUFFT_Z2D:
+            case cufftType.CUFFT_Z2Z:
+                return Sizeof.DOUBLE;
+        }
+        return Sizeof.FLOAT;
+    }
+
+    /**
+     * Parses sizes that are given as a string like <code>"64x32x16"</code>
+     *
+     * @param sizes The sizes string
+     * @return The sizes
+     */
+    static int[] parseSizes(String sizes)
+    {
+        String tokens[] = sizes.split("x");
+        int result[] = new int[tokens.length];
+        for (int i = 0; i < tokens.length; i++)
+        {
+            result[i] = Integer.parseInt(tokens[i].trim());
+        }
+        return result;
+    }
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private BenchmarkUtils()
+    {
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+
+import jcuda.Pointer;
+import jcuda.jcufft.JCufft;
+import jcuda.jcufft.cufftHandle;
+import jcuda.jcufft.cufftType;
+
+/**
+ * Benchmarks for the cost of a single call to each of the
+ * <code>cufftExec*</code> functions with <code>Pointer</code>
+ * arguments. The default size is small, so that the result is
+ * dominated by the JNI crossing and the work that JCufft does
+ * around the actual transform.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+public class ExecBenchmark
+{
+    /**
+     * The name of the cufftType
+     */
+    @Param({"CUFFT_C2C", "CUFFT_R2C", "CUFFT_C2R",
+        "CUFFT_Z2Z", "CUFFT_D2Z", "CUFFT_Z2D"})
+    public String type;
+
+    /**
+     * The size of the 1D transform
+     */
+    @Param({"16"})
+    public int size;
+
+    /**
+     * The cufftType
+     */
+    private int cufftTypeValue;
+
+    /**
+     * The plan
+     */
+    private cufftHandle plan;
+
+    /**
+     * The input memory
+     */
+    private Pointer input;
+
+    /**
+     * The output memory
+     */
+    private Pointer output;
+
+    /**
+     * Create the plan and the memory
+     */
+    @Setup(Level.Trial)
+    public void setup()
+    {
+        JCufft.setExceptionsEnabled(true);
+        cufftTypeValue = BenchmarkUtils.parseType(type);
+        plan = new cufftHandle();
+        JCufft.cufftPlan1d(plan, size, cufftTypeValue, 1);
+        long bytes = 2L * size * BenchmarkUtils.elementSize(cufftTypeValue);
+        input = BenchmarkMemory.allocate(bytes);
+        output = BenchmarkMemory.allocate(bytes);
+    }
+
+    /**
+     * Destroy the plan and free the memory
+     */
+    @TearDown(Level.Trial)
+    public void tearDown()
+    {
+        JCufft.cufftDestroy(plan);
+        BenchmarkMemory.free(input);
+        BenchmarkMemory.free(output);
+    }
+
+    /**
+     * Execute the plan
+     *
+     * @return The cufftResult
+     */
+    @Benchmark
+    public int exec()
+    {
+        switch (cufftTypeValue)
+        {
+            case cufftType.CUFFT_C2C:
+                return JCufft.cufftExecC2C(plan, input, output,
+                    JCufft.CUFFT_FORWARD);
+            case cufftType.CUFFT_R2C:
+                return JCufft.cufftExecR2C(plan, input, output);
+            case cufftType.CUFFT_C2R:
+                return JCufft.cufftExecC2R(plan, input, output);
+            case cufftType.CUFFT_Z2Z:
+                return JCufft.cufftExecZ2Z(plan, input, output,
+                    JCufft.CUFFT_FORWARD);
+            case cufftType.CUFFT_D2Z:
+                return JCufft.cufftExecD2Z(plan, input, output);
+            case cufftType.CUFFT_Z2D:
+                return JCufft.cufftExecZ2D(plan, input, output);
+        }
+        throw new IllegalArgumentException("Invalid type: " + type);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft.benchmarks;
+
+import org.openjdk.jmh.results.format.ResultFormatType;
+import org.openjdk.jmh.runner.Runner;
+import org.openjdk.jmh.runner.RunnerException;
+import org.openjdk.jmh.runner.options.ChainedOptionsBuilder;
+import org.openjdk.jmh.runner.options.CommandLineOptionException;
+import org.openjdk.jmh.runner.options.CommandLineOptions;
+import org.openjdk.jmh.runner.options.OptionsBuilder;
+
+/**
+ * Entry point for running the JCufft benchmarks.<br>
+ * <br>
+ * This accepts the usual JMH command line options. Unless specified
+ * otherwise, the results are written in JSON format to the file
+ * <code>jcufft-benchmarks.json</code>, so that the results of
+ * different releases can be compared.
+ */
+public class JCufftBenchmarks
+{
+    /**
+     * The default name of the result file
+     */
+    private static final String DEFAULT_RESULT_FILE = "jcufft-benchmarks.json";
+
+    /**
+     * The entry point
+     *
+     * @param args The JMH command line options
+     * @throws CommandLineOptionException If the options are invalid
+     * @throws RunnerException If running the benchmarks failed
+     */
+    public static void main(String[] args)
+        throws CommandLineOptionException, RunnerException
+    {
+        CommandLineOptions commandLineOptions = new CommandLineOptions(args);
+        ChainedOptionsBuilder builder =
+            new OptionsBuilder().parent(commandLineOptions);
+        if (commandLineOptions.getIncludes().isEmpty())
+        {
+            builder.include(JCufftBenchmarks.class.getPackage().getName());
+        }
+        if (!commandLineOptions.getResultFormat().hasValue())
+        {
+            builder.resultFormat(ResultFormatType.JSON);
+        }
+        if (!commandLineOptions.getResult().hasValue())
+        {
+            builder.result(DEFAULT_RESULT_FILE);
+        }
+        new Runner(builder.build()).run();
+    }
+}
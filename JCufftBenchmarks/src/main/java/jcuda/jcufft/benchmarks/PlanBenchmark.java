@@ -0,0 +1,140 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+
+import jcuda.jcufft.JCufft;
+import jcuda.jcufft.cufftHandle;
+
+/**
+ * Benchmarks for the creation and destruction of plans with
+ * different geometries
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+public class PlanBenchmark
+{
+    /**
+     * The sizes of the transform, like "64x64"
+     */
+    @Param({"256", "4096", "1000", "64x64", "16x16x16"})
+    public String sizes;
+
+    /**
+     * The batch size
+     */
+    @Param({"1", "64"})
+    public int batch;
+
+    /**
+     * The name of the cufftType
+     */
+    @Param({"CUFFT_C2C", "CUFFT_R2C"})
+    public String type;
+
+    /**
+     * The parsed sizes
+     */
+    private int n[];
+
+    /**
+     * The cufftType
+     */
+    private int cufftTypeValue;
+
+    /**
+     * The plan
+     */
+    private final cufftHandle plan = new cufftHandle();
+
+    /**
+     * The work size
+     */
+    private final long workSize[] = { 0 };
+
+    /**
+     * Parse the parameters
+     */
+    @Setup(Level.Trial)
+    public void setup()
+    {
+        JCufft.setExceptionsEnabled(true);
+        n = BenchmarkUtils.parseSizes(sizes);
+        cufftTypeValue = BenchmarkUtils.parseType(type);
+    }
+
+    /**
+     * Create a plan with cufftPlanMany and destroy it
+     *
+     * @return The cufftResult
+     */
+    @Benchmark
+    public int planMany()
+    {
+        JCufft.cufftPlanMany(plan, n.length, n,
+            null, 1, 0, null, 1, 0, cufftTypeValue, batch);
+        return JCufft.cufftDestroy(plan);
+    }
+
+    /**
+     * Create a plan with cufftCreate and cufftMakePlanMany, and destroy it
+     *
+     * @return The cufftResult
+     */
+    @Benchmark
+    public int makePlanMany()
+    {
+        JCufft.cufftCreate(plan);
+        JCufft.cufftMakePlanMany(plan, n.length, n,
+            null, 1, 0, null, 1, 0, cufftTypeValue, batch, workSize);
+        return JCufft.cufftDestroy(plan);
+    }
+
+    /**
+     * Destroy the plan if a benchmark failed
+     */
+    @TearDown(Level.Trial)
+    public void tearDown()
+    {
+        plan.close();
+    }
+}
@@ -0,0 +1,172 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+
+import jcuda.jcufft.JCufft;
+import jcuda.jcufft.cufftHandle;
+import jcuda.jcufft.cufftType;
+
+/**
+ * Benchmarks for the functions that query the size of the work area
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+public class SizeQueryBenchmark
+{
+    /**
+     * The size of each dimension of the transforms
+     */
+    @Param({"64", "1024"})
+    public int size;
+
+    /**
+     * A plan for the cufftGetSize functions
+     */
+    private cufftHandle plan;
+
+    /**
+     * The sizes for the cufftEstimateMany function
+     */
+    private int n[];
+
+    /**
+     * The work size
+     */
+    private final long workSize[] = { 0 };
+
+    /**
+     * Create the plan
+     */
+    @Setup(Level.Trial)
+    public void setup()
+    {
+        JCufft.setExceptionsEnabled(true);
+        plan = new cufftHandle();
+        JCufft.cufftPlan1d(plan, size, cufftType.CUFFT_C2C, 1);
+        n = new int[] { size, size };
+    }
+
+    /**
+     * Destroy the plan
+     */
+    @TearDown(Level.Trial)
+    public void tearDown()
+    {
+        JCufft.cufftDestroy(plan);
+    }
+
+    /**
+     * Query the size of the work area of an existing plan
+     *
+     * @return The work size
+     */
+    @Benchmark
+    public long getSize()
+    {
+        JCufft.cufftGetSize(plan, workSize);
+        return workSize[0];
+    }
+
+    /**
+     * Query the size of the work area for a 2D plan
+     *
+     * @return The work size
+     */
+    @Benchmark
+    public long getSizeMany()
+    {
+        JCufft.cufftGetSizeMany(plan, 2, n, null, 1, 0, null, 1, 0,
+            cufftType.CUFFT_C2C, 1, workSize);
+        return workSize[0];
+    }
+
+    /**
+     * Estimate the size of the work area of a 1D plan
+     *
+     * @return The work size
+     */
+    @Benchmark
+    public long estimate1d()
+    {
+        JCufft.cufftEstimate1d(size, cufftType.CUFFT_C2C, 1, workSize);
+        return workSize[0];
+    }
+
+    /**
+     * Estimate the size of the work area of a 2D plan
+     *
+     * @return The work size
+     */
+    @Benchmark
+    public long estimate2d()
+    {
+        JCufft.cufftEstimate2d(size, size, cufftType.CUFFT_C2C, workSize);
+        return workSize[0];
+    }
+
+    /**
+     * Estimate the size of the work area of a 3D plan
+     *
+     * @return The work size
+     */
+    @Benchmark
+    public long estimate3d()
+    {
+        JCufft.cufftEstimate3d(16, 16, size, cufftType.CUFFT_C2C, workSize);
+        return workSize[0];
+    }
+
+    /**
+     * Estimate the size of the work area of a 2D plan, with
+     * cufftEstimateMany
+     *
+     * @return The work size
+     */
+    @Benchmark
+    public long estimateMany()
+    {
+        JCufft.cufftEstimateMany(2, n, null, 1, 0, null, 1, 0,
+            cufftType.CUFFT_C2C, 1, workSize);
+        return workSize[0];
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft.benchmarks;
+
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+import jcuda.jcufft.JCufft;
+import jcuda.jcufft.cufftHandle;
+import jcuda.jcufft.cufftType;
+
+/**
+ * Benchmarks for the time that is required for loading JCufft in a
+ * new JVM, with the default and the fast startup mode.<br>
+ * <br>
+ * Each fork measures a single invocation, which is the first use of
+ * JCufft in this JVM. The startup mode is selected by setting the
+ * <code>jcufft.startup</code> system property before the JCufft class
+ * is initialized. The first fork with the fast startup mode may have
+ * to extract the native library into the cache directory.
+ */
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.SingleShotTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Warmup(iterations = 0)
+@Measurement(iterations = 1)
+@Fork(10)
+public class StartupBenchmark
+{
+    /**
+     * The startup mode, "default" or "fast"
+     */
+    @Param({"default", "fast"})
+    public String mode;
+
+    /**
+     * Select the startup mode. This must not refer to JCufft.
+     */
+    @Setup(Level.Trial)
+    public void setup()
+    {
+        if ("fast".equals(mode))
+        {
+            System.setProperty("jcufft.startup", "fast");
+        }
+    }
+
+    /**
+     * Load the native library
+     */
+    @Benchmark
+    public void initialize()
+    {
+        JCufft.initialize();
+    }
+
+    /**
+     * Load the native library and create the first plan, which
+     * initializes the CUDA context and CUFFT
+     *
+     * @return The result of destroying the plan
+     */
+    @Benchmark
+    public int initializeAndPlan()
+    {
+        JCufft.initialize();
+        cufftHandle plan = new cufftHandle();
+        JCufft.cufftPlan1d(plan, 256, cufftType.CUFFT_C2C, 1);
+        return JCufft.cufftDestroy(plan);
+    }
+}
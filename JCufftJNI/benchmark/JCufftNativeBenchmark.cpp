@@ -0,0 +1,420 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * A native microbenchmark for the JNI marshalling layer of JCufft.
+ *
+ * This creates an embedded JVM, and calls each JNI entry point of
+ * JCufft directly, so that the overhead of the marshalling inside
+ * the entry points can be measured without the noise of the JVM
+ * calling convention and the Java side of JCufft. Additionally, it
+ * measures the helper functions that are used by the entry points,
+ * and the corresponding calls to the CUFFT functions without JNI.
+ *
+ * It requires the CPU stand-in for CUFFT (JCUFFT_STUB_BACKEND), and
+ * counts the calls to the global operator new that are done by the
+ * code under test.
+ *
+ * Usage:
+ *
+ *     JCufftNativeBenchmark <classPath> [iterations]
+ *
+ * where the class path must contain the JCuda and JCufft JARs.
+ */
+
+#include "JCufft.hpp"
+#include "JCufft_common.hpp"
+#include "JCufftHandles.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+//============================================================================
+// Allocation counting
+
+static std::atomic<long long> allocationCount(0);
+
+void *operator new(size_t size)
+{
+    allocationCount++;
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    allocationCount++;
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+//============================================================================
+// Benchmark driver
+
+static JNIEnv *env = NULL;
+static long long iterations = 100000;
+static int failures = 0;
+
+/**
+ * Run the given function for the configured number of iterations, and
+ * print the nanoseconds and allocations per call
+ */
+template <typename Function>
+static void run(const char *name, Function function)
+{
+    long long warmup = iterations / 10 + 1;
+    for (long long i = 0; i < warmup; i++)
+    {
+        function();
+    }
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        printf("%-40s FAILED\n", name);
+        failures++;
+        return;
+    }
+    long long allocationsBefore = allocationCount.load();
+    auto before = std::chrono::steady_clock::now();
+    for (long long i = 0; i < iterations; i++)
+    {
+        function();
+    }
+    auto after = std::chrono::steady_clock::now();
+    long long allocations = allocationCount.load() - allocationsBefore;
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        after - before).count();
+    printf("%-40s %12.1f ns/call %8.2f allocs/call\n", name,
+        ns / (double)iterations, (double)allocations / (double)iterations);
+}
+
+/**
+ * Creates a new Java object of the given class with the default constructor
+ */
+static jobject newObject(const char *className)
+{
+    jclass cls = env->FindClass(className);
+    if (cls == NULL)
+    {
+        return NULL;
+    }
+    jmethodID constructor = env->GetMethodID(cls, "<init>", "()V");
+    if (constructor == NULL)
+    {
+        return NULL;
+    }
+    return env->NewObject(cls, constructor);
+}
+
+/**
+ * Creates a jcuda.Pointer to the given host memory, via a direct buffer
+ */
+static jobject newPointer(void *memory, size_t size)
+{
+    jclass cls = env->FindClass("jcuda/Pointer");
+    if (cls == NULL)
+    {
+        return NULL;
+    }
+    jmethodID to = env->GetStaticMethodID(cls, "to",
+        "(Ljava/nio/Buffer;)Ljcuda/Pointer;");
+    if (to == NULL)
+    {
+        return NULL;
+    }
+    jobject buffer = env->NewDirectByteBuffer(memory, (jlong)size);
+    return env->CallStaticObjectMethod(cls, to, buffer);
+}
+
+/**
+ * Creates a Java int array with the given contents
+ */
+static jintArray newIntArray(std::vector<jint> values)
+{
+    jintArray array = env->NewIntArray((jsize)values.size());
+    env->SetIntArrayRegion(array, 0, (jsize)values.size(), values.data());
+    return array;
+}
+
+/**
+ * Creates a Java long array with the given contents
+ */
+static jlongArray newLongArray(std::vector<jlong> values)
+{
+    jlongArray array = env->NewLongArray((jsize)values.size());
+    env->SetLongArrayRegion(array, 0, (jsize)values.size(), values.data());
+    return array;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: JCufftNativeBenchmark <classPath> [iterations]\n");
+        return 1;
+    }
+    if (argc > 2)
+    {
+        iterations = atoll(argv[2]);
+    }
+
+    // Create the JVM and initialize JCufft as if it was loaded
+    std::string classPath = std::string("-Djava.class.path=") + argv[1];
+    JavaVMOption options[1];
+    options[0].optionString = (char*)classPath.c_str();
+    JavaVMInitArgs vmArgs;
+    vmArgs.version = JNI_VERSION_1_6;
+    vmArgs.nOptions = 1;
+    vmArgs.options = options;
+    vmArgs.ignoreUnrecognized = JNI_FALSE;
+    JavaVM *jvm = NULL;
+    if (JNI_CreateJavaVM(&jvm, (void**)&env, &vmArgs) != JNI_OK)
+    {
+        printf("Could not create the JVM\n");
+        return 1;
+    }
+    if (JNI_OnLoad(jvm, NULL) == JNI_ERR)
+    {
+        env->ExceptionDescribe();
+        printf("Could not initialize JCufft\n");
+        return 1;
+    }
+    Java_jcuda_jcufft_JCufft_setLogLevel(env, NULL, LOG_QUIET);
+
+    // The helpers are called directly below, so initialize them here
+    // as well, in case the executable has its own copy of them
+    if (initJNIUtils(env) == JNI_ERR || initPointerUtils(env) == JNI_ERR)
+    {
+        printf("Could not initialize the helpers\n");
+        return 1;
+    }
+
+    const int size = 16;
+    std::vector<float> floatData(4 * size);
+    std::vector<double> doubleData(4 * size);
+    jobject floatIn = newPointer(floatData.data(), 2 * size * sizeof(float));
+    jobject floatOut = newPointer(floatData.data() + 2 * size, 2 * size * sizeof(float));
+    jobject doubleIn = newPointer(doubleData.data(), 2 * size * sizeof(double));
+    jobject doubleOut = newPointer(doubleData.data() + 2 * size, 2 * size * sizeof(double));
+    jobject stream = newObject("jcuda/runtime/cudaStream_t");
+    jobject temp = newObject("jcuda/jcufft/cufftHandle");
+    jintArray intValue = newIntArray({ 0 });
+    jlongArray workSize = newLongArray({ 0 });
+    jintArray n2 = newIntArray({ size, size });
+    jlongArray n2Long = newLongArray({ size, size });
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionDescribe();
+        printf("Could not create the benchmark data\n");
+        return 1;
+    }
+
+    // One plan of each type, for the exec functions
+    jobject plans[6];
+    int types[6] = { CUFFT_C2C, CUFFT_R2C, CUFFT_C2R, CUFFT_Z2Z, CUFFT_D2Z, CUFFT_Z2D };
+    for (int i = 0; i < 6; i++)
+    {
+        plans[i] = newObject("jcuda/jcufft/cufftHandle");
+        Java_jcuda_jcufft_JCufft_cufftPlan1dNative(env, NULL, plans[i], size, types[i], 1);
+    }
+    jobject c2c = plans[0];
+    jfieldID tokenField = env->GetFieldID(env->GetObjectClass(c2c), "token", "J");
+
+    // The native plan behind the token of the C2C plan, for the calls
+    // without JNI. The reference is released immediately, so that the
+    // plan can be destroyed at the end of the benchmark
+    cufftHandle nativeC2C = 0;
+    {
+        PlanReference reference(env, c2c);
+        if (!reference.valid())
+        {
+            printf("Could not resolve the plan handle\n");
+            return 1;
+        }
+        nativeC2C = reference.plan();
+    }
+
+    printf("JNI entry points, %lld iterations\n", iterations);
+
+    run("setLogLevel", [&]() {
+        Java_jcuda_jcufft_JCufft_setLogLevel(env, NULL, LOG_QUIET); });
+    run("cufftGetVersion", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftGetVersionNative(env, NULL, intValue); });
+    run("cufftGetProperty", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftGetPropertyNative(env, NULL, MAJOR_VERSION, intValue); });
+    run("cufftPlan1d + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftPlan1dNative(env, NULL, temp, size, CUFFT_C2C, 1);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftPlan2d + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftPlan2dNative(env, NULL, temp, size, size, CUFFT_C2C);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftPlan3d + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftPlan3dNative(env, NULL, temp, size, size, size, CUFFT_C2C);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftPlanMany + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftPlanManyNative(env, NULL, temp, 2, n2, NULL, 1, 0, NULL, 1, 0, CUFFT_C2C, 1);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftCreate + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftCreateNative(env, NULL, temp);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftCreate + cufftMakePlan1d + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftCreateNative(env, NULL, temp);
+        Java_jcuda_jcufft_JCufft_cufftMakePlan1dNative(env, NULL, temp, size, CUFFT_C2C, 1, workSize);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftCreate + cufftMakePlan2d + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftCreateNative(env, NULL, temp);
+        Java_jcuda_jcufft_JCufft_cufftMakePlan2dNative(env, NULL, temp, size, size, CUFFT_C2C, workSize);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftCreate + cufftMakePlan3d + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftCreateNative(env, NULL, temp);
+        Java_jcuda_jcufft_JCufft_cufftMakePlan3dNative(env, NULL, temp, size, size, size, CUFFT_C2C, workSize);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftCreate + cufftMakePlanMany + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftCreateNative(env, NULL, temp);
+        Java_jcuda_jcufft_JCufft_cufftMakePlanManyNative(env, NULL, temp, 2, n2, NULL, 1, 0, NULL, 1, 0, CUFFT_C2C, 1, workSize);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftCreate + cufftMakePlanMany64 + cufftDestroy", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftCreateNative(env, NULL, temp);
+        Java_jcuda_jcufft_JCufft_cufftMakePlanManyNative64(env, NULL, temp, 2, n2Long, NULL, 1, 0, NULL, 1, 0, CUFFT_C2C, 1, workSize);
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, temp); });
+    run("cufftGetSizeMany64", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftGetSizeMany64Native(env, NULL, c2c, 2, n2Long, NULL, 1, 0, NULL, 1, 0, CUFFT_C2C, 1, workSize); });
+    run("cufftEstimate1d", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftEstimate1dNative(env, NULL, size, CUFFT_C2C, 1, workSize); });
+    run("cufftEstimate2d", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftEstimate2dNative(env, NULL, size, size, CUFFT_C2C, workSize); });
+    run("cufftEstimate3d", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftEstimate3dNative(env, NULL, size, size, size, CUFFT_C2C, workSize); });
+    run("cufftEstimateMany", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftEstimateManyNative(env, NULL, 2, n2, NULL, 1, 0, NULL, 1, 0, CUFFT_C2C, 1, workSize); });
+    run("cufftGetSize1d", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftGetSize1dNative(env, NULL, c2c, size, CUFFT_C2C, 1, workSize); });
+    run("cufftGetSize2d", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftGetSize2dNative(env, NULL, c2c, size, size, CUFFT_C2C, workSize); });
+    run("cufftGetSize3d", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftGetSize3dNative(env, NULL, c2c, size, size, size, CUFFT_C2C, workSize); });
+    run("cufftGetSizeMany", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftGetSizeManyNative(env, NULL, c2c, 2, n2, NULL, 1, 0, NULL, 1, 0, CUFFT_C2C, 1, workSize); });
+    run("cufftGetSize", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftGetSizeNative(env, NULL, c2c, workSize); });
+    run("cufftSetWorkArea", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftSetWorkAreaNative(env, NULL, c2c, floatOut); });
+    run("cufftSetAutoAllocation", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftSetAutoAllocationNative(env, NULL, c2c, 1); });
+    run("cufftSetStream", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftSetStreamNative(env, NULL, c2c, stream); });
+    run("cufftExecC2C", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftExecC2CNative(env, NULL, plans[0], floatIn, floatOut, CUFFT_FORWARD); });
+    run("cufftExecR2C", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftExecR2CNative(env, NULL, plans[1], floatIn, floatOut); });
+    run("cufftExecC2R", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftExecC2RNative(env, NULL, plans[2], floatIn, floatOut); });
+    run("cufftExecZ2Z", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftExecZ2ZNative(env, NULL, plans[3], doubleIn, doubleOut, CUFFT_FORWARD); });
+    run("cufftExecD2Z", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftExecD2ZNative(env, NULL, plans[4], doubleIn, doubleOut); });
+    run("cufftExecZ2D", [&]() {
+        Java_jcuda_jcufft_JCufft_cufftExecZ2DNative(env, NULL, plans[5], doubleIn, doubleOut); });
+
+    printf("\nNative helpers, %lld iterations\n", iterations);
+
+    run("GetLongField", [&]() {
+        env->GetLongField(c2c, tokenField); });
+    run("PlanReference (token lookup)", [&]() {
+        PlanReference reference(env, c2c);
+        reference.plan(); });
+    run("getPointer", [&]() {
+        getPointer(env, floatIn); });
+    run("getArrayContents(jintArray) + delete[]", [&]() {
+        int *contents = getArrayContents(env, n2);
+        delete[] contents; });
+    run("getArrayContents(jlongArray) + delete[]", [&]() {
+        long long *contents = getArrayContents(env, n2Long);
+        delete[] contents; });
+    run("set(jlongArray)", [&]() {
+        set(env, workSize, 0, (jlong)0); });
+    run("Logger::log (disabled)", [&]() {
+        Logger::log(LOG_TRACE, "Executing %s\n", "cufftExecC2C"); });
+
+    printf("\nCUFFT stand-in without JNI, %lld iterations\n", iterations);
+
+    int nativeN2[] = { size, size };
+    size_t nativeWorkSize = 0;
+    run("cufftPlanMany + cufftDestroy", [&]() {
+        cufftHandle plan;
+        cufftPlanMany(&plan, 2, nativeN2, NULL, 1, 0, NULL, 1, 0, CUFFT_C2C, 1);
+        cufftDestroy(plan); });
+    run("cufftEstimateMany", [&]() {
+        cufftEstimateMany(2, nativeN2, NULL, 1, 0, NULL, 1, 0, CUFFT_C2C, 1, &nativeWorkSize); });
+    run("cufftGetSize", [&]() {
+        cufftGetSize(nativeC2C, &nativeWorkSize); });
+    run("cufftExecC2C", [&]() {
+        cufftExecC2C(nativeC2C, (cufftComplex*)floatData.data(),
+            (cufftComplex*)(floatData.data() + 2 * size), CUFFT_FORWARD); });
+
+    for (int i = 0; i < 6; i++)
+    {
+        Java_jcuda_jcufft_JCufft_cufftDestroyNative(env, NULL, plans[i]);
+    }
+    jvm->DestroyJavaVM();
+    return failures == 0 ? 0 : 1;
+}
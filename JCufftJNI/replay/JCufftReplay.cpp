@@ -0,0 +1,667 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * A tool for replaying the call records that have been written by
+ * the JCufft recorder (see JCufft#startRecording).
+ *
+ * The plans are re-created with the recorded geometries, and each
+ * recorded exec call is executed on buffers of the size that is
+ * required by the plan, synchronizing the device before and after
+ * the call. The times are summarized for each plan geometry, and
+ * compared to the recorded host times of the calls. Calls that have
+ * failed during the recording are skipped.
+ *
+ * When the tool is built with the JCUFFT_STUB_BACKEND option, the
+ * records are replayed against the CPU stand-in for CUFFT, using
+ * host memory.
+ *
+ * Usage: JCufftReplay [-r repetitions] [-v] recordFile
+ */
+
+#include <cufft.h>
+#ifndef JCUFFT_STUB_BACKEND
+#include <cuda_runtime.h>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "JCufftRecordFormat.hpp"
+
+/**
+ * The state of a replayed plan
+ */
+struct ReplayPlan
+{
+    cufftHandle handle;
+    bool made;
+    JCufftPlanRecord geometry;
+    void *input;
+    void *output;
+    size_t inputSize;
+    size_t outputSize;
+    void *workArea;
+};
+
+/**
+ * The summary of the exec calls for one plan geometry
+ */
+struct Summary
+{
+    long long count;
+    double recordedTotal;
+    double replayedTotal;
+    double replayedMin;
+    double replayedMax;
+};
+
+/**
+ * Whether messages about skipped records should be printed
+ */
+static bool verbose = false;
+
+/**
+ * Returns the current value of a monotonic clock, in nanoseconds
+ */
+static double nanos()
+{
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Allocates zero-initialized memory of the given size for the transforms
+ */
+static void *allocate(size_t size)
+{
+    void *pointer = NULL;
+#ifdef JCUFFT_STUB_BACKEND
+    pointer = calloc(size, 1);
+#else
+    if (cudaMalloc(&pointer, size) != cudaSuccess)
+    {
+        return NULL;
+    }
+    cudaMemset(pointer, 0, size);
+#endif
+    return pointer;
+}
+
+/**
+ * Frees the given memory
+ */
+static void release(void *pointer)
+{
+    if (pointer == NULL)
+    {
+        return;
+    }
+#ifdef JCUFFT_STUB_BACKEND
+    free(pointer);
+#else
+    cudaFree(pointer);
+#endif
+}
+
+/**
+ * Waits until all pending work is finished
+ */
+static void synchronize()
+{
+#ifndef JCUFFT_STUB_BACKEND
+    cudaDeviceSynchronize();
+#endif
+}
+
+/**
+ * Returns whether the given type has real input data
+ */
+static bool isRealInput(int type)
+{
+    return type == CUFFT_R2C || type == CUFFT_D2Z;
+}
+
+/**
+ * Returns whether the given type has real output data
+ */
+static bool isRealOutput(int type)
+{
+    return type == CUFFT_C2R || type == CUFFT_Z2D;
+}
+
+/**
+ * Returns whether the given type is a double precision type
+ */
+static bool isDouble(int type)
+{
+    return type == CUFFT_Z2Z || type == CUFFT_D2Z || type == CUFFT_Z2D;
+}
+
+/**
+ * Computes the number of bytes that are accessed on one side of the
+ * transform that is described by the given geometry
+ */
+static size_t extent(const JCufftPlanRecord &g, bool input)
+{
+    bool real = input ? isRealInput(g.type) : isRealOutput(g.type);
+    bool halfComplex = !real && (isRealInput(g.type) || isRealOutput(g.type));
+    const int64_t *embed = input ? g.inembed : g.onembed;
+    int flag = input ? JCUFFT_PLAN_FLAG_INEMBED : JCUFFT_PLAN_FLAG_ONEMBED;
+    int64_t stride = input ? g.istride : g.ostride;
+    int64_t dist = input ? g.idist : g.odist;
+
+    int64_t dims[3];
+    for (int i = 0; i < g.rank; i++)
+    {
+        dims[i] = g.n[i];
+    }
+    if (halfComplex)
+    {
+        dims[g.rank - 1] = dims[g.rank - 1] / 2 + 1;
+    }
+
+    int64_t elements = 0;
+    if ((g.flags & flag) == 0)
+    {
+        int64_t perBatch = 1;
+        for (int i = 0; i < g.rank; i++)
+        {
+            perBatch *= dims[i];
+        }
+        elements = perBatch * g.batch;
+    }
+    else
+    {
+        int64_t lastOffset = 0;
+        int64_t pitch = stride;
+        for (int i = g.rank - 1; i >= 0; i--)
+        {
+            lastOffset += (dims[i] - 1) * pitch;
+            pitch *= embed[i];
+        }
+        elements = (g.batch - 1) * dist + lastOffset + 1;
+    }
+    size_t size = isDouble(g.type) ? sizeof(double) : sizeof(float);
+    return (size_t)elements * (real ? size : 2 * size);
+}
+
+/**
+ * Returns a description of the given geometry, for the summary
+ */
+static std::string describe(const JCufftPlanRecord &g)
+{
+    const char *typeName = "?";
+    switch (g.type)
+    {
+        case CUFFT_C2C: typeName = "C2C"; break;
+        case CUFFT_R2C: typeName = "R2C"; break;
+        case CUFFT_C2R: typeName = "C2R"; break;
+        case CUFFT_Z2Z: typeName = "Z2Z"; break;
+        case CUFFT_D2Z: typeName = "D2Z"; break;
+        case CUFFT_Z2D: typeName = "Z2D"; break;
+    }
+    std::string result = typeName;
+    result += " ";
+    for (int i = 0; i < g.rank; i++)
+    {
+        if (i > 0)
+        {
+            result += "x";
+        }
+        result += std::to_string((long long)g.n[i]);
+    }
+    result += " batch " + std::to_string((long long)g.batch);
+    if (g.flags != 0)
+    {
+        result += " (advanced layout)";
+    }
+    return result;
+}
+
+/**
+ * Creates the given plan with the given geometry
+ */
+static cufftResult makePlan(ReplayPlan &plan, const JCufftPlanRecord &g)
+{
+    long long n[3];
+    long long inembed[3];
+    long long onembed[3];
+    for (int i = 0; i < g.rank; i++)
+    {
+        n[i] = g.n[i];
+        inembed[i] = g.inembed[i];
+        onembed[i] = g.onembed[i];
+    }
+    size_t workSize = 0;
+    cufftResult result = cufftMakePlanMany64(plan.handle, g.rank, n,
+        (g.flags & JCUFFT_PLAN_FLAG_INEMBED) ? inembed : NULL, g.istride, g.idist,
+        (g.flags & JCUFFT_PLAN_FLAG_ONEMBED) ? onembed : NULL, g.ostride, g.odist,
+        (cufftType)g.type, g.batch, &workSize);
+    if (result == CUFFT_SUCCESS)
+    {
+        plan.made = true;
+        plan.geometry = g;
+    }
+    return result;
+}
+
+/**
+ * Releases the buffers and the work area of the given plan
+ */
+static void releaseBuffers(ReplayPlan &plan)
+{
+    release(plan.input);
+    if (plan.output != plan.input)
+    {
+        release(plan.output);
+    }
+    release(plan.workArea);
+    plan.input = NULL;
+    plan.output = NULL;
+    plan.workArea = NULL;
+}
+
+/**
+ * Replays the records of the given file
+ */
+class Replayer
+{
+public:
+    Replayer() : records(0), skipped(0), failed(0), planTime(0)
+    {
+    }
+
+    ~Replayer()
+    {
+        for (std::map<int32_t, ReplayPlan>::iterator i = plans.begin(); i != plans.end(); ++i)
+        {
+            releaseBuffers(i->second);
+            cufftDestroy(i->second.handle);
+        }
+#ifndef JCUFFT_STUB_BACKEND
+        for (std::map<uint64_t, cudaStream_t>::iterator i = streams.begin(); i != streams.end(); ++i)
+        {
+            cudaStreamDestroy(i->second);
+        }
+#endif
+    }
+
+    bool replay(FILE *file)
+    {
+        JCufftRecordFileHeader fileHeader;
+        if (fread(&fileHeader, sizeof(fileHeader), 1, file) != 1 ||
+            memcmp(fileHeader.magic, JCUFFT_RECORD_MAGIC, sizeof(fileHeader.magic)) != 0)
+        {
+            fprintf(stderr, "Not a JCufft record file\n");
+            return false;
+        }
+        if (fileHeader.version != JCUFFT_RECORD_VERSION)
+        {
+            fprintf(stderr, "Unsupported record version %u\n", fileHeader.version);
+            return false;
+        }
+        fseek(file, (long)fileHeader.headerSize, SEEK_SET);
+
+        union
+        {
+            JCufftRecordHeader header;
+            JCufftPlanRecord plan;
+            JCufftHandleRecord handle;
+            JCufftExecRecord exec;
+            char bytes[1024];
+        } record;
+        while (fread(&record.header, sizeof(record.header), 1, file) == 1)
+        {
+            size_t size = record.header.size;
+            if (size < sizeof(record.header) || size > sizeof(record))
+            {
+                fprintf(stderr, "Invalid record size %u\n", (unsigned)size);
+                return false;
+            }
+            size_t remaining = size - sizeof(record.header);
+            if (remaining > 0 && fread(record.bytes + sizeof(record.header), remaining, 1, file) != 1)
+            {
+                fprintf(stderr, "Truncated record file\n");
+                break;
+            }
+            records++;
+            if (record.header.result != CUFFT_SUCCESS)
+            {
+                skipped++;
+                continue;
+            }
+            cufftResult result = CUFFT_SUCCESS;
+            switch (record.header.type)
+            {
+                case JCUFFT_RECORD_CREATE: result = create(record.handle.plan); break;
+                case JCUFFT_RECORD_DESTROY: result = destroy(record.handle.plan); break;
+                case JCUFFT_RECORD_PLAN: result = plan(record.plan); break;
+                case JCUFFT_RECORD_SET_STREAM: result = setStream(record.handle); break;
+                case JCUFFT_RECORD_SET_AUTO_ALLOCATION: result = setAutoAllocation(record.handle); break;
+                case JCUFFT_RECORD_SET_WORK_AREA: result = setWorkArea(record.handle); break;
+                case JCUFFT_RECORD_EXEC: result = exec(record.exec); break;
+                default:
+                    skipped++;
+                    break;
+            }
+            if (result != CUFFT_SUCCESS)
+            {
+                failed++;
+                if (verbose)
+                {
+                    fprintf(stderr, "Record %lld of type %d failed with %d\n",
+                        records, (int)record.header.type, (int)result);
+                }
+            }
+        }
+        return true;
+    }
+
+    void report(int repetitions)
+    {
+        printf("%lld records, %lld skipped, %lld failed during replay\n",
+            records, skipped, failed);
+        printf("Plan creation: %.3f ms\n", planTime / 1.0e6);
+        printf("%-40s %10s %14s %14s %14s %14s\n", "Geometry", "Calls",
+            "Recorded(us)", "Mean(us)", "Min(us)", "Max(us)");
+        for (std::map<std::string, Summary>::iterator i = summaries.begin(); i != summaries.end(); ++i)
+        {
+            const Summary &s = i->second;
+            printf("%-40s %10lld %14.3f %14.3f %14.3f %14.3f\n", i->first.c_str(),
+                s.count / repetitions,
+                s.recordedTotal / s.count / 1.0e3,
+                s.replayedTotal / s.count / 1.0e3,
+                s.replayedMin / 1.0e3,
+                s.replayedMax / 1.0e3);
+        }
+    }
+
+private:
+    cufftResult create(int32_t id)
+    {
+        ReplayPlan plan = {};
+        cufftResult result = cufftCreate(&plan.handle);
+        if (result == CUFFT_SUCCESS)
+        {
+            destroy(id);
+            plans[id] = plan;
+        }
+        return result;
+    }
+
+    cufftResult destroy(int32_t id)
+    {
+        std::map<int32_t, ReplayPlan>::iterator i = plans.find(id);
+        if (i == plans.end())
+        {
+            return CUFFT_SUCCESS;
+        }
+        releaseBuffers(i->second);
+        cufftResult result = cufftDestroy(i->second.handle);
+        plans.erase(i);
+        return result;
+    }
+
+    ReplayPlan *find(int32_t id)
+    {
+        std::map<int32_t, ReplayPlan>::iterator i = plans.find(id);
+        if (i == plans.end())
+        {
+            if (verbose)
+            {
+                fprintf(stderr, "Unknown plan %d\n", (int)id);
+            }
+            return NULL;
+        }
+        return &i->second;
+    }
+
+    cufftResult plan(const JCufftPlanRecord &g)
+    {
+        if (g.rank < 1 || g.rank > 3)
+        {
+            return CUFFT_INVALID_SIZE;
+        }
+        if (g.function == JCUFFT_FUNCTION_ESTIMATE || g.function == JCUFFT_FUNCTION_GET_SIZE)
+        {
+            // These do not change the state of a plan
+            return CUFFT_SUCCESS;
+        }
+        if (g.function == JCUFFT_FUNCTION_PLAN)
+        {
+            cufftResult result = create(g.plan);
+            if (result != CUFFT_SUCCESS)
+            {
+                return result;
+            }
+        }
+        ReplayPlan *p = find(g.plan);
+        if (p == NULL)
+        {
+            return CUFFT_INVALID_PLAN;
+        }
+        double before = nanos();
+        cufftResult result = makePlan(*p, g);
+        planTime += nanos() - before;
+        return result;
+    }
+
+    cufftResult setStream(const JCufftHandleRecord &r)
+    {
+        ReplayPlan *p = find(r.plan);
+        if (p == NULL)
+        {
+            return CUFFT_INVALID_PLAN;
+        }
+#ifdef JCUFFT_STUB_BACKEND
+        return cufftSetStream(p->handle, NULL);
+#else
+        cudaStream_t stream = NULL;
+        if (r.address != 0)
+        {
+            std::map<uint64_t, cudaStream_t>::iterator i = streams.find(r.address);
+            if (i == streams.end())
+            {
+                cudaStreamCreate(&stream);
+                streams[r.address] = stream;
+            }
+            else
+            {
+                stream = i->second;
+            }
+        }
+        return cufftSetStream(p->handle, stream);
+#endif
+    }
+
+    cufftResult setAutoAllocation(const JCufftHandleRecord &r)
+    {
+        ReplayPlan *p = find(r.plan);
+        if (p == NULL)
+        {
+            return CUFFT_INVALID_PLAN;
+        }
+        return cufftSetAutoAllocation(p->handle, r.value);
+    }
+
+    cufftResult setWorkArea(const JCufftHandleRecord &r)
+    {
+        ReplayPlan *p = find(r.plan);
+        if (p == NULL)
+        {
+            return CUFFT_INVALID_PLAN;
+        }
+        size_t workSize = 0;
+        cufftResult result = cufftGetSize(p->handle, &workSize);
+        if (result != CUFFT_SUCCESS)
+        {
+            return result;
+        }
+        release(p->workArea);
+        p->workArea = allocate(std::max(workSize, (size_t)1));
+        if (p->workArea == NULL)
+        {
+            return CUFFT_ALLOC_FAILED;
+        }
+        return cufftSetWorkArea(p->handle, p->workArea);
+    }
+
+    cufftResult exec(const JCufftExecRecord &r)
+    {
+        ReplayPlan *p = find(r.plan);
+        if (p == NULL || !p->made)
+        {
+            return CUFFT_INVALID_PLAN;
+        }
+        bool inPlace = (r.idata == r.odata);
+        size_t inputSize = extent(p->geometry, true);
+        size_t outputSize = extent(p->geometry, false);
+        if (inPlace)
+        {
+            inputSize = outputSize = std::max(inputSize, outputSize);
+        }
+        if (p->input == NULL || p->inputSize != inputSize || p->outputSize != outputSize ||
+            (p->input == p->output) != inPlace)
+        {
+            releaseBuffers(*p);
+            p->input = allocate(inputSize);
+            p->output = inPlace ? p->input : allocate(outputSize);
+            p->inputSize = inputSize;
+            p->outputSize = outputSize;
+            if (p->input == NULL || p->output == NULL)
+            {
+                return CUFFT_ALLOC_FAILED;
+            }
+        }
+
+        synchronize();
+        double before = nanos();
+        cufftResult result = CUFFT_INVALID_TYPE;
+        switch (r.type)
+        {
+            case CUFFT_C2C:
+                result = cufftExecC2C(p->handle, (cufftComplex*)p->input, (cufftComplex*)p->output, r.direction);
+                break;
+            case CUFFT_R2C:
+                result = cufftExecR2C(p->handle, (cufftReal*)p->input, (cufftComplex*)p->output);
+                break;
+            case CUFFT_C2R:
+                result = cufftExecC2R(p->handle, (cufftComplex*)p->input, (cufftReal*)p->output);
+                break;
+            case CUFFT_Z2Z:
+                result = cufftExecZ2Z(p->handle, (cufftDoubleComplex*)p->input, (cufftDoubleComplex*)p->output, r.direction);
+                break;
+            case CUFFT_D2Z:
+                result = cufftExecD2Z(p->handle, (cufftDoubleReal*)p->input, (cufftDoubleComplex*)p->output);
+                break;
+            case CUFFT_Z2D:
+                result = cufftExecZ2D(p->handle, (cufftDoubleComplex*)p->input, (cufftDoubleReal*)p->output);
+                break;
+        }
+        synchronize();
+        double duration = nanos() - before;
+        if (result != CUFFT_SUCCESS)
+        {
+            return result;
+        }
+
+        Summary &s = summaries[describe(p->geometry)];
+        if (s.count == 0 || duration < s.replayedMin)
+        {
+            s.replayedMin = duration;
+        }
+        s.replayedMax = std::max(s.replayedMax, duration);
+        s.count++;
+        s.recordedTotal += (double)r.header.durationNanos;
+        s.replayedTotal += duration;
+        return result;
+    }
+
+    std::map<int32_t, ReplayPlan> plans;
+#ifndef JCUFFT_STUB_BACKEND
+    std::map<uint64_t, cudaStream_t> streams;
+#endif
+    std::map<std::string, Summary> summaries;
+    long long records;
+    long long skipped;
+    long long failed;
+    double planTime;
+};
+
+int main(int argc, char *argv[])
+{
+    int repetitions = 1;
+    const char *fileName = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            repetitions = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "-v") == 0)
+        {
+            verbose = true;
+        }
+        else
+        {
+            fileName = argv[i];
+        }
+    }
+    if (fileName == NULL)
+    {
+        fprintf(stderr, "Usage: JCufftReplay [-r repetitions] [-v] recordFile\n");
+        return 1;
+    }
+
+    Replayer replayer;
+    for (int i = 0; i < repetitions; i++)
+    {
+        FILE *file = fopen(fileName, "rb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "Could not open %s\n", fileName);
+            return 1;
+        }
+        bool valid = replayer.replay(file);
+        fclose(file);
+        if (!valid)
+        {
+            return 1;
+        }
+    }
+    replayer.report(repetitions);
+    return 0;
+}
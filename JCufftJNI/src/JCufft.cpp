@@ -27,11 +27,24 @@
  */
 
 #include "JCufft.hpp"
+#include "JCufftStatistics.hpp"
+#include "JCufftRecorder.hpp"
+#include "JCufftRanges.hpp"
+#include "JCufftKernels.hpp"
+#include "JCufftInterleave.hpp"
+#include "JCufftHermitian.hpp"
+#include "JCufftEstimateCache.hpp"
+#include "JCufftHandles.hpp"
 #include "JCufft_common.hpp"
 #include <iostream>
 #include <cuda_runtime.h>
 
-jfieldID cufftHandle_plan; // int
+jfieldID cufftHandle_token; // long
+
+// Field IDs for resolving jcuda.Pointer objects
+static jfieldID Pointer_nativePointer; // long
+static jfieldID Pointer_byteOffset; // long
+static jfieldID Pointer_buffer; // Buffer
 
 
 /**
@@ -44,7 +57,7 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *jvm, void *reserved)
     {
         return JNI_ERR;
     }
-    Logger::log(LOG_TRACE, "Initializing JCufft\n");
+    JCUFFT_TRACE("Initializing JCufft\n");
 
     jclass cls = NULL;
 
@@ -52,9 +65,16 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *jvm, void *reserved)
     if (initJNIUtils(env) == JNI_ERR) return JNI_ERR;
     if (initPointerUtils(env) == JNI_ERR) return JNI_ERR;
 
-    // Obtain the methodID for cufftHandle#plan
+    // Obtain the fieldID for cufftHandle#token
     if (!init(env, cls, "jcuda/jcufft/cufftHandle")) return JNI_ERR;
-    if (!init(env, cls, cufftHandle_plan, "plan", "I")) return JNI_ERR;
+    if (!init(env, cls, cufftHandle_token, "token", "J")) return JNI_ERR;
+
+    // Obtain the fieldIDs for resolving Pointer objects
+    if (!init(env, cls, "jcuda/NativePointerObject")) return JNI_ERR;
+    if (!init(env, cls, Pointer_nativePointer, "nativePointer", "J")) return JNI_ERR;
+    if (!init(env, cls, "jcuda/Pointer")) return JNI_ERR;
+    if (!init(env, cls, Pointer_byteOffset, "byteOffset", "J")) return JNI_ERR;
+    if (!init(env, cls, Pointer_buffer, "buffer", "Ljava/nio/Buffer;")) return JNI_ERR;
 
     return JNI_VERSION_1_4;
 }
@@ -78,6 +98,172 @@ cufftType getCufftType(int type)
     return CUFFT_C2C;
 }
 
+/**
+ * Returns the address that the given Pointer object points to. This is
+ * the native pointer plus the byte offset, or, for a Pointer to a direct
+ * buffer, the address of the buffer plus the byte offset.
+ */
+static inline void *getDataPointer(JNIEnv *env, jobject pointer)
+{
+    if (pointer == NULL)
+    {
+        return NULL;
+    }
+    jlong address = env->GetLongField(pointer, Pointer_nativePointer);
+    jlong byteOffset = env->GetLongField(pointer, Pointer_byteOffset);
+    if (address == 0)
+    {
+        jobject buffer = env->GetObjectField(pointer, Pointer_buffer);
+        if (buffer != NULL)
+        {
+            address = (jlong)(intptr_t)env->GetDirectBufferAddress(buffer);
+            env->DeleteLocalRef(buffer);
+        }
+    }
+    return (void*)(intptr_t)(address + byteOffset);
+}
+
+/**
+ * Writes the given value into the first element of the given array.
+ * Returns false if an exception is pending afterwards.
+ */
+static inline bool writeValue(JNIEnv *env, jlongArray array, size_t value)
+{
+    jlong element = (jlong)value;
+    env->SetLongArrayRegion(array, 0, 1, &element);
+    return !env->ExceptionCheck();
+}
+
+/**
+ * Writes the given value into the first element of the given array.
+ * Returns false if an exception is pending afterwards.
+ */
+static inline bool writeValue(JNIEnv *env, jintArray array, int value)
+{
+    jint element = (jint)value;
+    env->SetIntArrayRegion(array, 0, 1, &element);
+    return !env->ExceptionCheck();
+}
+
+/**
+ * Fixed storage for the 'n', 'inembed' and 'onembed' arrays of the
+ * cufftPlanMany family of functions. The pointers are NULL if the
+ * respective Java array was null.
+ */
+template <typename T>
+struct Layout
+{
+    T nData[JCUFFT_MAX_RANK];
+    T inembedData[JCUFFT_MAX_RANK];
+    T onembedData[JCUFFT_MAX_RANK];
+    T *n;
+    T *inembed;
+    T *onembed;
+};
+
+/**
+ * Copies the first 'rank' elements of the given array into the given
+ * target, and returns the target, or NULL if the array is NULL or an
+ * exception is pending afterwards
+ */
+static int *readRankArray(JNIEnv *env, jintArray array, jint rank, int *target)
+{
+    if (array == NULL)
+    {
+        return NULL;
+    }
+    jint values[JCUFFT_MAX_RANK];
+    env->GetIntArrayRegion(array, 0, rank, values);
+    for (int i = 0; i < rank; i++)
+    {
+        target[i] = (int)values[i];
+    }
+    return target;
+}
+
+/**
+ * Copies the first 'rank' elements of the given array into the given
+ * target, and returns the target, or NULL if the array is NULL or an
+ * exception is pending afterwards
+ */
+static long long *readRankArray(JNIEnv *env, jlongArray array, jint rank, long long *target)
+{
+    if (array == NULL)
+    {
+        return NULL;
+    }
+    jlong values[JCUFFT_MAX_RANK];
+    env->GetLongArrayRegion(array, 0, rank, values);
+    for (int i = 0; i < rank; i++)
+    {
+        target[i] = (long long)values[i];
+    }
+    return target;
+}
+
+/**
+ * Reads the given arrays into the given layout, without allocating
+ * memory. Returns CUFFT_SUCCESS, CUFFT_INVALID_SIZE if the rank is
+ * not supported by CUFFT, or JCUFFT_INTERNAL_ERROR if an array was
+ * too short, in which case an exception is pending.
+ */
+template <typename T, typename ArrayType>
+static int readLayout(JNIEnv *env, jint rank, ArrayType n, ArrayType inembed, ArrayType onembed, Layout<T> &layout)
+{
+    if (rank < 1 || rank > JCUFFT_MAX_RANK)
+    {
+        return CUFFT_INVALID_SIZE;
+    }
+    layout.n = readRankArray(env, n, rank, layout.nData);
+    if (env->ExceptionCheck()) return JCUFFT_INTERNAL_ERROR;
+    layout.inembed = readRankArray(env, inembed, rank, layout.inembedData);
+    if (env->ExceptionCheck()) return JCUFFT_INTERNAL_ERROR;
+    layout.onembed = readRankArray(env, onembed, rank, layout.onembedData);
+    if (env->ExceptionCheck()) return JCUFFT_INTERNAL_ERROR;
+    return CUFFT_SUCCESS;
+}
+
+/**
+ * Stores the given geometry in the given slot of the handle table, and
+ * notifies the statistics and the range annotations that the plan has
+ * been created successfully with this geometry
+ */
+template <typename T>
+static inline void planCreated(HandleEntry *entry, int rank, const T *n, int type, long long batch)
+{
+    handleTableSetGeometry(entry, rank, n, type, batch);
+#if defined(JCUFFT_ENABLE_STATISTICS) || defined(JCUFFT_ENABLE_RANGES)
+    JCUFFT_PLAN_CREATED(entry);
+    JCUFFT_RANGES_PLAN_CREATED(entry);
+#endif
+}
+
+/**
+ * Registers the given plan, which has just been created, in the handle
+ * table, and stores its token in the given cufftHandle object. The
+ * geometry is only stored if the rank is positive. If the table is
+ * full, then the plan is destroyed and CUFFT_ALLOC_FAILED is returned.
+ */
+template <typename T>
+static cufftResult registerPlan(JNIEnv *env, jobject handle, cufftHandle plan, int rank, const T *n, int type, long long batch)
+{
+    jlong token = handleTableRegister(plan);
+    if (token == 0)
+    {
+        Logger::log(LOG_ERROR, "The handle table is full\n");
+        cufftDestroy(plan);
+        return CUFFT_ALLOC_FAILED;
+    }
+    if (rank > 0)
+    {
+        HandleEntry *entry = handleTableAcquire(token);
+        planCreated(entry, rank, n, type, batch);
+        handleTableRelease(entry);
+    }
+    env->SetLongField(handle, cufftHandle_token, token);
+    return CUFFT_SUCCESS;
+}
+
 
 /*
  * Set the log level
@@ -107,11 +293,11 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftGetVersionNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftGetVersion\n");
+    JCUFFT_TRACE("Executing cufftGetVersion\n");
 
     int nativeVersion = 0;
     int result = cufftGetVersion(&nativeVersion);
-    set(env, version, 0, nativeVersion);
+    if (!writeValue(env, version, nativeVersion)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -126,7 +312,7 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftGetPropertyNative(JNIEnv *e
     }
 
     // Log message
-    Logger::log(LOG_TRACE, "Executing cufftGetProperty(type=%d, value=%p)\n",
+    JCUFFT_TRACE("Executing cufftGetProperty(type=%d, value=%p)\n",
         type, value);
 
     // Native variable declarations
@@ -142,7 +328,7 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftGetPropertyNative(JNIEnv *e
 
     // Write back native variable values
     // type is primitive
-    if (!set(env, value, 0, (jint)value_native)) return JCUFFT_INTERNAL_ERROR;
+    if (!writeValue(env, value, value_native)) return JCUFFT_INTERNAL_ERROR;
 
     // Return the result
     jint jniResult = (jint)jniResult_native;
@@ -166,11 +352,19 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftPlan1dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Creating 1D plan for %d elements of type %d\n", nx, type);
+    JCUFFT_TRACE("Creating 1D plan for %d elements of type %d\n", nx, type);
 
-    cufftHandle plan = env->GetIntField(handle, cufftHandle_plan);
+    cufftHandle plan = 0;
+    JCUFFT_RANGE_BEGIN_PLAN(env, "cufftPlan1d", 1, Dims(nx).values, getCufftType(type), batch);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftPlan1d(&plan, nx, getCufftType(type), batch);
-    env->SetIntField(handle, cufftHandle_plan, plan);
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_PLAN, plan, 1, Dims(nx).values, getCufftType(type), batch, 0);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        int dims[] = { nx };
+        result = registerPlan(env, handle, plan, 1, dims, type, batch);
+    }
     return result;
 }
 
@@ -188,11 +382,19 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftPlan2dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Creating 2D plan for (%d, %d) elements of type %d\n", nx, ny, type);
+    JCUFFT_TRACE("Creating 2D plan for (%d, %d) elements of type %d\n", nx, ny, type);
 
-    cufftHandle plan = env->GetIntField(handle, cufftHandle_plan);
+    cufftHandle plan = 0;
+    JCUFFT_RANGE_BEGIN_PLAN(env, "cufftPlan2d", 2, Dims(nx, ny).values, getCufftType(type), 1);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftPlan2d(&plan, nx, ny, getCufftType(type));
-    env->SetIntField(handle, cufftHandle_plan, plan);
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_PLAN, plan, 2, Dims(nx, ny).values, getCufftType(type), 1, 0);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        int dims[] = { nx, ny };
+        result = registerPlan(env, handle, plan, 2, dims, type, 1);
+    }
     return result;
 }
 
@@ -210,11 +412,19 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftPlan3dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Creating 3D plan for (%d, %d, %d) elements of type %d\n", nx, ny, nz, type);
+    JCUFFT_TRACE("Creating 3D plan for (%d, %d, %d) elements of type %d\n", nx, ny, nz, type);
 
-    cufftHandle plan = env->GetIntField(handle, cufftHandle_plan);
+    cufftHandle plan = 0;
+    JCUFFT_RANGE_BEGIN_PLAN(env, "cufftPlan3d", 3, Dims(nx, ny, nz).values, getCufftType(type), 1);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftPlan3d(&plan, nx, ny, nz, getCufftType(type));
-    env->SetIntField(handle, cufftHandle_plan, plan);
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_PLAN, plan, 3, Dims(nx, ny, nz).values, getCufftType(type), 1, 0);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        int dims[] = { nx, ny, nz };
+        result = registerPlan(env, handle, plan, 3, dims, type, 1);
+    }
     return result;
 }
 
@@ -238,19 +448,25 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftPlanManyNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftPlanMany\n");
+    JCUFFT_TRACE("Executing cufftPlanMany\n");
 
-    cufftHandle plan = env->GetIntField(handle, cufftHandle_plan);
-    int *nativeN = getArrayContents(env, n);
-    int *nativeInembed = getArrayContents(env, inembed);
-    int *nativeOnembed = getArrayContents(env, onembed);
-
-    cufftResult result = cufftPlanMany(&plan, rank, nativeN, nativeInembed, (int)istride, (int)idist, nativeOnembed, (int)ostride, (int)odist, getCufftType(type), (int)batch);
+    cufftHandle plan = 0;
+    Layout<int> layout;
+    int layoutResult = readLayout(env, rank, n, inembed, onembed, layout);
+    if (layoutResult != CUFFT_SUCCESS)
+    {
+        return layoutResult;
+    }
 
-    delete[] nativeN;
-    delete[] nativeInembed;
-    delete[] nativeOnembed;
-    env->SetIntField(handle, cufftHandle_plan, plan);
+    JCUFFT_RANGE_BEGIN_PLAN(env, "cufftPlanMany", rank, layout.n, getCufftType(type), batch);
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = cufftPlanMany(&plan, rank, layout.n, layout.inembed, (int)istride, (int)idist, layout.onembed, (int)ostride, (int)odist, getCufftType(type), (int)batch);
+    JCUFFT_RECORD_PLAN(recordStart, result, JCUFFT_FUNCTION_PLAN, plan, rank, layout.n, layout.inembed, istride, idist, layout.onembed, ostride, odist, getCufftType(type), batch, 0);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        result = registerPlan(env, handle, plan, rank, layout.n, type, batch);
+    }
     return result;
 
 }
@@ -277,15 +493,28 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftMakePlan1dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftMakePlan1d\n");
+    JCUFFT_TRACE("Executing cufftMakePlan1d\n");
 
-    cufftHandle nativePlan = env->GetIntField(plan, cufftHandle_plan);
+    PlanReference reference(env, plan);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
     size_t nativeWorkSize = 0;
 
+    JCUFFT_RANGE_BEGIN_PLAN(env, "cufftMakePlan1d", 1, Dims(nx).values, getCufftType(type), batch);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftMakePlan1d(nativePlan, (int)nx, getCufftType(type), (int)batch, &nativeWorkSize);
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_MAKE_PLAN, nativePlan, 1, Dims(nx).values, getCufftType(type), batch, nativeWorkSize);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        long long dims[] = { nx };
+        planCreated(reference.entry, 1, dims, type, batch);
+    }
 
-    env->SetIntField(plan, cufftHandle_plan, nativePlan);
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -310,15 +539,28 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftMakePlan2dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftMakePlan2d\n");
+    JCUFFT_TRACE("Executing cufftMakePlan2d\n");
 
-    cufftHandle nativePlan = env->GetIntField(plan, cufftHandle_plan);
+    PlanReference reference(env, plan);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
     size_t nativeWorkSize = 0;
 
+    JCUFFT_RANGE_BEGIN_PLAN(env, "cufftMakePlan2d", 2, Dims(nx, ny).values, getCufftType(type), 1);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftMakePlan2d(nativePlan, (int)nx, (int)ny, getCufftType(type), &nativeWorkSize);
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_MAKE_PLAN, nativePlan, 2, Dims(nx, ny).values, getCufftType(type), 1, nativeWorkSize);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        int dims[] = { nx, ny };
+        planCreated(reference.entry, 2, dims, type, 1);
+    }
 
-    env->SetIntField(plan, cufftHandle_plan, nativePlan);
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -341,15 +583,28 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftMakePlan3dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftMakePlan3d\n");
+    JCUFFT_TRACE("Executing cufftMakePlan3d\n");
 
-    cufftHandle nativePlan = env->GetIntField(plan, cufftHandle_plan);
+    PlanReference reference(env, plan);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
     size_t nativeWorkSize = 0;
 
+    JCUFFT_RANGE_BEGIN_PLAN(env, "cufftMakePlan3d", 3, Dims(nx, ny, nz).values, getCufftType(type), 1);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftMakePlan3d(nativePlan, (int)nx, (int)ny, (int)nz, getCufftType(type), &nativeWorkSize);
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_MAKE_PLAN, nativePlan, 3, Dims(nx, ny, nz).values, getCufftType(type), 1, nativeWorkSize);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        int dims[] = { nx, ny, nz };
+        planCreated(reference.entry, 3, dims, type, 1);
+    }
 
-    env->SetIntField(plan, cufftHandle_plan, nativePlan);
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -377,21 +632,33 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftMakePlanManyNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftMakePlanMany\n");
+    JCUFFT_TRACE("Executing cufftMakePlanMany\n");
 
-    cufftHandle nativePlan = env->GetIntField(plan, cufftHandle_plan);
-    int *nativeN = getArrayContents(env, n);
-    int *nativeInembed = getArrayContents(env, inembed);
-    int *nativeOnembed = getArrayContents(env, onembed);
+    PlanReference reference(env, plan);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
+    Layout<int> layout;
+    int layoutResult = readLayout(env, rank, n, inembed, onembed, layout);
+    if (layoutResult != CUFFT_SUCCESS)
+    {
+        return layoutResult;
+    }
     size_t nativeWorkSize = 0;
 
-    cufftResult result = cufftMakePlanMany(nativePlan, (int)rank, nativeN, nativeInembed, (int)istride, (int)idist, nativeOnembed, (int)ostride, (int)odist, getCufftType(type), (int)batch, &nativeWorkSize);
+    JCUFFT_RANGE_BEGIN_PLAN(env, "cufftMakePlanMany", rank, layout.n, getCufftType(type), batch);
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = cufftMakePlanMany(nativePlan, (int)rank, layout.n, layout.inembed, (int)istride, (int)idist, layout.onembed, (int)ostride, (int)odist, getCufftType(type), (int)batch, &nativeWorkSize);
+    JCUFFT_RECORD_PLAN(recordStart, result, JCUFFT_FUNCTION_MAKE_PLAN, nativePlan, rank, layout.n, layout.inembed, istride, idist, layout.onembed, ostride, odist, getCufftType(type), batch, nativeWorkSize);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        planCreated(reference.entry, rank, layout.n, type, batch);
+    }
 
-    delete[] nativeN;
-    delete[] nativeInembed;
-    delete[] nativeOnembed;
-    env->SetIntField(plan, cufftHandle_plan, nativePlan);
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -420,21 +687,33 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftMakePlanManyNative64
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftMakePlanMany64\n");
+    JCUFFT_TRACE("Executing cufftMakePlanMany64\n");
 
-    cufftHandle nativePlan = env->GetIntField(plan, cufftHandle_plan);
-    long long *nativeN = getArrayContents(env, n);
-    long long *nativeInembed = getArrayContents(env, inembed);
-    long long *nativeOnembed = getArrayContents(env, onembed);
+    PlanReference reference(env, plan);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
+    Layout<long long> layout;
+    int layoutResult = readLayout(env, rank, n, inembed, onembed, layout);
+    if (layoutResult != CUFFT_SUCCESS)
+    {
+        return layoutResult;
+    }
     size_t nativeWorkSize = 0;
 
-    cufftResult result = cufftMakePlanMany64(nativePlan, (int)rank, nativeN, nativeInembed, (long long)istride, (long long)idist, nativeOnembed, (long long)ostride, (long long)odist, getCufftType(type), (long long)batch, &nativeWorkSize);
+    JCUFFT_RANGE_BEGIN_PLAN(env, "cufftMakePlanMany64", rank, layout.n, getCufftType(type), batch);
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = cufftMakePlanMany64(nativePlan, (int)rank, layout.n, layout.inembed, (long long)istride, (long long)idist, layout.onembed, (long long)ostride, (long long)odist, getCufftType(type), (long long)batch, &nativeWorkSize);
+    JCUFFT_RECORD_PLAN(recordStart, result, JCUFFT_FUNCTION_MAKE_PLAN, nativePlan, rank, layout.n, layout.inembed, istride, idist, layout.onembed, ostride, odist, getCufftType(type), batch, nativeWorkSize);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        planCreated(reference.entry, rank, layout.n, type, batch);
+    }
 
-    delete[] nativeN;
-    delete[] nativeInembed;
-    delete[] nativeOnembed;
-    env->SetIntField(plan, cufftHandle_plan, nativePlan);
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -462,21 +741,30 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftGetSizeMany64Native
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftGetSizeMany64\n");
+    JCUFFT_TRACE("Executing cufftGetSizeMany64\n");
 
-    cufftHandle nativePlan = env->GetIntField(plan, cufftHandle_plan);
-    long long *nativeN = getArrayContents(env, n);
-    long long *nativeInembed = getArrayContents(env, inembed);
-    long long *nativeOnembed = getArrayContents(env, onembed);
+    PlanReference reference(env, plan);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
+    Layout<long long> layout;
+    int layoutResult = readLayout(env, rank, n, inembed, onembed, layout);
+    if (layoutResult != CUFFT_SUCCESS)
+    {
+        return layoutResult;
+    }
     size_t nativeWorkSize = 0;
 
-    cufftResult result = cufftGetSizeMany64(nativePlan, (int)rank, nativeN, nativeInembed, (long long)istride, (long long)idist, nativeOnembed, (long long)ostride, (long long)odist, getCufftType(type), (long long)batch, &nativeWorkSize);
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = CUFFT_SUCCESS;
+    EstimateKey key = makeEstimateKey(JCUFFT_CACHED_GET_SIZE, (int)rank, layout.n, layout.inembed, istride, idist, layout.onembed, ostride, odist, getCufftType(type), batch);
+    JCUFFT_CACHED_SIZE(key, result, nativeWorkSize,
+        result = cufftGetSizeMany64(nativePlan, (int)rank, layout.n, layout.inembed, (long long)istride, (long long)idist, layout.onembed, (long long)ostride, (long long)odist, getCufftType(type), (long long)batch, &nativeWorkSize));
+    JCUFFT_RECORD_PLAN(recordStart, result, JCUFFT_FUNCTION_GET_SIZE, nativePlan, rank, layout.n, layout.inembed, istride, idist, layout.onembed, ostride, odist, getCufftType(type), batch, nativeWorkSize);
 
-    delete[] nativeN;
-    delete[] nativeInembed;
-    delete[] nativeOnembed;
-    env->SetIntField(plan, cufftHandle_plan, nativePlan);
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -495,12 +783,17 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftEstimate1dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftEstimate1d\n");
+    JCUFFT_TRACE("Executing cufftEstimate1d\n");
 
     size_t nativeWorkSize = 0;
-    cufftResult result = cufftEstimate1d((int)nx, getCufftType(type), (int)batch, &nativeWorkSize);
-
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = CUFFT_SUCCESS;
+    EstimateKey key = makeEstimateKey(JCUFFT_CACHED_ESTIMATE, 1, Dims(nx).values, (long long*)NULL, 0, 0, (long long*)NULL, 0, 0, getCufftType(type), batch);
+    JCUFFT_CACHED_SIZE(key, result, nativeWorkSize,
+        result = cufftEstimate1d((int)nx, getCufftType(type), (int)batch, &nativeWorkSize));
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_ESTIMATE, -1, 1, Dims(nx).values, getCufftType(type), batch, nativeWorkSize);
+
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -519,12 +812,17 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftEstimate2dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftEstimate2d\n");
+    JCUFFT_TRACE("Executing cufftEstimate2d\n");
 
     size_t nativeWorkSize = 0;
-    cufftResult result = cufftEstimate2d((int)nx, (int)ny, getCufftType(type), &nativeWorkSize);
-
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = CUFFT_SUCCESS;
+    EstimateKey key = makeEstimateKey(JCUFFT_CACHED_ESTIMATE, 2, Dims(nx, ny).values, (long long*)NULL, 0, 0, (long long*)NULL, 0, 0, getCufftType(type), 1);
+    JCUFFT_CACHED_SIZE(key, result, nativeWorkSize,
+        result = cufftEstimate2d((int)nx, (int)ny, getCufftType(type), &nativeWorkSize));
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_ESTIMATE, -1, 2, Dims(nx, ny).values, getCufftType(type), 1, nativeWorkSize);
+
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -542,12 +840,17 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftEstimate3dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftEstimate3d\n");
+    JCUFFT_TRACE("Executing cufftEstimate3d\n");
 
     size_t nativeWorkSize = 0;
-    cufftResult result = cufftEstimate3d((int)nx, (int)ny, (int)nz, getCufftType(type), &nativeWorkSize);
-
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = CUFFT_SUCCESS;
+    EstimateKey key = makeEstimateKey(JCUFFT_CACHED_ESTIMATE, 3, Dims(nx, ny, nz).values, (long long*)NULL, 0, 0, (long long*)NULL, 0, 0, getCufftType(type), 1);
+    JCUFFT_CACHED_SIZE(key, result, nativeWorkSize,
+        result = cufftEstimate3d((int)nx, (int)ny, (int)nz, getCufftType(type), &nativeWorkSize));
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_ESTIMATE, -1, 3, Dims(nx, ny, nz).values, getCufftType(type), 1, nativeWorkSize);
+
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -571,19 +874,24 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftEstimateManyNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftEstimateMany\n");
+    JCUFFT_TRACE("Executing cufftEstimateMany\n");
 
-    int *nativeN = getArrayContents(env, n);
-    int *nativeInembed = getArrayContents(env, inembed);
-    int *nativeOnembed = getArrayContents(env, onembed);
+    Layout<int> layout;
+    int layoutResult = readLayout(env, rank, n, inembed, onembed, layout);
+    if (layoutResult != CUFFT_SUCCESS)
+    {
+        return layoutResult;
+    }
     size_t nativeWorkSize = 0;
 
-    cufftResult result = cufftEstimateMany((int)rank, nativeN, nativeInembed, (int)istride, (int)idist, nativeOnembed, (int)ostride, (int)odist, getCufftType(type), (int)batch, &nativeWorkSize);
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = CUFFT_SUCCESS;
+    EstimateKey key = makeEstimateKey(JCUFFT_CACHED_ESTIMATE, (int)rank, layout.n, layout.inembed, istride, idist, layout.onembed, ostride, odist, getCufftType(type), batch);
+    JCUFFT_CACHED_SIZE(key, result, nativeWorkSize,
+        result = cufftEstimateMany((int)rank, layout.n, layout.inembed, (int)istride, (int)idist, layout.onembed, (int)ostride, (int)odist, getCufftType(type), (int)batch, &nativeWorkSize));
+    JCUFFT_RECORD_PLAN(recordStart, result, JCUFFT_FUNCTION_ESTIMATE, -1, rank, layout.n, layout.inembed, istride, idist, layout.onembed, ostride, odist, getCufftType(type), batch, nativeWorkSize);
 
-    delete[] nativeN;
-    delete[] nativeInembed;
-    delete[] nativeOnembed;
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -601,13 +909,18 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftCreateNative
         ThrowByName(env, "java/lang/NullPointerException", "Parameter 'handle' is null for cufftCreate");
         return JCUFFT_INTERNAL_ERROR;
     }
-    Logger::log(LOG_TRACE, "Executing cufftCreate\n");
+    JCUFFT_TRACE("Executing cufftCreate\n");
 
-    cufftHandle nativeHandle = env->GetIntField(handle, cufftHandle_plan);
+    cufftHandle nativeHandle = 0;
 
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftCreate(&nativeHandle);
+    JCUFFT_RECORD_HANDLE(recordStart, result, JCUFFT_RECORD_CREATE, nativeHandle, 0, NULL);
 
-    env->SetIntField(handle, cufftHandle_plan, nativeHandle);
+    if (result == CUFFT_SUCCESS)
+    {
+        result = registerPlan(env, handle, nativeHandle, 0, (int*)NULL, 0, 0);
+    }
     return result;
 
 }
@@ -631,14 +944,21 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftGetSize1dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftGetSize1d\n");
+    JCUFFT_TRACE("Executing cufftGetSize1d\n");
 
-    cufftHandle nativeHandle = env->GetIntField(handle, cufftHandle_plan);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativeHandle = reference.plan();
     size_t nativeWorkSize = 0;
 
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftGetSize1d(nativeHandle, (int)nx, getCufftType(type), (int)batch, &nativeWorkSize);
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_GET_SIZE, nativeHandle, 1, Dims(nx).values, getCufftType(type), batch, nativeWorkSize);
 
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -661,14 +981,21 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftGetSize2dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftGetSize2d\n");
+    JCUFFT_TRACE("Executing cufftGetSize2d\n");
 
-    cufftHandle nativeHandle = env->GetIntField(handle, cufftHandle_plan);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativeHandle = reference.plan();
     size_t nativeWorkSize = 0;
 
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftGetSize2d(nativeHandle, (int)nx, (int)ny, getCufftType(type), &nativeWorkSize);
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_GET_SIZE, nativeHandle, 2, Dims(nx, ny).values, getCufftType(type), 1, nativeWorkSize);
 
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -692,14 +1019,21 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftGetSize3dNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftGetSize3d\n");
+    JCUFFT_TRACE("Executing cufftGetSize3d\n");
 
-    cufftHandle nativeHandle = env->GetIntField(handle, cufftHandle_plan);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativeHandle = reference.plan();
     size_t nativeWorkSize = 0;
 
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftGetSize3d(nativeHandle, (int)nx, (int)ny, (int)nz, getCufftType(type), &nativeWorkSize);
+    JCUFFT_RECORD_BASIC_PLAN(recordStart, result, JCUFFT_FUNCTION_GET_SIZE, nativeHandle, 3, Dims(nx, ny, nz).values, getCufftType(type), 1, nativeWorkSize);
 
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 
 }
@@ -728,20 +1062,30 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftGetSizeManyNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftGetSizeMany\n");
+    JCUFFT_TRACE("Executing cufftGetSizeMany\n");
 
-    cufftHandle nativeHandle = env->GetIntField(handle, cufftHandle_plan);
-    int *nativeN = getArrayContents(env, n);
-    int *nativeInembed = getArrayContents(env, inembed);
-    int *nativeOnembed = getArrayContents(env, onembed);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativeHandle = reference.plan();
+    Layout<int> layout;
+    int layoutResult = readLayout(env, rank, n, inembed, onembed, layout);
+    if (layoutResult != CUFFT_SUCCESS)
+    {
+        return layoutResult;
+    }
     size_t nativeWorkSize = 0;
 
-    cufftResult result = cufftGetSizeMany(nativeHandle, (int)rank, nativeN, nativeInembed, (int)istride, (int)idist, nativeOnembed, (int)ostride, (int)odist, getCufftType(type), (int)batch, &nativeWorkSize);
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = CUFFT_SUCCESS;
+    EstimateKey key = makeEstimateKey(JCUFFT_CACHED_GET_SIZE, (int)rank, layout.n, layout.inembed, istride, idist, layout.onembed, ostride, odist, getCufftType(type), batch);
+    JCUFFT_CACHED_SIZE(key, result, nativeWorkSize,
+        result = cufftGetSizeMany(nativeHandle, (int)rank, layout.n, layout.inembed, (int)istride, (int)idist, layout.onembed, (int)ostride, (int)odist, getCufftType(type), (int)batch, &nativeWorkSize));
+    JCUFFT_RECORD_PLAN(recordStart, result, JCUFFT_FUNCTION_GET_SIZE, nativeHandle, rank, layout.n, layout.inembed, istride, idist, layout.onembed, ostride, odist, getCufftType(type), batch, nativeWorkSize);
 
-    delete[] nativeN;
-    delete[] nativeInembed;
-    delete[] nativeOnembed;
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -765,14 +1109,19 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftGetSizeNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftGetSize\n");
+    JCUFFT_TRACE("Executing cufftGetSize\n");
 
-    cufftHandle nativeHandle = env->GetIntField(handle, cufftHandle_plan);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativeHandle = reference.plan();
     size_t nativeWorkSize = 0;
 
     cufftResult result = cufftGetSize(nativeHandle, &nativeWorkSize);
 
-    set(env, workSize, 0, (jlong)nativeWorkSize);
+    if (!writeValue(env, workSize, nativeWorkSize)) return JCUFFT_INTERNAL_ERROR;
     return result;
 }
 
@@ -795,12 +1144,25 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftSetWorkAreaNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftSetWorkArea\n");
+    JCUFFT_TRACE("Executing cufftSetWorkArea\n");
 
-    cufftHandle nativeHandle = env->GetIntField(handle, cufftHandle_plan);
-    void *nativeWorkArea = getPointer(env, workArea);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativeHandle = reference.plan();
+    void *nativeWorkArea = getDataPointer(env, workArea);
 
+    JCUFFT_RANGE_BEGIN_HANDLE(env, "cufftSetWorkArea", reference.entry);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftSetWorkArea(nativeHandle, nativeWorkArea);
+    JCUFFT_RECORD_HANDLE(recordStart, result, JCUFFT_RECORD_SET_WORK_AREA, nativeHandle, 0, nativeWorkArea);
+    JCUFFT_RANGE_END(env);
+    if (result == CUFFT_SUCCESS)
+    {
+        reference.entry->workArea.store(nativeWorkArea, std::memory_order_relaxed);
+    }
 
     return result;
 
@@ -821,10 +1183,17 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftSetAutoAllocationNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftSetAutoAllocation\n");
+    JCUFFT_TRACE("Executing cufftSetAutoAllocation\n");
 
-    cufftHandle nativeHandle = env->GetIntField(handle, cufftHandle_plan);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativeHandle = reference.plan();
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftSetAutoAllocation(nativeHandle, (int)autoAllocate);
+    JCUFFT_RECORD_HANDLE(recordStart, result, JCUFFT_RECORD_SET_AUTO_ALLOCATION, nativeHandle, (int)autoAllocate, NULL);
     return result;
 }
 
@@ -832,6 +1201,22 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftSetAutoAllocationNative
 
 
 
+/**
+ * Destroys the plan of the given slot of the handle table. This is
+ * called by handleTableRemove, or, if the plan was destroyed by a
+ * thread that was still using it, when this thread releases its last
+ * reference to the slot.
+ */
+static cufftResult destroyPlan(HandleEntry *entry)
+{
+    cufftHandle plan = entry->plan;
+    JCUFFT_RECORD_START(recordStart);
+    cufftResult result = cufftDestroy(plan);
+    JCUFFT_RECORD_HANDLE(recordStart, result, JCUFFT_RECORD_DESTROY, plan, 0, NULL);
+    JCUFFT_PLAN_DESTROYED(entry);
+    return result;
+}
+
 /*
  * Class:     jcuda_jcufft_JCufft
  * Method:    cufftDestroyNative
@@ -846,11 +1231,9 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftDestroyNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Destroying plan\n");
+    JCUFFT_TRACE("Destroying plan\n");
 
-    cufftHandle plan = env->GetIntField(handle, cufftHandle_plan);
-    cufftResult result = cufftDestroy(plan);
-    return result;
+    return handleTableRemove(env->GetLongField(handle, cufftHandle_token), destroyPlan);
 }
 
 
@@ -880,13 +1263,24 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftExecC2CNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftExecC2C\n");
+    JCUFFT_TRACE("Executing cufftExecC2C\n");
 
-    cufftHandle nativePlan = env->GetIntField(handle, cufftHandle_plan);
-    cufftComplex* nativeCIData = (cufftComplex*)getPointer(env, cIdata);
-    cufftComplex* nativeCOData = (cufftComplex*)getPointer(env, cOdata);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
+    cufftComplex* nativeCIData = (cufftComplex*)getDataPointer(env, cIdata);
+    cufftComplex* nativeCOData = (cufftComplex*)getDataPointer(env, cOdata);
 
+    JCUFFT_EXEC_BEGIN(reference.entry);
+    JCUFFT_RANGE_BEGIN_HANDLE(env, "cufftExecC2C", reference.entry);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftExecC2C(nativePlan, nativeCIData, nativeCOData, direction);
+    JCUFFT_RECORD_EXEC(recordStart, result, nativePlan, CUFFT_C2C, direction, nativeCIData, nativeCOData);
+    JCUFFT_RANGE_END(env);
+    JCUFFT_EXEC_END(result);
     return result;
 }
 
@@ -914,13 +1308,24 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftExecR2CNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftExecR2C\n");
+    JCUFFT_TRACE("Executing cufftExecR2C\n");
 
-    cufftHandle nativePlan = env->GetIntField(handle, cufftHandle_plan);
-    float* nativeRIData = (float*)getPointer(env, rIdata);
-    cufftComplex* nativeCOData = (cufftComplex*)getPointer(env, cOdata);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
+    float* nativeRIData = (float*)getDataPointer(env, rIdata);
+    cufftComplex* nativeCOData = (cufftComplex*)getDataPointer(env, cOdata);
 
+    JCUFFT_EXEC_BEGIN(reference.entry);
+    JCUFFT_RANGE_BEGIN_HANDLE(env, "cufftExecR2C", reference.entry);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftExecR2C(nativePlan, nativeRIData, nativeCOData);
+    JCUFFT_RECORD_EXEC(recordStart, result, nativePlan, CUFFT_R2C, 0, nativeRIData, nativeCOData);
+    JCUFFT_RANGE_END(env);
+    JCUFFT_EXEC_END(result);
     return result;
 }
 
@@ -948,13 +1353,24 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftExecC2RNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftExecC2R\n");
+    JCUFFT_TRACE("Executing cufftExecC2R\n");
 
-    cufftHandle nativePlan = env->GetIntField(handle, cufftHandle_plan);
-    cufftComplex* nativeCIData = (cufftComplex*)getPointer(env, cIdata);
-    float* nativeROData = (float*)getPointer(env, rOdata);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
+    cufftComplex* nativeCIData = (cufftComplex*)getDataPointer(env, cIdata);
+    float* nativeROData = (float*)getDataPointer(env, rOdata);
 
+    JCUFFT_EXEC_BEGIN(reference.entry);
+    JCUFFT_RANGE_BEGIN_HANDLE(env, "cufftExecC2R", reference.entry);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftExecC2R(nativePlan, nativeCIData, nativeROData);
+    JCUFFT_RECORD_EXEC(recordStart, result, nativePlan, CUFFT_C2R, 0, nativeCIData, nativeROData);
+    JCUFFT_RANGE_END(env);
+    JCUFFT_EXEC_END(result);
     return result;
 }
 
@@ -988,13 +1404,24 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftExecZ2ZNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftExecZ2Z\n");
+    JCUFFT_TRACE("Executing cufftExecZ2Z\n");
 
-    cufftHandle nativePlan = env->GetIntField(handle, cufftHandle_plan);
-    cufftDoubleComplex* nativeCIData = (cufftDoubleComplex*)getPointer(env, cIdata);
-    cufftDoubleComplex* nativeCOData = (cufftDoubleComplex*)getPointer(env, cOdata);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
+    cufftDoubleComplex* nativeCIData = (cufftDoubleComplex*)getDataPointer(env, cIdata);
+    cufftDoubleComplex* nativeCOData = (cufftDoubleComplex*)getDataPointer(env, cOdata);
 
+    JCUFFT_EXEC_BEGIN(reference.entry);
+    JCUFFT_RANGE_BEGIN_HANDLE(env, "cufftExecZ2Z", reference.entry);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftExecZ2Z(nativePlan, nativeCIData, nativeCOData, direction);
+    JCUFFT_RECORD_EXEC(recordStart, result, nativePlan, CUFFT_Z2Z, direction, nativeCIData, nativeCOData);
+    JCUFFT_RANGE_END(env);
+    JCUFFT_EXEC_END(result);
     return result;
 }
 
@@ -1022,13 +1449,24 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftExecD2ZNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftExecD2Z\n");
+    JCUFFT_TRACE("Executing cufftExecD2Z\n");
 
-    cufftHandle nativePlan = env->GetIntField(handle, cufftHandle_plan);
-    double* nativeRIData = (double*)getPointer(env, rIdata);
-    cufftDoubleComplex* nativeCOData = (cufftDoubleComplex*)getPointer(env, cOdata);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
+    double* nativeRIData = (double*)getDataPointer(env, rIdata);
+    cufftDoubleComplex* nativeCOData = (cufftDoubleComplex*)getDataPointer(env, cOdata);
 
+    JCUFFT_EXEC_BEGIN(reference.entry);
+    JCUFFT_RANGE_BEGIN_HANDLE(env, "cufftExecD2Z", reference.entry);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftExecD2Z(nativePlan, nativeRIData, nativeCOData);
+    JCUFFT_RECORD_EXEC(recordStart, result, nativePlan, CUFFT_D2Z, 0, nativeRIData, nativeCOData);
+    JCUFFT_RANGE_END(env);
+    JCUFFT_EXEC_END(result);
     return result;
 }
 
@@ -1056,13 +1494,24 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftExecZ2DNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftExecZ2D\n");
+    JCUFFT_TRACE("Executing cufftExecZ2D\n");
 
-    cufftHandle nativePlan = env->GetIntField(handle, cufftHandle_plan);
-    cufftDoubleComplex* nativeCIData = (cufftDoubleComplex*)getPointer(env, cIdata);
-    double* nativeROData = (double*)getPointer(env, rOdata);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
+    cufftDoubleComplex* nativeCIData = (cufftDoubleComplex*)getDataPointer(env, cIdata);
+    double* nativeROData = (double*)getDataPointer(env, rOdata);
 
+    JCUFFT_EXEC_BEGIN(reference.entry);
+    JCUFFT_RANGE_BEGIN_HANDLE(env, "cufftExecZ2D", reference.entry);
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftExecZ2D(nativePlan, nativeCIData, nativeROData);
+    JCUFFT_RECORD_EXEC(recordStart, result, nativePlan, CUFFT_Z2D, 0, nativeCIData, nativeROData);
+    JCUFFT_RANGE_END(env);
+    JCUFFT_EXEC_END(result);
     return result;
 }
 
@@ -1086,13 +1535,24 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftSetStreamNative
         return JCUFFT_INTERNAL_ERROR;
     }
 
-    Logger::log(LOG_TRACE, "Executing cufftSetStream\n");
+    JCUFFT_TRACE("Executing cufftSetStream\n");
 
-    cufftHandle nativePlan = env->GetIntField(handle, cufftHandle_plan);
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftHandle nativePlan = reference.plan();
     cudaStream_t nativeStream = NULL;
     nativeStream = (cudaStream_t)getNativePointerValue(env, stream);
 
+    JCUFFT_RECORD_START(recordStart);
     cufftResult result = cufftSetStream(nativePlan, nativeStream);
+    JCUFFT_RECORD_HANDLE(recordStart, result, JCUFFT_RECORD_SET_STREAM, nativePlan, 0, nativeStream);
+    if (result == CUFFT_SUCCESS)
+    {
+        reference.entry->stream.store((void*)nativeStream, std::memory_order_relaxed);
+    }
     return result;
 }
 
@@ -1109,3 +1569,297 @@ JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftSetCompatibilityModeNative
 	ThrowByName(env, "java/lang/UnsupportedOperationException", "Function cufftSetCompatibilityMode was removed in CUDA version 9.1.");
 	return JCUFFT_INTERNAL_ERROR;
 }
+
+
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    transposeNative
+ * Signature: (Ljcuda/Pointer;Ljcuda/Pointer;JJJILjcuda/runtime/cudaStream_t;)I
+ */
+JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_transposeNative
+  (JNIEnv *env, jclass cla, jobject src, jobject dst, jlong batch, jlong rows, jlong cols, jint elementSize, jobject stream)
+{
+    if (src == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter 'src' is null for transpose");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+    if (dst == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter 'dst' is null for transpose");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+
+    JCUFFT_TRACE("Executing transpose\n");
+
+    void *nativeSrc = getDataPointer(env, src);
+    void *nativeDst = getDataPointer(env, dst);
+    void *nativeStream = NULL;
+    if (stream != NULL)
+    {
+        nativeStream = (void*)getNativePointerValue(env, stream);
+    }
+    return jcufftTranspose(nativeSrc, nativeDst, (long long)batch, (long long)rows, (long long)cols, (int)elementSize, nativeStream);
+}
+
+
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    interleaveNative
+ * Signature: (Ljava/lang/Object;Ljava/lang/Object;ILjcuda/Pointer;I)V
+ */
+JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_interleaveNative
+  (JNIEnv *env, jclass cla, jobject re, jobject im, jint elementSize, jobject dst, jint count)
+{
+    if (re == NULL || im == NULL || dst == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter is null for interleave");
+        return;
+    }
+    void *nativeDst = getDataPointer(env, dst);
+    void *nativeRe = env->GetPrimitiveArrayCritical((jarray)re, NULL);
+    if (nativeRe == NULL)
+    {
+        return;
+    }
+    void *nativeIm = env->GetPrimitiveArrayCritical((jarray)im, NULL);
+    if (nativeIm == NULL)
+    {
+        env->ReleasePrimitiveArrayCritical((jarray)re, nativeRe, JNI_ABORT);
+        return;
+    }
+    if (elementSize == sizeof(double))
+    {
+        interleaveDouble((const double*)nativeRe, (const double*)nativeIm, (double*)nativeDst, (size_t)count);
+    }
+    else
+    {
+        interleaveFloat((const float*)nativeRe, (const float*)nativeIm, (float*)nativeDst, (size_t)count);
+    }
+    env->ReleasePrimitiveArrayCritical((jarray)im, nativeIm, JNI_ABORT);
+    env->ReleasePrimitiveArrayCritical((jarray)re, nativeRe, JNI_ABORT);
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    deinterleaveNative
+ * Signature: (Ljcuda/Pointer;Ljava/lang/Object;Ljava/lang/Object;II)V
+ */
+JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_deinterleaveNative
+  (JNIEnv *env, jclass cla, jobject src, jobject re, jobject im, jint elementSize, jint count)
+{
+    if (src == NULL || re == NULL || im == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter is null for deinterleave");
+        return;
+    }
+    void *nativeSrc = getDataPointer(env, src);
+    void *nativeRe = env->GetPrimitiveArrayCritical((jarray)re, NULL);
+    if (nativeRe == NULL)
+    {
+        return;
+    }
+    void *nativeIm = env->GetPrimitiveArrayCritical((jarray)im, NULL);
+    if (nativeIm == NULL)
+    {
+        env->ReleasePrimitiveArrayCritical((jarray)re, nativeRe, 0);
+        return;
+    }
+    if (elementSize == sizeof(double))
+    {
+        deinterleaveDouble((const double*)nativeSrc, (double*)nativeRe, (double*)nativeIm, (size_t)count);
+    }
+    else
+    {
+        deinterleaveFloat((const float*)nativeSrc, (float*)nativeRe, (float*)nativeIm, (size_t)count);
+    }
+    env->ReleasePrimitiveArrayCritical((jarray)im, nativeIm, 0);
+    env->ReleasePrimitiveArrayCritical((jarray)re, nativeRe, 0);
+}
+
+
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    hermitianExpandNative
+ * Signature: (Ljava/lang/Object;Ljava/lang/Object;IJJJJ)V
+ */
+JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_hermitianExpandNative
+  (JNIEnv *env, jclass cla, jobject half, jobject full, jint elementSize, jlong batch, jlong n0, jlong n1, jlong n2)
+{
+    if (half == NULL || full == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter is null for hermitianExpand");
+        return;
+    }
+    void *nativeHalf = env->GetPrimitiveArrayCritical((jarray)half, NULL);
+    if (nativeHalf == NULL)
+    {
+        return;
+    }
+    void *nativeFull = env->GetPrimitiveArrayCritical((jarray)full, NULL);
+    if (nativeFull == NULL)
+    {
+        env->ReleasePrimitiveArrayCritical((jarray)half, nativeHalf, JNI_ABORT);
+        return;
+    }
+    if (elementSize == sizeof(double))
+    {
+        hermitianExpandDouble((const double*)nativeHalf, (double*)nativeFull, batch, n0, n1, n2);
+    }
+    else
+    {
+        hermitianExpandFloat((const float*)nativeHalf, (float*)nativeFull, batch, n0, n1, n2);
+    }
+    env->ReleasePrimitiveArrayCritical((jarray)full, nativeFull, 0);
+    env->ReleasePrimitiveArrayCritical((jarray)half, nativeHalf, JNI_ABORT);
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    hermitianExpandDeviceNative
+ * Signature: (Ljcuda/Pointer;Ljcuda/Pointer;IJJJJLjcuda/runtime/cudaStream_t;)I
+ */
+JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_hermitianExpandDeviceNative
+  (JNIEnv *env, jclass cla, jobject half, jobject full, jint elementSize, jlong batch, jlong n0, jlong n1, jlong n2, jobject stream)
+{
+    if (half == NULL || full == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter is null for hermitianExpand");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+
+    JCUFFT_TRACE("Executing hermitianExpand\n");
+
+    void *nativeHalf = getDataPointer(env, half);
+    void *nativeFull = getDataPointer(env, full);
+    void *nativeStream = NULL;
+    if (stream != NULL)
+    {
+        nativeStream = (void*)getNativePointerValue(env, stream);
+    }
+    return jcufftHermitianExpand(nativeHalf, nativeFull, (long long)batch, (long long)n0, (long long)n1, (long long)n2, 2 * (int)elementSize, nativeStream);
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    trigPreTwiddleNative
+ * Signature: (Ljcuda/Pointer;Ljcuda/Pointer;IIJJJLjcuda/runtime/cudaStream_t;)I
+ */
+JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_trigPreTwiddleNative
+  (JNIEnv *env, jclass cla, jobject src, jobject work, jint kind, jint elementSize, jlong count, jlong stride, jlong n, jobject stream)
+{
+    if (src == NULL || work == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter is null for trigPreTwiddle");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+
+    JCUFFT_TRACE("Executing trigPreTwiddle\n");
+
+    void *nativeSrc = getDataPointer(env, src);
+    void *nativeWork = getDataPointer(env, work);
+    void *nativeStream = NULL;
+    if (stream != NULL)
+    {
+        nativeStream = (void*)getNativePointerValue(env, stream);
+    }
+    return jcufftTrigPreTwiddle(nativeSrc, nativeWork, (int)kind, (long long)count, (long long)stride, (long long)n, (int)elementSize, nativeStream);
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    trigPostTwiddleNative
+ * Signature: (Ljcuda/Pointer;Ljcuda/Pointer;IIJJJLjcuda/runtime/cudaStream_t;)I
+ */
+JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_trigPostTwiddleNative
+  (JNIEnv *env, jclass cla, jobject spectrum, jobject dst, jint kind, jint elementSize, jlong count, jlong stride, jlong n, jobject stream)
+{
+    if (spectrum == NULL || dst == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter is null for trigPostTwiddle");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+
+    JCUFFT_TRACE("Executing trigPostTwiddle\n");
+
+    void *nativeSpectrum = getDataPointer(env, spectrum);
+    void *nativeDst = getDataPointer(env, dst);
+    void *nativeStream = NULL;
+    if (stream != NULL)
+    {
+        nativeStream = (void*)getNativePointerValue(env, stream);
+    }
+    return jcufftTrigPostTwiddle(nativeSpectrum, nativeDst, (int)kind, (long long)count, (long long)stride, (long long)n, (int)elementSize, nativeStream);
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    chirpMultiplyNative
+ * Signature: (Ljcuda/Pointer;JLjcuda/Pointer;JLjcuda/Pointer;JJILjcuda/runtime/cudaStream_t;)I
+ */
+JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_chirpMultiplyNative
+  (JNIEnv *env, jclass cla, jobject src, jlong srcPitch, jobject factors, jlong count, jobject dst, jlong dstPitch, jlong rows, jint elementSize, jobject stream)
+{
+    if (src == NULL || factors == NULL || dst == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter is null for chirpMultiply");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+
+    JCUFFT_TRACE("Executing chirpMultiply\n");
+
+    void *nativeSrc = getDataPointer(env, src);
+    void *nativeFactors = getDataPointer(env, factors);
+    void *nativeDst = getDataPointer(env, dst);
+    void *nativeStream = NULL;
+    if (stream != NULL)
+    {
+        nativeStream = (void*)getNativePointerValue(env, stream);
+    }
+    return jcufftChirpMultiply(nativeSrc, (long long)srcPitch, nativeFactors, (long long)count, nativeDst, (long long)dstPitch, (long long)rows, 2 * (int)elementSize, nativeStream);
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    setEstimateCacheEnabledNative
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_setEstimateCacheEnabledNative
+  (JNIEnv *env, jclass cla, jboolean enabled)
+{
+    estimateCacheSetEnabled(enabled == JNI_TRUE);
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    clearEstimateCacheNative
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_clearEstimateCacheNative
+  (JNIEnv *env, jclass cla)
+{
+    estimateCacheClear();
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    getEstimateCacheCountsNative
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_jcuda_jcufft_JCufft_getEstimateCacheCountsNative
+  (JNIEnv *env, jclass cla)
+{
+    long long counts[3];
+    estimateCacheGetCounts(counts);
+    jlongArray result = env->NewLongArray(3);
+    if (result == NULL)
+    {
+        return NULL;
+    }
+    jlong values[3] = { (jlong)counts[0], (jlong)counts[1], (jlong)counts[2] };
+    env->SetLongArrayRegion(result, 0, 3, values);
+    return result;
+}
@@ -311,6 +311,142 @@ extern "C" {
     JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_cufftExecZ2DNative
         (JNIEnv *, jclass, jobject, jobject, jobject);
 
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    setStatisticsEnabledNative
+    * Signature: (Z)Z
+    */
+    JNIEXPORT jboolean JNICALL Java_jcuda_jcufft_JCufft_setStatisticsEnabledNative
+        (JNIEnv *, jclass, jboolean);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    getPlanStatisticsNative
+    * Signature: (Ljcuda/jcufft/cufftHandle;)[J
+    */
+    JNIEXPORT jlongArray JNICALL Java_jcuda_jcufft_JCufft_getPlanStatisticsNative
+        (JNIEnv *, jclass, jobject);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    recordTransferNative
+    * Signature: (Ljcuda/jcufft/cufftHandle;JJ)V
+    */
+    JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_recordTransferNative
+        (JNIEnv *, jclass, jobject, jlong, jlong);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    startRecordingNative
+    * Signature: (Ljava/lang/String;)I
+    */
+    JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_startRecordingNative
+        (JNIEnv *, jclass, jstring);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    stopRecordingNative
+    * Signature: ()I
+    */
+    JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_stopRecordingNative
+        (JNIEnv *, jclass);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    setRangeProviderNative
+    * Signature: (I)Z
+    */
+    JNIEXPORT jboolean JNICALL Java_jcuda_jcufft_JCufft_setRangeProviderNative
+        (JNIEnv *, jclass, jint);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    transposeNative
+    * Signature: (Ljcuda/Pointer;Ljcuda/Pointer;JJJILjcuda/runtime/cudaStream_t;)I
+    */
+    JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_transposeNative
+        (JNIEnv *, jclass, jobject, jobject, jlong, jlong, jlong, jint, jobject);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    interleaveNative
+    * Signature: (Ljava/lang/Object;Ljava/lang/Object;ILjcuda/Pointer;I)V
+    */
+    JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_interleaveNative
+        (JNIEnv *, jclass, jobject, jobject, jint, jobject, jint);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    deinterleaveNative
+    * Signature: (Ljcuda/Pointer;Ljava/lang/Object;Ljava/lang/Object;II)V
+    */
+    JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_deinterleaveNative
+        (JNIEnv *, jclass, jobject, jobject, jobject, jint, jint);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    hermitianExpandNative
+    * Signature: (Ljava/lang/Object;Ljava/lang/Object;IJJJJ)V
+    */
+    JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_hermitianExpandNative
+        (JNIEnv *, jclass, jobject, jobject, jint, jlong, jlong, jlong, jlong);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    hermitianExpandDeviceNative
+    * Signature: (Ljcuda/Pointer;Ljcuda/Pointer;IJJJJLjcuda/runtime/cudaStream_t;)I
+    */
+    JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_hermitianExpandDeviceNative
+        (JNIEnv *, jclass, jobject, jobject, jint, jlong, jlong, jlong, jlong, jobject);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    trigPreTwiddleNative
+    * Signature: (Ljcuda/Pointer;Ljcuda/Pointer;IIJJJLjcuda/runtime/cudaStream_t;)I
+    */
+    JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_trigPreTwiddleNative
+        (JNIEnv *, jclass, jobject, jobject, jint, jint, jlong, jlong, jlong, jobject);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    trigPostTwiddleNative
+    * Signature: (Ljcuda/Pointer;Ljcuda/Pointer;IIJJJLjcuda/runtime/cudaStream_t;)I
+    */
+    JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_trigPostTwiddleNative
+        (JNIEnv *, jclass, jobject, jobject, jint, jint, jlong, jlong, jlong, jobject);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    chirpMultiplyNative
+    * Signature: (Ljcuda/Pointer;JLjcuda/Pointer;JLjcuda/Pointer;JJILjcuda/runtime/cudaStream_t;)I
+    */
+    JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_chirpMultiplyNative
+        (JNIEnv *, jclass, jobject, jlong, jobject, jlong, jobject, jlong, jlong, jint, jobject);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    setEstimateCacheEnabledNative
+    * Signature: (Z)V
+    */
+    JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_setEstimateCacheEnabledNative
+        (JNIEnv *, jclass, jboolean);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    clearEstimateCacheNative
+    * Signature: ()V
+    */
+    JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_clearEstimateCacheNative
+        (JNIEnv *, jclass);
+
+    /*
+    * Class:     jcuda_jcufft_JCufft
+    * Method:    getEstimateCacheCountsNative
+    * Signature: ()[J
+    */
+    JNIEXPORT jlongArray JNICALL Java_jcuda_jcufft_JCufft_getEstimateCacheCountsNative
+        (JNIEnv *, jclass);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,194 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "JCufftEstimateCache.hpp"
+
+#include <atomic>
+#include <mutex>
+
+// The number of sets of the table, as a power of two
+#define JCUFFT_ESTIMATE_CACHE_SETS 256
+
+// The number of entries per set
+#define JCUFFT_ESTIMATE_CACHE_WAYS 4
+
+/**
+ * An entry of the cache
+ */
+struct EstimateEntry
+{
+    bool used;
+    EstimateKey key;
+    size_t workSize;
+};
+
+/**
+ * A set of entries, and the index of the entry that is replaced next
+ */
+struct EstimateSet
+{
+    EstimateEntry entries[JCUFFT_ESTIMATE_CACHE_WAYS];
+    int next;
+};
+
+/**
+ * The table
+ */
+static EstimateSet estimateSets[JCUFFT_ESTIMATE_CACHE_SETS];
+
+/**
+ * The mutex protecting the table
+ */
+static std::mutex estimateMutex;
+
+/**
+ * Whether the cache is enabled
+ */
+static std::atomic<bool> estimateCacheEnabled(true);
+
+/**
+ * The number of hits and misses
+ */
+static std::atomic<long long> estimateHits(0);
+static std::atomic<long long> estimateMisses(0);
+
+/**
+ * Computes the FNV-1a hash of the given key. The key is zeroed with
+ * memset when it is created, so the padding bytes are defined.
+ */
+static unsigned int hashKey(const EstimateKey &key)
+{
+    const unsigned char *bytes = (const unsigned char*)&key;
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(EstimateKey); i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool estimateCacheLookup(const EstimateKey &key, size_t *workSize)
+{
+    if (!estimateCacheEnabled.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    EstimateSet &set = estimateSets[hashKey(key) % JCUFFT_ESTIMATE_CACHE_SETS];
+    {
+        std::lock_guard<std::mutex> lock(estimateMutex);
+        for (int i = 0; i < JCUFFT_ESTIMATE_CACHE_WAYS; i++)
+        {
+            EstimateEntry &entry = set.entries[i];
+            if (entry.used && memcmp(&entry.key, &key, sizeof(EstimateKey)) == 0)
+            {
+                *workSize = entry.workSize;
+                estimateHits++;
+                return true;
+            }
+        }
+    }
+    estimateMisses++;
+    return false;
+}
+
+void estimateCacheStore(const EstimateKey &key, cufftResult result, size_t workSize)
+{
+    if (result != CUFFT_SUCCESS || !estimateCacheEnabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    EstimateSet &set = estimateSets[hashKey(key) % JCUFFT_ESTIMATE_CACHE_SETS];
+    std::lock_guard<std::mutex> lock(estimateMutex);
+    int index = -1;
+    for (int i = 0; i < JCUFFT_ESTIMATE_CACHE_WAYS; i++)
+    {
+        EstimateEntry &entry = set.entries[i];
+        if (entry.used && memcmp(&entry.key, &key, sizeof(EstimateKey)) == 0)
+        {
+            index = i;
+            break;
+        }
+        if (!entry.used && index == -1)
+        {
+            index = i;
+        }
+    }
+    if (index == -1)
+    {
+        index = set.next;
+        set.next = (set.next + 1) % JCUFFT_ESTIMATE_CACHE_WAYS;
+    }
+    EstimateEntry &entry = set.entries[index];
+    entry.used = true;
+    entry.key = key;
+    entry.workSize = workSize;
+}
+
+void estimateCacheSetEnabled(bool enabled)
+{
+    estimateCacheEnabled.store(enabled);
+    if (!enabled)
+    {
+        estimateCacheClear();
+    }
+}
+
+void estimateCacheClear()
+{
+    std::lock_guard<std::mutex> lock(estimateMutex);
+    for (int s = 0; s < JCUFFT_ESTIMATE_CACHE_SETS; s++)
+    {
+        for (int i = 0; i < JCUFFT_ESTIMATE_CACHE_WAYS; i++)
+        {
+            estimateSets[s].entries[i].used = false;
+        }
+        estimateSets[s].next = 0;
+    }
+    estimateHits.store(0);
+    estimateMisses.store(0);
+}
+
+void estimateCacheGetCounts(long long counts[3])
+{
+    std::lock_guard<std::mutex> lock(estimateMutex);
+    long long entries = 0;
+    for (int s = 0; s < JCUFFT_ESTIMATE_CACHE_SETS; s++)
+    {
+        for (int i = 0; i < JCUFFT_ESTIMATE_CACHE_WAYS; i++)
+        {
+            if (estimateSets[s].entries[i].used)
+            {
+                entries++;
+            }
+        }
+    }
+    counts[0] = estimateHits.load();
+    counts[1] = estimateMisses.load();
+    counts[2] = entries;
+}
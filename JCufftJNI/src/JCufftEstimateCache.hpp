@@ -0,0 +1,156 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_ESTIMATE_CACHE
+#define JCUFFT_ESTIMATE_CACHE
+
+#include "JCufft_common.hpp"
+
+#include <cstring>
+#include <cuda_runtime.h>
+
+/*
+ * A memoizing cache for the results of the functions that compute the
+ * size of the work area of a plan without creating it, namely the
+ * cufftEstimate* functions and cufftGetSizeMany/cufftGetSizeMany64.
+ *
+ * These functions always return the same size for the same geometry
+ * on the same device, but may take a considerable amount of time. The
+ * results of successful calls are stored in a fixed, set-associative
+ * table that is keyed by the function, the device and the complete
+ * geometry. The table does not allocate any memory. When a set is
+ * full, the entries of the set are replaced in round-robin order.
+ *
+ * The cache is enabled by default.
+ */
+
+// The kinds of the functions whose results are cached. The estimates
+// and the sizes for handles are kept apart, because CUFFT may return
+// a more accurate size for a handle.
+#define JCUFFT_CACHED_ESTIMATE 0
+#define JCUFFT_CACHED_GET_SIZE 1
+
+/**
+ * The key of a cached result
+ */
+struct EstimateKey
+{
+    int function;
+    int device;
+    int rank;
+    int type;
+    long long n[JCUFFT_MAX_RANK];
+    long long inembed[JCUFFT_MAX_RANK];
+    long long onembed[JCUFFT_MAX_RANK];
+    long long istride;
+    long long idist;
+    long long ostride;
+    long long odist;
+    long long batch;
+};
+
+/**
+ * Creates the key for the given function and geometry, on the current
+ * device. The embed arrays may be NULL, in which case the strides and
+ * distances are ignored, as in CUFFT.
+ */
+template <typename T>
+EstimateKey makeEstimateKey(int function, int rank, const T *n, const T *inembed, long long istride, long long idist, const T *onembed, long long ostride, long long odist, cufftType type, long long batch)
+{
+    EstimateKey key;
+    memset(&key, 0, sizeof(EstimateKey));
+    key.function = function;
+    cudaGetDevice(&key.device);
+    key.rank = rank;
+    key.type = (int)type;
+    for (int i = 0; i < rank && i < JCUFFT_MAX_RANK; i++)
+    {
+        key.n[i] = (long long)n[i];
+        key.inembed[i] = inembed == NULL ? 0 : (long long)inembed[i];
+        key.onembed[i] = onembed == NULL ? 0 : (long long)onembed[i];
+    }
+    if (inembed != NULL)
+    {
+        key.istride = istride;
+        key.idist = idist;
+    }
+    if (onembed != NULL)
+    {
+        key.ostride = ostride;
+        key.odist = odist;
+    }
+    key.batch = batch;
+    return key;
+}
+
+/**
+ * Looks up the work size for the given key. Returns false if the
+ * cache is disabled, or there is no entry for the key.
+ */
+bool estimateCacheLookup(const EstimateKey &key, size_t *workSize);
+
+/**
+ * Stores the given work size for the given key, if the cache is
+ * enabled and the result is CUFFT_SUCCESS
+ */
+void estimateCacheStore(const EstimateKey &key, cufftResult result, size_t workSize);
+
+/**
+ * Enables or disables the cache. Disabling the cache clears it.
+ */
+void estimateCacheSetEnabled(bool enabled);
+
+/**
+ * Removes all entries from the cache
+ */
+void estimateCacheClear();
+
+/**
+ * Writes the number of hits, the number of misses and the number of
+ * entries of the cache into the given array
+ */
+void estimateCacheGetCounts(long long counts[3]);
+
+/**
+ * Calls the given CUFFT function, unless the work size for the given
+ * key is already cached. The 'call' is an expression that assigns the
+ * cufftResult to 'result' and writes the work size to 'workSize'.
+ */
+#define JCUFFT_CACHED_SIZE(key, result, workSize, call) \
+    if (estimateCacheLookup(key, &workSize)) \
+    { \
+        result = CUFFT_SUCCESS; \
+    } \
+    else \
+    { \
+        call; \
+        estimateCacheStore(key, result, workSize); \
+    }
+
+#endif
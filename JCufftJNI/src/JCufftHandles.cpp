@@ -0,0 +1,326 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "JCufftHandles.hpp"
+
+#include <mutex>
+#include <thread>
+
+// The number of slots per chunk of the table, as a power of two
+#define JCUFFT_HANDLE_CHUNK_BITS 10
+#define JCUFFT_HANDLE_CHUNK_SIZE (1 << JCUFFT_HANDLE_CHUNK_BITS)
+
+// The maximum number of chunks of the table
+#define JCUFFT_HANDLE_MAX_CHUNKS 4096
+
+// The flag in the state of a slot indicating that it contains a plan
+#define JCUFFT_HANDLE_LIVE 0x80000000ULL
+
+// The flag in the state of a slot indicating that the plan has to be
+// destroyed when the last reference is released
+#define JCUFFT_HANDLE_PENDING 0x40000000ULL
+
+// The mask for the reference count in the state of a slot
+#define JCUFFT_HANDLE_REFS 0x3FFFFFFFULL
+
+// The number of references that are tracked per thread, for detecting
+// that a thread destroys a plan that it is currently using
+#define JCUFFT_HANDLE_TRACKED_REFERENCES 8
+
+/**
+ * The chunks of the table. Chunks are allocated when they are first
+ * needed, and never freed.
+ */
+static std::atomic<HandleEntry*> handleChunks[JCUFFT_HANDLE_MAX_CHUNKS];
+
+/**
+ * The number of slots that have been handed out at least once
+ */
+static std::atomic<unsigned int> handleSlotCount(0);
+
+/**
+ * The head of the list of free slots. The lower 32 bits are the index
+ * of the first free slot plus one, or 0 if the list is empty. The upper
+ * 32 bits are incremented with each change, to avoid the ABA problem.
+ */
+static std::atomic<unsigned long long> handleFreeList(0);
+
+/**
+ * The mutex that is used for allocating chunks
+ */
+static std::mutex handleChunkMutex;
+
+/**
+ * The slots that the current thread holds references to, in the order
+ * in which they have been acquired, and the number of these references.
+ * References beyond the tracked ones are only counted.
+ */
+static thread_local HandleEntry *heldEntries[JCUFFT_HANDLE_TRACKED_REFERENCES];
+static thread_local int heldCount = 0;
+
+/**
+ * Returns the slot with the given index, which must have been handed
+ * out already
+ */
+static inline HandleEntry *slotAt(unsigned int index)
+{
+    HandleEntry *chunk = handleChunks[index >> JCUFFT_HANDLE_CHUNK_BITS].load(std::memory_order_acquire);
+    return &chunk[index & (JCUFFT_HANDLE_CHUNK_SIZE - 1)];
+}
+
+/**
+ * Takes a slot from the list of free slots, or hands out a new one.
+ * Returns false if the table is full.
+ */
+static bool allocateSlot(unsigned int *index)
+{
+    unsigned long long head = handleFreeList.load(std::memory_order_acquire);
+    while ((head & 0xFFFFFFFFULL) != 0)
+    {
+        unsigned int first = (unsigned int)(head & 0xFFFFFFFFULL) - 1;
+        unsigned int next = slotAt(first)->nextFree.load(std::memory_order_relaxed);
+        unsigned long long newHead = ((head >> 32) + 1) << 32 | next;
+        if (handleFreeList.compare_exchange_weak(head, newHead, std::memory_order_acq_rel))
+        {
+            *index = first;
+            return true;
+        }
+    }
+
+    unsigned int newIndex = handleSlotCount.fetch_add(1, std::memory_order_relaxed);
+    unsigned int chunkIndex = newIndex >> JCUFFT_HANDLE_CHUNK_BITS;
+    if (chunkIndex >= JCUFFT_HANDLE_MAX_CHUNKS)
+    {
+        handleSlotCount.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (handleChunks[chunkIndex].load(std::memory_order_acquire) == NULL)
+    {
+        std::lock_guard<std::mutex> lock(handleChunkMutex);
+        if (handleChunks[chunkIndex].load(std::memory_order_relaxed) == NULL)
+        {
+            HandleEntry *chunk = new HandleEntry[JCUFFT_HANDLE_CHUNK_SIZE];
+            for (int i = 0; i < JCUFFT_HANDLE_CHUNK_SIZE; i++)
+            {
+                chunk[i].state.store(0, std::memory_order_relaxed);
+                chunk[i].nextFree.store(0, std::memory_order_relaxed);
+                chunk[i].index = (chunkIndex << JCUFFT_HANDLE_CHUNK_BITS) + i;
+                chunk[i].pendingDestroy = NULL;
+                chunk[i].stream.store(NULL, std::memory_order_relaxed);
+                chunk[i].workArea.store(NULL, std::memory_order_relaxed);
+#ifdef JCUFFT_ENABLE_STATISTICS
+                chunk[i].statistics.store(NULL, std::memory_order_relaxed);
+#endif
+#ifdef JCUFFT_ENABLE_RANGES
+                chunk[i].described.store(false, std::memory_order_relaxed);
+#endif
+            }
+            handleChunks[chunkIndex].store(chunk, std::memory_order_release);
+        }
+    }
+    *index = newIndex;
+    return true;
+}
+
+/**
+ * Puts the slot with the given index into the list of free slots
+ */
+static void freeSlot(unsigned int index)
+{
+    HandleEntry *entry = slotAt(index);
+    unsigned long long head = handleFreeList.load(std::memory_order_acquire);
+    while (true)
+    {
+        entry->nextFree.store((unsigned int)(head & 0xFFFFFFFFULL), std::memory_order_relaxed);
+        unsigned long long newHead = ((head >> 32) + 1) << 32 | (index + 1);
+        if (handleFreeList.compare_exchange_weak(head, newHead, std::memory_order_acq_rel))
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * Returns the slot that the given token refers to, or NULL if the
+ * token is not valid. The generation of the slot is not checked.
+ */
+static inline HandleEntry *slotFor(jlong token)
+{
+    unsigned int index = (unsigned int)((unsigned long long)token & 0xFFFFFFFFULL);
+    if (index == 0 || index > handleSlotCount.load(std::memory_order_acquire))
+    {
+        return NULL;
+    }
+    unsigned int chunkIndex = (index - 1) >> JCUFFT_HANDLE_CHUNK_BITS;
+    if (chunkIndex >= JCUFFT_HANDLE_MAX_CHUNKS ||
+        handleChunks[chunkIndex].load(std::memory_order_acquire) == NULL)
+    {
+        return NULL;
+    }
+    return slotAt(index - 1);
+}
+
+jlong handleTableRegister(cufftHandle plan)
+{
+    unsigned int index = 0;
+    if (!allocateSlot(&index))
+    {
+        return 0;
+    }
+    HandleEntry *entry = slotAt(index);
+    entry->plan = plan;
+    entry->rank = 0;
+    for (int i = 0; i < JCUFFT_MAX_RANK; i++)
+    {
+        entry->n[i] = 0;
+    }
+    entry->type = 0;
+    entry->batch = 0;
+    entry->stream.store(NULL, std::memory_order_relaxed);
+    entry->workArea.store(NULL, std::memory_order_relaxed);
+#ifdef JCUFFT_ENABLE_RANGES
+    entry->described.store(false, std::memory_order_relaxed);
+#endif
+
+    unsigned long long generation = entry->state.load(std::memory_order_relaxed) >> 32;
+    entry->state.store(generation << 32 | JCUFFT_HANDLE_LIVE, std::memory_order_release);
+    return (jlong)(generation << 32 | (index + 1));
+}
+
+HandleEntry *handleTableAcquire(jlong token)
+{
+    HandleEntry *entry = slotFor(token);
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+    unsigned long long generation = (unsigned long long)token >> 32;
+    unsigned long long state = entry->state.load(std::memory_order_acquire);
+    while (true)
+    {
+        if ((state >> 32) != generation ||
+            (state & JCUFFT_HANDLE_LIVE) == 0 ||
+            (state & JCUFFT_HANDLE_REFS) == JCUFFT_HANDLE_REFS)
+        {
+            return NULL;
+        }
+        if (entry->state.compare_exchange_weak(state, state + 1, std::memory_order_acquire))
+        {
+            break;
+        }
+    }
+    if (heldCount < JCUFFT_HANDLE_TRACKED_REFERENCES)
+    {
+        heldEntries[heldCount] = entry;
+    }
+    heldCount++;
+    return entry;
+}
+
+/**
+ * Destroys the plan of the given slot, which must not be referenced
+ * any more, and puts the slot into the list of free slots
+ */
+static cufftResult destroySlot(HandleEntry *entry, HandleDestroyFunction destroy)
+{
+    cufftResult result = destroy(entry);
+    entry->pendingDestroy = NULL;
+    unsigned long long generation = entry->state.load(std::memory_order_relaxed) >> 32;
+    entry->state.store(((generation + 1) & 0xFFFFFFFFULL) << 32, std::memory_order_release);
+    freeSlot(entry->index);
+    return result;
+}
+
+void handleTableRelease(HandleEntry *entry)
+{
+    heldCount--;
+    unsigned long long state = entry->state.fetch_sub(1, std::memory_order_acq_rel);
+    if ((state & JCUFFT_HANDLE_PENDING) != 0 && (state & JCUFFT_HANDLE_REFS) == 1)
+    {
+        destroySlot(entry, entry->pendingDestroy);
+    }
+}
+
+/**
+ * Returns the number of references to the given slot that are held by
+ * the current thread
+ */
+static unsigned long long heldReferences(HandleEntry *entry)
+{
+    unsigned long long count = 0;
+    int tracked = heldCount < JCUFFT_HANDLE_TRACKED_REFERENCES ? heldCount : JCUFFT_HANDLE_TRACKED_REFERENCES;
+    for (int i = 0; i < tracked; i++)
+    {
+        if (heldEntries[i] == entry)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+cufftResult handleTableRemove(jlong token, HandleDestroyFunction destroy)
+{
+    HandleEntry *entry = slotFor(token);
+    if (entry == NULL)
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    unsigned long long generation = (unsigned long long)token >> 32;
+    unsigned long long state = entry->state.load(std::memory_order_acquire);
+    while (true)
+    {
+        if ((state >> 32) != generation || (state & JCUFFT_HANDLE_LIVE) == 0)
+        {
+            return CUFFT_INVALID_PLAN;
+        }
+        if (entry->state.compare_exchange_weak(state, state & ~JCUFFT_HANDLE_LIVE, std::memory_order_acq_rel))
+        {
+            break;
+        }
+    }
+
+    // Wait until the functions that are currently using the plan in
+    // other threads have released their references
+    unsigned long long held = heldReferences(entry);
+    while ((entry->state.load(std::memory_order_acquire) & JCUFFT_HANDLE_REFS) != held)
+    {
+        std::this_thread::yield();
+    }
+    if (held == 0)
+    {
+        return destroySlot(entry, destroy);
+    }
+
+    // The current thread is still using the plan. Only this thread
+    // holds references now, and the last one of them will destroy it
+    entry->pendingDestroy = destroy;
+    entry->state.fetch_or(JCUFFT_HANDLE_PENDING, std::memory_order_acq_rel);
+    return CUFFT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_HANDLES
+#define JCUFFT_HANDLES
+
+#include "JCufft_common.hpp"
+#include "JCufftStatistics.hpp"
+#include "JCufftRanges.hpp"
+
+#include <atomic>
+
+/*
+ * The table of the plans that have been created through JCufft.
+ *
+ * The Java cufftHandle does not store the CUFFT plan itself, but a
+ * 64-bit token that consists of the index of a slot in this table and
+ * the generation of the slot. The generation is incremented whenever
+ * a plan is removed from the slot, so that a token of a destroyed plan
+ * can never refer to a different plan that later re-uses the slot, or
+ * the same CUFFT plan id.
+ *
+ * Each slot has a reference count. A native function acquires a
+ * reference to the slot before using the plan, with a single atomic
+ * compare-and-swap, and releases it afterwards. Removing a plan first
+ * marks the slot as dead, so that no new references can be acquired,
+ * and then waits until the references of other threads have been
+ * released, before the plan is destroyed. A handle can therefore be
+ * shared by multiple threads, and destroyed by any of them, without a
+ * lock on the call path. The table only takes a lock when it has to
+ * grow.
+ *
+ * A plan may also be destroyed by the thread that is currently using
+ * it, for example, from a callback that is invoked during an exec
+ * call. In this case, the destruction is deferred until this thread
+ * releases its last reference to the slot.
+ *
+ * The slots also store the geometry of the plan, its stream, its work
+ * area, its statistics and its description, so that this information can be looked up
+ * in constant time. The geometry is written when the plan is created or made, and
+ * is only read by the functions that use the plan afterwards.
+ */
+
+struct HandleEntry;
+
+/**
+ * A function that destroys the plan of the given slot, and returns
+ * the result of cufftDestroy
+ */
+typedef cufftResult (*HandleDestroyFunction)(HandleEntry *entry);
+
+/**
+ * A slot of the handle table
+ */
+struct HandleEntry
+{
+    // The generation of the slot in the upper 32 bits, a flag that
+    // indicates whether the slot contains a live plan in bit 31, a
+    // flag that indicates whether the plan has to be destroyed when
+    // the last reference is released in bit 30, and the reference
+    // count in the lower 30 bits
+    std::atomic<unsigned long long> state;
+
+    // The index of the next free slot plus one, or 0
+    std::atomic<unsigned int> nextFree;
+
+    // The index of this slot
+    unsigned int index;
+
+    // The function that destroys the plan when the last reference
+    // is released, if the destruction was deferred
+    HandleDestroyFunction pendingDestroy;
+
+    // The CUFFT plan
+    cufftHandle plan;
+
+    // The geometry of the plan. The rank is 0 if the plan was only
+    // created with cufftCreate.
+    int rank;
+    long long n[JCUFFT_MAX_RANK];
+    int type;
+    long long batch;
+
+    // The stream and the user-defined work area, or NULL
+    std::atomic<void*> stream;
+    std::atomic<void*> workArea;
+
+#ifdef JCUFFT_ENABLE_STATISTICS
+    // The statistics of the plan, or NULL if the plan was not made yet
+    std::atomic<PlanStatisticsEntry*> statistics;
+#endif
+
+#ifdef JCUFFT_ENABLE_RANGES
+    // The description of the plan for the range annotations. It is
+    // written once, when the plan is made, and only read after the
+    // flag has been set
+    std::atomic<bool> described;
+    char description[JCUFFT_RANGES_DESCRIPTION_LENGTH];
+#endif
+};
+
+/**
+ * Stores the given CUFFT plan in a free slot of the table, and returns
+ * the token for the slot, or 0 if the table is full
+ */
+jlong handleTableRegister(cufftHandle plan);
+
+/**
+ * Acquires a reference to the slot with the given token. Returns NULL
+ * if the token does not refer to a live plan.
+ */
+HandleEntry *handleTableAcquire(jlong token);
+
+/**
+ * Releases a reference that was acquired with handleTableAcquire
+ */
+void handleTableRelease(HandleEntry *entry);
+
+/**
+ * Removes the plan with the given token from the table, and destroys
+ * it with the given function, after the references of other threads
+ * have been released. If the calling thread itself holds a reference
+ * to the slot, then the plan is destroyed when this reference is
+ * released, and CUFFT_SUCCESS is returned. Returns CUFFT_INVALID_PLAN
+ * if the token does not refer to a live plan.
+ */
+cufftResult handleTableRemove(jlong token, HandleDestroyFunction destroy);
+
+/**
+ * Stores the given geometry in the given slot
+ */
+template <typename T>
+void handleTableSetGeometry(HandleEntry *entry, int rank, const T *n, int type, long long batch)
+{
+    entry->rank = rank;
+    for (int i = 0; i < JCUFFT_MAX_RANK; i++)
+    {
+        entry->n[i] = i < rank ? (long long)n[i] : 0;
+    }
+    entry->type = type;
+    entry->batch = batch;
+}
+
+/**
+ * A reference to the slot of the plan of a cufftHandle object, which
+ * is released when the reference goes out of scope
+ */
+class PlanReference
+{
+public:
+    PlanReference(JNIEnv *env, jobject handle)
+        : token(env->GetLongField(handle, cufftHandle_token)),
+          entry(handleTableAcquire(token))
+    {
+    }
+
+    ~PlanReference()
+    {
+        if (entry != NULL)
+        {
+            handleTableRelease(entry);
+        }
+    }
+
+    /**
+     * Returns whether the handle refers to a live plan
+     */
+    bool valid() const
+    {
+        return entry != NULL;
+    }
+
+    /**
+     * Returns the CUFFT plan. Only valid if valid() returns true.
+     */
+    cufftHandle plan() const
+    {
+        return entry->plan;
+    }
+
+    const jlong token;
+    HandleEntry *const entry;
+
+private:
+    PlanReference(const PlanReference &other);
+    PlanReference &operator=(const PlanReference &other);
+};
+
+#endif
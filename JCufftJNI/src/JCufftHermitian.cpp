@@ -0,0 +1,126 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "JCufftHermitian.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JCUFFT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+ * Writes the conjugates of the complex values src[m], src[m-1], ...
+ * into dst[0], dst[1], ..., for the given number of values
+ */
+static void conjugateReversedFloat(const float *src, long long m, float *dst, long long count)
+{
+    long long i = 0;
+#ifdef JCUFFT_USE_SSE2
+    const __m128 sign = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+    for (; i + 2 <= count; i += 2)
+    {
+        // Load the values m-i-1 and m-i, and swap them
+        __m128 v = _mm_loadu_ps(src + 2 * (m - i - 1));
+        v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2));
+        _mm_storeu_ps(dst + 2 * i, _mm_xor_ps(v, sign));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[2 * i] = src[2 * (m - i)];
+        dst[2 * i + 1] = -src[2 * (m - i) + 1];
+    }
+}
+
+/**
+ * Writes the conjugates of the complex values src[m], src[m-1], ...
+ * into dst[0], dst[1], ..., for the given number of values
+ */
+static void conjugateReversedDouble(const double *src, long long m, double *dst, long long count)
+{
+    long long i = 0;
+#ifdef JCUFFT_USE_SSE2
+    const __m128d sign = _mm_set_pd(-0.0, 0.0);
+    for (; i < count; i++)
+    {
+        __m128d v = _mm_loadu_pd(src + 2 * (m - i));
+        _mm_storeu_pd(dst + 2 * i, _mm_xor_pd(v, sign));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[2 * i] = src[2 * (m - i)];
+        dst[2 * i + 1] = -src[2 * (m - i) + 1];
+    }
+}
+
+/**
+ * Implementation of the expansion for float or double values
+ */
+template <typename T>
+static void hermitianExpand(const T *half, T *full, long long batch, long long n0, long long n1, long long n2,
+    void (*conjugateReversed)(const T*, long long, T*, long long))
+{
+    long long h = n2 / 2 + 1;
+    long long halfSize = n0 * n1 * h;
+    long long fullSize = n0 * n1 * n2;
+    for (long long b = 0; b < batch; b++)
+    {
+        const T *halfBatch = half + 2 * b * halfSize;
+        T *fullBatch = full + 2 * b * fullSize;
+        for (long long k0 = 0; k0 < n0; k0++)
+        {
+            long long m0 = (n0 - k0) % n0;
+            for (long long k1 = 0; k1 < n1; k1++)
+            {
+                long long m1 = (n1 - k1) % n1;
+                const T *row = halfBatch + 2 * (k0 * n1 + k1) * h;
+                const T *mirrorRow = halfBatch + 2 * (m0 * n1 + m1) * h;
+                T *fullRow = fullBatch + 2 * (k0 * n1 + k1) * n2;
+                memcpy(fullRow, row, 2 * h * sizeof(T));
+
+                // The elements h...n2-1 are the conjugates of the
+                // elements n2-h...1 of the mirrored row
+                conjugateReversed(mirrorRow, n2 - h, fullRow + 2 * h, n2 - h);
+            }
+        }
+    }
+}
+
+void hermitianExpandFloat(const float *half, float *full, long long batch, long long n0, long long n1, long long n2)
+{
+    hermitianExpand<float>(half, full, batch, n0, n1, n2, conjugateReversedFloat);
+}
+
+void hermitianExpandDouble(const double *half, double *full, long long batch, long long n0, long long n1, long long n2)
+{
+    hermitianExpand<double>(half, full, batch, n0, n1, n2, conjugateReversedDouble);
+}
@@ -0,0 +1,54 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_HERMITIAN
+#define JCUFFT_HERMITIAN
+
+/*
+ * Expansion of the half spectrum of a real-to-complex transform to the
+ * full, conjugate-symmetric spectrum, on the host.
+ *
+ * The sizes are the logical sizes of the real data of one transform,
+ * padded with leading 1's to three dimensions. The half spectrum of
+ * each transform contains n0*n1*(n2/2+1) complex values, and the full
+ * spectrum contains n0*n1*n2 complex values. The element at (k0,k1,k2)
+ * of the full spectrum with k2 > n2/2 is the conjugate of the element
+ * at ((n0-k0)%n0, (n1-k1)%n1, n2-k2) of the half spectrum.
+ *
+ * The mirrored parts of the rows are computed with SSE2 shuffles when
+ * they are available.
+ */
+
+/**
+ * Expands the given number of half spectra into full spectra
+ */
+void hermitianExpandFloat(const float *half, float *full, long long batch, long long n0, long long n1, long long n2);
+void hermitianExpandDouble(const double *half, double *full, long long batch, long long n0, long long n1, long long n2);
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "JCufftInterleave.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JCUFFT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+void interleaveFloat(const float *re, const float *im, float *dst, size_t n)
+{
+    size_t i = 0;
+#ifdef JCUFFT_USE_SSE2
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 r = _mm_loadu_ps(re + i);
+        __m128 c = _mm_loadu_ps(im + i);
+        _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(r, c));
+        _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(r, c));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[2 * i] = re[i];
+        dst[2 * i + 1] = im[i];
+    }
+}
+
+void interleaveDouble(const double *re, const double *im, double *dst, size_t n)
+{
+    size_t i = 0;
+#ifdef JCUFFT_USE_SSE2
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d r = _mm_loadu_pd(re + i);
+        __m128d c = _mm_loadu_pd(im + i);
+        _mm_storeu_pd(dst + 2 * i, _mm_unpacklo_pd(r, c));
+        _mm_storeu_pd(dst + 2 * i + 2, _mm_unpackhi_pd(r, c));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[2 * i] = re[i];
+        dst[2 * i + 1] = im[i];
+    }
+}
+
+void deinterleaveFloat(const float *src, float *re, float *im, size_t n)
+{
+    size_t i = 0;
+#ifdef JCUFFT_USE_SSE2
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(src + 2 * i);
+        __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+        _mm_storeu_ps(re + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(im + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        re[i] = src[2 * i];
+        im[i] = src[2 * i + 1];
+    }
+}
+
+void deinterleaveDouble(const double *src, double *re, double *im, size_t n)
+{
+    size_t i = 0;
+#ifdef JCUFFT_USE_SSE2
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d a = _mm_loadu_pd(src + 2 * i);
+        __m128d b = _mm_loadu_pd(src + 2 * i + 2);
+        _mm_storeu_pd(re + i, _mm_unpacklo_pd(a, b));
+        _mm_storeu_pd(im + i, _mm_unpackhi_pd(a, b));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        re[i] = src[2 * i];
+        im[i] = src[2 * i + 1];
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_INTERLEAVE
+#define JCUFFT_INTERLEAVE
+
+#include <stddef.h>
+
+/*
+ * Conversion between split complex data, with separate arrays for the
+ * real and the imaginary parts, and the interleaved complex data that
+ * is used by CUFFT.
+ *
+ * The conversions use SSE2 shuffles when they are available, and
+ * plain loops otherwise. The pointers do not have to be aligned.
+ */
+
+/**
+ * Interleaves the given number of real and imaginary parts into the
+ * given destination, which must have space for 2*n values
+ */
+void interleaveFloat(const float *re, const float *im, float *dst, size_t n);
+void interleaveDouble(const double *re, const double *im, double *dst, size_t n);
+
+/**
+ * Splits the given number of interleaved complex values from the given
+ * source into the real and imaginary parts
+ */
+void deinterleaveFloat(const float *src, float *re, float *im, size_t n);
+void deinterleaveDouble(const double *src, double *re, double *im, size_t n);
+
+#endif
@@ -0,0 +1,382 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "JCufftKernels.hpp"
+#include "JCufftTrig.hpp"
+
+#include <cuda_runtime.h>
+
+// The size of the square tiles that are transposed by one block
+#define TILE_DIM 32
+
+// The number of rows of a tile that are processed by one thread
+#define BLOCK_ROWS 8
+
+// The maximum number of blocks in the y- and z-dimension of a grid
+#define MAX_GRID_YZ 65535
+
+// The block size and the maximum grid size for element-wise kernels
+#define ELEMENT_BLOCK_SIZE 256
+#define MAX_ELEMENT_BLOCKS (1 << 20)
+
+/**
+ * Transposes the given matrices, tile by tile, through shared memory.
+ * The tile has one additional column to avoid bank conflicts. The
+ * y- and z-dimensions of the grid may be smaller than the number of
+ * tiles in y-direction and the number of matrices, in which case each
+ * block processes several tiles.
+ */
+template <typename T>
+__global__ void transposeKernel(const T *src, T *dst, long long batch, long long rows, long long cols)
+{
+    __shared__ T tile[TILE_DIM][TILE_DIM + 1];
+
+    long long tilesY = (rows + TILE_DIM - 1) / TILE_DIM;
+    for (long long b = blockIdx.z; b < batch; b += gridDim.z)
+    {
+        const T *matrixSrc = src + b * rows * cols;
+        T *matrixDst = dst + b * rows * cols;
+        for (long long tileY = blockIdx.y; tileY < tilesY; tileY += gridDim.y)
+        {
+            long long x = (long long)blockIdx.x * TILE_DIM + threadIdx.x;
+            long long y = tileY * TILE_DIM + threadIdx.y;
+            for (int j = 0; j < TILE_DIM; j += BLOCK_ROWS)
+            {
+                if (x < cols && y + j < rows)
+                {
+                    tile[threadIdx.y + j][threadIdx.x] = matrixSrc[(y + j) * cols + x];
+                }
+            }
+            __syncthreads();
+
+            x = tileY * TILE_DIM + threadIdx.x;
+            y = (long long)blockIdx.x * TILE_DIM + threadIdx.y;
+            for (int j = 0; j < TILE_DIM; j += BLOCK_ROWS)
+            {
+                if (x < rows && y + j < cols)
+                {
+                    matrixDst[(y + j) * rows + x] = tile[threadIdx.x][threadIdx.y + j];
+                }
+            }
+            __syncthreads();
+        }
+    }
+}
+
+/**
+ * Launches the transpose kernel for the given element type
+ */
+template <typename T>
+static int launchTranspose(const void *src, void *dst, long long batch, long long rows, long long cols, cudaStream_t stream)
+{
+    long long tilesX = (cols + TILE_DIM - 1) / TILE_DIM;
+    long long tilesY = (rows + TILE_DIM - 1) / TILE_DIM;
+    dim3 grid((unsigned int)tilesX,
+        (unsigned int)(tilesY < MAX_GRID_YZ ? tilesY : MAX_GRID_YZ),
+        (unsigned int)(batch < MAX_GRID_YZ ? batch : MAX_GRID_YZ));
+    dim3 block(TILE_DIM, BLOCK_ROWS);
+    transposeKernel<T><<<grid, block, 0, stream>>>((const T*)src, (T*)dst, batch, rows, cols);
+    return cudaGetLastError();
+}
+
+int jcufftTranspose(const void *src, void *dst, long long batch, long long rows, long long cols, int elementSize, void *stream)
+{
+    if (batch <= 0 || rows <= 0 || cols <= 0)
+    {
+        return cudaSuccess;
+    }
+    if ((cols + TILE_DIM - 1) / TILE_DIM > 0x7FFFFFFFLL)
+    {
+        return cudaErrorInvalidValue;
+    }
+    cudaStream_t cudaStream = (cudaStream_t)stream;
+    switch (elementSize)
+    {
+        case 4:
+            return launchTranspose<float>(src, dst, batch, rows, cols, cudaStream);
+        case 8:
+            return launchTranspose<double>(src, dst, batch, rows, cols, cudaStream);
+        case 16:
+            return launchTranspose<double2>(src, dst, batch, rows, cols, cudaStream);
+    }
+    return cudaErrorInvalidValue;
+}
+
+/**
+ * Computes the elements of the full spectra from the half spectra. The
+ * element at (k0,k1,k2) with k2 > n2/2 is the conjugate of the element
+ * at ((n0-k0)%n0, (n1-k1)%n1, n2-k2) of the half spectrum.
+ */
+template <typename T>
+__global__ void hermitianExpandKernel(const T *half, T *full, long long batch, long long n0, long long n1, long long n2)
+{
+    long long h = n2 / 2 + 1;
+    long long fullSize = n0 * n1 * n2;
+    long long total = batch * fullSize;
+    long long step = (long long)blockDim.x * gridDim.x;
+    for (long long i = (long long)blockIdx.x * blockDim.x + threadIdx.x; i < total; i += step)
+    {
+        long long b = i / fullSize;
+        long long r = i - b * fullSize;
+        long long k2 = r % n2;
+        long long k1 = (r / n2) % n1;
+        long long k0 = r / (n1 * n2);
+        const T *halfBatch = half + b * n0 * n1 * h;
+        T value;
+        if (k2 < h)
+        {
+            value = halfBatch[(k0 * n1 + k1) * h + k2];
+        }
+        else
+        {
+            long long m0 = (n0 - k0) % n0;
+            long long m1 = (n1 - k1) % n1;
+            value = halfBatch[(m0 * n1 + m1) * h + (n2 - k2)];
+            value.y = -value.y;
+        }
+        full[i] = value;
+    }
+}
+
+/**
+ * Launches the Hermitian expansion kernel for the given element type
+ */
+template <typename T>
+static int launchHermitianExpand(const void *half, void *full, long long batch, long long n0, long long n1, long long n2, cudaStream_t stream)
+{
+    long long total = batch * n0 * n1 * n2;
+    long long blocks = (total + ELEMENT_BLOCK_SIZE - 1) / ELEMENT_BLOCK_SIZE;
+    if (blocks > MAX_ELEMENT_BLOCKS)
+    {
+        blocks = MAX_ELEMENT_BLOCKS;
+    }
+    hermitianExpandKernel<T><<<(unsigned int)blocks, ELEMENT_BLOCK_SIZE, 0, stream>>>((const T*)half, (T*)full, batch, n0, n1, n2);
+    return cudaGetLastError();
+}
+
+int jcufftHermitianExpand(const void *half, void *full, long long batch, long long n0, long long n1, long long n2, int elementSize, void *stream)
+{
+    if (batch <= 0 || n0 <= 0 || n1 <= 0 || n2 <= 0)
+    {
+        return cudaSuccess;
+    }
+    cudaStream_t cudaStream = (cudaStream_t)stream;
+    switch (elementSize)
+    {
+        case 8:
+            return launchHermitianExpand<float2>(half, full, batch, n0, n1, n2, cudaStream);
+        case 16:
+            return launchHermitianExpand<double2>(half, full, batch, n0, n1, n2, cudaStream);
+    }
+    return cudaErrorInvalidValue;
+}
+
+/**
+ * Computes the cosine and the sine of pi * q / (4 * L), where q is an
+ * integer in [0, 8 * L)
+ */
+__device__ inline void trigAngle(long long q, long long L, float *c, float *s)
+{
+    sincospif((float)q / (float)(4 * L), s, c);
+}
+__device__ inline void trigAngle(long long q, long long L, double *c, double *s)
+{
+    sincospi((double)q / (double)(4 * L), s, c);
+}
+
+/**
+ * Writes the real and imaginary parts of the pre-twiddled and
+ * zero-padded input sequences. The angle is reduced to an integer
+ * multiple of pi/(4*L) before it is converted to floating point, so
+ * that the twiddle factors remain accurate for long sequences.
+ */
+template <typename T>
+__global__ void trigPreTwiddleKernel(const T *src, T *work, TrigParameters p, long long count, long long stride, long long n)
+{
+    long long total = p.parts * count * p.m;
+    long long step = (long long)blockDim.x * gridDim.x;
+    for (long long i = (long long)blockIdx.x * blockDim.x + threadIdx.x; i < total; i += step)
+    {
+        long long row = i / p.m;
+        long long j = i - row * p.m;
+        if (j >= n)
+        {
+            work[i] = 0;
+            continue;
+        }
+        long long part = row / count;
+        long long t = row - part * count;
+        T x = src[((t / stride) * n + j) * stride + (t % stride)];
+        T w = (T)trigWeight(&p, j, n);
+        T c, s;
+        trigAngle((2 * j * p.b2) % (8 * p.L), p.L, &c, &s);
+        work[i] = part == 0 ? w * x * c : -w * x * s;
+    }
+}
+
+/**
+ * Combines the spectra of the real and imaginary parts, and applies
+ * the post-twiddle factors
+ */
+template <typename T, typename C>
+__global__ void trigPostTwiddleKernel(const C *spectrum, T *dst, TrigParameters p, long long count, long long stride, long long n)
+{
+    long long h = p.m / 2 + 1;
+    long long total = count * n;
+    long long step = (long long)blockDim.x * gridDim.x;
+    for (long long i = (long long)blockIdx.x * blockDim.x + threadIdx.x; i < total; i += step)
+    {
+        long long t = i / n;
+        long long k = i - t * n;
+        C a = spectrum[t * h + k];
+        T zr = a.x;
+        T zi = a.y;
+        if (p.parts == 2)
+        {
+            C b = spectrum[(count + t) * h + k];
+            zr -= b.y;
+            zi += b.x;
+        }
+        T c, s;
+        trigAngle((p.a2 * (2 * k + p.b2)) % (8 * p.L), p.L, &c, &s);
+        T y = p.sine ? s * zr - c * zi : c * zr + s * zi;
+        dst[((t / stride) * n + k) * stride + (t % stride)] = y;
+    }
+}
+
+/**
+ * Returns the number of blocks for an element-wise kernel that
+ * processes the given number of elements
+ */
+static unsigned int elementBlocks(long long total)
+{
+    long long blocks = (total + ELEMENT_BLOCK_SIZE - 1) / ELEMENT_BLOCK_SIZE;
+    return (unsigned int)(blocks < MAX_ELEMENT_BLOCKS ? blocks : MAX_ELEMENT_BLOCKS);
+}
+
+int jcufftTrigPreTwiddle(const void *src, void *work, int kind, long long count, long long stride, long long n, int elementSize, void *stream)
+{
+    TrigParameters p;
+    if (!trigParameters(kind, n, &p) || stride <= 0)
+    {
+        return cudaErrorInvalidValue;
+    }
+    if (count <= 0)
+    {
+        return cudaSuccess;
+    }
+    cudaStream_t cudaStream = (cudaStream_t)stream;
+    unsigned int blocks = elementBlocks(p.parts * count * p.m);
+    switch (elementSize)
+    {
+        case 4:
+            trigPreTwiddleKernel<float><<<blocks, ELEMENT_BLOCK_SIZE, 0, cudaStream>>>((const float*)src, (float*)work, p, count, stride, n);
+            return cudaGetLastError();
+        case 8:
+            trigPreTwiddleKernel<double><<<blocks, ELEMENT_BLOCK_SIZE, 0, cudaStream>>>((const double*)src, (double*)work, p, count, stride, n);
+            return cudaGetLastError();
+    }
+    return cudaErrorInvalidValue;
+}
+
+int jcufftTrigPostTwiddle(const void *spectrum, void *dst, int kind, long long count, long long stride, long long n, int elementSize, void *stream)
+{
+    TrigParameters p;
+    if (!trigParameters(kind, n, &p) || stride <= 0)
+    {
+        return cudaErrorInvalidValue;
+    }
+    if (count <= 0)
+    {
+        return cudaSuccess;
+    }
+    cudaStream_t cudaStream = (cudaStream_t)stream;
+    unsigned int blocks = elementBlocks(count * n);
+    switch (elementSize)
+    {
+        case 4:
+            trigPostTwiddleKernel<float, float2><<<blocks, ELEMENT_BLOCK_SIZE, 0, cudaStream>>>((const float2*)spectrum, (float*)dst, p, count, stride, n);
+            return cudaGetLastError();
+        case 8:
+            trigPostTwiddleKernel<double, double2><<<blocks, ELEMENT_BLOCK_SIZE, 0, cudaStream>>>((const double2*)spectrum, (double*)dst, p, count, stride, n);
+            return cudaGetLastError();
+    }
+    return cudaErrorInvalidValue;
+}
+
+/**
+ * Multiplies the rows of the source with the factors, element-wise,
+ * and zero-pads them to the pitch of the destination
+ */
+template <typename C>
+__global__ void chirpMultiplyKernel(const C *src, long long srcPitch, const C *factors, long long count, C *dst, long long dstPitch, long long rows)
+{
+    long long total = rows * dstPitch;
+    long long step = (long long)blockDim.x * gridDim.x;
+    for (long long i = (long long)blockIdx.x * blockDim.x + threadIdx.x; i < total; i += step)
+    {
+        long long row = i / dstPitch;
+        long long j = i - row * dstPitch;
+        C result;
+        result.x = 0;
+        result.y = 0;
+        if (j < count)
+        {
+            C a = src[row * srcPitch + j];
+            C b = factors[j];
+            result.x = a.x * b.x - a.y * b.y;
+            result.y = a.x * b.y + a.y * b.x;
+        }
+        dst[i] = result;
+    }
+}
+
+int jcufftChirpMultiply(const void *src, long long srcPitch, const void *factors, long long count, void *dst, long long dstPitch, long long rows, int elementSize, void *stream)
+{
+    if (count > dstPitch)
+    {
+        return cudaErrorInvalidValue;
+    }
+    if (rows <= 0 || dstPitch <= 0)
+    {
+        return cudaSuccess;
+    }
+    cudaStream_t cudaStream = (cudaStream_t)stream;
+    unsigned int blocks = elementBlocks(rows * dstPitch);
+    switch (elementSize)
+    {
+        case 8:
+            chirpMultiplyKernel<float2><<<blocks, ELEMENT_BLOCK_SIZE, 0, cudaStream>>>((const float2*)src, srcPitch, (const float2*)factors, count, (float2*)dst, dstPitch, rows);
+            return cudaGetLastError();
+        case 16:
+            chirpMultiplyKernel<double2><<<blocks, ELEMENT_BLOCK_SIZE, 0, cudaStream>>>((const double2*)src, srcPitch, (const double2*)factors, count, (double2*)dst, dstPitch, rows);
+            return cudaGetLastError();
+    }
+    return cudaErrorInvalidValue;
+}
@@ -0,0 +1,95 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_KERNELS
+#define JCUFFT_KERNELS
+
+/*
+ * Device kernels for the Java helper classes, for rearranging data
+ * between the layouts that the helper classes support.
+ *
+ * The launchers are plain C++ functions, so that they may be called
+ * from the JNI entry points that are not compiled with NVCC. They
+ * return a cudaError_t value. When JCufft is built with the
+ * JCUFFT_STUB_BACKEND option, they are implemented on the host, and
+ * operate on host memory.
+ */
+
+/**
+ * Transposes the given number of consecutive row-major matrices with
+ * the given number of rows and columns from the source into the
+ * destination, asynchronously in the given stream. The element size
+ * must be 4, 8 or 16 bytes. The source and the destination must not
+ * overlap.
+ */
+int jcufftTranspose(const void *src, void *dst, long long batch, long long rows, long long cols, int elementSize, void *stream);
+
+/**
+ * Expands the given number of half spectra of real-to-complex
+ * transforms with the given logical sizes (padded with leading 1's to
+ * three dimensions) into full, conjugate-symmetric spectra,
+ * asynchronously in the given stream. The element size is the size of
+ * one complex value, 8 or 16 bytes. See JCufftHermitian.hpp for the
+ * data layout.
+ */
+int jcufftHermitianExpand(const void *half, void *full, long long batch, long long n0, long long n1, long long n2, int elementSize, void *stream);
+
+/**
+ * Writes the real sequences for the real-to-complex transforms of the
+ * DCT or DST of the given kind (see JCufftTrig.hpp), for the given
+ * number of transforms of the given length, asynchronously in the
+ * given stream. Transform t reads the elements
+ * src[((t / stride) * n + j) * stride + (t % stride)], so that any
+ * dimension of a row-major array may be transformed. The work buffer
+ * receives parts*count sequences of the length M. The element size is
+ * the size of one real value, 4 or 8 bytes.
+ */
+int jcufftTrigPreTwiddle(const void *src, void *work, int kind, long long count, long long stride, long long n, int elementSize, void *stream);
+
+/**
+ * Computes the DCT or DST of the given kind from the spectra of the
+ * sequences that have been written by jcufftTrigPreTwiddle, and writes
+ * the results into the destination, with the same layout as the
+ * source of jcufftTrigPreTwiddle, asynchronously in the given stream.
+ */
+int jcufftTrigPostTwiddle(const void *spectrum, void *dst, int kind, long long count, long long stride, long long n, int elementSize, void *stream);
+
+/**
+ * Multiplies the first 'count' complex elements of each of the given
+ * number of rows of the source with the corresponding elements of the
+ * given factors, and writes the products into the rows of the
+ * destination, asynchronously in the given stream. The remaining
+ * elements of each destination row are set to zero. The pitches are
+ * the distances between the rows, in elements. The source and the
+ * destination may be the same memory if the pitches are equal. The
+ * element size is the size of one complex value, 8 or 16 bytes.
+ */
+int jcufftChirpMultiply(const void *src, long long srcPitch, const void *factors, long long count, void *dst, long long dstPitch, long long rows, int elementSize, void *stream);
+
+#endif
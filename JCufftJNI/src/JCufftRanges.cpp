@@ -0,0 +1,291 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "JCufft.hpp"
+#include "JCufftRanges.hpp"
+#include "JCufftHandles.hpp"
+
+#ifdef JCUFFT_ENABLE_RANGES
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+// The maximum length of a range name
+#define JCUFFT_RANGES_NAME_LENGTH 128
+
+std::atomic<const RangeProvider*> rangeProvider(NULL);
+
+/**
+ * Returns the name of the given type
+ */
+static const char *typeName(cufftType type)
+{
+    switch (type)
+    {
+        case CUFFT_C2C: return "C2C";
+        case CUFFT_R2C: return "R2C";
+        case CUFFT_C2R: return "C2R";
+        case CUFFT_Z2Z: return "Z2Z";
+        case CUFFT_D2Z: return "D2Z";
+        case CUFFT_Z2D: return "Z2D";
+    }
+    return "?";
+}
+
+/**
+ * Writes a description of the given geometry into the given buffer
+ */
+static void describe(char *buffer, size_t size, int rank, const long long *n, cufftType type, long long batch)
+{
+    int length = snprintf(buffer, size, "%s ", typeName(type));
+    for (int i = 0; i < rank && i < JCUFFT_MAX_RANK && length > 0 && (size_t)length < size; i++)
+    {
+        length += snprintf(buffer + length, size - length, i == 0 ? "%lld" : "x%lld", n[i]);
+    }
+    if (length > 0 && (size_t)length < size)
+    {
+        snprintf(buffer + length, size - length, " batch %lld", batch);
+    }
+}
+
+const RangeProvider *beginPlanRangeSlow(JNIEnv *env, const char *function, int rank, const long long *n, cufftType type, long long batch)
+{
+    const RangeProvider *provider = rangeProvider.load(std::memory_order_acquire);
+    if (provider == NULL)
+    {
+        return NULL;
+    }
+    char description[JCUFFT_RANGES_DESCRIPTION_LENGTH];
+    describe(description, sizeof(description), rank, n, type, batch);
+    char name[JCUFFT_RANGES_NAME_LENGTH];
+    snprintf(name, sizeof(name), "%s %s", function, description);
+    provider->push(env, name);
+    return provider;
+}
+
+const RangeProvider *beginHandleRangeSlow(JNIEnv *env, const char *function, HandleEntry *handle)
+{
+    const RangeProvider *provider = rangeProvider.load(std::memory_order_acquire);
+    if (provider == NULL)
+    {
+        return NULL;
+    }
+    char name[JCUFFT_RANGES_NAME_LENGTH];
+    if (handle->described.load(std::memory_order_acquire))
+    {
+        snprintf(name, sizeof(name), "%s %s (plan %d)", function, handle->description, (int)handle->plan);
+    }
+    else
+    {
+        snprintf(name, sizeof(name), "%s (plan %d)", function, (int)handle->plan);
+    }
+    provider->push(env, name);
+    return provider;
+}
+
+void rangesPlanCreated(HandleEntry *handle)
+{
+    // The description is only written once, so that it does not change
+    // while other threads may be reading it
+    if (handle->described.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    describe(handle->description, sizeof(handle->description),
+        handle->rank, handle->n, (cufftType)handle->type, handle->batch);
+    handle->described.store(true, std::memory_order_release);
+}
+
+
+//=== NVTX ===================================================================
+
+typedef int (*NvtxRangePushFunction)(const char *message);
+typedef int (*NvtxRangePopFunction)();
+
+static NvtxRangePushFunction nvtxRangePush = NULL;
+static NvtxRangePopFunction nvtxRangePop = NULL;
+
+static void nvtxPush(JNIEnv *env, const char *name)
+{
+    nvtxRangePush(name);
+}
+
+static void nvtxPop(JNIEnv *env)
+{
+    nvtxRangePop();
+}
+
+static const RangeProvider nvtxProvider = { nvtxPush, nvtxPop };
+
+/**
+ * Tries to load the NVTX library and obtain the range functions.
+ * Returns whether this succeeded.
+ */
+static bool loadNvtx()
+{
+    static std::mutex mutex;
+    static bool attempted = false;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (attempted)
+    {
+        return nvtxRangePush != NULL;
+    }
+    attempted = true;
+
+#ifdef _WIN32
+    HMODULE library = LoadLibraryA("nvToolsExt64_1.dll");
+    if (library == NULL)
+    {
+        return false;
+    }
+    NvtxRangePushFunction push = (NvtxRangePushFunction)GetProcAddress(library, "nvtxRangePushA");
+    NvtxRangePopFunction pop = (NvtxRangePopFunction)GetProcAddress(library, "nvtxRangePop");
+#else
+    void *library = dlopen("libnvToolsExt.so.1", RTLD_LAZY | RTLD_LOCAL);
+    if (library == NULL)
+    {
+        library = dlopen("libnvToolsExt.so", RTLD_LAZY | RTLD_LOCAL);
+    }
+    if (library == NULL)
+    {
+        return false;
+    }
+    NvtxRangePushFunction push = (NvtxRangePushFunction)dlsym(library, "nvtxRangePushA");
+    NvtxRangePopFunction pop = (NvtxRangePopFunction)dlsym(library, "nvtxRangePop");
+#endif
+    if (push == NULL || pop == NULL)
+    {
+        Logger::log(LOG_ERROR, "The NVTX library does not contain the range functions\n");
+        return false;
+    }
+    nvtxRangePush = push;
+    nvtxRangePop = pop;
+    return true;
+}
+
+
+//=== Java ===================================================================
+
+/**
+ * The JCufft class, and the static methods that dispatch the ranges
+ * to the RangeListener
+ */
+static jclass JCufft_class = NULL;
+static jmethodID JCufft_rangeStarted = NULL; // (Ljava/lang/String;)V
+static jmethodID JCufft_rangeEnded = NULL; // ()V
+
+static void javaPush(JNIEnv *env, const char *name)
+{
+    jstring string = env->NewStringUTF(name);
+    if (string == NULL)
+    {
+        env->ExceptionClear();
+        return;
+    }
+    env->CallStaticVoidMethod(JCufft_class, JCufft_rangeStarted, string);
+    env->DeleteLocalRef(string);
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionClear();
+    }
+}
+
+static void javaPop(JNIEnv *env)
+{
+    env->CallStaticVoidMethod(JCufft_class, JCufft_rangeEnded);
+    if (env->ExceptionCheck())
+    {
+        env->ExceptionClear();
+    }
+}
+
+static const RangeProvider javaProvider = { javaPush, javaPop };
+
+/**
+ * Obtains the method IDs of the Java callbacks. Returns whether this
+ * succeeded. Otherwise, an exception is pending.
+ */
+static bool initJavaCallbacks(JNIEnv *env, jclass cls)
+{
+    if (JCufft_class != NULL)
+    {
+        return true;
+    }
+    JCufft_rangeStarted = env->GetStaticMethodID(cls, "rangeStarted", "(Ljava/lang/String;)V");
+    if (JCufft_rangeStarted == NULL) return false;
+    JCufft_rangeEnded = env->GetStaticMethodID(cls, "rangeEnded", "()V");
+    if (JCufft_rangeEnded == NULL) return false;
+    JCufft_class = (jclass)env->NewGlobalRef(cls);
+    return JCufft_class != NULL;
+}
+
+#endif // JCUFFT_ENABLE_RANGES
+
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    setRangeProviderNative
+ * Signature: (I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_jcuda_jcufft_JCufft_setRangeProviderNative
+  (JNIEnv *env, jclass cls, jint provider)
+{
+#ifdef JCUFFT_ENABLE_RANGES
+    switch (provider)
+    {
+        case JCUFFT_RANGES_NONE:
+            rangeProvider.store(NULL);
+            return JNI_TRUE;
+
+        case JCUFFT_RANGES_NVTX:
+            if (!loadNvtx())
+            {
+                return JNI_FALSE;
+            }
+            rangeProvider.store(&nvtxProvider);
+            return JNI_TRUE;
+
+        case JCUFFT_RANGES_JAVA:
+            if (!initJavaCallbacks(env, cls))
+            {
+                return JNI_FALSE;
+            }
+            rangeProvider.store(&javaProvider);
+            return JNI_TRUE;
+    }
+#endif
+    return JNI_FALSE;
+}
@@ -0,0 +1,131 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_RANGES
+#define JCUFFT_RANGES
+
+#include "JCufft_common.hpp"
+
+/*
+ * Optional range annotations around the plan creation, work area
+ * changes and exec calls, for timeline profilers.
+ *
+ * A RangeProvider receives a 'push' with a descriptive name before
+ * each of these calls, and a 'pop' afterwards. The name contains the
+ * function, the type and the geometry of the plan, for example,
+ * "cufftExecR2C R2C 512x512 batch 4 (plan 3)". There are two
+ * providers: One that forwards the ranges to NVTX, if the NVTX library
+ * can be loaded, and one that forwards them to a Java RangeListener.
+ *
+ * The ranges are only compiled in when JCUFFT_ENABLE_RANGES is defined.
+ * When no provider is active, each annotated call only performs a
+ * single relaxed atomic load.
+ */
+
+// The kinds of range providers, as passed in from Java
+#define JCUFFT_RANGES_NONE 0
+#define JCUFFT_RANGES_NVTX 1
+#define JCUFFT_RANGES_JAVA 2
+
+// The maximum length of a plan description
+#define JCUFFT_RANGES_DESCRIPTION_LENGTH 64
+
+#ifdef JCUFFT_ENABLE_RANGES
+
+#include <atomic>
+
+struct HandleEntry;
+
+/**
+ * A receiver of range annotations
+ */
+struct RangeProvider
+{
+    void (*push)(JNIEnv *env, const char *name);
+    void (*pop)(JNIEnv *env);
+};
+
+/**
+ * The currently active range provider, or NULL
+ */
+extern std::atomic<const RangeProvider*> rangeProvider;
+
+const RangeProvider *beginPlanRangeSlow(JNIEnv *env, const char *function, int rank, const long long *n, cufftType type, long long batch);
+const RangeProvider *beginHandleRangeSlow(JNIEnv *env, const char *function, HandleEntry *handle);
+void rangesPlanCreated(HandleEntry *handle);
+
+/**
+ * Begins a range for a call that creates a plan with the given
+ * geometry. Returns the provider that must be used for ending
+ * the range, or NULL if no provider is active.
+ */
+template <typename T>
+inline const RangeProvider *beginPlanRange(JNIEnv *env, const char *function, int rank, const T *n, cufftType type, long long batch)
+{
+    if (rangeProvider.load(std::memory_order_relaxed) == NULL)
+    {
+        return NULL;
+    }
+    long long dims[JCUFFT_MAX_RANK] = { 0, 0, 0 };
+    for (int i = 0; i < rank && i < JCUFFT_MAX_RANK; i++)
+    {
+        dims[i] = (long long)n[i];
+    }
+    return beginPlanRangeSlow(env, function, rank, dims, type, batch);
+}
+
+/**
+ * Begins a range for a call that receives the plan in the given slot
+ * of the handle table. Returns the provider that must be used for
+ * ending the range, or NULL if no provider is active.
+ */
+inline const RangeProvider *beginHandleRange(JNIEnv *env, const char *function, HandleEntry *handle)
+{
+    if (rangeProvider.load(std::memory_order_relaxed) == NULL)
+    {
+        return NULL;
+    }
+    return beginHandleRangeSlow(env, function, handle);
+}
+
+#define JCUFFT_RANGE_BEGIN_PLAN(env, function, rank, n, type, batch) const RangeProvider *range = beginPlanRange(env, function, rank, n, type, batch)
+#define JCUFFT_RANGE_BEGIN_HANDLE(env, function, handle) const RangeProvider *range = beginHandleRange(env, function, handle)
+#define JCUFFT_RANGE_END(env) do { if (range != NULL) range->pop(env); } while (0)
+#define JCUFFT_RANGES_PLAN_CREATED(handle) rangesPlanCreated(handle)
+
+#else
+
+#define JCUFFT_RANGE_BEGIN_PLAN(env, function, rank, n, type, batch) ((void)0)
+#define JCUFFT_RANGE_BEGIN_HANDLE(env, function, handle) ((void)0)
+#define JCUFFT_RANGE_END(env) ((void)0)
+#define JCUFFT_RANGES_PLAN_CREATED(handle) ((void)0)
+
+#endif // JCUFFT_ENABLE_RANGES
+
+#endif
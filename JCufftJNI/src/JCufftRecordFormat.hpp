@@ -0,0 +1,188 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_RECORD_FORMAT
+#define JCUFFT_RECORD_FORMAT
+
+/*
+ * The binary format of the call records that are written by the
+ * JCufft recorder, and read by the JCufftReplay tool.
+ *
+ * A record file starts with a JCufftRecordFileHeader, followed by a
+ * sequence of records. Each record starts with a JCufftRecordHeader,
+ * whose 'size' is the total size of the record, including the header.
+ * Readers must skip records of unknown types. All values are stored
+ * in the native byte order of the recording machine.
+ *
+ * This header only depends on the C standard library, so that it may
+ * be used by tools that are not linked against JNI or CUFFT.
+ */
+
+#include <stdint.h>
+
+// The magic bytes at the start of a record file
+#define JCUFFT_RECORD_MAGIC "JCUFFTRC"
+
+// The version of the record format
+#define JCUFFT_RECORD_VERSION 1
+
+/**
+ * The types of records
+ */
+enum JCufftRecordType
+{
+    JCUFFT_RECORD_CREATE = 1,
+    JCUFFT_RECORD_DESTROY = 2,
+    JCUFFT_RECORD_PLAN = 3,
+    JCUFFT_RECORD_SET_STREAM = 4,
+    JCUFFT_RECORD_SET_AUTO_ALLOCATION = 5,
+    JCUFFT_RECORD_SET_WORK_AREA = 6,
+    JCUFFT_RECORD_EXEC = 7
+};
+
+/**
+ * The functions that are described by a JCufftPlanRecord
+ */
+enum JCufftPlanFunction
+{
+    // cufftPlan1d, cufftPlan2d, cufftPlan3d and cufftPlanMany
+    JCUFFT_FUNCTION_PLAN = 1,
+
+    // cufftMakePlan1d, ..., cufftMakePlanMany64
+    JCUFFT_FUNCTION_MAKE_PLAN = 2,
+
+    // cufftGetSize1d, ..., cufftGetSizeMany64
+    JCUFFT_FUNCTION_GET_SIZE = 3,
+
+    // cufftEstimate1d, ..., cufftEstimateMany
+    JCUFFT_FUNCTION_ESTIMATE = 4
+};
+
+// The flags of a JCufftPlanRecord, indicating whether the
+// 'inembed' and 'onembed' arrays have been given
+#define JCUFFT_PLAN_FLAG_INEMBED 1
+#define JCUFFT_PLAN_FLAG_ONEMBED 2
+
+/**
+ * The header of a record file
+ */
+struct JCufftRecordFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+
+    // The wall clock time at which the recording was started,
+    // in nanoseconds since the epoch
+    int64_t startTimeNanos;
+};
+
+/**
+ * The header of a single record
+ */
+struct JCufftRecordHeader
+{
+    // The JCufftRecordType
+    uint16_t type;
+
+    // The size of the record, including this header
+    uint16_t size;
+
+    // The cufftResult of the call
+    int32_t result;
+
+    // An identifier of the calling thread
+    uint64_t threadId;
+
+    // The time at which the call started, in nanoseconds since the
+    // start of the recording
+    int64_t timeNanos;
+
+    // The host time that was spent in the call, in nanoseconds. For
+    // the exec functions, this is only the time for enqueueing the
+    // transform, unless the stream is synchronized by CUFFT.
+    int64_t durationNanos;
+};
+
+/**
+ * A record of a function that receives a plan geometry. The geometry
+ * is stored in the form of the cufftMakePlanMany64 parameters. The plan
+ * is -1 for the estimate functions.
+ */
+struct JCufftPlanRecord
+{
+    JCufftRecordHeader header;
+    int32_t plan;
+    int32_t function;
+    int32_t rank;
+    int32_t type;
+    int32_t flags;
+    int32_t reserved;
+    int64_t n[3];
+    int64_t inembed[3];
+    int64_t istride;
+    int64_t idist;
+    int64_t onembed[3];
+    int64_t ostride;
+    int64_t odist;
+    int64_t batch;
+    uint64_t workSize;
+};
+
+/**
+ * A record of a function that only receives a plan and a value:
+ * cufftCreate, cufftDestroy, cufftSetStream (where the address is
+ * the stream), cufftSetAutoAllocation (where the value is the flag)
+ * and cufftSetWorkArea (where the address is the work area)
+ */
+struct JCufftHandleRecord
+{
+    JCufftRecordHeader header;
+    int32_t plan;
+    int32_t value;
+    uint64_t address;
+};
+
+/**
+ * A record of an exec function. The type is the cufftType that
+ * corresponds to the exec function. The direction is 0 for real
+ * transforms.
+ */
+struct JCufftExecRecord
+{
+    JCufftRecordHeader header;
+    int32_t plan;
+    int32_t type;
+    int32_t direction;
+    int32_t reserved;
+    uint64_t idata;
+    uint64_t odata;
+};
+
+#endif
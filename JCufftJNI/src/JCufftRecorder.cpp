@@ -0,0 +1,221 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "JCufft.hpp"
+#include "JCufftRecorder.hpp"
+
+#ifdef JCUFFT_ENABLE_RECORDER
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <functional>
+
+// The size of the buffer for the records
+#define JCUFFT_RECORDER_BUFFER_SIZE (256 * 1024)
+
+std::atomic<bool> recording(false);
+
+/**
+ * The mutex protecting the state of the recording
+ */
+static std::mutex recorderMutex;
+
+/**
+ * The file that the records are written to, or NULL
+ */
+static FILE *recordFile = NULL;
+
+/**
+ * The time at which the recording was started, from recorderNanos
+ */
+static long long recordStartNanos = 0;
+
+/**
+ * Whether writing to the file failed
+ */
+static bool recordFailed = false;
+
+/**
+ * The buffer for the records
+ */
+static char recordBuffer[JCUFFT_RECORDER_BUFFER_SIZE];
+
+/**
+ * The number of bytes in the buffer
+ */
+static size_t recordBufferUsed = 0;
+
+long long recorderNanos()
+{
+    return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Returns an identifier for the calling thread
+ */
+static uint64_t currentThreadId()
+{
+    static thread_local uint64_t threadId =
+        (uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+    return threadId;
+}
+
+/**
+ * Writes the contents of the buffer to the file. Must be called while
+ * holding the mutex.
+ */
+static void flushRecords()
+{
+    if (recordBufferUsed > 0 &&
+        fwrite(recordBuffer, 1, recordBufferUsed, recordFile) != recordBufferUsed)
+    {
+        recordFailed = true;
+    }
+    recordBufferUsed = 0;
+}
+
+void writeRecord(JCufftRecordHeader *header, int type, size_t size, long long start, int result)
+{
+    long long end = recorderNanos();
+    header->type = (uint16_t)type;
+    header->size = (uint16_t)size;
+    header->result = (int32_t)result;
+    header->threadId = currentThreadId();
+    header->durationNanos = end - start;
+
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    if (recordFile == NULL)
+    {
+        return;
+    }
+    header->timeNanos = start > recordStartNanos ? start - recordStartNanos : 0;
+    if (recordBufferUsed + size > JCUFFT_RECORDER_BUFFER_SIZE)
+    {
+        flushRecords();
+    }
+    memcpy(recordBuffer + recordBufferUsed, header, size);
+    recordBufferUsed += size;
+}
+
+#endif // JCUFFT_ENABLE_RECORDER
+
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    startRecordingNative
+ * Signature: (Ljava/lang/String;)I
+ */
+JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_startRecordingNative
+  (JNIEnv *env, jclass cls, jstring fileName)
+{
+    if (fileName == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter 'fileName' is null for startRecording");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+#ifdef JCUFFT_ENABLE_RECORDER
+    const char *nativeFileName = env->GetStringUTFChars(fileName, NULL);
+    if (nativeFileName == NULL)
+    {
+        return JCUFFT_INTERNAL_ERROR;
+    }
+
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    if (recordFile != NULL)
+    {
+        env->ReleaseStringUTFChars(fileName, nativeFileName);
+        ThrowByName(env, "java/lang/IllegalStateException", "A recording is already active");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+    FILE *file = fopen(nativeFileName, "wb");
+    env->ReleaseStringUTFChars(fileName, nativeFileName);
+    if (file == NULL)
+    {
+        ThrowByName(env, "java/io/IOException", "Could not open the record file");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+
+    JCufftRecordFileHeader header = {};
+    memcpy(header.magic, JCUFFT_RECORD_MAGIC, sizeof(header.magic));
+    header.version = JCUFFT_RECORD_VERSION;
+    header.headerSize = sizeof(header);
+    header.startTimeNanos = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (fwrite(&header, sizeof(header), 1, file) != 1)
+    {
+        fclose(file);
+        ThrowByName(env, "java/io/IOException", "Could not write the record file");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+
+    recordFile = file;
+    recordFailed = false;
+    recordBufferUsed = 0;
+    recordStartNanos = recorderNanos();
+    recording.store(true);
+    return CUFFT_SUCCESS;
+#else
+    ThrowByName(env, "java/lang/UnsupportedOperationException", "The native library was compiled without JCUFFT_ENABLE_RECORDER");
+    return JCUFFT_INTERNAL_ERROR;
+#endif
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    stopRecordingNative
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_jcuda_jcufft_JCufft_stopRecordingNative
+  (JNIEnv *env, jclass cls)
+{
+#ifdef JCUFFT_ENABLE_RECORDER
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    recording.store(false);
+    if (recordFile == NULL)
+    {
+        return CUFFT_SUCCESS;
+    }
+    flushRecords();
+    if (fclose(recordFile) != 0)
+    {
+        recordFailed = true;
+    }
+    recordFile = NULL;
+    if (recordFailed)
+    {
+        ThrowByName(env, "java/io/IOException", "Could not write the record file");
+        return JCUFFT_INTERNAL_ERROR;
+    }
+#endif
+    return CUFFT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_RECORDER
+#define JCUFFT_RECORDER
+
+#include "JCufft_common.hpp"
+#include "JCufftRecordFormat.hpp"
+
+/*
+ * Optional recording of all calls of the JNI entry points into a
+ * binary file, in the format that is described in JCufftRecordFormat.hpp.
+ *
+ * The records are collected in a buffer and written to the file when
+ * the buffer is full, or when the recording is stopped. The recording
+ * is only compiled in when JCUFFT_ENABLE_RECORDER is defined. When it
+ * is compiled in but not active, each entry point only performs a
+ * single relaxed atomic load.
+ */
+
+#ifdef JCUFFT_ENABLE_RECORDER
+
+#include <atomic>
+
+/**
+ * Whether a recording is currently active
+ */
+extern std::atomic<bool> recording;
+
+/**
+ * Returns the current value of a monotonic clock, in nanoseconds
+ */
+long long recorderNanos();
+
+/**
+ * Completes the header of the given record, and appends the record to
+ * the current recording, if there is one
+ */
+void writeRecord(JCufftRecordHeader *header, int type, size_t size, long long start, int result);
+
+/**
+ * Records a function that receives a plan geometry
+ */
+template <typename T>
+inline void recordPlan(long long start, int result, int function, cufftHandle plan,
+    int rank, const T *n, const T *inembed, long long istride, long long idist,
+    const T *onembed, long long ostride, long long odist, int type, long long batch, size_t workSize)
+{
+    JCufftPlanRecord record = {};
+    record.plan = (int32_t)plan;
+    record.function = function;
+    record.rank = rank;
+    record.type = type;
+    for (int i = 0; i < rank && i < JCUFFT_MAX_RANK; i++)
+    {
+        record.n[i] = (int64_t)n[i];
+        if (inembed != NULL)
+        {
+            record.inembed[i] = (int64_t)inembed[i];
+        }
+        if (onembed != NULL)
+        {
+            record.onembed[i] = (int64_t)onembed[i];
+        }
+    }
+    record.flags =
+        (inembed != NULL ? JCUFFT_PLAN_FLAG_INEMBED : 0) |
+        (onembed != NULL ? JCUFFT_PLAN_FLAG_ONEMBED : 0);
+    record.istride = istride;
+    record.idist = idist;
+    record.ostride = ostride;
+    record.odist = odist;
+    record.batch = batch;
+    record.workSize = (uint64_t)workSize;
+    writeRecord(&record.header, JCUFFT_RECORD_PLAN, sizeof(record), start, result);
+}
+
+/**
+ * Records a function that receives a plan geometry with the basic
+ * data layout
+ */
+inline void recordBasicPlan(long long start, int result, int function, cufftHandle plan,
+    int rank, const long long *n, int type, long long batch, size_t workSize)
+{
+    recordPlan(start, result, function, plan, rank, n, (const long long*)NULL, 1, 0,
+        (const long long*)NULL, 1, 0, type, batch, workSize);
+}
+
+/**
+ * Records a function that only receives a plan and a value
+ */
+inline void recordHandle(long long start, int result, int type, cufftHandle plan, int value, const void *address)
+{
+    JCufftHandleRecord record = {};
+    record.plan = (int32_t)plan;
+    record.value = value;
+    record.address = (uint64_t)(uintptr_t)address;
+    writeRecord(&record.header, type, sizeof(record), start, result);
+}
+
+/**
+ * Records an exec function
+ */
+inline void recordExec(long long start, int result, cufftHandle plan, cufftType type, int direction, const void *idata, const void *odata)
+{
+    JCufftExecRecord record = {};
+    record.plan = (int32_t)plan;
+    record.type = (int32_t)type;
+    record.direction = direction;
+    record.idata = (uint64_t)(uintptr_t)idata;
+    record.odata = (uint64_t)(uintptr_t)odata;
+    writeRecord(&record.header, JCUFFT_RECORD_EXEC, sizeof(record), start, result);
+}
+
+#define JCUFFT_RECORD_START(start) long long start = recording.load(std::memory_order_relaxed) ? recorderNanos() : 0
+#define JCUFFT_RECORD_PLAN(start, result, ...) do { if (start != 0) recordPlan(start, result, __VA_ARGS__); } while (0)
+#define JCUFFT_RECORD_BASIC_PLAN(start, result, ...) do { if (start != 0) recordBasicPlan(start, result, __VA_ARGS__); } while (0)
+#define JCUFFT_RECORD_HANDLE(start, result, ...) do { if (start != 0) recordHandle(start, result, __VA_ARGS__); } while (0)
+#define JCUFFT_RECORD_EXEC(start, result, ...) do { if (start != 0) recordExec(start, result, __VA_ARGS__); } while (0)
+
+#else
+
+#define JCUFFT_RECORD_START(start) ((void)0)
+#define JCUFFT_RECORD_PLAN(start, result, ...) ((void)0)
+#define JCUFFT_RECORD_BASIC_PLAN(start, result, ...) ((void)0)
+#define JCUFFT_RECORD_HANDLE(start, result, ...) ((void)0)
+#define JCUFFT_RECORD_EXEC(start, result, ...) ((void)0)
+
+#endif // JCUFFT_ENABLE_RECORDER
+
+#endif
@@ -0,0 +1,444 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "JCufft.hpp"
+#include "JCufftStatistics.hpp"
+#include "JCufftHandles.hpp"
+
+#ifdef JCUFFT_ENABLE_STATISTICS
+
+#include <chrono>
+#include <cstring>
+#include <new>
+#ifndef JCUFFT_STUB_BACKEND
+#include <cuda_runtime.h>
+#endif
+
+// The number of executions per plan that may be timed concurrently
+#define JCUFFT_STATISTICS_SLOTS 8
+
+// The states of a timing slot
+#define SLOT_FREE 0
+#define SLOT_BUSY 1
+#define SLOT_RECORDED 2
+
+std::atomic<bool> statisticsEnabled(false);
+
+/**
+ * A lock-free log-linear histogram of nanosecond values
+ */
+struct AtomicHistogram
+{
+    std::atomic<unsigned long long> buckets[JCUFFT_HISTOGRAM_BUCKETS];
+    std::atomic<unsigned long long> count;
+    std::atomic<unsigned long long> total;
+    std::atomic<unsigned long long> max;
+};
+
+/**
+ * A pair of events for timing a single execution
+ */
+struct TimingSlot
+{
+    std::atomic<int> state;
+    bool created;
+#ifndef JCUFFT_STUB_BACKEND
+    cudaEvent_t start;
+    cudaEvent_t stop;
+#endif
+};
+
+/**
+ * The statistics of a single plan. They are allocated when the plan is
+ * made, and deleted when the plan is destroyed. The stream of the plan
+ * is taken from its slot in the handle table.
+ */
+struct PlanStatisticsEntry
+{
+    std::atomic<unsigned long long> execCount;
+    std::atomic<unsigned long long> failedCount;
+    std::atomic<unsigned long long> bytesPerExec;
+    std::atomic<unsigned long long> bytesMoved;
+    std::atomic<unsigned long long> untimedCount;
+    TimingSlot slots[JCUFFT_STATISTICS_SLOTS];
+    AtomicHistogram deviceTime;
+    std::atomic<unsigned long long> transferBytes;
+    AtomicHistogram transferTime;
+};
+
+/**
+ * Returns the index of the highest bit that is set in the given value
+ */
+static inline int highestBit(unsigned long long value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1)
+    {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * Record the given value in the given histogram
+ */
+static void record(AtomicHistogram &histogram, unsigned long long value)
+{
+    int index = 0;
+    if (value < JCUFFT_HISTOGRAM_SUB_BUCKETS)
+    {
+        index = (int)value;
+    }
+    else
+    {
+        int shift = highestBit(value) - JCUFFT_HISTOGRAM_SUB_BUCKET_BITS;
+        index = (shift + 1) * JCUFFT_HISTOGRAM_SUB_BUCKETS +
+            (int)((value >> shift) - JCUFFT_HISTOGRAM_SUB_BUCKETS);
+        if (index >= JCUFFT_HISTOGRAM_BUCKETS)
+        {
+            index = JCUFFT_HISTOGRAM_BUCKETS - 1;
+        }
+    }
+    histogram.buckets[index].fetch_add(1, std::memory_order_relaxed);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.total.fetch_add(value, std::memory_order_relaxed);
+    unsigned long long max = histogram.max.load(std::memory_order_relaxed);
+    while (value > max && !histogram.max.compare_exchange_weak(max, value))
+    {
+        // Retry with the updated maximum
+    }
+}
+
+/**
+ * Reset the given histogram
+ */
+static void reset(AtomicHistogram &histogram)
+{
+    for (int i = 0; i < JCUFFT_HISTOGRAM_BUCKETS; i++)
+    {
+        histogram.buckets[i].store(0, std::memory_order_relaxed);
+    }
+    histogram.count.store(0, std::memory_order_relaxed);
+    histogram.total.store(0, std::memory_order_relaxed);
+    histogram.max.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Collect the device times of all timing slots of the given entry
+ * whose executions have completed
+ */
+static void collect(PlanStatisticsEntry &entry)
+{
+#ifndef JCUFFT_STUB_BACKEND
+    for (int i = 0; i < JCUFFT_STATISTICS_SLOTS; i++)
+    {
+        TimingSlot &slot = entry.slots[i];
+        int expected = SLOT_RECORDED;
+        if (!slot.state.compare_exchange_strong(expected, SLOT_BUSY))
+        {
+            continue;
+        }
+        if (cudaEventQuery(slot.stop) == cudaErrorNotReady)
+        {
+            slot.state.store(SLOT_RECORDED, std::memory_order_release);
+            continue;
+        }
+        float ms = 0;
+        if (cudaEventElapsedTime(&ms, slot.start, slot.stop) == cudaSuccess)
+        {
+            record(entry.deviceTime, (unsigned long long)(ms * 1.0e6));
+        }
+        slot.state.store(SLOT_FREE, std::memory_order_release);
+    }
+#endif
+}
+
+/**
+ * Returns the current host time, in nanoseconds
+ */
+static long long hostNanos()
+{
+    return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ExecTiming beginExecSlow(HandleEntry *handle)
+{
+    ExecTiming timing = { NULL, -1, 0, NULL };
+    PlanStatisticsEntry *entry = handle->statistics.load(std::memory_order_acquire);
+    if (entry == NULL)
+    {
+        return timing;
+    }
+    timing.entry = entry;
+    timing.stream = (cudaStream_t)handle->stream.load(std::memory_order_relaxed);
+#ifdef JCUFFT_STUB_BACKEND
+    // The stand-in executes synchronously on the host
+    timing.hostStartNanos = hostNanos();
+#else
+    collect(*entry);
+    for (int i = 0; i < JCUFFT_STATISTICS_SLOTS; i++)
+    {
+        TimingSlot &slot = entry->slots[i];
+        int expected = SLOT_FREE;
+        if (!slot.state.compare_exchange_strong(expected, SLOT_BUSY))
+        {
+            continue;
+        }
+        if (!slot.created)
+        {
+            if (cudaEventCreate(&slot.start) != cudaSuccess ||
+                cudaEventCreate(&slot.stop) != cudaSuccess)
+            {
+                slot.state.store(SLOT_FREE, std::memory_order_release);
+                break;
+            }
+            slot.created = true;
+        }
+        cudaEventRecord(slot.start, timing.stream);
+        timing.slot = i;
+        break;
+    }
+#endif
+    return timing;
+}
+
+void endExecSlow(ExecTiming &timing, cufftResult result)
+{
+    PlanStatisticsEntry &entry = *timing.entry;
+    if (result != CUFFT_SUCCESS)
+    {
+        entry.failedCount.fetch_add(1, std::memory_order_relaxed);
+        if (timing.slot >= 0)
+        {
+            entry.slots[timing.slot].state.store(SLOT_FREE, std::memory_order_release);
+        }
+        return;
+    }
+    entry.execCount.fetch_add(1, std::memory_order_relaxed);
+    entry.bytesMoved.fetch_add(entry.bytesPerExec.load(std::memory_order_relaxed), std::memory_order_relaxed);
+#ifdef JCUFFT_STUB_BACKEND
+    record(entry.deviceTime, (unsigned long long)(hostNanos() - timing.hostStartNanos));
+#else
+    if (timing.slot < 0)
+    {
+        entry.untimedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TimingSlot &slot = entry.slots[timing.slot];
+    cudaEventRecord(slot.stop, timing.stream);
+    slot.state.store(SLOT_RECORDED, std::memory_order_release);
+#endif
+}
+
+void statisticsPlanCreated(HandleEntry *handle)
+{
+    PlanStatisticsEntry *entry = handle->statistics.load(std::memory_order_relaxed);
+    bool created = false;
+    if (entry == NULL)
+    {
+        entry = new (std::nothrow) PlanStatisticsEntry();
+        if (entry == NULL)
+        {
+            return;
+        }
+        for (int i = 0; i < JCUFFT_STATISTICS_SLOTS; i++)
+        {
+            entry->slots[i].state.store(SLOT_FREE, std::memory_order_relaxed);
+            entry->slots[i].created = false;
+        }
+        created = true;
+    }
+    int rank = handle->rank;
+    const long long *n = handle->n;
+    long long elements = handle->batch;
+    long long halfElements = handle->batch;
+    for (int i = 0; i < rank; i++)
+    {
+        elements *= n[i];
+        halfElements *= (i == rank - 1) ? n[i] / 2 + 1 : n[i];
+    }
+    unsigned long long bytes = 0;
+    switch (handle->type)
+    {
+        case CUFFT_C2C: bytes = elements * 2 * sizeof(cufftComplex); break;
+        case CUFFT_Z2Z: bytes = elements * 2 * sizeof(cufftDoubleComplex); break;
+        case CUFFT_R2C:
+        case CUFFT_C2R: bytes = elements * sizeof(cufftReal) + halfElements * sizeof(cufftComplex); break;
+        case CUFFT_D2Z:
+        case CUFFT_Z2D: bytes = elements * sizeof(cufftDoubleReal) + halfElements * sizeof(cufftDoubleComplex); break;
+    }
+    entry->execCount.store(0, std::memory_order_relaxed);
+    entry->failedCount.store(0, std::memory_order_relaxed);
+    entry->bytesPerExec.store(bytes, std::memory_order_relaxed);
+    entry->bytesMoved.store(0, std::memory_order_relaxed);
+    entry->untimedCount.store(0, std::memory_order_relaxed);
+    entry->transferBytes.store(0, std::memory_order_relaxed);
+    reset(entry->deviceTime);
+    reset(entry->transferTime);
+    if (created)
+    {
+        handle->statistics.store(entry, std::memory_order_release);
+    }
+}
+
+void statisticsPlanDestroyed(HandleEntry *handle)
+{
+    PlanStatisticsEntry *entry = handle->statistics.exchange(NULL, std::memory_order_acq_rel);
+    if (entry == NULL)
+    {
+        return;
+    }
+#ifndef JCUFFT_STUB_BACKEND
+    for (int i = 0; i < JCUFFT_STATISTICS_SLOTS; i++)
+    {
+        TimingSlot &slot = entry->slots[i];
+        if (slot.created)
+        {
+            cudaEventDestroy(slot.start);
+            cudaEventDestroy(slot.stop);
+        }
+    }
+#endif
+    delete entry;
+}
+
+/**
+ * Copy the given histogram into the given snapshot array
+ */
+static void copy(AtomicHistogram &histogram, jlong *count, jlong *total, jlong *max, jlong *buckets)
+{
+    *count = (jlong)histogram.count.load(std::memory_order_relaxed);
+    *total = (jlong)histogram.total.load(std::memory_order_relaxed);
+    *max = (jlong)histogram.max.load(std::memory_order_relaxed);
+    for (int i = 0; i < JCUFFT_HISTOGRAM_BUCKETS; i++)
+    {
+        buckets[i] = (jlong)histogram.buckets[i].load(std::memory_order_relaxed);
+    }
+}
+
+#endif // JCUFFT_ENABLE_STATISTICS
+
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    setStatisticsEnabledNative
+ * Signature: (Z)Z
+ */
+JNIEXPORT jboolean JNICALL Java_jcuda_jcufft_JCufft_setStatisticsEnabledNative
+  (JNIEnv *env, jclass cls, jboolean enabled)
+{
+#ifdef JCUFFT_ENABLE_STATISTICS
+    statisticsEnabled.store(enabled == JNI_TRUE, std::memory_order_relaxed);
+    return JNI_TRUE;
+#else
+    return JNI_FALSE;
+#endif
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    getPlanStatisticsNative
+ * Signature: (Ljcuda/jcufft/cufftHandle;)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_jcuda_jcufft_JCufft_getPlanStatisticsNative
+  (JNIEnv *env, jclass cls, jobject handle)
+{
+    if (handle == NULL)
+    {
+        ThrowByName(env, "java/lang/NullPointerException", "Parameter 'handle' is null for getPlanStatistics");
+        return NULL;
+    }
+#ifdef JCUFFT_ENABLE_STATISTICS
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return NULL;
+    }
+    PlanStatisticsEntry *entry = reference.entry->statistics.load(std::memory_order_acquire);
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+    collect(*entry);
+
+    const int size = JCUFFT_STATISTICS_HEADER_SIZE + 2 * JCUFFT_HISTOGRAM_BUCKETS;
+    jlong data[size];
+    data[0] = (jlong)entry->execCount.load(std::memory_order_relaxed);
+    data[1] = (jlong)entry->failedCount.load(std::memory_order_relaxed);
+    data[2] = (jlong)entry->bytesMoved.load(std::memory_order_relaxed);
+    data[3] = (jlong)entry->untimedCount.load(std::memory_order_relaxed);
+    copy(entry->deviceTime, &data[4], &data[5], &data[6],
+        &data[JCUFFT_STATISTICS_HEADER_SIZE]);
+    data[7] = (jlong)entry->transferBytes.load(std::memory_order_relaxed);
+    copy(entry->transferTime, &data[8], &data[9], &data[10],
+        &data[JCUFFT_STATISTICS_HEADER_SIZE + JCUFFT_HISTOGRAM_BUCKETS]);
+
+    jlongArray result = env->NewLongArray(size);
+    if (result == NULL)
+    {
+        return NULL;
+    }
+    env->SetLongArrayRegion(result, 0, size, data);
+    return result;
+#else
+    return NULL;
+#endif
+}
+
+/*
+ * Class:     jcuda_jcufft_JCufft
+ * Method:    recordTransferNative
+ * Signature: (Ljcuda/jcufft/cufftHandle;JJ)V
+ */
+JNIEXPORT void JNICALL Java_jcuda_jcufft_JCufft_recordTransferNative
+  (JNIEnv *env, jclass cls, jobject handle, jlong bytes, jlong nanos)
+{
+#ifdef JCUFFT_ENABLE_STATISTICS
+    if (handle == NULL || !statisticsEnabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    PlanReference reference(env, handle);
+    if (!reference.valid())
+    {
+        return;
+    }
+    PlanStatisticsEntry *entry = reference.entry->statistics.load(std::memory_order_acquire);
+    if (entry != NULL)
+    {
+        entry->transferBytes.fetch_add((unsigned long long)bytes, std::memory_order_relaxed);
+        record(entry->transferTime, (unsigned long long)nanos);
+    }
+#endif
+}
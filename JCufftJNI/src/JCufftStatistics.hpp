@@ -0,0 +1,127 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_STATISTICS
+#define JCUFFT_STATISTICS
+
+#include "JCufft_common.hpp"
+
+/*
+ * Optional per-plan instrumentation of the exec functions.
+ *
+ * For each plan, the number of executions, the number of bytes that
+ * are read and written by the transforms, and the device time of each
+ * execution are recorded. The device time is measured with pairs of
+ * CUDA events that are recorded on the stream of the plan, and
+ * collected lazily, so that the exec functions never synchronize.
+ * Additionally, the time of the memory transfers that are done by the
+ * array overloads on the Java side may be recorded.
+ *
+ * The statistics of a plan are allocated when the plan is created,
+ * and stored in its slot of the handle table, until the plan is
+ * destroyed. The times are recorded in lock-free log-linear histograms.
+ *
+ * The instrumentation is only compiled in when JCUFFT_ENABLE_STATISTICS
+ * is defined. It is disabled at runtime by default. When it is not
+ * compiled in, the macros below expand to nothing. When it is compiled
+ * in but disabled, each exec function only performs a single relaxed
+ * atomic load.
+ */
+
+// The number of sub-buckets of the histograms, as a power of two
+#define JCUFFT_HISTOGRAM_SUB_BUCKET_BITS 3
+#define JCUFFT_HISTOGRAM_SUB_BUCKETS (1 << JCUFFT_HISTOGRAM_SUB_BUCKET_BITS)
+
+// The histograms cover values up to 2^40 nanoseconds (about 18 minutes)
+#define JCUFFT_HISTOGRAM_MAX_BITS 40
+#define JCUFFT_HISTOGRAM_BUCKETS ((JCUFFT_HISTOGRAM_MAX_BITS - JCUFFT_HISTOGRAM_SUB_BUCKET_BITS + 1) * JCUFFT_HISTOGRAM_SUB_BUCKETS)
+
+// The number of values at the start of a statistics snapshot, before
+// the buckets of the device time and the transfer time histograms
+#define JCUFFT_STATISTICS_HEADER_SIZE 11
+
+#ifdef JCUFFT_ENABLE_STATISTICS
+
+#include <atomic>
+
+struct PlanStatisticsEntry;
+struct HandleEntry;
+
+/**
+ * Whether the statistics are currently enabled
+ */
+extern std::atomic<bool> statisticsEnabled;
+
+/**
+ * The state of a single execution that is being measured
+ */
+struct ExecTiming
+{
+    PlanStatisticsEntry *entry;
+    int slot;
+    long long hostStartNanos;
+    cudaStream_t stream;
+};
+
+ExecTiming beginExecSlow(HandleEntry *handle);
+void endExecSlow(ExecTiming &timing, cufftResult result);
+
+/**
+ * Begin the measurement of an execution of the plan in the given slot
+ * of the handle table. The entry of the result is NULL if the
+ * statistics are disabled.
+ */
+inline ExecTiming beginExec(HandleEntry *handle)
+{
+    if (!statisticsEnabled.load(std::memory_order_relaxed))
+    {
+        ExecTiming timing = { NULL, -1, 0, NULL };
+        return timing;
+    }
+    return beginExecSlow(handle);
+}
+
+void statisticsPlanCreated(HandleEntry *handle);
+void statisticsPlanDestroyed(HandleEntry *handle);
+
+#define JCUFFT_EXEC_BEGIN(handle) ExecTiming execTiming = beginExec(handle)
+#define JCUFFT_EXEC_END(result) if (execTiming.entry != NULL) endExecSlow(execTiming, result)
+#define JCUFFT_PLAN_CREATED(handle) statisticsPlanCreated(handle)
+#define JCUFFT_PLAN_DESTROYED(handle) statisticsPlanDestroyed(handle)
+
+#else
+
+#define JCUFFT_EXEC_BEGIN(handle) ((void)0)
+#define JCUFFT_EXEC_END(result) ((void)0)
+#define JCUFFT_PLAN_CREATED(handle) ((void)0)
+#define JCUFFT_PLAN_DESTROYED(handle) ((void)0)
+
+#endif // JCUFFT_ENABLE_STATISTICS
+
+#endif
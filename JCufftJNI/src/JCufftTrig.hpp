@@ -0,0 +1,142 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef JCUFFT_TRIG
+#define JCUFFT_TRIG
+
+/*
+ * The parameters of the DCT and DST types I-IV, which are computed
+ * with real-to-complex transforms by the twiddle kernels in
+ * JCufftKernels.hpp.
+ *
+ * All types are unnormalized, as in FFTW (REDFT00 ... RODFT11), and
+ * have the form
+ *
+ *   Y[k] = sum_n w[n] * x[n] * trig(pi * (n + a) * (k + b) / L)
+ *
+ * where trig is the cosine for the DCT and the sine for the DST, and
+ * the weight w[n] is 2, except for the first or last element of some
+ * types. With z[n] = w[n] * x[n] * exp(-i*pi*n*b/L), the sum is
+ *
+ *   exp(-i*pi*a*(k+b)/L) * Z[k]
+ *
+ * where Z is the DFT of z, zero-padded to the length M = 2*L. The real
+ * and imaginary parts of z are transformed as two real sequences, one
+ * after another in the same batched real-to-complex transform. When
+ * b is 0, the imaginary part vanishes, and one real sequence suffices.
+ */
+
+#ifdef __CUDACC__
+#define JCUFFT_HOST_DEVICE __host__ __device__
+#else
+#define JCUFFT_HOST_DEVICE
+#endif
+
+// The kinds of the transforms, as in the Java TrigPlan.Type enum
+#define JCUFFT_DCT_I 0
+#define JCUFFT_DCT_II 1
+#define JCUFFT_DCT_III 2
+#define JCUFFT_DCT_IV 3
+#define JCUFFT_DST_I 4
+#define JCUFFT_DST_II 5
+#define JCUFFT_DST_III 6
+#define JCUFFT_DST_IV 7
+
+/**
+ * The parameters of one transform type and length
+ */
+struct TrigParameters
+{
+    // The offsets a and b, multiplied by 2
+    int a2;
+    int b2;
+
+    // The denominator L
+    long long L;
+
+    // The length M = 2*L of the real-to-complex transform
+    long long m;
+
+    // Whether the transform is a DST
+    int sine;
+
+    // The number of real sequences that are transformed, 1 or 2
+    int parts;
+
+    // The weights of the first and the last element, 1 or 2
+    int firstWeight;
+    int lastWeight;
+};
+
+/**
+ * Computes the parameters for the given kind and length. Returns
+ * false if the kind is not valid, or the length is not supported.
+ * This is called on the host, and the parameters are passed to the
+ * kernels.
+ */
+inline bool trigParameters(int kind, long long n, TrigParameters *p)
+{
+    if (kind < 0 || kind > 7 || n < 1 || (kind == JCUFFT_DCT_I && n < 2))
+    {
+        return false;
+    }
+    switch (kind)
+    {
+        case JCUFFT_DCT_I: p->a2 = 0; p->b2 = 0; break;
+        case JCUFFT_DCT_II: p->a2 = 1; p->b2 = 0; break;
+        case JCUFFT_DCT_III: p->a2 = 0; p->b2 = 1; break;
+        case JCUFFT_DST_I: p->a2 = 2; p->b2 = 2; break;
+        case JCUFFT_DST_II: p->a2 = 1; p->b2 = 2; break;
+        case JCUFFT_DST_III: p->a2 = 2; p->b2 = 1; break;
+        default: p->a2 = 1; p->b2 = 1; break;
+    }
+    p->L = kind == JCUFFT_DCT_I ? n - 1 : kind == JCUFFT_DST_I ? n + 1 : n;
+    p->m = 2 * p->L;
+    p->sine = kind >= JCUFFT_DST_I;
+    p->parts = p->b2 == 0 ? 1 : 2;
+    p->firstWeight = kind == JCUFFT_DCT_I || kind == JCUFFT_DCT_III ? 1 : 2;
+    p->lastWeight = kind == JCUFFT_DCT_I || kind == JCUFFT_DST_III ? 1 : 2;
+    return true;
+}
+
+/**
+ * Returns the weight of the given element of a transform with the
+ * given parameters and length
+ */
+inline JCUFFT_HOST_DEVICE int trigWeight(const TrigParameters *p, long long j, long long n)
+{
+    int w = j == 0 ? p->firstWeight : 2;
+    if (j == n - 1 && p->lastWeight < w)
+    {
+        w = p->lastWeight;
+    }
+    return w;
+}
+
+#endif
@@ -31,7 +31,11 @@
 
 #define JCUFFT_INTERNAL_ERROR 0xFF
 
+// The maximum rank of a transform that is supported by CUFFT
+#define JCUFFT_MAX_RANK 3
+
 #include <stdlib.h>
+#include <stdint.h>
 #include <jni.h>
 #include <cufft.h>
 
@@ -39,4 +43,31 @@
 #include "JNIUtils.hpp"
 #include "PointerUtils.hpp"
 
+// The field ID of the 'token' field of the cufftHandle class
+extern jfieldID cufftHandle_token;
+
+/**
+ * Helper for passing the dimensions of the 1D, 2D and 3D functions
+ * as an array
+ */
+struct Dims
+{
+    long long values[JCUFFT_MAX_RANK];
+    Dims(long long nx, long long ny = 0, long long nz = 0)
+    {
+        values[0] = nx;
+        values[1] = ny;
+        values[2] = nz;
+    }
+};
+
+// Trace logging of the entry points. This compiles to nothing unless
+// JCUFFT_ENABLE_TRACE is defined, so that the arguments are not even
+// evaluated on the regular call path.
+#ifdef JCUFFT_ENABLE_TRACE
+#define JCUFFT_TRACE(...) Logger::log(LOG_TRACE, __VA_ARGS__)
+#else
+#define JCUFFT_TRACE(...) ((void)0)
+#endif
+
 #endif
\ No newline at end of file
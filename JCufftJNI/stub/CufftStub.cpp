@@ -0,0 +1,817 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * A CPU stand-in for the CUFFT library.
+ *
+ * This implements the subset of the CUFFT API that is used by JCufft,
+ * operating on host memory. It is intended for measuring the overhead
+ * of the JNI bindings on machines without a GPU: When JCufft is built
+ * with the JCUFFT_STUB_BACKEND option, it is linked against this file
+ * instead of the CUFFT library, and the "device" pointers that are
+ * passed to the exec functions must be pointers to host memory, for
+ * example, direct buffers.
+ *
+ * The transforms are computed in double precision, with a radix-2 FFT
+ * for power-of-two sizes and a plain DFT otherwise. The results are
+ * correct, but no attempt is made to be fast. In-place real transforms
+ * with the basic data layout assume unpadded real data.
+ */
+
+#include <cufft.h>
+#include <complex>
+#include <vector>
+#include <mutex>
+#include <cmath>
+#include <cstring>
+
+typedef std::complex<double> Complex;
+
+/**
+ * The description of a plan
+ */
+struct StubPlan
+{
+    bool used;
+    bool made;
+    int rank;
+    long long n[3];
+    long long inembed[3];
+    long long istride;
+    long long idist;
+    long long onembed[3];
+    long long ostride;
+    long long odist;
+    cufftType type;
+    long long batch;
+    int autoAllocate;
+    void *workArea;
+};
+
+/**
+ * The plans. The handle of a plan is its index, plus 1.
+ */
+static std::vector<StubPlan> plans;
+
+/**
+ * The mutex protecting the plans
+ */
+static std::mutex plansMutex;
+
+/**
+ * Returns the plan for the given handle, or NULL if the handle is
+ * not valid. The plan may only be accessed while holding the mutex,
+ * but the mutex is not held during the execution of a transform,
+ * so a copy of the plan is returned here.
+ */
+static bool getStubPlan(cufftHandle handle, StubPlan *plan)
+{
+    std::lock_guard<std::mutex> lock(plansMutex);
+    if (handle <= 0 || handle > (int)plans.size() || !plans[handle - 1].used)
+    {
+        return false;
+    }
+    *plan = plans[handle - 1];
+    return true;
+}
+
+/**
+ * Returns whether the input of the given type is real
+ */
+static bool isRealInput(cufftType type)
+{
+    return type == CUFFT_R2C || type == CUFFT_D2Z;
+}
+
+/**
+ * Returns whether the output of the given type is real
+ */
+static bool isRealOutput(cufftType type)
+{
+    return type == CUFFT_C2R || type == CUFFT_Z2D;
+}
+
+/**
+ * Returns whether the given type is a valid cufftType
+ */
+static bool isValidType(cufftType type)
+{
+    switch (type)
+    {
+        case CUFFT_R2C:
+        case CUFFT_C2R:
+        case CUFFT_C2C:
+        case CUFFT_D2Z:
+        case CUFFT_Z2D:
+        case CUFFT_Z2Z:
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Returns the number of elements of the logical transform
+ */
+static long long logicalSize(const StubPlan &plan)
+{
+    long long size = 1;
+    for (int i = 0; i < plan.rank; i++)
+    {
+        size *= plan.n[i];
+    }
+    return size;
+}
+
+/**
+ * Fill the layout of the given plan from the given parameters, as
+ * they are passed to the cufftPlanMany family of functions. Returns
+ * CUFFT_SUCCESS or an error code.
+ */
+static cufftResult initStubPlan(StubPlan &plan, int rank, const long long *n,
+    const long long *inembed, long long istride, long long idist,
+    const long long *onembed, long long ostride, long long odist,
+    cufftType type, long long batch)
+{
+    if (rank < 1 || rank > 3 || n == NULL || batch < 1)
+    {
+        return CUFFT_INVALID_SIZE;
+    }
+    if (!isValidType(type))
+    {
+        return CUFFT_INVALID_TYPE;
+    }
+    plan.rank = rank;
+    plan.type = type;
+    plan.batch = batch;
+    for (int i = 0; i < rank; i++)
+    {
+        if (n[i] < 1)
+        {
+            return CUFFT_INVALID_SIZE;
+        }
+        plan.n[i] = n[i];
+    }
+
+    // The basic layout: The complex side of real transforms only
+    // contains the non-redundant half of the last dimension
+    long long realEmbed[3];
+    long long complexEmbed[3];
+    for (int i = 0; i < rank; i++)
+    {
+        realEmbed[i] = n[i];
+        complexEmbed[i] = n[i];
+    }
+    complexEmbed[rank - 1] = n[rank - 1] / 2 + 1;
+    const long long *basicIn = isRealOutput(type) ? complexEmbed : realEmbed;
+    const long long *basicOut = isRealInput(type) ? complexEmbed : realEmbed;
+
+    bool basic = inembed == NULL || onembed == NULL;
+    long long inDist = 1;
+    long long outDist = 1;
+    for (int i = 0; i < rank; i++)
+    {
+        plan.inembed[i] = basic ? basicIn[i] : inembed[i];
+        plan.onembed[i] = basic ? basicOut[i] : onembed[i];
+        inDist *= plan.inembed[i];
+        outDist *= plan.onembed[i];
+    }
+    plan.istride = basic ? 1 : istride;
+    plan.idist = basic ? inDist : idist;
+    plan.ostride = basic ? 1 : ostride;
+    plan.odist = basic ? outDist : odist;
+    return CUFFT_SUCCESS;
+}
+
+/**
+ * Returns the size of the work area that is reported for the given plan
+ */
+static size_t stubWorkSize(const StubPlan &plan)
+{
+    return (size_t)(logicalSize(plan) * plan.batch) * sizeof(cufftComplex);
+}
+
+/**
+ * Computes the offset of the element with the given logical index
+ * in a batch entry with the given embedding and stride
+ */
+static long long offsetOf(const StubPlan &plan, const long long *index,
+    const long long *embed, long long stride)
+{
+    long long offset = 0;
+    for (int i = 0; i < plan.rank; i++)
+    {
+        offset = offset * embed[i] + index[i];
+    }
+    return offset * stride;
+}
+
+/**
+ * Advance the given logical index over the given extents. Returns
+ * false when the index wrapped around.
+ */
+static bool nextIndex(int rank, long long *index, const long long *extents)
+{
+    for (int i = rank - 1; i >= 0; i--)
+    {
+        if (++index[i] < extents[i])
+        {
+            return true;
+        }
+        index[i] = 0;
+    }
+    return false;
+}
+
+/**
+ * Computes the 1D transform of the given number of elements, starting
+ * at the given pointer, with the given stride, in place.
+ */
+static void transform1d(Complex *data, long long n, long long stride,
+    int direction, std::vector<Complex> &scratch)
+{
+    scratch.resize((size_t)n);
+    double sign = direction == CUFFT_FORWARD ? -1.0 : 1.0;
+    if ((n & (n - 1)) == 0)
+    {
+        // Radix-2, with bit reversal
+        for (long long i = 0, j = 0; i < n; i++)
+        {
+            scratch[(size_t)j] = data[i * stride];
+            long long bit = n >> 1;
+            while (bit > 0 && (j & bit) != 0)
+            {
+                j ^= bit;
+                bit >>= 1;
+            }
+            j |= bit;
+        }
+        for (long long length = 2; length <= n; length <<= 1)
+        {
+            double angle = sign * 2.0 * M_PI / (double)length;
+            Complex w(cos(angle), sin(angle));
+            for (long long i = 0; i < n; i += length)
+            {
+                Complex t(1.0, 0.0);
+                for (long long k = 0; k < length / 2; k++)
+                {
+                    Complex u = scratch[(size_t)(i + k)];
+                    Complex v = scratch[(size_t)(i + k + length / 2)] * t;
+                    scratch[(size_t)(i + k)] = u + v;
+                    scratch[(size_t)(i + k + length / 2)] = u - v;
+                    t *= w;
+                }
+            }
+        }
+    }
+    else
+    {
+        for (long long k = 0; k < n; k++)
+        {
+            Complex sum(0.0, 0.0);
+            for (long long j = 0; j < n; j++)
+            {
+                double angle = sign * 2.0 * M_PI * (double)((j * k) % n) / (double)n;
+                sum += data[j * stride] * Complex(cos(angle), sin(angle));
+            }
+            scratch[(size_t)k] = sum;
+        }
+    }
+    for (long long i = 0; i < n; i++)
+    {
+        data[i * stride] = scratch[(size_t)i];
+    }
+}
+
+/**
+ * Computes the multidimensional transform of the given dense data,
+ * in place, by applying 1D transforms along each dimension.
+ */
+static void transformNd(const StubPlan &plan, std::vector<Complex> &data,
+    int direction)
+{
+    std::vector<Complex> scratch;
+    long long total = logicalSize(plan);
+    long long stride = 1;
+    for (int d = plan.rank - 1; d >= 0; d--)
+    {
+        long long n = plan.n[d];
+        for (long long start = 0; start < total; start++)
+        {
+            // Start positions are the elements whose index in
+            // dimension d is 0
+            if ((start / stride) % n == 0)
+            {
+                transform1d(&data[(size_t)start], n, stride, direction, scratch);
+            }
+        }
+        stride *= n;
+    }
+}
+
+/**
+ * Executes the given plan. The input and output are given as arrays
+ * of real values of type T, and complex values are interleaved.
+ */
+template <typename T>
+static cufftResult execute(cufftHandle handle, const void *idata,
+    void *odata, int direction)
+{
+    StubPlan plan;
+    if (!getStubPlan(handle, &plan) || !plan.made)
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    if (idata == NULL || odata == NULL)
+    {
+        return CUFFT_INVALID_VALUE;
+    }
+    const T *input = (const T*)idata;
+    T *output = (T*)odata;
+    bool realIn = isRealInput(plan.type);
+    bool realOut = isRealOutput(plan.type);
+    if (realIn)
+    {
+        direction = CUFFT_FORWARD;
+    }
+    if (realOut)
+    {
+        direction = CUFFT_INVERSE;
+    }
+
+    long long total = logicalSize(plan);
+    int rank = plan.rank;
+    long long last = plan.n[rank - 1];
+    long long halfExtents[3];
+    for (int i = 0; i < rank; i++)
+    {
+        halfExtents[i] = plan.n[i];
+    }
+    halfExtents[rank - 1] = last / 2 + 1;
+
+    // All batch entries are gathered before the output is written,
+    // so that in-place transforms do not overwrite pending input
+    std::vector<std::vector<Complex> > batches((size_t)plan.batch);
+    long long index[3];
+    for (long long b = 0; b < plan.batch; b++)
+    {
+        std::vector<Complex> &data = batches[(size_t)b];
+        data.assign((size_t)total, Complex(0.0, 0.0));
+        const T *in = input + b * plan.idist * (realIn ? 1 : 2);
+        memset(index, 0, sizeof(index));
+        const long long *extents = realOut ? halfExtents : plan.n;
+        do
+        {
+            long long offset = offsetOf(plan, index, plan.inembed, plan.istride);
+            Complex value = realIn ?
+                Complex((double)in[offset], 0.0) :
+                Complex((double)in[2 * offset], (double)in[2 * offset + 1]);
+            long long dense = 0;
+            for (int i = 0; i < rank; i++)
+            {
+                dense = dense * plan.n[i] + index[i];
+            }
+            data[(size_t)dense] = value;
+            if (realOut && index[rank - 1] > 0 && index[rank - 1] < (last + 1) / 2)
+            {
+                // Hermitian symmetry: X[n - k] = conj(X[k])
+                long long mirror = 0;
+                for (int i = 0; i < rank; i++)
+                {
+                    long long k = index[i] == 0 ? 0 : plan.n[i] - index[i];
+                    mirror = mirror * plan.n[i] + k;
+                }
+                data[(size_t)mirror] = std::conj(value);
+            }
+        }
+        while (nextIndex(rank, index, extents));
+        transformNd(plan, data, direction);
+    }
+
+    for (long long b = 0; b < plan.batch; b++)
+    {
+        const std::vector<Complex> &data = batches[(size_t)b];
+        T *out = output + b * plan.odist * (realOut ? 1 : 2);
+        memset(index, 0, sizeof(index));
+        const long long *extents = realIn ? halfExtents : plan.n;
+        do
+        {
+            long long offset = offsetOf(plan, index, plan.onembed, plan.ostride);
+            long long dense = 0;
+            for (int i = 0; i < rank; i++)
+            {
+                dense = dense * plan.n[i] + index[i];
+            }
+            const Complex &value = data[(size_t)dense];
+            if (realOut)
+            {
+                out[offset] = (T)value.real();
+            }
+            else
+            {
+                out[2 * offset] = (T)value.real();
+                out[2 * offset + 1] = (T)value.imag();
+            }
+        }
+        while (nextIndex(rank, index, extents));
+    }
+    return CUFFT_SUCCESS;
+}
+
+/**
+ * Allocates a new, empty plan, and returns its handle
+ */
+static cufftHandle allocateStubPlan()
+{
+    std::lock_guard<std::mutex> lock(plansMutex);
+    for (size_t i = 0; i < plans.size(); i++)
+    {
+        if (!plans[i].used)
+        {
+            memset(&plans[i], 0, sizeof(StubPlan));
+            plans[i].used = true;
+            plans[i].autoAllocate = 1;
+            return (cufftHandle)(i + 1);
+        }
+    }
+    StubPlan plan;
+    memset(&plan, 0, sizeof(StubPlan));
+    plan.used = true;
+    plan.autoAllocate = 1;
+    plans.push_back(plan);
+    return (cufftHandle)plans.size();
+}
+
+/**
+ * Make the plan with the given handle, with the given layout
+ */
+static cufftResult makeStubPlan(cufftHandle handle, int rank,
+    const long long *n,
+    const long long *inembed, long long istride, long long idist,
+    const long long *onembed, long long ostride, long long odist,
+    cufftType type, long long batch, size_t *workSize)
+{
+    StubPlan plan;
+    if (!getStubPlan(handle, &plan))
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    cufftResult result = initStubPlan(plan, rank, n,
+        inembed, istride, idist, onembed, ostride, odist, type, batch);
+    if (result != CUFFT_SUCCESS)
+    {
+        return result;
+    }
+    plan.made = true;
+    if (workSize != NULL)
+    {
+        *workSize = stubWorkSize(plan);
+    }
+    std::lock_guard<std::mutex> lock(plansMutex);
+    plans[handle - 1] = plan;
+    return CUFFT_SUCCESS;
+}
+
+/**
+ * Convert the given int array to a long long array
+ */
+static const long long *toLongLong(const int *array, int rank, long long *target)
+{
+    if (array == NULL)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < rank && i < 3; i++)
+    {
+        target[i] = array[i];
+    }
+    return target;
+}
+
+/**
+ * Computes the work size for the given layout without creating a plan
+ */
+static cufftResult estimateStub(int rank, const long long *n,
+    cufftType type, long long batch, size_t *workSize)
+{
+    StubPlan plan;
+    memset(&plan, 0, sizeof(StubPlan));
+    cufftResult result = initStubPlan(plan, rank, n,
+        NULL, 1, 0, NULL, 1, 0, type, batch);
+    if (result == CUFFT_SUCCESS && workSize != NULL)
+    {
+        *workSize = stubWorkSize(plan);
+    }
+    return result;
+}
+
+//============================================================================
+// The CUFFT API
+
+cufftResult CUFFTAPI cufftGetVersion(int *version)
+{
+    if (version == NULL)
+    {
+        return CUFFT_INVALID_VALUE;
+    }
+    *version = CUFFT_VERSION;
+    return CUFFT_SUCCESS;
+}
+
+cufftResult CUFFTAPI cufftGetProperty(libraryPropertyType type, int *value)
+{
+    if (value == NULL)
+    {
+        return CUFFT_INVALID_VALUE;
+    }
+    switch (type)
+    {
+        case MAJOR_VERSION: *value = CUFFT_VER_MAJOR; return CUFFT_SUCCESS;
+        case MINOR_VERSION: *value = CUFFT_VER_MINOR; return CUFFT_SUCCESS;
+        case PATCH_LEVEL: *value = CUFFT_VER_PATCH; return CUFFT_SUCCESS;
+    }
+    return CUFFT_INVALID_TYPE;
+}
+
+cufftResult CUFFTAPI cufftCreate(cufftHandle *handle)
+{
+    if (handle == NULL)
+    {
+        return CUFFT_INVALID_VALUE;
+    }
+    *handle = allocateStubPlan();
+    return CUFFT_SUCCESS;
+}
+
+cufftResult CUFFTAPI cufftDestroy(cufftHandle handle)
+{
+    std::lock_guard<std::mutex> lock(plansMutex);
+    if (handle <= 0 || handle > (int)plans.size() || !plans[handle - 1].used)
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    plans[handle - 1].used = false;
+    return CUFFT_SUCCESS;
+}
+
+cufftResult CUFFTAPI cufftMakePlanMany64(cufftHandle plan, int rank,
+    long long int *n,
+    long long int *inembed, long long int istride, long long int idist,
+    long long int *onembed, long long int ostride, long long int odist,
+    cufftType type, long long int batch, size_t *workSize)
+{
+    return makeStubPlan(plan, rank, n, inembed, istride, idist,
+        onembed, ostride, odist, type, batch, workSize);
+}
+
+cufftResult CUFFTAPI cufftMakePlanMany(cufftHandle plan, int rank, int *n,
+    int *inembed, int istride, int idist,
+    int *onembed, int ostride, int odist,
+    cufftType type, int batch, size_t *workSize)
+{
+    long long n64[3];
+    long long inembed64[3];
+    long long onembed64[3];
+    return makeStubPlan(plan, rank, toLongLong(n, rank, n64),
+        toLongLong(inembed, rank, inembed64), istride, idist,
+        toLongLong(onembed, rank, onembed64), ostride, odist,
+        type, batch, workSize);
+}
+
+cufftResult CUFFTAPI cufftMakePlan1d(cufftHandle plan, int nx,
+    cufftType type, int batch, size_t *workSize)
+{
+    return cufftMakePlanMany(plan, 1, &nx, NULL, 1, 0, NULL, 1, 0,
+        type, batch, workSize);
+}
+
+cufftResult CUFFTAPI cufftMakePlan2d(cufftHandle plan, int nx, int ny,
+    cufftType type, size_t *workSize)
+{
+    int n[] = { nx, ny };
+    return cufftMakePlanMany(plan, 2, n, NULL, 1, 0, NULL, 1, 0,
+        type, 1, workSize);
+}
+
+cufftResult CUFFTAPI cufftMakePlan3d(cufftHandle plan, int nx, int ny, int nz,
+    cufftType type, size_t *workSize)
+{
+    int n[] = { nx, ny, nz };
+    return cufftMakePlanMany(plan, 3, n, NULL, 1, 0, NULL, 1, 0,
+        type, 1, workSize);
+}
+
+cufftResult CUFFTAPI cufftPlanMany(cufftHandle *plan, int rank, int *n,
+    int *inembed, int istride, int idist,
+    int *onembed, int ostride, int odist,
+    cufftType type, int batch)
+{
+    if (plan == NULL)
+    {
+        return CUFFT_INVALID_VALUE;
+    }
+    cufftHandle handle = allocateStubPlan();
+    cufftResult result = cufftMakePlanMany(handle, rank, n,
+        inembed, istride, idist, onembed, ostride, odist, type, batch, NULL);
+    if (result != CUFFT_SUCCESS)
+    {
+        cufftDestroy(handle);
+        return result;
+    }
+    *plan = handle;
+    return CUFFT_SUCCESS;
+}
+
+cufftResult CUFFTAPI cufftPlan1d(cufftHandle *plan, int nx,
+    cufftType type, int batch)
+{
+    return cufftPlanMany(plan, 1, &nx, NULL, 1, 0, NULL, 1, 0, type, batch);
+}
+
+cufftResult CUFFTAPI cufftPlan2d(cufftHandle *plan, int nx, int ny,
+    cufftType type)
+{
+    int n[] = { nx, ny };
+    return cufftPlanMany(plan, 2, n, NULL, 1, 0, NULL, 1, 0, type, 1);
+}
+
+cufftResult CUFFTAPI cufftPlan3d(cufftHandle *plan, int nx, int ny, int nz,
+    cufftType type)
+{
+    int n[] = { nx, ny, nz };
+    return cufftPlanMany(plan, 3, n, NULL, 1, 0, NULL, 1, 0, type, 1);
+}
+
+cufftResult CUFFTAPI cufftEstimate1d(int nx, cufftType type, int batch,
+    size_t *workSize)
+{
+    long long n[] = { nx };
+    return estimateStub(1, n, type, batch, workSize);
+}
+
+cufftResult CUFFTAPI cufftEstimate2d(int nx, int ny, cufftType type,
+    size_t *workSize)
+{
+    long long n[] = { nx, ny };
+    return estimateStub(2, n, type, 1, workSize);
+}
+
+cufftResult CUFFTAPI cufftEstimate3d(int nx, int ny, int nz, cufftType type,
+    size_t *workSize)
+{
+    long long n[] = { nx, ny, nz };
+    return estimateStub(3, n, type, 1, workSize);
+}
+
+cufftResult CUFFTAPI cufftEstimateMany(int rank, int *n,
+    int *inembed, int istride, int idist,
+    int *onembed, int ostride, int odist,
+    cufftType type, int batch, size_t *workSize)
+{
+    long long n64[3];
+    return estimateStub(rank, toLongLong(n, rank, n64), type, batch, workSize);
+}
+
+cufftResult CUFFTAPI cufftGetSize1d(cufftHandle handle, int nx,
+    cufftType type, int batch, size_t *workSize)
+{
+    return cufftEstimate1d(nx, type, batch, workSize);
+}
+
+cufftResult CUFFTAPI cufftGetSize2d(cufftHandle handle, int nx, int ny,
+    cufftType type, size_t *workSize)
+{
+    return cufftEstimate2d(nx, ny, type, workSize);
+}
+
+cufftResult CUFFTAPI cufftGetSize3d(cufftHandle handle, int nx, int ny, int nz,
+    cufftType type, size_t *workSize)
+{
+    return cufftEstimate3d(nx, ny, nz, type, workSize);
+}
+
+cufftResult CUFFTAPI cufftGetSizeMany(cufftHandle handle, int rank, int *n,
+    int *inembed, int istride, int idist,
+    int *onembed, int ostride, int odist,
+    cufftType type, int batch, size_t *workArea)
+{
+    return cufftEstimateMany(rank, n, inembed, istride, idist,
+        onembed, ostride, odist, type, batch, workArea);
+}
+
+cufftResult CUFFTAPI cufftGetSizeMany64(cufftHandle plan, int rank,
+    long long int *n,
+    long long int *inembed, long long int istride, long long int idist,
+    long long int *onembed, long long int ostride, long long int odist,
+    cufftType type, long long int batch, size_t *workSize)
+{
+    return estimateStub(rank, n, type, batch, workSize);
+}
+
+cufftResult CUFFTAPI cufftGetSize(cufftHandle handle, size_t *workSize)
+{
+    StubPlan plan;
+    if (!getStubPlan(handle, &plan) || !plan.made)
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    if (workSize != NULL)
+    {
+        *workSize = stubWorkSize(plan);
+    }
+    return CUFFT_SUCCESS;
+}
+
+cufftResult CUFFTAPI cufftSetWorkArea(cufftHandle handle, void *workArea)
+{
+    std::lock_guard<std::mutex> lock(plansMutex);
+    if (handle <= 0 || handle > (int)plans.size() || !plans[handle - 1].used)
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    plans[handle - 1].workArea = workArea;
+    return CUFFT_SUCCESS;
+}
+
+cufftResult CUFFTAPI cufftSetAutoAllocation(cufftHandle handle, int autoAllocate)
+{
+    std::lock_guard<std::mutex> lock(plansMutex);
+    if (handle <= 0 || handle > (int)plans.size() || !plans[handle - 1].used)
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    plans[handle - 1].autoAllocate = autoAllocate;
+    return CUFFT_SUCCESS;
+}
+
+cufftResult CUFFTAPI cufftSetStream(cufftHandle handle, cudaStream_t stream)
+{
+    StubPlan plan;
+    if (!getStubPlan(handle, &plan))
+    {
+        return CUFFT_INVALID_PLAN;
+    }
+    // The stand-in executes all transforms synchronously
+    return CUFFT_SUCCESS;
+}
+
+cufftResult CUFFTAPI cufftExecC2C(cufftHandle plan, cufftComplex *idata,
+    cufftComplex *odata, int direction)
+{
+    return execute<float>(plan, idata, odata, direction);
+}
+
+cufftResult CUFFTAPI cufftExecR2C(cufftHandle plan, cufftReal *idata,
+    cufftComplex *odata)
+{
+    return execute<float>(plan, idata, odata, CUFFT_FORWARD);
+}
+
+cufftResult CUFFTAPI cufftExecC2R(cufftHandle plan, cufftComplex *idata,
+    cufftReal *odata)
+{
+    return execute<float>(plan, idata, odata, CUFFT_INVERSE);
+}
+
+cufftResult CUFFTAPI cufftExecZ2Z(cufftHandle plan, cufftDoubleComplex *idata,
+    cufftDoubleComplex *odata, int direction)
+{
+    return execute<double>(plan, idata, odata, direction);
+}
+
+cufftResult CUFFTAPI cufftExecD2Z(cufftHandle plan, cufftDoubleReal *idata,
+    cufftDoubleComplex *odata)
+{
+    return execute<double>(plan, idata, odata, CUFFT_FORWARD);
+}
+
+cufftResult CUFFTAPI cufftExecZ2D(cufftHandle plan, cufftDoubleComplex *idata,
+    cufftDoubleReal *odata)
+{
+    return execute<double>(plan, idata, odata, CUFFT_INVERSE);
+}
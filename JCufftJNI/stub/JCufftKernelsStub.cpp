@@ -0,0 +1,231 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * A host implementation of the kernel launchers in JCufftKernels.hpp,
+ * for builds with the JCUFFT_STUB_BACKEND option. Like the CPU
+ * stand-in for CUFFT, it operates on host memory, and ignores the
+ * stream.
+ */
+
+#include "JCufftKernels.hpp"
+#include "JCufftHermitian.hpp"
+#include "JCufftTrig.hpp"
+
+#include <cmath>
+#include <cstring>
+
+// The values of the cudaError_t constants that are returned
+#define STUB_SUCCESS 0
+#define STUB_ERROR_INVALID_VALUE 1
+
+// The size of the blocks that are transposed at once
+#define BLOCK_SIZE 32
+
+int jcufftTranspose(const void *src, void *dst, long long batch, long long rows, long long cols, int elementSize, void *stream)
+{
+    if (elementSize != 4 && elementSize != 8 && elementSize != 16)
+    {
+        return STUB_ERROR_INVALID_VALUE;
+    }
+    for (long long b = 0; b < batch; b++)
+    {
+        const char *s = (const char*)src + b * rows * cols * elementSize;
+        char *d = (char*)dst + b * rows * cols * elementSize;
+        for (long long r0 = 0; r0 < rows; r0 += BLOCK_SIZE)
+        {
+            for (long long c0 = 0; c0 < cols; c0 += BLOCK_SIZE)
+            {
+                long long r1 = r0 + BLOCK_SIZE < rows ? r0 + BLOCK_SIZE : rows;
+                long long c1 = c0 + BLOCK_SIZE < cols ? c0 + BLOCK_SIZE : cols;
+                for (long long r = r0; r < r1; r++)
+                {
+                    for (long long c = c0; c < c1; c++)
+                    {
+                        memcpy(d + (c * rows + r) * elementSize, s + (r * cols + c) * elementSize, elementSize);
+                    }
+                }
+            }
+        }
+    }
+    return STUB_SUCCESS;
+}
+
+int jcufftHermitianExpand(const void *half, void *full, long long batch, long long n0, long long n1, long long n2, int elementSize, void *stream)
+{
+    switch (elementSize)
+    {
+        case 8:
+            hermitianExpandFloat((const float*)half, (float*)full, batch, n0, n1, n2);
+            return STUB_SUCCESS;
+        case 16:
+            hermitianExpandDouble((const double*)half, (double*)full, batch, n0, n1, n2);
+            return STUB_SUCCESS;
+    }
+    return STUB_ERROR_INVALID_VALUE;
+}
+
+/**
+ * Implementation of jcufftTrigPreTwiddle for the given element type
+ */
+template <typename T>
+static void trigPreTwiddle(const T *src, T *work, const TrigParameters &p, long long count, long long stride, long long n)
+{
+    for (long long row = 0; row < p.parts * count; row++)
+    {
+        long long part = row / count;
+        long long t = row - part * count;
+        T *w = work + row * p.m;
+        for (long long j = 0; j < p.m; j++)
+        {
+            if (j >= n)
+            {
+                w[j] = 0;
+                continue;
+            }
+            T x = src[((t / stride) * n + j) * stride + (t % stride)];
+            double angle = M_PI * (double)((2 * j * p.b2) % (8 * p.L)) / (double)(4 * p.L);
+            double v = trigWeight(&p, j, n) * (double)x;
+            w[j] = (T)(part == 0 ? v * cos(angle) : -v * sin(angle));
+        }
+    }
+}
+
+/**
+ * Implementation of jcufftTrigPostTwiddle for the given element type
+ */
+template <typename T>
+static void trigPostTwiddle(const T *spectrum, T *dst, const TrigParameters &p, long long count, long long stride, long long n)
+{
+    long long h = p.m / 2 + 1;
+    for (long long t = 0; t < count; t++)
+    {
+        for (long long k = 0; k < n; k++)
+        {
+            const T *a = spectrum + 2 * (t * h + k);
+            double zr = a[0];
+            double zi = a[1];
+            if (p.parts == 2)
+            {
+                const T *b = spectrum + 2 * ((count + t) * h + k);
+                zr -= b[1];
+                zi += b[0];
+            }
+            double angle = M_PI * (double)((p.a2 * (2 * k + p.b2)) % (8 * p.L)) / (double)(4 * p.L);
+            double c = cos(angle);
+            double s = sin(angle);
+            double y = p.sine ? s * zr - c * zi : c * zr + s * zi;
+            dst[((t / stride) * n + k) * stride + (t % stride)] = (T)y;
+        }
+    }
+}
+
+int jcufftTrigPreTwiddle(const void *src, void *work, int kind, long long count, long long stride, long long n, int elementSize, void *stream)
+{
+    TrigParameters p;
+    if (!trigParameters(kind, n, &p) || stride <= 0)
+    {
+        return STUB_ERROR_INVALID_VALUE;
+    }
+    switch (elementSize)
+    {
+        case 4:
+            trigPreTwiddle((const float*)src, (float*)work, p, count, stride, n);
+            return STUB_SUCCESS;
+        case 8:
+            trigPreTwiddle((const double*)src, (double*)work, p, count, stride, n);
+            return STUB_SUCCESS;
+    }
+    return STUB_ERROR_INVALID_VALUE;
+}
+
+int jcufftTrigPostTwiddle(const void *spectrum, void *dst, int kind, long long count, long long stride, long long n, int elementSize, void *stream)
+{
+    TrigParameters p;
+    if (!trigParameters(kind, n, &p) || stride <= 0)
+    {
+        return STUB_ERROR_INVALID_VALUE;
+    }
+    switch (elementSize)
+    {
+        case 4:
+            trigPostTwiddle((const float*)spectrum, (float*)dst, p, count, stride, n);
+            return STUB_SUCCESS;
+        case 8:
+            trigPostTwiddle((const double*)spectrum, (double*)dst, p, count, stride, n);
+            return STUB_SUCCESS;
+    }
+    return STUB_ERROR_INVALID_VALUE;
+}
+
+/**
+ * Implementation of jcufftChirpMultiply for the given element type
+ */
+template <typename T>
+static void chirpMultiply(const T *src, long long srcPitch, const T *factors, long long count, T *dst, long long dstPitch, long long rows)
+{
+    for (long long row = 0; row < rows; row++)
+    {
+        const T *s = src + 2 * row * srcPitch;
+        T *d = dst + 2 * row * dstPitch;
+        for (long long j = 0; j < dstPitch; j++)
+        {
+            if (j >= count)
+            {
+                d[2 * j + 0] = 0;
+                d[2 * j + 1] = 0;
+                continue;
+            }
+            T ar = s[2 * j + 0];
+            T ai = s[2 * j + 1];
+            T br = factors[2 * j + 0];
+            T bi = factors[2 * j + 1];
+            d[2 * j + 0] = ar * br - ai * bi;
+            d[2 * j + 1] = ar * bi + ai * br;
+        }
+    }
+}
+
+int jcufftChirpMultiply(const void *src, long long srcPitch, const void *factors, long long count, void *dst, long long dstPitch, long long rows, int elementSize, void *stream)
+{
+    if (count > dstPitch)
+    {
+        return STUB_ERROR_INVALID_VALUE;
+    }
+    switch (elementSize)
+    {
+        case 8:
+            chirpMultiply((const float*)src, srcPitch, (const float*)factors, count, (float*)dst, dstPitch, rows);
+            return STUB_SUCCESS;
+        case 16:
+            chirpMultiply((const double*)src, srcPitch, (const double*)factors, count, (double*)dst, dstPitch, rows);
+            return STUB_SUCCESS;
+    }
+    return STUB_ERROR_INVALID_VALUE;
+}
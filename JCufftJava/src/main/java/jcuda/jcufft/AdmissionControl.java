@@ -0,0 +1,289 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+import static jcuda.jcufft.JCufftUtils.checkCufft;
+
+import jcuda.runtime.JCuda;
+
+/**
+ * Methods for deciding whether a batched transform fits into the
+ * device memory that is currently free, and how to split it into
+ * smaller batches if it does not.<br>
+ * <br>
+ * The memory that is required for a batch consists of the work area
+ * of the plan, as computed with {@link PlanGeometry#estimate(long[])},
+ * and optionally of the input and output buffers. The work sizes are
+ * cached in the native library, so repeated decisions for the same
+ * geometries do not call CUFFT again. The free memory is queried with
+ * <code>cudaMemGetInfo</code> for each decision.<br>
+ * <br>
+ * Usage example:
+ * <pre><code>
+ * AdmissionControl.Decision d = AdmissionControl.admit(geometry);
+ * if (!d.isFeasible()) reject();
+ * for (long b = 0; b &lt; geometry.getBatch(); b += d.getSubBatch()) ...
+ * </code></pre>
+ */
+public final class AdmissionControl
+{
+    /**
+     * The result of an admission decision
+     */
+    public static final class Decision
+    {
+        /**
+         * The geometry, with the requested batch size
+         */
+        private final PlanGeometry geometry;
+
+        /**
+         * The largest batch size that fits, or 0
+         */
+        private final long subBatch;
+
+        /**
+         * The number of bytes that are required for the sub-batch
+         */
+        private final long requiredBytes;
+
+        /**
+         * The number of bytes that were available
+         */
+        private final long availableBytes;
+
+        /**
+         * Creates a new decision
+         *
+         * @param geometry The geometry
+         * @param subBatch The sub-batch size
+         * @param requiredBytes The required bytes
+         * @param availableBytes The available bytes
+         */
+        Decision(PlanGeometry geometry, long subBatch,
+            long requiredBytes, long availableBytes)
+        {
+            this.geometry = geometry;
+            this.subBatch = subBatch;
+            this.requiredBytes = requiredBytes;
+            this.availableBytes = availableBytes;
+        }
+
+        /**
+         * Returns the geometry, with the requested batch size
+         *
+         * @return The geometry
+         */
+        public PlanGeometry getGeometry()
+        {
+            return geometry;
+        }
+
+        /**
+         * Returns whether the whole batch fits into the available
+         * memory
+         *
+         * @return Whether the job is admitted without splitting
+         */
+        public boolean isAdmitted()
+        {
+            return subBatch == geometry.getBatch();
+        }
+
+        /**
+         * Returns whether at least a batch size of 1 fits into the
+         * available memory
+         *
+         * @return Whether the job can be executed in parts
+         */
+        public boolean isFeasible()
+        {
+            return subBatch > 0;
+        }
+
+        /**
+         * Returns the largest batch size that fits into the available
+         * memory, which is at most the requested batch size, or 0 if
+         * not even a single transform fits
+         *
+         * @return The sub-batch size
+         */
+        public long getSubBatch()
+        {
+            return subBatch;
+        }
+
+        /**
+         * Returns the number of parts that the batch has to be split
+         * into, or 0 if the job is not feasible
+         *
+         * @return The number of parts
+         */
+        public long getSplitCount()
+        {
+            if (subBatch == 0)
+            {
+                return 0;
+            }
+            return (geometry.getBatch() + subBatch - 1) / subBatch;
+        }
+
+        /**
+         * Returns the number of bytes that are required for the
+         * sub-batch size, or for a batch size of 1 if the job is not
+         * feasible
+         *
+         * @return The required number of bytes
+         */
+        public long getRequiredBytes()
+        {
+            return requiredBytes;
+        }
+
+        /**
+         * Returns the number of bytes that were available for the
+         * decision, which is the free device memory minus the reserve
+         *
+         * @return The available number of bytes
+         */
+        public long getAvailableBytes()
+        {
+            return availableBytes;
+        }
+
+        @Override
+        public String toString()
+        {
+            return "Decision[geometry=" + geometry +
+                ",subBatch=" + subBatch +
+                ",splitCount=" + getSplitCount() +
+                ",requiredBytes=" + requiredBytes +
+                ",availableBytes=" + availableBytes + "]";
+        }
+    }
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private AdmissionControl()
+    {
+    }
+
+    /**
+     * Decides whether the given job, including its input and output
+     * buffers, fits into the currently free device memory
+     *
+     * @param geometry The geometry, with the batch size of the job
+     * @return The decision
+     * @throws jcuda.CudaException If the free memory or a work size can
+     * not be obtained
+     */
+    public static Decision admit(PlanGeometry geometry)
+    {
+        return admit(geometry, 0, true);
+    }
+
+    /**
+     * Decides whether the given job fits into the currently free device
+     * memory, minus the given reserve.
+     *
+     * @param geometry The geometry, with the batch size of the job
+     * @param reserveBytes The number of bytes that should remain free
+     * @param includeBuffers Whether the input and output buffers of the
+     * transform have to be allocated as well. These are assumed to be
+     * separate buffers for out-of-place transforms.
+     * @return The decision
+     * @throws jcuda.CudaException If the free memory or a work size can
+     * not be obtained
+     */
+    public static Decision admit(
+        PlanGeometry geometry, long reserveBytes, boolean includeBuffers)
+    {
+        long free[] = { 0 };
+        long total[] = { 0 };
+        checkCuda(JCuda.cudaMemGetInfo(free, total));
+        long available = Math.max(0, free[0] - reserveBytes);
+        long batch = geometry.getBatch();
+        long required = requiredBytes(geometry, includeBuffers);
+        if (required <= available)
+        {
+            return new Decision(geometry, batch, required, available);
+        }
+        long low = 0;
+        long lowRequired = requiredBytes(
+            geometry.withBatch(1), includeBuffers);
+        if (lowRequired <= available)
+        {
+            low = 1;
+        }
+        long high = batch;
+        while (low > 0 && high - low > 1)
+        {
+            long middle = low + (high - low) / 2;
+            long middleRequired = requiredBytes(
+                geometry.withBatch(middle), includeBuffers);
+            if (middleRequired <= available)
+            {
+                low = middle;
+                lowRequired = middleRequired;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return new Decision(geometry, low, lowRequired, available);
+    }
+
+    /**
+     * Returns the number of bytes that are required for the given
+     * geometry
+     *
+     * @param geometry The geometry
+     * @param includeBuffers Whether the buffers are included
+     * @return The number of bytes
+     */
+    private static long requiredBytes(
+        PlanGeometry geometry, boolean includeBuffers)
+    {
+        long workSize[] = { 0 };
+        checkCufft(geometry.estimate(workSize));
+        long bytes = workSize[0];
+        if (includeBuffers)
+        {
+            long batch = geometry.getBatch();
+            bytes += batch * geometry.getInputDistance() *
+                geometry.getInputElementSize();
+            bytes += batch * geometry.getOutputDistance() *
+                geometry.getOutputElementSize();
+        }
+        return bytes;
+    }
+}
@@ -0,0 +1,764 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+import static jcuda.jcufft.JCufftUtils.checkCufft;
+
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaMemcpyKind;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * A plan for the chirp-z transform, which evaluates the z-transform of
+ * complex sequences at equally spaced frequencies, using Bluestein's
+ * algorithm.<br>
+ * <br>
+ * For an input sequence <code>x</code> of length <code>n</code>, the
+ * output element <code>k</code> is
+ * <pre><code>
+ * X[k] = sum(j=0..n-1) x[j] * exp(-2 * pi * i * j * (f0 + k * df))
+ * </code></pre>
+ * for <code>k = 0..m-1</code>, where <code>f0</code> is the start
+ * frequency and <code>df</code> is the frequency step, both in cycles
+ * per sample. With <code>f0 = 0</code>, <code>df = 1/n</code> and
+ * <code>m = n</code>, this is the DFT of length <code>n</code>, which
+ * may be created with {@link #createDft(int, int, int)}. Other values
+ * evaluate a zoomed spectrum over a frequency sub-band, without
+ * computing a larger DFT and discarding most of it.<br>
+ * <br>
+ * The transform is computed as a convolution with a chirp, using two
+ * batched complex transforms whose length is the next power of two
+ * that is at least <code>n + m - 1</code>. This makes lengths with
+ * large prime factors run at the speed of power-of-two lengths. The
+ * chirps and the spectrum of the convolution kernel are computed in
+ * double precision on the host. They are cached per geometry, so that
+ * plans with the same geometry only have to copy them to the device.
+ * <br>
+ * Usage example for a zoom over the band from 0.1 to 0.15 cycles per
+ * sample, with 1000 output frequencies:
+ * <pre><code>
+ * ChirpZPlan p = ChirpZPlan.create(n, 1000, 0.1, 0.05 / 1000,
+ *     cufftType.CUFFT_C2C, batch);
+ * p.exec(input, output);
+ * p.close();
+ * </code></pre>
+ */
+public class ChirpZPlan implements AutoCloseable
+{
+    /**
+     * The native resources of a ChirpZPlan. This is the cleanup action
+     * that is registered in the {@link ResourceReclaimer}, and thus must
+     * not refer to the ChirpZPlan.
+     */
+    private static final class Resources implements Runnable
+    {
+        /**
+         * The power-of-two plan
+         */
+        final cufftHandle plan = new cufftHandle();
+
+        /**
+         * The buffer for the convolution
+         */
+        final Pointer work = new Pointer();
+
+        /**
+         * The chirp that the input is multiplied with
+         */
+        final Pointer inputChirp = new Pointer();
+
+        /**
+         * The chirp that the output is multiplied with
+         */
+        final Pointer outputChirp = new Pointer();
+
+        /**
+         * The scaled spectrum of the convolution kernel
+         */
+        final Pointer kernelSpectrum = new Pointer();
+
+        /**
+         * The number of bytes of device memory that have been reserved
+         * in the {@link MemoryBudget}
+         */
+        long deviceBytes = 0;
+
+        /**
+         * Releases all resources
+         */
+        @Override
+        public void run()
+        {
+            JCuda.cudaFree(work);
+            JCuda.cudaFree(inputChirp);
+            JCuda.cudaFree(outputChirp);
+            JCuda.cudaFree(kernelSpectrum);
+            plan.close();
+            MemoryBudget.release(
+                MemoryBudget.Category.POOL, deviceBytes, "ChirpZPlan");
+            deviceBytes = 0;
+        }
+    }
+
+    /**
+     * The geometry of a chirp-z transform, which is the key for the
+     * chirp cache
+     */
+    private static final class Geometry
+    {
+        /**
+         * The input length
+         */
+        final int n;
+
+        /**
+         * The output length
+         */
+        final int m;
+
+        /**
+         * The start frequency
+         */
+        final double startFrequency;
+
+        /**
+         * The frequency step
+         */
+        final double frequencyStep;
+
+        /**
+         * Creates a new geometry
+         *
+         * @param n The input length
+         * @param m The output length
+         * @param startFrequency The start frequency
+         * @param frequencyStep The frequency step
+         */
+        Geometry(int n, int m, double startFrequency, double frequencyStep)
+        {
+            this.n = n;
+            this.m = m;
+            this.startFrequency = startFrequency;
+            this.frequencyStep = frequencyStep;
+        }
+
+        @Override
+        public int hashCode()
+        {
+            long f0 = Double.doubleToLongBits(startFrequency);
+            long df = Double.doubleToLongBits(frequencyStep);
+            int result = 31 * n + m;
+            result = 31 * result + (int)(f0 ^ (f0 >>> 32));
+            result = 31 * result + (int)(df ^ (df >>> 32));
+            return result;
+        }
+
+        @Override
+        public boolean equals(Object object)
+        {
+            if (this == object)
+            {
+                return true;
+            }
+            if (!(object instanceof Geometry))
+            {
+                return false;
+            }
+            Geometry other = (Geometry)object;
+            return n == other.n && m == other.m &&
+                Double.doubleToLongBits(startFrequency) ==
+                Double.doubleToLongBits(other.startFrequency) &&
+                Double.doubleToLongBits(frequencyStep) ==
+                Double.doubleToLongBits(other.frequencyStep);
+        }
+    }
+
+    /**
+     * The chirps of one geometry, as interleaved complex values
+     */
+    private static final class Chirps
+    {
+        /**
+         * The chirp that the input is multiplied with
+         */
+        final double input[];
+
+        /**
+         * The chirp that the output is multiplied with
+         */
+        final double output[];
+
+        /**
+         * The spectrum of the convolution kernel, divided by the
+         * transform length
+         */
+        final double kernelSpectrum[];
+
+        /**
+         * Creates new chirps
+         *
+         * @param input The input chirp
+         * @param output The output chirp
+         * @param kernelSpectrum The kernel spectrum
+         */
+        Chirps(double input[], double output[], double kernelSpectrum[])
+        {
+            this.input = input;
+            this.output = output;
+            this.kernelSpectrum = kernelSpectrum;
+        }
+    }
+
+    /**
+     * The maximum number of geometries whose chirps are cached
+     */
+    private static final int MAX_CACHED_CHIRPS = 32;
+
+    /**
+     * The cached chirps, in access order
+     */
+    private static final Map<Geometry, Chirps> chirpCache =
+        new LinkedHashMap<Geometry, Chirps>(16, 0.75f, true)
+    {
+        private static final long serialVersionUID = 1L;
+
+        @Override
+        protected boolean removeEldestEntry(Map.Entry<Geometry, Chirps> e)
+        {
+            return size() > MAX_CACHED_CHIRPS;
+        }
+    };
+
+    /**
+     * The geometry
+     */
+    private final Geometry geometry;
+
+    /**
+     * The cufftType
+     */
+    private final int type;
+
+    /**
+     * The batch size
+     */
+    private final int batch;
+
+    /**
+     * The length of the power-of-two transforms
+     */
+    private final int fftLength;
+
+    /**
+     * The stream, or <code>null</code> for the default stream
+     */
+    private cudaStream_t stream = null;
+
+    /**
+     * Whether this object has been destroyed
+     */
+    private boolean destroyed = false;
+
+    /**
+     * The native resources of this object
+     */
+    private final Resources resources;
+
+    /**
+     * The registration of the resources in the {@link ResourceReclaimer}
+     */
+    private final ResourceReclaimer.Registration registration;
+
+    /**
+     * Creates a plan for the chirp-z transform with the given geometry
+     *
+     * @param n The length of the input sequences
+     * @param m The number of output frequencies
+     * @param startFrequency The first frequency, in cycles per sample
+     * @param frequencyStep The distance between the frequencies, in
+     * cycles per sample
+     * @param type The cufftType, CUFFT_C2C or CUFFT_Z2Z
+     * @param batch The number of transforms
+     * @return The plan
+     * @throws IllegalArgumentException If the arguments are not valid
+     * @throws jcuda.CudaException If the plan or the buffers can not be
+     * created
+     */
+    public static ChirpZPlan create(int n, int m, double startFrequency,
+        double frequencyStep, int type, int batch)
+    {
+        return new ChirpZPlan(new Geometry(
+            n, m, startFrequency, frequencyStep), type, batch);
+    }
+
+    /**
+     * Creates a plan for a forward DFT of the given length, which may
+     * be any length, including large primes
+     *
+     * @param n The length
+     * @param type The cufftType, CUFFT_C2C or CUFFT_Z2Z
+     * @param batch The number of transforms
+     * @return The plan
+     * @throws IllegalArgumentException If the arguments are not valid
+     * @throws jcuda.CudaException If the plan or the buffers can not be
+     * created
+     */
+    public static ChirpZPlan createDft(int n, int type, int batch)
+    {
+        return create(n, n, 0.0, 1.0 / n, type, batch);
+    }
+
+    /**
+     * Creates a new plan
+     *
+     * @param geometry The geometry
+     * @param type The cufftType
+     * @param batch The batch size
+     */
+    private ChirpZPlan(Geometry geometry, int type, int batch)
+    {
+        if (geometry.n < 1 || geometry.m < 1 || batch < 1)
+        {
+            throw new IllegalArgumentException(
+                "The lengths and the batch size must be positive, but are " +
+                geometry.n + ", " + geometry.m + " and " + batch);
+        }
+        if (type != cufftType.CUFFT_C2C && type != cufftType.CUFFT_Z2Z)
+        {
+            throw new IllegalArgumentException(
+                "The type must be CUFFT_C2C or CUFFT_Z2Z, but is " +
+                cufftType.stringFor(type));
+        }
+        if (Double.isNaN(geometry.startFrequency) ||
+            Double.isInfinite(geometry.startFrequency) ||
+            Double.isNaN(geometry.frequencyStep) ||
+            Double.isInfinite(geometry.frequencyStep))
+        {
+            throw new IllegalArgumentException(
+                "The frequencies must be finite");
+        }
+        long length = Long.highestOneBit(
+            Math.max(1L, (long)geometry.n + geometry.m - 2)) << 1;
+        if (length > (1 << 30))
+        {
+            throw new IllegalArgumentException(
+                "The lengths are too large: " + geometry.n +
+                " and " + geometry.m);
+        }
+        this.geometry = geometry;
+        this.type = type;
+        this.batch = batch;
+        this.fftLength = (int)length;
+
+        this.resources = new Resources();
+        this.registration = ResourceReclaimer.register(this, resources);
+        try
+        {
+            Chirps chirps = chirps(geometry, fftLength);
+            int complexSize = 2 * JCufftUtils.elementSize(type);
+            long workBytes = (long)batch * fftLength * complexSize;
+            long chirpBytes = ((long)geometry.n + geometry.m + fftLength) *
+                complexSize;
+            MemoryBudget.reserve(MemoryBudget.Category.POOL,
+                workBytes + chirpBytes, "ChirpZPlan");
+            resources.deviceBytes = workBytes + chirpBytes;
+            checkCufft(JCufft.cufftPlanMany(resources.plan, 1,
+                new int[] { fftLength }, null, 1, fftLength,
+                null, 1, fftLength, type, batch));
+            checkCuda(JCuda.cudaMalloc(resources.work, workBytes));
+            upload(chirps.input, resources.inputChirp);
+            upload(chirps.output, resources.outputChirp);
+            upload(chirps.kernelSpectrum, resources.kernelSpectrum);
+        }
+        catch (RuntimeException e)
+        {
+            destroy();
+            throw e;
+        }
+    }
+
+    /**
+     * Allocates device memory for the given complex values, and copies
+     * them to the device, in the precision of this plan
+     *
+     * @param values The values
+     * @param pointer The pointer for the device memory
+     */
+    private void upload(double values[], Pointer pointer)
+    {
+        Pointer host = Pointer.to(values);
+        long bytes = (long)values.length * JCufftUtils.elementSize(type);
+        if (type == cufftType.CUFFT_C2C)
+        {
+            float floatValues[] = new float[values.length];
+            for (int i = 0; i < values.length; i++)
+            {
+                floatValues[i] = (float)values[i];
+            }
+            host = Pointer.to(floatValues);
+        }
+        checkCuda(JCuda.cudaMalloc(pointer, bytes));
+        checkCuda(JCuda.cudaMemcpy(pointer, host, bytes,
+            cudaMemcpyKind.cudaMemcpyHostToDevice));
+    }
+
+    /**
+     * Returns the chirps for the given geometry, from the cache, or
+     * computes them and puts them into the cache
+     *
+     * @param geometry The geometry
+     * @param length The transform length
+     * @return The chirps
+     */
+    private static Chirps chirps(Geometry geometry, int length)
+    {
+        synchronized (chirpCache)
+        {
+            Chirps chirps = chirpCache.get(geometry);
+            if (chirps != null)
+            {
+                return chirps;
+            }
+        }
+        Chirps chirps = computeChirps(geometry, length);
+        synchronized (chirpCache)
+        {
+            chirpCache.put(geometry, chirps);
+        }
+        return chirps;
+    }
+
+    /**
+     * Computes the chirps for the given geometry. With the frequency
+     * step <code>df</code>, the identity
+     * <code>j*k = (j*j + k*k - (k-j)*(k-j)) / 2</code> turns the
+     * transform into the convolution of the input, multiplied with
+     * <code>exp(-2*pi*i*(j*f0 + j*j*df/2))</code>, and the kernel
+     * <code>exp(pi*i*d*d*df)</code>, followed by the multiplication
+     * with <code>exp(-pi*i*k*k*df)</code>.
+     *
+     * @param geometry The geometry
+     * @param length The transform length
+     * @return The chirps
+     */
+    private static Chirps computeChirps(Geometry geometry, int length)
+    {
+        double f0 = geometry.startFrequency;
+        double halfStep = geometry.frequencyStep / 2;
+        double input[] = new double[2 * geometry.n];
+        for (int j = 0; j < geometry.n; j++)
+        {
+            double cycles = fraction(j * f0) +
+                fraction((double)((long)j * j) * halfStep);
+            setPhase(input, j, -cycles);
+        }
+        double output[] = new double[2 * geometry.m];
+        for (int k = 0; k < geometry.m; k++)
+        {
+            setPhase(output, k, -fraction((double)((long)k * k) * halfStep));
+        }
+        double kernel[] = new double[2 * length];
+        for (int k = 0; k < geometry.m; k++)
+        {
+            setPhase(kernel, k, fraction((double)((long)k * k) * halfStep));
+        }
+        for (int j = 1; j < geometry.n; j++)
+        {
+            setPhase(kernel, length - j,
+                fraction((double)((long)j * j) * halfStep));
+        }
+        fft(kernel, length);
+        for (int i = 0; i < kernel.length; i++)
+        {
+            kernel[i] /= length;
+        }
+        return new Chirps(input, output, kernel);
+    }
+
+    /**
+     * Returns the fractional part of the given value
+     *
+     * @param value The value
+     * @return The fractional part, in [0,1)
+     */
+    private static double fraction(double value)
+    {
+        return value - Math.floor(value);
+    }
+
+    /**
+     * Sets the given complex element to <code>exp(2*pi*i*cycles)</code>
+     *
+     * @param array The array of interleaved complex values
+     * @param index The index of the complex element
+     * @param cycles The phase, in cycles
+     */
+    private static void setPhase(double array[], int index, double cycles)
+    {
+        double angle = 2 * Math.PI * cycles;
+        array[2 * index + 0] = Math.cos(angle);
+        array[2 * index + 1] = Math.sin(angle);
+    }
+
+    /**
+     * Computes the forward DFT of the given interleaved complex values,
+     * in place, with an iterative radix-2 FFT
+     *
+     * @param data The data
+     * @param length The length, which must be a power of two
+     */
+    private static void fft(double data[], int length)
+    {
+        for (int i = 1, j = 0; i < length; i++)
+        {
+            int bit = length >> 1;
+            for (; (j & bit) != 0; bit >>= 1)
+            {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j)
+            {
+                swap(data, 2 * i, 2 * j);
+                swap(data, 2 * i + 1, 2 * j + 1);
+            }
+        }
+        for (int size = 2; size <= length; size <<= 1)
+        {
+            int half = size >> 1;
+            for (int k = 0; k < half; k++)
+            {
+                double angle = -2 * Math.PI * k / size;
+                double wr = Math.cos(angle);
+                double wi = Math.sin(angle);
+                for (int start = 0; start < length; start += size)
+                {
+                    int a = 2 * (start + k);
+                    int b = 2 * (start + k + half);
+                    double tr = data[b] * wr - data[b + 1] * wi;
+                    double ti = data[b] * wi + data[b + 1] * wr;
+                    data[b] = data[a] - tr;
+                    data[b + 1] = data[a + 1] - ti;
+                    data[a] += tr;
+                    data[a + 1] += ti;
+                }
+            }
+        }
+    }
+
+    /**
+     * Swaps the given elements of the given array
+     *
+     * @param data The array
+     * @param i The first index
+     * @param j The second index
+     */
+    private static void swap(double data[], int i, int j)
+    {
+        double t = data[i];
+        data[i] = data[j];
+        data[j] = t;
+    }
+
+    /**
+     * Removes all chirps from the cache. This does not affect existing
+     * plans.
+     */
+    public static void clearChirpCache()
+    {
+        synchronized (chirpCache)
+        {
+            chirpCache.clear();
+        }
+    }
+
+    /**
+     * Set the stream for all transforms and multiplications of this plan
+     *
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @throws jcuda.CudaException If the stream can not be set
+     */
+    public synchronized void setStream(cudaStream_t stream)
+    {
+        checkNotDestroyed();
+        checkCufft(JCufft.cufftSetStream(resources.plan, stream));
+        this.stream = stream;
+    }
+
+    /**
+     * Executes this plan, asynchronously in the stream of this plan.
+     * The input consists of <code>batch</code> sequences of
+     * {@link #getInputLength()} complex values, and the output of
+     * <code>batch</code> sequences of {@link #getOutputLength()} complex
+     * values.
+     *
+     * @param idata The input data, in device memory
+     * @param odata The output data, in device memory
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public synchronized void exec(Pointer idata, Pointer odata)
+    {
+        checkNotDestroyed();
+        int elementSize = JCufftUtils.elementSize(type);
+        Pointer work = resources.work;
+        checkCuda(JCufft.chirpMultiply(idata, geometry.n,
+            resources.inputChirp, geometry.n, work, fftLength,
+            batch, elementSize, stream));
+        checkCufft(JCufftUtils.exec(
+            resources.plan, type, work, work, JCufft.CUFFT_FORWARD));
+        checkCuda(JCufft.chirpMultiply(work, fftLength,
+            resources.kernelSpectrum, fftLength, work, fftLength,
+            batch, elementSize, stream));
+        checkCufft(JCufftUtils.exec(
+            resources.plan, type, work, work, JCufft.CUFFT_INVERSE));
+        checkCuda(JCufft.chirpMultiply(work, fftLength,
+            resources.outputChirp, geometry.m, odata, geometry.m,
+            batch, elementSize, stream));
+    }
+
+    /**
+     * Returns the length of the input sequences
+     *
+     * @return The input length
+     */
+    public int getInputLength()
+    {
+        return geometry.n;
+    }
+
+    /**
+     * Returns the number of output frequencies
+     *
+     * @return The output length
+     */
+    public int getOutputLength()
+    {
+        return geometry.m;
+    }
+
+    /**
+     * Returns the first frequency, in cycles per sample
+     *
+     * @return The start frequency
+     */
+    public double getStartFrequency()
+    {
+        return geometry.startFrequency;
+    }
+
+    /**
+     * Returns the distance between the frequencies, in cycles per sample
+     *
+     * @return The frequency step
+     */
+    public double getFrequencyStep()
+    {
+        return geometry.frequencyStep;
+    }
+
+    /**
+     * Returns the length of the power-of-two transforms that are used
+     * internally
+     *
+     * @return The transform length
+     */
+    public int getFftLength()
+    {
+        return fftLength;
+    }
+
+    /**
+     * Returns the cufftType
+     *
+     * @return The cufftType
+     */
+    public int getType()
+    {
+        return type;
+    }
+
+    /**
+     * Returns the batch size
+     *
+     * @return The batch size
+     */
+    public int getBatch()
+    {
+        return batch;
+    }
+
+    /**
+     * Throws an IllegalStateException if this object has been destroyed
+     */
+    private void checkNotDestroyed()
+    {
+        if (destroyed)
+        {
+            throw new IllegalStateException("The ChirpZPlan was destroyed");
+        }
+    }
+
+    /**
+     * Releases the plan and the buffers of this object
+     */
+    public synchronized void destroy()
+    {
+        if (destroyed)
+        {
+            return;
+        }
+        destroyed = true;
+        registration.clean();
+    }
+
+    /**
+     * Equivalent to {@link #destroy()}
+     */
+    @Override
+    public void close()
+    {
+        destroy();
+    }
+
+    @Override
+    public String toString()
+    {
+        return "ChirpZPlan[type=" + cufftType.stringFor(type) +
+            ",n=" + geometry.n + ",m=" + geometry.m +
+            ",startFrequency=" + geometry.startFrequency +
+            ",frequencyStep=" + geometry.frequencyStep +
+            ",fftLength=" + fftLength + ",batch=" + batch + "]";
+    }
+}
@@ -0,0 +1,483 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentLinkedDeque;
+import java.util.concurrent.ConcurrentMap;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLong;
+
+import jcuda.CudaException;
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * An executor that allows multiple threads to execute transforms with
+ * the same geometry concurrently.<br>
+ * <br>
+ * A single plan may not be executed concurrently from multiple threads.
+ * This class therefore keeps a pool of plan instances for each
+ * {@link PlanGeometry}, where each instance is bound to its own stream.
+ * Instances are handed out as {@link Lease leases}, using a lock-free
+ * free list. When no instance is available, a new one is created, so
+ * that a thread never blocks waiting for another one. Instances that
+ * have been idle for longer than the idle timeout are destroyed, so
+ * that the pool shrinks again when the load decreases.<br>
+ * <br>
+ * Usage example:
+ * <pre><code>
+ * ConcurrentExecutor executor = new ConcurrentExecutor();
+ * PlanGeometry geometry = PlanGeometry.of1d(4096, cufftType.CUFFT_C2C, 1);
+ *
+ * // In any thread:
+ * executor.exec(geometry, deviceInput, deviceOutput, JCufft.CUFFT_FORWARD);
+ *
+ * executor.destroy();
+ * </code></pre>
+ */
+public class ConcurrentExecutor implements AutoCloseable
+{
+    /**
+     * The default time after which idle instances are destroyed,
+     * in milliseconds
+     */
+    private static final long DEFAULT_IDLE_TIMEOUT_MS = 10000;
+
+    /**
+     * A plan instance with its stream, which is handed out to a
+     * single thread at a time
+     */
+    public static final class Lease
+    {
+        /**
+         * The pool that this lease belongs to
+         */
+        private final Pool pool;
+
+        /**
+         * The plan
+         */
+        private final cufftHandle plan = new cufftHandle();
+
+        /**
+         * The stream that the plan is bound to
+         */
+        private final cudaStream_t stream = new cudaStream_t();
+
+        /**
+         * The time when this instance was returned to the pool,
+         * via System#nanoTime
+         */
+        private long releaseTime;
+
+        /**
+         * Creates a new lease for the given pool
+         *
+         * @param pool The pool
+         */
+        Lease(Pool pool)
+        {
+            this.pool = pool;
+        }
+
+        /**
+         * Returns the plan. It may only be executed by the thread that
+         * acquired this lease, and its stream must not be changed.
+         *
+         * @return The plan
+         */
+        public cufftHandle getPlan()
+        {
+            return plan;
+        }
+
+        /**
+         * Returns the stream that the plan is bound to
+         *
+         * @return The stream
+         */
+        public cudaStream_t getStream()
+        {
+            return stream;
+        }
+
+        /**
+         * Returns the geometry of the plan
+         *
+         * @return The geometry
+         */
+        public PlanGeometry getGeometry()
+        {
+            return pool.geometry;
+        }
+    }
+
+    /**
+     * The pool of plan instances for a single geometry
+     */
+    private static final class Pool
+    {
+        /**
+         * The geometry of all instances
+         */
+        final PlanGeometry geometry;
+
+        /**
+         * The free list. Instances are taken from and returned to the
+         * head, so that recently used instances are reused first, and
+         * idle instances accumulate at the tail.
+         */
+        final ConcurrentLinkedDeque<Lease> free =
+            new ConcurrentLinkedDeque<Lease>();
+
+        /**
+         * The total number of instances of this pool
+         */
+        final AtomicInteger size = new AtomicInteger();
+
+        /**
+         * Creates a new pool for the given geometry
+         *
+         * @param geometry The geometry
+         */
+        Pool(PlanGeometry geometry)
+        {
+            this.geometry = geometry;
+        }
+    }
+
+    /**
+     * The pools for all geometries
+     */
+    private final ConcurrentMap<PlanGeometry, Pool> pools =
+        new ConcurrentHashMap<PlanGeometry, Pool>();
+
+    /**
+     * The time after which idle instances are destroyed, in nanoseconds
+     */
+    private final long idleTimeoutNanos;
+
+    /**
+     * The time of the last trim operation, via System#nanoTime
+     */
+    private final AtomicLong lastTrimTime = new AtomicLong(System.nanoTime());
+
+    /**
+     * The number of instances that have been created
+     */
+    private final AtomicLong createdCount = new AtomicLong();
+
+    /**
+     * The number of instances that have been destroyed
+     */
+    private final AtomicLong destroyedCount = new AtomicLong();
+
+    /**
+     * Whether this executor has been destroyed
+     */
+    private volatile boolean destroyed = false;
+
+    /**
+     * Creates a new executor with a default idle timeout of 10 seconds
+     */
+    public ConcurrentExecutor()
+    {
+        this(DEFAULT_IDLE_TIMEOUT_MS);
+    }
+
+    /**
+     * Creates a new executor with the given idle timeout
+     *
+     * @param idleTimeoutMs The time after which idle plan instances
+     * are destroyed, in milliseconds
+     */
+    public ConcurrentExecutor(long idleTimeoutMs)
+    {
+        this.idleTimeoutNanos = idleTimeoutMs * 1000000L;
+    }
+
+    /**
+     * Acquire a plan instance for the given geometry. If no instance
+     * is available, a new one is created. The returned lease must be
+     * given back with {@link #release(Lease)}.
+     *
+     * @param geometry The geometry
+     * @return The lease
+     * @throws CudaException If a new instance could not be created
+     * @throws IllegalStateException If this executor was destroyed
+     */
+    public Lease acquire(PlanGeometry geometry)
+    {
+        if (destroyed)
+        {
+            throw new IllegalStateException("The executor was destroyed");
+        }
+        Pool pool = pools.get(geometry);
+        if (pool == null)
+        {
+            Pool newPool = new Pool(geometry);
+            pool = pools.putIfAbsent(geometry, newPool);
+            if (pool == null)
+            {
+                pool = newPool;
+            }
+        }
+        Lease lease = pool.free.pollFirst();
+        if (lease != null)
+        {
+            return lease;
+        }
+        return create(pool);
+    }
+
+    /**
+     * Give back the given lease, so that its plan instance may be
+     * reused by other threads. This does not wait for pending work
+     * on the stream of the lease. Instances that have been idle
+     * for longer than the idle timeout are destroyed.
+     *
+     * @param lease The lease
+     */
+    public void release(Lease lease)
+    {
+        if (destroyed)
+        {
+            destroy(lease);
+            return;
+        }
+        lease.releaseTime = System.nanoTime();
+        lease.pool.free.offerFirst(lease);
+
+        // The executor may have been destroyed after the check above,
+        // and the pool may already have been drained
+        if (destroyed)
+        {
+            if (lease.pool.free.removeFirstOccurrence(lease))
+            {
+                destroy(lease);
+            }
+            return;
+        }
+        trimIfDue(lease.releaseTime);
+    }
+
+    /**
+     * Executes a transform with the given geometry, on a plan instance
+     * that is not used by any other thread, and waits until the
+     * transform is complete. The transform is ordered after all work
+     * that has been issued to the default stream before.
+     *
+     * @param geometry The geometry
+     * @param idata The input data, in device memory
+     * @param odata The output data, in device memory
+     * @param direction The direction, for complex-to-complex transforms
+     * @return The cufftResult
+     */
+    public int exec(PlanGeometry geometry,
+        Pointer idata, Pointer odata, int direction)
+    {
+        Lease lease = acquire(geometry);
+        try
+        {
+            int result = JCufftUtils.exec(lease.plan,
+                geometry.getType(), idata, odata, direction);
+            if (result == cufftResult.CUFFT_SUCCESS)
+            {
+                checkCuda(JCuda.cudaStreamSynchronize(lease.stream));
+            }
+            return result;
+        }
+        finally
+        {
+            release(lease);
+        }
+    }
+
+    /**
+     * Destroy all instances that have been idle for longer than the
+     * idle timeout. This is done automatically when leases are
+     * released, and usually does not have to be called explicitly.
+     */
+    public void trim()
+    {
+        long now = System.nanoTime();
+        lastTrimTime.set(now);
+        for (Pool pool : pools.values())
+        {
+            while (true)
+            {
+                Lease lease = pool.free.peekLast();
+                if (lease == null ||
+                    now - lease.releaseTime < idleTimeoutNanos)
+                {
+                    break;
+                }
+                if (pool.free.removeLastOccurrence(lease))
+                {
+                    destroy(lease);
+                }
+            }
+        }
+    }
+
+    /**
+     * Calls {@link #trim()} if the last trim was longer ago than
+     * the idle timeout
+     *
+     * @param now The current time, via System#nanoTime
+     */
+    private void trimIfDue(long now)
+    {
+        long last = lastTrimTime.get();
+        if (now - last >= idleTimeoutNanos &&
+            lastTrimTime.compareAndSet(last, now))
+        {
+            trim();
+        }
+    }
+
+    /**
+     * Creates a new plan instance for the given pool
+     *
+     * @param pool The pool
+     * @return The lease for the new instance
+     * @throws CudaException If the instance could not be created
+     */
+    private Lease create(Pool pool)
+    {
+        Lease lease = new Lease(pool);
+
+        // The stream is a blocking stream, so that the transforms are
+        // ordered after pending work in the legacy default stream, for
+        // example the copy or the kernel that produces the input
+        checkCuda(JCuda.cudaStreamCreate(lease.stream));
+        int result = MemoryBudget.createManagedPlan(pool.geometry, lease.plan);
+        if (result == cufftResult.CUFFT_SUCCESS)
+        {
+            result = JCufft.cufftSetStream(lease.plan, lease.stream);
+            if (result != cufftResult.CUFFT_SUCCESS)
+            {
+                JCufft.cufftDestroy(lease.plan);
+            }
+        }
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            JCuda.cudaStreamDestroy(lease.stream);
+            throw new CudaException(cufftResult.stringFor(result));
+        }
+        pool.size.incrementAndGet();
+        createdCount.incrementAndGet();
+        return lease;
+    }
+
+    /**
+     * Destroy the plan and the stream of the given lease
+     *
+     * @param lease The lease
+     */
+    private void destroy(Lease lease)
+    {
+        JCuda.cudaStreamSynchronize(lease.stream);
+        JCufft.cufftDestroy(lease.plan);
+        JCuda.cudaStreamDestroy(lease.stream);
+        lease.pool.size.decrementAndGet();
+        destroyedCount.incrementAndGet();
+    }
+
+    /**
+     * Returns the number of plan instances that currently exist for
+     * the given geometry, including the ones that are leased
+     *
+     * @param geometry The geometry
+     * @return The number of instances
+     */
+    public int getPoolSize(PlanGeometry geometry)
+    {
+        Pool pool = pools.get(geometry);
+        return pool == null ? 0 : pool.size.get();
+    }
+
+    /**
+     * Returns the total number of plan instances that have been created
+     *
+     * @return The number of created instances
+     */
+    public long getCreatedCount()
+    {
+        return createdCount.get();
+    }
+
+    /**
+     * Returns the total number of plan instances that have been destroyed
+     *
+     * @return The number of destroyed instances
+     */
+    public long getDestroyedCount()
+    {
+        return destroyedCount.get();
+    }
+
+    /**
+     * Destroy all plan instances that are not currently leased. Leases
+     * that are released after this call are destroyed immediately.
+     */
+    public void destroy()
+    {
+        destroyed = true;
+        for (Pool pool : pools.values())
+        {
+            Lease lease = null;
+            while ((lease = pool.free.pollFirst()) != null)
+            {
+                destroy(lease);
+            }
+        }
+    }
+
+    /**
+     * Equivalent to {@link #destroy()}
+     */
+    @Override
+    public void close()
+    {
+        destroy();
+    }
+
+    @Override
+    public String toString()
+    {
+        return "ConcurrentExecutor[geometries=" + pools.size() +
+            ",created=" + getCreatedCount() +
+            ",destroyed=" + getDestroyedCount() + "]";
+    }
+}
@@ -0,0 +1,534 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+
+import java.util.HashMap;
+import java.util.Map;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.PriorityBlockingQueue;
+import java.util.concurrent.atomic.AtomicLong;
+
+import jcuda.CudaException;
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * A scheduler for transforms with mixed latency requirements.<br>
+ * <br>
+ * Jobs are submitted with a {@link Priority}. Interactive jobs are
+ * executed on a CUDA stream with the greatest available priority, in
+ * the order of their deadlines. Bulk jobs are executed on a stream
+ * with the least priority, in the order of their submission. Bulk
+ * jobs with a large batch size are split into chunks, and at most one
+ * chunk is pending on the device at any time. The device can thus
+ * start interactive work between two chunks, instead of waiting for
+ * the whole bulk job.<br>
+ * <br>
+ * For each priority, the scheduler records the queueing latency (from
+ * submission until the job is dispatched to the device) and the
+ * execution latency (from dispatch until completion) in
+ * {@link LatencyHistogram} instances.<br>
+ * <br>
+ * The device memory that is passed to the <code>submit</code> methods
+ * must contain the input data when the job is submitted, and must
+ * remain valid until the returned future is completed. The future is
+ * completed with the cufftResult of the job.
+ */
+public class FftScheduler implements AutoCloseable
+{
+    /**
+     * The priority classes of jobs
+     */
+    public enum Priority
+    {
+        /**
+         * Small, latency-sensitive jobs
+         */
+        INTERACTIVE,
+
+        /**
+         * Large, throughput-oriented jobs, which may be split into chunks
+         */
+        BULK
+    }
+
+    /**
+     * The default maximum number of elements of a single bulk chunk
+     */
+    private static final long DEFAULT_MAX_CHUNK_ELEMENTS = 1L << 22;
+
+    /**
+     * A job that was submitted to the scheduler
+     */
+    private static final class Job implements Comparable<Job>
+    {
+        /**
+         * The geometry of the transform
+         */
+        final PlanGeometry geometry;
+
+        /**
+         * The input and output data, in device memory
+         */
+        final Pointer idata;
+        final Pointer odata;
+
+        /**
+         * The direction, for complex-to-complex transforms
+         */
+        final int direction;
+
+        /**
+         * The absolute deadline, via System#nanoTime
+         */
+        final long deadline;
+
+        /**
+         * The sequence number, establishing the order of submission
+         */
+        final long sequence;
+
+        /**
+         * The time of the submission, via System#nanoTime
+         */
+        final long submitTime;
+
+        /**
+         * The future that receives the cufftResult
+         */
+        final CompletableFuture<Integer> future =
+            new CompletableFuture<Integer>();
+
+        Job(PlanGeometry geometry, Pointer idata, Pointer odata,
+            int direction, long deadline, long sequence)
+        {
+            this.geometry = geometry;
+            this.idata = idata;
+            this.odata = odata;
+            this.direction = direction;
+            this.deadline = deadline;
+            this.sequence = sequence;
+            this.submitTime = System.nanoTime();
+        }
+
+        @Override
+        public int compareTo(Job other)
+        {
+            if (deadline != other.deadline)
+            {
+                return deadline - other.deadline < 0 ? -1 : 1;
+            }
+            return Long.compare(sequence, other.sequence);
+        }
+    }
+
+    /**
+     * A thread that dispatches the jobs of one priority class to its
+     * own stream, with its own plans
+     */
+    private final class Dispatcher extends Thread
+    {
+        /**
+         * The priority of the jobs of this dispatcher
+         */
+        final Priority priority;
+
+        /**
+         * The queue of jobs that are waiting to be dispatched
+         */
+        final BlockingQueue<Job> queue;
+
+        /**
+         * The stream that all plans of this dispatcher are bound to
+         */
+        final cudaStream_t stream = new cudaStream_t();
+
+        /**
+         * The device of the stream, on which the plans are created
+         */
+        final int device;
+
+        /**
+         * The plans of this dispatcher, which are only accessed by
+         * the dispatcher thread
+         */
+        final Map<PlanGeometry, cufftHandle> plans =
+            new HashMap<PlanGeometry, cufftHandle>();
+
+        /**
+         * The latencies from submission to dispatch
+         */
+        final LatencyHistogram queueLatencies = new LatencyHistogram();
+
+        /**
+         * The latencies from dispatch to completion
+         */
+        final LatencyHistogram executionLatencies = new LatencyHistogram();
+
+        Dispatcher(Priority priority, BlockingQueue<Job> queue,
+            int streamPriority)
+        {
+            super("JCufft-FftScheduler-" + priority);
+            setDaemon(true);
+            this.priority = priority;
+            this.queue = queue;
+            int currentDevice[] = { 0 };
+            JCuda.cudaGetDevice(currentDevice);
+            this.device = currentDevice[0];
+            checkCuda(JCuda.cudaStreamCreateWithPriority(
+                stream, JCuda.cudaStreamNonBlocking, streamPriority));
+        }
+
+        @Override
+        public void run()
+        {
+            // The plans have to be created on the device of the stream
+            JCuda.cudaSetDevice(device);
+            while (!shutdown)
+            {
+                Job job = null;
+                try
+                {
+                    job = queue.take();
+                }
+                catch (InterruptedException e)
+                {
+                    break;
+                }
+                long dispatchTime = System.nanoTime();
+                queueLatencies.record(dispatchTime - job.submitTime);
+                try
+                {
+                    int result = execute(job);
+                    executionLatencies.record(System.nanoTime() - dispatchTime);
+                    job.future.complete(result);
+                }
+                catch (RuntimeException e)
+                {
+                    job.future.completeExceptionally(e);
+                }
+            }
+            for (Job job : queue)
+            {
+                job.future.completeExceptionally(
+                    new IllegalStateException("The scheduler was shut down"));
+            }
+            for (cufftHandle plan : plans.values())
+            {
+                JCufft.cufftDestroy(plan);
+            }
+            JCuda.cudaStreamDestroy(stream);
+        }
+
+        /**
+         * Execute the given job, splitting it into chunks if it is a
+         * bulk job with a large batch size, and wait for its completion
+         *
+         * @param job The job
+         * @return The cufftResult
+         */
+        private int execute(Job job)
+        {
+            PlanGeometry geometry = job.geometry;
+            long batch = geometry.getBatch();
+            long chunkBatch = batch;
+            if (priority == Priority.BULK)
+            {
+                long elements = Math.max(1, geometry.getElementCount());
+                chunkBatch = Math.max(1, Math.min(batch,
+                    maxChunkElements / elements));
+            }
+            long inputChunkBytes = chunkBatch *
+                geometry.getInputDistance() * geometry.getInputElementSize();
+            long outputChunkBytes = chunkBatch *
+                geometry.getOutputDistance() * geometry.getOutputElementSize();
+
+            for (long done = 0; done < batch; done += chunkBatch)
+            {
+                long n = Math.min(chunkBatch, batch - done);
+                long chunk = done / chunkBatch;
+                cufftHandle plan = planFor(geometry.withBatch(n));
+                int result = JCufftUtils.exec(plan, geometry.getType(),
+                    job.idata.withByteOffset(chunk * inputChunkBytes),
+                    job.odata.withByteOffset(chunk * outputChunkBytes),
+                    job.direction);
+                if (result != cufftResult.CUFFT_SUCCESS)
+                {
+                    return result;
+                }
+                checkCuda(JCuda.cudaStreamSynchronize(stream));
+                if (n < batch)
+                {
+                    chunkCount.incrementAndGet();
+                }
+            }
+            return cufftResult.CUFFT_SUCCESS;
+        }
+
+        /**
+         * Returns the plan for the given geometry, creating it if
+         * necessary
+         *
+         * @param geometry The geometry
+         * @return The plan
+         * @throws CudaException If the plan can not be created
+         */
+        private cufftHandle planFor(PlanGeometry geometry)
+        {
+            cufftHandle plan = plans.get(geometry);
+            if (plan != null)
+            {
+                return plan;
+            }
+            plan = new cufftHandle();
+            JCufftUtils.checkCufft(
+                MemoryBudget.createManagedPlan(geometry, plan));
+            int result = JCufft.cufftSetStream(plan, stream);
+            if (result != cufftResult.CUFFT_SUCCESS)
+            {
+                JCufft.cufftDestroy(plan);
+                throw new CudaException(cufftResult.stringFor(result));
+            }
+            plans.put(geometry, plan);
+            return plan;
+        }
+    }
+
+    /**
+     * The dispatcher for interactive jobs
+     */
+    private final Dispatcher interactive;
+
+    /**
+     * The dispatcher for bulk jobs
+     */
+    private final Dispatcher bulk;
+
+    /**
+     * The maximum number of elements of a single bulk chunk
+     */
+    private final long maxChunkElements;
+
+    /**
+     * The sequence number for submitted jobs
+     */
+    private final AtomicLong sequence = new AtomicLong();
+
+    /**
+     * The number of bulk chunks that have been executed
+     */
+    private final AtomicLong chunkCount = new AtomicLong();
+
+    /**
+     * Whether this scheduler has been shut down
+     */
+    private volatile boolean shutdown = false;
+
+    /**
+     * Creates a new scheduler with a default chunk size of 4M elements
+     */
+    public FftScheduler()
+    {
+        this(DEFAULT_MAX_CHUNK_ELEMENTS);
+    }
+
+    /**
+     * Creates a new scheduler
+     *
+     * @param maxChunkElements The maximum number of elements that a
+     * single chunk of a bulk job should contain. A chunk always
+     * contains at least one transform of the batch.
+     * @throws CudaException If the streams can not be created
+     */
+    public FftScheduler(long maxChunkElements)
+    {
+        this.maxChunkElements = Math.max(1, maxChunkElements);
+        int leastPriority[] = { 0 };
+        int greatestPriority[] = { 0 };
+        checkCuda(JCuda.cudaDeviceGetStreamPriorityRange(
+            leastPriority, greatestPriority));
+        interactive = new Dispatcher(Priority.INTERACTIVE,
+            new PriorityBlockingQueue<Job>(), greatestPriority[0]);
+        bulk = new Dispatcher(Priority.BULK,
+            new LinkedBlockingQueue<Job>(), leastPriority[0]);
+        interactive.start();
+        bulk.start();
+    }
+
+    /**
+     * Submit a job with the given priority. Interactive jobs that are
+     * submitted with this method are executed after all interactive
+     * jobs that have a deadline.
+     *
+     * @param geometry The geometry of the transform
+     * @param idata The input data, in device memory
+     * @param odata The output data, in device memory
+     * @param direction The direction, for complex-to-complex transforms
+     * @param priority The priority
+     * @return The future that will be completed with the cufftResult
+     */
+    public CompletableFuture<Integer> submit(PlanGeometry geometry,
+        Pointer idata, Pointer odata, int direction, Priority priority)
+    {
+        return submit(geometry, idata, odata, direction,
+            priority, Long.MAX_VALUE);
+    }
+
+    /**
+     * Submit an interactive job with the given deadline. Interactive
+     * jobs are executed in the order of their deadlines.
+     *
+     * @param geometry The geometry of the transform
+     * @param idata The input data, in device memory
+     * @param odata The output data, in device memory
+     * @param direction The direction, for complex-to-complex transforms
+     * @param deadlineNanos The deadline, relative to the time of the
+     * submission, in nanoseconds
+     * @return The future that will be completed with the cufftResult
+     */
+    public CompletableFuture<Integer> submit(PlanGeometry geometry,
+        Pointer idata, Pointer odata, int direction, long deadlineNanos)
+    {
+        return submit(geometry, idata, odata, direction,
+            Priority.INTERACTIVE, System.nanoTime() + deadlineNanos);
+    }
+
+    /**
+     * Submit the given job
+     *
+     * @param geometry The geometry of the transform
+     * @param idata The input data, in device memory
+     * @param odata The output data, in device memory
+     * @param direction The direction, for complex-to-complex transforms
+     * @param priority The priority
+     * @param deadline The absolute deadline, via System#nanoTime
+     * @return The future that will be completed with the cufftResult
+     */
+    private CompletableFuture<Integer> submit(PlanGeometry geometry,
+        Pointer idata, Pointer odata, int direction,
+        Priority priority, long deadline)
+    {
+        if (geometry == null || idata == null || odata == null)
+        {
+            throw new NullPointerException(
+                "The geometry and the data may not be null");
+        }
+        if (shutdown)
+        {
+            throw new IllegalStateException("The scheduler was shut down");
+        }
+        Job job = new Job(geometry, idata, odata, direction,
+            deadline, sequence.getAndIncrement());
+        dispatcherFor(priority).queue.add(job);
+        return job.future;
+    }
+
+    /**
+     * Returns the dispatcher for the given priority
+     *
+     * @param priority The priority
+     * @return The dispatcher
+     */
+    private Dispatcher dispatcherFor(Priority priority)
+    {
+        return priority == Priority.INTERACTIVE ? interactive : bulk;
+    }
+
+    /**
+     * Returns the number of jobs of the given priority that are
+     * waiting to be dispatched
+     *
+     * @param priority The priority
+     * @return The number of queued jobs
+     */
+    public int getQueuedJobCount(Priority priority)
+    {
+        return dispatcherFor(priority).queue.size();
+    }
+
+    /**
+     * Returns the histogram of the times that the jobs of the given
+     * priority spent in the queue before being dispatched
+     *
+     * @param priority The priority
+     * @return The queueing latency histogram
+     */
+    public LatencyHistogram getQueueLatencyHistogram(Priority priority)
+    {
+        return dispatcherFor(priority).queueLatencies;
+    }
+
+    /**
+     * Returns the histogram of the times from the dispatch of the jobs
+     * of the given priority until their completion on the device
+     *
+     * @param priority The priority
+     * @return The execution latency histogram
+     */
+    public LatencyHistogram getExecutionLatencyHistogram(Priority priority)
+    {
+        return dispatcherFor(priority).executionLatencies;
+    }
+
+    /**
+     * Returns the number of chunks that bulk jobs have been split into
+     *
+     * @return The number of chunks
+     */
+    public long getChunkCount()
+    {
+        return chunkCount.get();
+    }
+
+    /**
+     * Shut down this scheduler. Jobs that are currently executing are
+     * completed. Jobs that are still queued are completed exceptionally.
+     * The plans and streams of the scheduler are destroyed.
+     */
+    public void shutdown()
+    {
+        shutdown = true;
+        interactive.interrupt();
+        bulk.interrupt();
+    }
+
+    /**
+     * Equivalent to {@link #shutdown()}
+     */
+    @Override
+    public void close()
+    {
+        shutdown();
+    }
+}
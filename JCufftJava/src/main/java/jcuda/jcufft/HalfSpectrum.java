@@ -0,0 +1,269 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+/**
+ * A read-only view on the half spectra of real-to-complex transforms,
+ * that offers access to the values of the full, conjugate-symmetric
+ * spectra without expanding them.<br>
+ * <br>
+ * The values are addressed with the index of the complex value in the
+ * full spectra, in row-major order, with the batches one after another.
+ * The values that are not stored in the half spectra are computed from
+ * the conjugate symmetry on each access.<br>
+ * <br>
+ * The view does not copy the half spectra: Changes of the underlying
+ * array are visible in the view.
+ */
+public final class HalfSpectrum
+{
+    /**
+     * The half spectra, if they are single precision
+     */
+    private final float floatData[];
+
+    /**
+     * The half spectra, if they are double precision
+     */
+    private final double doubleData[];
+
+    /**
+     * The logical sizes, padded to three dimensions
+     */
+    private final long n0;
+    private final long n1;
+    private final long n2;
+
+    /**
+     * The length of the last dimension of the half spectra
+     */
+    private final long h;
+
+    /**
+     * The number of spectra
+     */
+    private final int batch;
+
+    /**
+     * Creates a new view
+     *
+     * @param floatData The float data
+     * @param doubleData The double data
+     * @param n The logical sizes
+     * @param batch The number of spectra
+     */
+    private HalfSpectrum(float floatData[], double doubleData[],
+        int n[], int batch)
+    {
+        long sizes[] = HermitianSpectra.sizes(n);
+        this.floatData = floatData;
+        this.doubleData = doubleData;
+        this.n0 = sizes[0];
+        this.n1 = sizes[1];
+        this.n2 = sizes[2];
+        this.h = n2 / 2 + 1;
+        this.batch = batch;
+        long required = 2 * batch * HermitianSpectra.getHalfLength(n);
+        long length = floatData != null ? floatData.length : doubleData.length;
+        if (length < required)
+        {
+            throw new IllegalArgumentException(
+                "The half spectra must have at least " + required +
+                " elements, but have " + length);
+        }
+    }
+
+    /**
+     * Creates a view on the given single precision half spectra, as
+     * computed with <code>cufftExecR2C</code>
+     *
+     * @param half The half spectra
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The number of spectra
+     * @return The view
+     * @throws IllegalArgumentException If the array is too small
+     */
+    public static HalfSpectrum of(float half[], int n[], int batch)
+    {
+        return new HalfSpectrum(half, null, n, batch);
+    }
+
+    /**
+     * Creates a view on the given double precision half spectra, as
+     * computed with <code>cufftExecD2Z</code>
+     *
+     * @param half The half spectra
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The number of spectra
+     * @return The view
+     * @throws IllegalArgumentException If the array is too small
+     */
+    public static HalfSpectrum of(double half[], int n[], int batch)
+    {
+        return new HalfSpectrum(null, half, n, batch);
+    }
+
+    /**
+     * Returns the number of complex values of the full spectra
+     *
+     * @return The length
+     */
+    public long getFullLength()
+    {
+        return batch * n0 * n1 * n2;
+    }
+
+    /**
+     * Returns the real part of the value with the given index in the
+     * full spectra
+     *
+     * @param index The index
+     * @return The real part
+     * @throws IndexOutOfBoundsException If the index is not valid
+     */
+    public double getReal(long index)
+    {
+        long halfIndex = halfIndex(index);
+        return value(halfIndex < 0 ? -halfIndex - 1 : halfIndex, 0);
+    }
+
+    /**
+     * Returns the imaginary part of the value with the given index in
+     * the full spectra
+     *
+     * @param index The index
+     * @return The imaginary part
+     * @throws IndexOutOfBoundsException If the index is not valid
+     */
+    public double getImag(long index)
+    {
+        long halfIndex = halfIndex(index);
+        if (halfIndex < 0)
+        {
+            return -value(-halfIndex - 1, 1);
+        }
+        return value(halfIndex, 1);
+    }
+
+    /**
+     * Writes the full spectra into the given array
+     *
+     * @param full The full spectra
+     * @throws IllegalArgumentException If the array is too small, or
+     * the precision does not match
+     */
+    public void expandTo(float full[])
+    {
+        if (floatData == null)
+        {
+            throw new IllegalArgumentException(
+                "The half spectra are double precision");
+        }
+        HermitianSpectra.expand(floatData, full, sizes(), batch);
+    }
+
+    /**
+     * Writes the full spectra into the given array
+     *
+     * @param full The full spectra
+     * @throws IllegalArgumentException If the array is too small, or
+     * the precision does not match
+     */
+    public void expandTo(double full[])
+    {
+        if (doubleData == null)
+        {
+            throw new IllegalArgumentException(
+                "The half spectra are single precision");
+        }
+        HermitianSpectra.expand(doubleData, full, sizes(), batch);
+    }
+
+    /**
+     * Returns the complex index in the half spectra that stores the
+     * value for the given index of the full spectra. If the value is
+     * the conjugate of the stored value, then <code>-(i+1)</code> is
+     * returned, where <code>i</code> is the index of the stored value.
+     *
+     * @param index The index in the full spectra
+     * @return The index in the half spectra
+     */
+    private long halfIndex(long index)
+    {
+        if (index < 0 || index >= getFullLength())
+        {
+            throw new IndexOutOfBoundsException(
+                "Index " + index + " for length " + getFullLength());
+        }
+        long fullSize = n0 * n1 * n2;
+        long b = index / fullSize;
+        long r = index - b * fullSize;
+        long k2 = r % n2;
+        long k1 = (r / n2) % n1;
+        long k0 = r / (n1 * n2);
+        long base = b * n0 * n1 * h;
+        if (k2 < h)
+        {
+            return base + (k0 * n1 + k1) * h + k2;
+        }
+        long m0 = (n0 - k0) % n0;
+        long m1 = (n1 - k1) % n1;
+        return -(base + (m0 * n1 + m1) * h + (n2 - k2)) - 1;
+    }
+
+    /**
+     * Returns the real or imaginary part of the given stored value
+     *
+     * @param halfIndex The complex index in the half spectra
+     * @param part 0 for the real part, 1 for the imaginary part
+     * @return The value
+     */
+    private double value(long halfIndex, int part)
+    {
+        int i = (int)(2 * halfIndex + part);
+        return floatData != null ? floatData[i] : doubleData[i];
+    }
+
+    /**
+     * Returns the logical sizes, padded to three dimensions
+     *
+     * @return The sizes
+     */
+    private int[] sizes()
+    {
+        return new int[] { (int)n0, (int)n1, (int)n2 };
+    }
+
+    @Override
+    public String toString()
+    {
+        return "HalfSpectrum[n=" + n0 + "x" + n1 + "x" + n2 +
+            ",batch=" + batch + "]";
+    }
+}
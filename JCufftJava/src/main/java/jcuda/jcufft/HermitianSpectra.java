@@ -0,0 +1,445 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+import static jcuda.jcufft.JCufftUtils.checkCufft;
+
+import jcuda.Pointer;
+import jcuda.Sizeof;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaMemcpyKind;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * Methods for converting between the half spectra of real transforms
+ * and full, conjugate-symmetric spectra.<br>
+ * <br>
+ * A real-to-complex transform of real data with the logical sizes
+ * <code>n</code> only stores the <code>n[rank-1]/2+1</code> non-redundant
+ * values in the last dimension. The remaining values follow from the
+ * conjugate symmetry: The value at <code>(k0, ..., kl)</code> is the
+ * conjugate of the value at <code>((n0-k0)%n0, ..., (nl-kl)%nl)</code>.
+ * This class offers methods to {@link #expand(float[], float[], int[], int)
+ * expand} half spectra into full spectra, and to
+ * {@link #compress(float[], float[], int[], int) compress} full spectra
+ * into half spectra, on the host and on the device, as well as exec
+ * methods that directly produce or consume full spectra.<br>
+ * <br>
+ * Consumers that only read individual values of the spectrum may avoid
+ * the expansion, by accessing the half spectrum through a
+ * {@link HalfSpectrum}.<br>
+ * <br>
+ * All spectra are stored as interleaved complex values, and batches of
+ * spectra are stored one after another.
+ */
+public final class HermitianSpectra
+{
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private HermitianSpectra()
+    {
+    }
+
+    /**
+     * Returns the number of complex values of one half spectrum for the
+     * given logical sizes
+     *
+     * @param n The logical sizes
+     * @return The length of the half spectrum
+     */
+    public static long getHalfLength(int n[])
+    {
+        long sizes[] = sizes(n);
+        return sizes[0] * sizes[1] * (sizes[2] / 2 + 1);
+    }
+
+    /**
+     * Returns the number of complex values of one full spectrum for the
+     * given logical sizes
+     *
+     * @param n The logical sizes
+     * @return The length of the full spectrum
+     */
+    public static long getFullLength(int n[])
+    {
+        long sizes[] = sizes(n);
+        return sizes[0] * sizes[1] * sizes[2];
+    }
+
+    /**
+     * Expands the given half spectra into full spectra, on the host
+     *
+     * @param half The half spectra
+     * @param full The full spectra
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The number of spectra
+     * @throws IllegalArgumentException If the arrays are too small
+     */
+    public static void expand(float half[], float full[], int n[], int batch)
+    {
+        long sizes[] = sizes(n);
+        checkLength(half.length, 2 * batch * getHalfLength(n), "half");
+        checkLength(full.length, 2 * batch * getFullLength(n), "full");
+        JCufft.hermitianExpand(half, full, Sizeof.FLOAT,
+            batch, sizes[0], sizes[1], sizes[2]);
+    }
+
+    /**
+     * Expands the given half spectra into full spectra, on the host
+     *
+     * @param half The half spectra
+     * @param full The full spectra
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The number of spectra
+     * @throws IllegalArgumentException If the arrays are too small
+     */
+    public static void expand(double half[], double full[], int n[], int batch)
+    {
+        long sizes[] = sizes(n);
+        checkLength(half.length, 2 * batch * getHalfLength(n), "half");
+        checkLength(full.length, 2 * batch * getFullLength(n), "full");
+        JCufft.hermitianExpand(half, full, Sizeof.DOUBLE,
+            batch, sizes[0], sizes[1], sizes[2]);
+    }
+
+    /**
+     * Compresses the given full spectra into half spectra, on the host.
+     * The full spectra are assumed to be conjugate-symmetric. Only the
+     * non-redundant values are copied.
+     *
+     * @param full The full spectra
+     * @param half The half spectra
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The number of spectra
+     * @throws IllegalArgumentException If the arrays are too small
+     */
+    public static void compress(float full[], float half[], int n[], int batch)
+    {
+        checkLength(full.length, 2 * batch * getFullLength(n), "full");
+        checkLength(half.length, 2 * batch * getHalfLength(n), "half");
+        compressRows(full, half, sizes(n), batch);
+    }
+
+    /**
+     * Compresses the given full spectra into half spectra, on the host.
+     * The full spectra are assumed to be conjugate-symmetric. Only the
+     * non-redundant values are copied.
+     *
+     * @param full The full spectra
+     * @param half The half spectra
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The number of spectra
+     * @throws IllegalArgumentException If the arrays are too small
+     */
+    public static void compress(double full[], double half[], int n[], int batch)
+    {
+        checkLength(full.length, 2 * batch * getFullLength(n), "full");
+        checkLength(half.length, 2 * batch * getHalfLength(n), "half");
+        compressRows(full, half, sizes(n), batch);
+    }
+
+    /**
+     * Copies the first <code>n2/2+1</code> complex values of each row of
+     * the given full spectra into the half spectra
+     *
+     * @param full The full spectra
+     * @param half The half spectra
+     * @param sizes The logical sizes, padded to three dimensions
+     * @param batch The number of spectra
+     */
+    private static void compressRows(
+        Object full, Object half, long sizes[], int batch)
+    {
+        int n2 = (int)sizes[2];
+        int h = n2 / 2 + 1;
+        long rows = batch * sizes[0] * sizes[1];
+        for (long r = 0; r < rows; r++)
+        {
+            System.arraycopy(full, (int)(2 * r * n2),
+                half, (int)(2 * r * h), 2 * h);
+        }
+    }
+
+    /**
+     * Expands the given half spectra into full spectra, on the device,
+     * asynchronously in the given stream
+     *
+     * @param half The half spectra, in device memory
+     * @param full The full spectra, in device memory
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The number of spectra
+     * @param type The cufftType of the real-to-complex transform, which
+     * determines the precision
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @throws jcuda.CudaException If the expansion fails
+     */
+    public static void expand(Pointer half, Pointer full, int n[],
+        int batch, int type, cudaStream_t stream)
+    {
+        long sizes[] = sizes(n);
+        checkCuda(JCufft.hermitianExpand(half, full,
+            JCufftUtils.elementSize(type),
+            batch, sizes[0], sizes[1], sizes[2], stream));
+    }
+
+    /**
+     * Compresses the given full spectra into half spectra, on the device,
+     * asynchronously in the given stream
+     *
+     * @param full The full spectra, in device memory
+     * @param half The half spectra, in device memory
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The number of spectra
+     * @param type The cufftType of the complex-to-real transform, which
+     * determines the precision
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @throws jcuda.CudaException If the compression fails
+     */
+    public static void compress(Pointer full, Pointer half, int n[],
+        int batch, int type, cudaStream_t stream)
+    {
+        long sizes[] = sizes(n);
+        long complexSize = 2L * JCufftUtils.elementSize(type);
+        long h = sizes[2] / 2 + 1;
+        checkCuda(JCuda.cudaMemcpy2DAsync(
+            half, h * complexSize, full, sizes[2] * complexSize,
+            h * complexSize, batch * sizes[0] * sizes[1],
+            cudaMemcpyKind.cudaMemcpyDeviceToDevice, stream));
+    }
+
+    /**
+     * Executes the given real-to-complex plan, and stores the full
+     * spectra in the given output array. The expansion is done on the
+     * device, before the spectra are copied to the host.
+     *
+     * @param plan The plan, with the given logical sizes and batch size
+     * @param rIdata The real input
+     * @param fullOdata The full spectra
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The batch size
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public static void execR2C(cufftHandle plan,
+        float rIdata[], float fullOdata[], int n[], int batch)
+    {
+        execToFull(plan, cufftType.CUFFT_R2C,
+            Pointer.to(rIdata), Pointer.to(fullOdata), n, batch);
+    }
+
+    /**
+     * Executes the given real-to-complex plan, and stores the full
+     * spectra in the given output array. The expansion is done on the
+     * device, before the spectra are copied to the host.
+     *
+     * @param plan The plan, with the given logical sizes and batch size
+     * @param rIdata The real input
+     * @param fullOdata The full spectra
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The batch size
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public static void execD2Z(cufftHandle plan,
+        double rIdata[], double fullOdata[], int n[], int batch)
+    {
+        execToFull(plan, cufftType.CUFFT_D2Z,
+            Pointer.to(rIdata), Pointer.to(fullOdata), n, batch);
+    }
+
+    /**
+     * Executes the given complex-to-real plan with the given full
+     * spectra as the input. The spectra are compressed on the device,
+     * after they have been copied to the device.
+     *
+     * @param plan The plan, with the given logical sizes and batch size
+     * @param fullIdata The full spectra
+     * @param rOdata The real output
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The batch size
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public static void execC2R(cufftHandle plan,
+        float fullIdata[], float rOdata[], int n[], int batch)
+    {
+        execFromFull(plan, cufftType.CUFFT_C2R,
+            Pointer.to(fullIdata), Pointer.to(rOdata), n, batch);
+    }
+
+    /**
+     * Executes the given complex-to-real plan with the given full
+     * spectra as the input. The spectra are compressed on the device,
+     * after they have been copied to the device.
+     *
+     * @param plan The plan, with the given logical sizes and batch size
+     * @param fullIdata The full spectra
+     * @param rOdata The real output
+     * @param n The logical sizes, with 1, 2 or 3 elements
+     * @param batch The batch size
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public static void execZ2D(cufftHandle plan,
+        double fullIdata[], double rOdata[], int n[], int batch)
+    {
+        execFromFull(plan, cufftType.CUFFT_Z2D,
+            Pointer.to(fullIdata), Pointer.to(rOdata), n, batch);
+    }
+
+    /**
+     * Implementation of the real-to-complex exec methods
+     *
+     * @param plan The plan
+     * @param type The cufftType
+     * @param hostInput The real input
+     * @param hostOutput The full spectra
+     * @param n The logical sizes
+     * @param batch The batch size
+     */
+    private static void execToFull(cufftHandle plan, int type,
+        Pointer hostInput, Pointer hostOutput, int n[], int batch)
+    {
+        int elementSize = JCufftUtils.elementSize(type);
+        long realBytes = batch * getFullLength(n) * elementSize;
+        long halfBytes = batch * getHalfLength(n) * 2 * elementSize;
+        long fullBytes = batch * getFullLength(n) * 2 * elementSize;
+        Pointer input = new Pointer();
+        Pointer half = new Pointer();
+        Pointer full = new Pointer();
+        try
+        {
+            checkCuda(JCuda.cudaMalloc(input, realBytes));
+            checkCuda(JCuda.cudaMalloc(half, halfBytes));
+            checkCuda(JCuda.cudaMalloc(full, fullBytes));
+            checkCuda(JCuda.cudaMemcpy(input, hostInput, realBytes,
+                cudaMemcpyKind.cudaMemcpyHostToDevice));
+            checkCufft(JCufftUtils.exec(
+                plan, type, input, half, JCufft.CUFFT_FORWARD));
+            expand(half, full, n, batch, type, null);
+            checkCuda(JCuda.cudaMemcpy(hostOutput, full, fullBytes,
+                cudaMemcpyKind.cudaMemcpyDeviceToHost));
+        }
+        finally
+        {
+            JCuda.cudaFree(input);
+            JCuda.cudaFree(half);
+            JCuda.cudaFree(full);
+        }
+    }
+
+    /**
+     * Implementation of the complex-to-real exec methods
+     *
+     * @param plan The plan
+     * @param type The cufftType
+     * @param hostInput The full spectra
+     * @param hostOutput The real output
+     * @param n The logical sizes
+     * @param batch The batch size
+     */
+    private static void execFromFull(cufftHandle plan, int type,
+        Pointer hostInput, Pointer hostOutput, int n[], int batch)
+    {
+        int elementSize = JCufftUtils.elementSize(type);
+        long realBytes = batch * getFullLength(n) * elementSize;
+        long halfBytes = batch * getHalfLength(n) * 2 * elementSize;
+        long fullBytes = batch * getFullLength(n) * 2 * elementSize;
+        Pointer full = new Pointer();
+        Pointer half = new Pointer();
+        Pointer output = new Pointer();
+        try
+        {
+            checkCuda(JCuda.cudaMalloc(full, fullBytes));
+            checkCuda(JCuda.cudaMalloc(half, halfBytes));
+            checkCuda(JCuda.cudaMalloc(output, realBytes));
+            checkCuda(JCuda.cudaMemcpy(full, hostInput, fullBytes,
+                cudaMemcpyKind.cudaMemcpyHostToDevice));
+            compress(full, half, n, batch, type, null);
+            checkCufft(JCufftUtils.exec(
+                plan, type, half, output, JCufft.CUFFT_INVERSE));
+            checkCuda(JCuda.cudaMemcpy(hostOutput, output, realBytes,
+                cudaMemcpyKind.cudaMemcpyDeviceToHost));
+        }
+        finally
+        {
+            JCuda.cudaFree(full);
+            JCuda.cudaFree(half);
+            JCuda.cudaFree(output);
+        }
+    }
+
+    /**
+     * Returns the given logical sizes, padded with leading 1's to three
+     * dimensions
+     *
+     * @param n The logical sizes
+     * @return The padded sizes
+     * @throws IllegalArgumentException If the rank is not 1, 2 or 3, or
+     * a size is not positive
+     */
+    static long[] sizes(int n[])
+    {
+        if (n.length < 1 || n.length > 3)
+        {
+            throw new IllegalArgumentException(
+                "The rank must be 1, 2 or 3, but is " + n.length);
+        }
+        long sizes[] = { 1, 1, 1 };
+        for (int i = 0; i < n.length; i++)
+        {
+            if (n[i] <= 0)
+            {
+                throw new IllegalArgumentException(
+                    "The sizes must be positive, but size " + i +
+                    " is " + n[i]);
+            }
+            sizes[3 - n.length + i] = n[i];
+        }
+        return sizes;
+    }
+
+    /**
+     * Throws an IllegalArgumentException if the given length is smaller
+     * than the required length
+     *
+     * @param length The length
+     * @param required The required length
+     * @param name The name of the array
+     */
+    private static void checkLength(long length, long required, String name)
+    {
+        if (length < required)
+        {
+            throw new IllegalArgumentException("The " + name +
+                " array must have at least " + required +
+                " elements, but has " + length);
+        }
+    }
+}
@@ -28,6 +28,17 @@
 
 package jcuda.jcufft;
 
+import java.io.File;
+import java.io.IOException;
+import java.lang.reflect.Array;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.DoubleBuffer;
+import java.nio.FloatBuffer;
+import java.util.logging.Level;
+import java.util.logging.Logger;
+import java.util.stream.IntStream;
+
 import jcuda.*;
 import jcuda.runtime.*;
 
@@ -40,108 +51,1237 @@ import jcuda.runtime.*;
 public class JCufft
 {
     /**
-     * CUFFT transform direction
+     * CUFFT transform direction
+     */
+    public static final int CUFFT_FORWARD = -1;
+
+    /**
+     * CUFFT transform direction
+     */
+    public static final int CUFFT_INVERSE = 1;
+
+
+    /**
+     * The flag that indicates whether the native library has been
+     * loaded
+     */
+    private static boolean initialized = false;
+
+    /**
+     * The name of the system property that selects the startup mode.
+     * If it is <code>fast</code>, then the native library is loaded
+     * through the {@link NativeLibraryCache}, and the startup tasks
+     * are deferred until the first plan is created.
+     */
+    private static final String STARTUP_PROPERTY = "jcufft.startup";
+
+    /**
+     * Whether the startup tasks have been deferred and not been
+     * performed yet
+     */
+    private static volatile boolean startupPending = false;
+
+    /**
+     * Whether a CudaException should be thrown if a method is about
+     * to return a result code that is not cufftResult.CUFFT_SUCCESS
+     */
+    private static boolean exceptionsEnabled = false;
+
+    /**
+     * Whether the per-plan statistics are enabled. This is only used
+     * to decide whether the transfers of the array overloads of the
+     * exec methods are timed.
+     */
+    private static volatile boolean statisticsEnabled = false;
+
+    /**
+     * The name of the system property that may contain the name of a
+     * file that all calls should be recorded to, starting when the
+     * native library is loaded
+     */
+    private static final String RECORD_PROPERTY = "jcufft.record";
+
+    /**
+     * The shutdown hook that stops the current recording, or null if
+     * no recording is active
+     */
+    private static Thread recordingShutdownHook = null;
+
+    /**
+     * The range provider kinds that may be passed to the native library
+     */
+    private static final int RANGES_NONE = 0;
+    private static final int RANGES_NVTX = 1;
+    private static final int RANGES_JAVA = 2;
+
+    /**
+     * The current range provider kind
+     */
+    private static int rangeProvider = RANGES_NONE;
+
+    /**
+     * The current RangeListener, or null
+     */
+    private static volatile RangeListener rangeListener = null;
+
+    /* Private constructor to prevent instantiation */
+    private JCufft()
+    {
+    }
+
+    // Initialize the native library.
+    static
+    {
+        initialize();
+    }
+
+    /**
+     * Initializes the native library. Note that this method
+     * does not have to be called explicitly by the user of
+     * the library: The library will automatically be
+     * loaded when this class is loaded.<br>
+     * <br>
+     * If the system property <code>jcufft.startup</code> is set to
+     * <code>fast</code>, then the native library is extracted from
+     * the JAR only once, into a directory that is shared between
+     * processes, and then loaded from there. The plan warm-up and the
+     * recording that may be configured with system properties are
+     * then started when the first plan is created, so that the CUDA
+     * context and CUFFT are not initialized before they are needed.
+     */
+    public static void initialize()
+    {
+        if (!initialized)
+        {
+            String libraryBaseName = "JCufft-" + JCudaVersion.get();
+            String libraryName = 
+                LibUtils.createPlatformLibraryName(libraryBaseName);
+            boolean fast = "fast".equals(System.getProperty(STARTUP_PROPERTY));
+            if (!fast || !loadCachedLibrary(libraryName))
+            {
+                LibUtilsCuda.loadLibrary(libraryName);
+            }
+            initialized = true;
+
+            if (fast)
+            {
+                startupPending = true;
+            }
+            else
+            {
+                startup();
+            }
+        }
+    }
+
+    /**
+     * Loads the native library with the given name from a directory on
+     * the library path, or from the {@link NativeLibraryCache}. Returns
+     * <code>false</code> if neither is possible.
+     *
+     * @param libraryName The library name
+     * @return Whether the library was loaded
+     */
+    private static boolean loadCachedLibrary(String libraryName)
+    {
+        try
+        {
+            System.loadLibrary(libraryName);
+            return true;
+        }
+        catch (UnsatisfiedLinkError e)
+        {
+            return NativeLibraryCache.load(libraryName);
+        }
+    }
+
+    /**
+     * Performs the startup tasks if they have been deferred by the fast
+     * startup mode. This is called before a plan is created.
+     */
+    private static void ensureStarted()
+    {
+        if (startupPending)
+        {
+            synchronized (JCufft.class)
+            {
+                if (startupPending)
+                {
+                    startupPending = false;
+                    startup();
+                }
+            }
+        }
+    }
+
+    /**
+     * Starts the plan warm-up and the recording, if they are configured
+     * with the respective system properties
+     */
+    private static void startup()
+    {
+        PlanWarmup.startup();
+
+        String recordFileName = System.getProperty(RECORD_PROPERTY);
+        if (recordFileName != null)
+        {
+            try
+            {
+                startRecording(recordFileName);
+            }
+            catch (IOException | RuntimeException e)
+            {
+                Logger.getLogger(JCufft.class.getName()).log(
+                    Level.WARNING, "Could not start the recording to " +
+                    recordFileName, e);
+            }
+        }
+    }
+
+
+    /**
+     * Set the specified log level for the JCufft library.<br />
+     * <br />
+     * Currently supported log levels:
+     * <br />
+     * LOG_QUIET: Never print anything <br />
+     * LOG_ERROR: Print error messages <br />
+     * LOG_TRACE: Print a trace of all native function calls <br />
+     *
+     * @param logLevel The log level to use.
+     */
+    public static void setLogLevel(LogLevel logLevel)
+    {
+        setLogLevel(logLevel.ordinal());
+    }
+
+    private static native void setLogLevel(int logLevel);
+
+
+    /**
+     * Enables or disables exceptions. By default, the methods of this class
+     * only return the cufftResult error code from the underlying CUDA function.
+     * If exceptions are enabled, a CudaException with a detailed error
+     * message will be thrown if a method is about to return a result code
+     * that is not cufftResult.CUFFT_SUCCESS
+     *
+     * @param enabled Whether exceptions are enabled
+     */
+    public static void setExceptionsEnabled(boolean enabled)
+    {
+        exceptionsEnabled = enabled;
+    }
+
+    /**
+     * If the given result is different to cufftResult.CUFFT_SUCCESS and
+     * exceptions have been enabled, this method will throw a
+     * CudaException with an error message that corresponds to the
+     * given result code. Otherwise, the given result is simply
+     * returned.
+     *
+     * @param result The result to check
+     * @return The result that was given as the parameter
+     * @throws CudaException If exceptions have been enabled and
+     * the given result code is not cufftResult.CUFFT_SUCCESS
+     */
+    private static int checkResult(int result)
+    {
+        if (exceptionsEnabled && result != cufftResult.CUFFT_SUCCESS)
+        {
+            throw new CudaException(cufftResult.stringFor(result));
+        }
+        return result;
+    }
+
+    /**
+     * Enables or disables the per-plan execution statistics. By default,
+     * the statistics are disabled. When they are enabled, the number of
+     * executions, the number of bytes that are processed, and the device
+     * time of each execution are recorded for each plan, and can be
+     * obtained with {@link #getPlanStatistics(cufftHandle)}.<br>
+     * <br>
+     * The device times are measured with CUDA events that are recorded
+     * on the stream of the plan, so the exec methods do not synchronize
+     * when the statistics are enabled.<br>
+     * <br>
+     * The statistics may be omitted from the native library at compile
+     * time. In this case, this method returns <code>false</code> and
+     * has no effect.
+     *
+     * @param enabled Whether the statistics are enabled
+     * @return Whether the native library supports statistics
+     */
+    public static boolean setStatisticsEnabled(boolean enabled)
+    {
+        boolean supported = setStatisticsEnabledNative(enabled);
+        statisticsEnabled = supported && enabled;
+        return supported;
+    }
+    private static native boolean setStatisticsEnabledNative(boolean enabled);
+
+    /**
+     * Returns whether the per-plan execution statistics are enabled
+     *
+     * @return Whether the statistics are enabled
+     */
+    public static boolean isStatisticsEnabled()
+    {
+        return statisticsEnabled;
+    }
+
+    /**
+     * Returns a snapshot of the execution statistics of the given plan.
+     * Returns <code>null</code> if no statistics have been recorded for
+     * the plan, or the statistics are not supported by the native
+     * library. The statistics of a plan are reset when a new plan is
+     * created with the same handle.
+     *
+     * @param plan The plan
+     * @return The {@link PlanStatistics}, or <code>null</code>
+     */
+    public static PlanStatistics getPlanStatistics(cufftHandle plan)
+    {
+        long data[] = getPlanStatisticsNative(plan);
+        if (data == null)
+        {
+            return null;
+        }
+        return new PlanStatistics(data);
+    }
+    private static native long[] getPlanStatisticsNative(cufftHandle plan);
+
+    /**
+     * Enables or disables the cache for the work sizes that are
+     * computed by the <code>cufftEstimate*</code> functions and by
+     * <code>cufftGetSizeMany</code> and <code>cufftGetSizeMany64</code>.
+     * By default, the cache is enabled.<br>
+     * <br>
+     * These functions always return the same work size for the same
+     * geometry on the same device. When the cache is enabled, the
+     * results of successful calls are stored in a fixed-size table in
+     * the native library, and returned for subsequent calls with the
+     * same geometry, without calling CUFFT. Disabling the cache clears
+     * it.
+     *
+     * @param enabled Whether the cache is enabled
+     */
+    public static void setEstimateCacheEnabled(boolean enabled)
+    {
+        setEstimateCacheEnabledNative(enabled);
+    }
+    private static native void setEstimateCacheEnabledNative(boolean enabled);
+
+    /**
+     * Removes all entries from the work size cache, and resets its
+     * counters.
+     *
+     * @see #setEstimateCacheEnabled(boolean)
+     */
+    public static void clearEstimateCache()
+    {
+        clearEstimateCacheNative();
+    }
+    private static native void clearEstimateCacheNative();
+
+    /**
+     * Returns the counters of the work size cache, as an array
+     * containing the number of hits, the number of misses, and the
+     * current number of entries.
+     *
+     * @return The counters
+     * @see #setEstimateCacheEnabled(boolean)
+     */
+    public static long[] getEstimateCacheCounts()
+    {
+        return getEstimateCacheCountsNative();
+    }
+    private static native long[] getEstimateCacheCountsNative();
+
+    /**
+     * Performs a cudaMemcpy for one of the array overloads of the exec
+     * methods. If the statistics are enabled, then the time of the
+     * copy is recorded for the given plan.
+     *
+     * @param plan The plan
+     * @param dst The destination
+     * @param src The source
+     * @param count The number of bytes
+     * @param kind The cudaMemcpyKind
+     * @return The cudaError
+     */
+    private static int memcpy(cufftHandle plan,
+        Pointer dst, Pointer src, long count, int kind)
+    {
+        if (!statisticsEnabled)
+        {
+            return JCuda.cudaMemcpy(dst, src, count, kind);
+        }
+        long before = System.nanoTime();
+        int result = JCuda.cudaMemcpy(dst, src, count, kind);
+        long after = System.nanoTime();
+        if (result == cudaError.cudaSuccess)
+        {
+            recordTransferNative(plan, count, after - before);
+        }
+        return result;
+    }
+    private static native void recordTransferNative(
+        cufftHandle plan, long bytes, long nanos);
+
+    /**
+     * Executes the given plan for data in Java arrays, where complex
+     * data may be given as separate arrays for the real and imaginary
+     * parts. Split complex data is interleaved into and split from
+     * page-locked staging memory.
+     *
+     * @param plan The plan
+     * @param type The cufftType of the plan
+     * @param inRe The real input, or the real parts of the input
+     * @param inIm The imaginary parts of the input, or <code>null</code>
+     * for real input
+     * @param inputCount The number of input values
+     * @param outRe The real output, or the real parts of the output
+     * @param outIm The imaginary parts of the output, or
+     * <code>null</code> for real output
+     * @param outputCount The number of output values
+     * @param direction The direction, for complex-to-complex transforms
+     * @return The cufftResult
+     */
+    private static int execSplit(cufftHandle plan, int type,
+        Object inRe, Object inIm, int inputCount,
+        Object outRe, Object outIm, int outputCount, int direction)
+    {
+        int elementSize = JCufftUtils.elementSize(type);
+        long inputBytes = (inIm == null ? 1L : 2L) * inputCount * elementSize;
+        long outputBytes = (outIm == null ? 1L : 2L) * outputCount * elementSize;
+        long transferSizes[] =
+            transferSizes(plan, inputBytes, outputBytes, false);
+
+        int cudaResult = cudaError.cudaSuccess;
+        int result = cufftResult.CUFFT_SUCCESS;
+        StagingPool.Buffer staging =
+            StagingPool.acquire(Math.max(inputBytes, outputBytes));
+        Pointer deviceIdata = new Pointer();
+        Pointer deviceOdata = new Pointer();
+        try
+        {
+            if (staging == null)
+            {
+                cudaResult = cudaError.cudaErrorMemoryAllocation;
+            }
+            if (cudaResult == cudaError.cudaSuccess)
+            {
+                cudaResult = JCuda.cudaMalloc(deviceIdata, transferSizes[0]);
+            }
+            if (cudaResult == cudaError.cudaSuccess)
+            {
+                cudaResult = JCuda.cudaMalloc(deviceOdata, transferSizes[1]);
+            }
+            if (cudaResult == cudaError.cudaSuccess)
+            {
+                Pointer hostIdata = staging.pointer;
+                if (inIm == null)
+                {
+                    hostIdata = pointerTo(inRe);
+                }
+                else
+                {
+                    interleaveNative(inRe, inIm, elementSize,
+                        staging.pointer, inputCount);
+                }
+                cudaResult = memcpy(plan, deviceIdata, hostIdata,
+                    transferSizes[0], cudaMemcpyKind.cudaMemcpyHostToDevice);
+            }
+            if (cudaResult == cudaError.cudaSuccess)
+            {
+                result = JCufftUtils.exec(
+                    plan, type, deviceIdata, deviceOdata, direction);
+            }
+            if (cudaResult == cudaError.cudaSuccess &&
+                result == cufftResult.CUFFT_SUCCESS)
+            {
+                Pointer hostOdata = outIm == null ?
+                    pointerTo(outRe) : staging.pointer;
+                cudaResult = memcpy(plan, hostOdata, deviceOdata,
+                    transferSizes[1], cudaMemcpyKind.cudaMemcpyDeviceToHost);
+                if (cudaResult == cudaError.cudaSuccess && outIm != null)
+                {
+                    deinterleaveNative(staging.pointer, outRe, outIm,
+                        elementSize, (int)(transferSizes[1] / (2 * elementSize)));
+                }
+            }
+        }
+        finally
+        {
+            JCuda.cudaFree(deviceIdata);
+            JCuda.cudaFree(deviceOdata);
+            if (staging != null)
+            {
+                StagingPool.release(staging);
+            }
+        }
+        if (cudaResult != cudaError.cudaSuccess)
+        {
+            if (exceptionsEnabled)
+            {
+                throw new CudaException("JCuda error: "+cudaError.stringFor(cudaResult));
+            }
+            return cufftResult.JCUFFT_INTERNAL_ERROR;
+        }
+        return result;
+    }
+    private static native void interleaveNative(
+        Object re, Object im, int elementSize, Pointer dst, int count);
+    private static native void deinterleaveNative(
+        Pointer src, Object re, Object im, int elementSize, int count);
+
+    /**
+     * Returns the length of split complex data with the given lengths
+     * of the arrays for the real and imaginary parts
+     *
+     * @param reLength The length of the array for the real parts
+     * @param imLength The length of the array for the imaginary parts
+     * @return The length
+     * @throws IllegalArgumentException If the lengths are different
+     */
+    private static int splitLength(int reLength, int imLength)
+    {
+        if (reLength != imLength)
+        {
+            throw new IllegalArgumentException(
+                "The arrays for the real and imaginary parts have " +
+                "different lengths: " + reLength + " and " + imLength);
+        }
+        return reLength;
+    }
+
+    /**
+     * Returns the numbers of bytes of the input and the output that are
+     * touched by the given plan, as an array of length 2. If the geometry
+     * of the plan is not known, then these are the given sizes of the
+     * arrays. For in-place transforms, both values are the larger one of
+     * the input and output extents.
+     *
+     * @param plan The plan
+     * @param inputBytes The size of the input array, in bytes
+     * @param outputBytes The size of the output array, in bytes
+     * @param inPlace Whether the transform is in-place
+     * @return The input and output sizes, in bytes
+     * @throws IllegalArgumentException If one of the arrays is smaller
+     * than the data that is touched by the plan
+     */
+    private static long[] transferSizes(cufftHandle plan,
+        long inputBytes, long outputBytes, boolean inPlace)
+    {
+        PlanGeometry geometry = plan.getGeometry();
+        if (geometry == null)
+        {
+            return new long[] { inputBytes, outputBytes };
+        }
+        long inputExtent =
+            geometry.getInputExtent() * geometry.getInputElementSize();
+        long outputExtent =
+            geometry.getOutputExtent() * geometry.getOutputElementSize();
+        if (inPlace)
+        {
+            inputExtent = Math.max(inputExtent, outputExtent);
+            outputExtent = inputExtent;
+        }
+        if (inputBytes < inputExtent)
+        {
+            throw new IllegalArgumentException(
+                "The input has " + inputBytes + " bytes, but the plan " +
+                "reads " + inputExtent + " bytes: " + geometry);
+        }
+        if (outputBytes < outputExtent)
+        {
+            throw new IllegalArgumentException(
+                "The output has " + outputBytes + " bytes, but the plan " +
+                "writes " + outputExtent + " bytes: " + geometry);
+        }
+        return new long[] { inputExtent, outputExtent };
+    }
+
+    /**
+     * Returns a pointer to the given float or double array
+     *
+     * @param array The array
+     * @return The pointer
+     */
+    private static Pointer pointerTo(Object array)
+    {
+        if (array instanceof double[])
+        {
+            return Pointer.to((double[])array);
+        }
+        return Pointer.to((float[])array);
+    }
+
+    /**
+     * The minimum total number of bytes for which the rows of the
+     * batched array overloads are gathered and scattered in parallel
+     */
+    private static final long PARALLEL_GATHER_BYTES = 1L << 20;
+
+    /**
+     * Executes the given batched plan for data in Java arrays, where
+     * each row contains one signal of the batch. The rows are gathered
+     * into page-locked staging memory, copied to the device with a
+     * single copy, transformed with a single exec call, and the results
+     * are scattered back into the output rows.
+     *
+     * @param plan The plan
+     * @param type The cufftType of the plan
+     * @param input The input rows, float[] or double[] arrays
+     * @param output The output rows, float[] or double[] arrays
+     * @param direction The direction, for complex-to-complex transforms
+     * @return The cufftResult
+     * @throws IllegalArgumentException If the numbers of input and
+     * output rows are different, the rows have different lengths, or
+     * the rows do not match the batch size and distances of the plan
+     */
+    private static int execBatched(cufftHandle plan, int type,
+        Object input[], Object output[], int direction)
+    {
+        int inputLength = rowLength(input);
+        int outputLength = rowLength(output);
+        if (input.length != output.length)
+        {
+            throw new IllegalArgumentException(
+                "The number of input rows (" + input.length + ") and " +
+                "output rows (" + output.length + ") are different");
+        }
+        boolean inPlace = (input == output);
+        int elementSize = JCufftUtils.elementSize(type);
+        long inputRowBytes = (long)inputLength * elementSize;
+        long outputRowBytes = (long)outputLength * elementSize;
+        long inputBytes = input.length * inputRowBytes;
+        long outputBytes = output.length * outputRowBytes;
+        PlanGeometry geometry = plan.getGeometry();
+        if (geometry != null)
+        {
+            validateRows(geometry, input.length,
+                inputRowBytes, outputRowBytes, inPlace);
+        }
+
+        // The rows are always transferred completely, but they have to
+        // cover the data that is touched by the plan
+        transferSizes(plan, inputBytes, outputBytes, inPlace);
+
+        int cudaResult = cudaError.cudaSuccess;
+        int result = cufftResult.CUFFT_SUCCESS;
+        StagingPool.Buffer staging =
+            StagingPool.acquire(Math.max(inputBytes, outputBytes));
+        Pointer deviceIdata = new Pointer();
+        Pointer deviceOdata = inPlace ? deviceIdata : new Pointer();
+        try
+        {
+            if (staging == null)
+            {
+                cudaResult = cudaError.cudaErrorMemoryAllocation;
+            }
+            if (cudaResult == cudaError.cudaSuccess)
+            {
+                cudaResult = JCuda.cudaMalloc(deviceIdata, inputBytes);
+            }
+            if (cudaResult == cudaError.cudaSuccess && !inPlace)
+            {
+                cudaResult = JCuda.cudaMalloc(deviceOdata, outputBytes);
+            }
+            if (cudaResult == cudaError.cudaSuccess)
+            {
+                transferRows(staging.pointer, input, inputRowBytes, true);
+                cudaResult = memcpy(plan, deviceIdata, staging.pointer,
+                    inputBytes, cudaMemcpyKind.cudaMemcpyHostToDevice);
+            }
+            if (cudaResult == cudaError.cudaSuccess)
+            {
+                result = JCufftUtils.exec(
+                    plan, type, deviceIdata, deviceOdata, direction);
+            }
+            if (cudaResult == cudaError.cudaSuccess &&
+                result == cufftResult.CUFFT_SUCCESS)
+            {
+                cudaResult = memcpy(plan, staging.pointer, deviceOdata,
+                    outputBytes, cudaMemcpyKind.cudaMemcpyDeviceToHost);
+                if (cudaResult == cudaError.cudaSuccess)
+                {
+                    transferRows(staging.pointer, output, outputRowBytes, false);
+                }
+            }
+        }
+        finally
+        {
+            JCuda.cudaFree(deviceIdata);
+            if (!inPlace)
+            {
+                JCuda.cudaFree(deviceOdata);
+            }
+            if (staging != null)
+            {
+                StagingPool.release(staging);
+            }
+        }
+        if (cudaResult != cudaError.cudaSuccess)
+        {
+            if (exceptionsEnabled)
+            {
+                throw new CudaException("JCuda error: "+cudaError.stringFor(cudaResult));
+            }
+            return cufftResult.JCUFFT_INTERNAL_ERROR;
+        }
+        return result;
+    }
+
+    /**
+     * Checks that the rows of a batched array overload match the given
+     * geometry: There has to be one row for each signal of the batch,
+     * and each row has to cover exactly the distance between two
+     * consecutive signals.
+     *
+     * @param geometry The geometry of the plan
+     * @param rows The number of rows
+     * @param inputRowBytes The size of each input row, in bytes
+     * @param outputRowBytes The size of each output row, in bytes
+     * @param inPlace Whether the transform is in-place
+     * @throws IllegalArgumentException If the rows do not match
+     */
+    private static void validateRows(PlanGeometry geometry, int rows,
+        long inputRowBytes, long outputRowBytes, boolean inPlace)
+    {
+        if (rows != geometry.getBatch())
+        {
+            throw new IllegalArgumentException(
+                "Found " + rows + " rows, but the plan has a batch size " +
+                "of " + geometry.getBatch() + ": " + geometry);
+        }
+        long inputDistance =
+            geometry.getInputDistance() * geometry.getInputElementSize();
+        long outputDistance =
+            geometry.getOutputDistance() * geometry.getOutputElementSize();
+        if (inPlace)
+        {
+            inputDistance = Math.max(inputDistance, outputDistance);
+            outputDistance = inputDistance;
+        }
+        if (inputRowBytes != inputDistance)
+        {
+            throw new IllegalArgumentException(
+                "The input rows have " + inputRowBytes + " bytes, but the " +
+                "plan reads " + inputDistance + " bytes per signal: " +
+                geometry);
+        }
+        if (outputRowBytes != outputDistance)
+        {
+            throw new IllegalArgumentException(
+                "The output rows have " + outputRowBytes + " bytes, but the " +
+                "plan writes " + outputDistance + " bytes per signal: " +
+                geometry);
+        }
+    }
+
+    /**
+     * Returns the common length of the given rows
+     *
+     * @param rows The float[] or double[] rows
+     * @return The length of the rows, or 0 if there are no rows
+     * @throws IllegalArgumentException If the rows have different lengths
+     */
+    private static int rowLength(Object rows[])
+    {
+        int length = 0;
+        for (int i = 0; i < rows.length; i++)
+        {
+            int rowLength = Array.getLength(rows[i]);
+            if (i == 0)
+            {
+                length = rowLength;
+            }
+            else if (rowLength != length)
+            {
+                throw new IllegalArgumentException(
+                    "Row " + i + " has length " + rowLength +
+                    ", expected " + length);
+            }
+        }
+        return length;
+    }
+
+    /**
+     * Copies the given rows into the given host memory, or the contents
+     * of the host memory into the rows. If the total size is large, the
+     * rows are copied in parallel.
+     *
+     * @param host The pointer to page-locked host memory
+     * @param rows The float[] or double[] rows
+     * @param rowBytes The size of one row, in bytes
+     * @param gather Whether the rows are copied into the host memory
+     */
+    private static void transferRows(final Pointer host,
+        final Object rows[], final long rowBytes, final boolean gather)
+    {
+        IntStream indices = IntStream.range(0, rows.length);
+        if (rows.length * rowBytes >= PARALLEL_GATHER_BYTES)
+        {
+            indices = indices.parallel();
+        }
+        indices.forEach(i ->
+        {
+            ByteBuffer bytes = host.getByteBuffer(i * rowBytes, rowBytes)
+                .order(ByteOrder.nativeOrder());
+            if (rows[i] instanceof double[])
+            {
+                DoubleBuffer buffer = bytes.asDoubleBuffer();
+                if (gather)
+                {
+                    buffer.put((double[])rows[i]);
+                }
+                else
+                {
+                    buffer.get((double[])rows[i]);
+                }
+            }
+            else
+            {
+                FloatBuffer buffer = bytes.asFloatBuffer();
+                if (gather)
+                {
+                    buffer.put((float[])rows[i]);
+                }
+                else
+                {
+                    buffer.get((float[])rows[i]);
+                }
+            }
+        });
+    }
+
+
+    /**
+     * Starts recording all calls to the native library into the given
+     * file. The file will contain the plan geometries, the handles, the
+     * streams and the data pointers that are passed to the functions,
+     * as well as the results and the host time of each call, in a
+     * compact binary format. It can be replayed with the JCufftReplay
+     * tool that is part of the native build, to reproduce the sequence
+     * of calls and profile it offline.<br>
+     * <br>
+     * The recording is stopped by calling {@link #stopRecording()}, or
+     * when the JVM shuts down. A recording may also be started when the
+     * native library is loaded, by setting the system property
+     * <code>jcufft.record</code> to the name of the file.
+     *
+     * @param fileName The name of the file
+     * @throws IOException If the file can not be written
+     * @throws IllegalStateException If a recording is already active
+     * @throws UnsupportedOperationException If the native library was
+     * compiled without support for recording
+     */
+    public static synchronized void startRecording(String fileName)
+        throws IOException
+    {
+        startRecordingNative(fileName);
+        recordingShutdownHook = new Thread(() ->
+        {
+            try
+            {
+                stopRecordingNative();
+            }
+            catch (IOException e)
+            {
+                // Nothing to report this to during shutdown
+            }
+        }, "JCufft recording shutdown");
+        Runtime.getRuntime().addShutdownHook(recordingShutdownHook);
+    }
+    private static native int startRecordingNative(String fileName)
+        throws IOException;
+
+    /**
+     * Stops the current recording, if there is one, and writes all
+     * pending records to the file.
+     *
+     * @throws IOException If the file could not be written
+     */
+    public static synchronized void stopRecording() throws IOException
+    {
+        if (recordingShutdownHook != null)
+        {
+            Runtime.getRuntime().removeShutdownHook(recordingShutdownHook);
+            recordingShutdownHook = null;
+        }
+        stopRecordingNative();
+    }
+    private static native int stopRecordingNative() throws IOException;
+
+    /**
+     * Returns whether a recording is currently active
+     *
+     * @return Whether a recording is active
+     */
+    public static synchronized boolean isRecording()
+    {
+        return recordingShutdownHook != null;
+    }
+
+    /**
+     * Writes the geometries of all plans that have been created in this
+     * process, together with the sizes of their work areas, to the given
+     * file. When the file is passed to {@link PlanWarmup#warmUp(File)},
+     * or given as the <code>jcufft.warmup</code> system property in a
+     * later process, then plans for these geometries are pre-built in
+     * the background. See {@link PlanWarmup} for details.
+     *
+     * @param file The file
+     * @throws IOException If the file can not be written
+     */
+    public static void exportPlanGeometries(File file) throws IOException
+    {
+        PlanWarmup.export(file);
+    }
+
+
+    /**
+     * Enables or disables NVTX range annotations. When they are enabled,
+     * a named NVTX range is pushed around each plan creation, each call
+     * to {@link #cufftSetWorkArea(cufftHandle, Pointer)} and each exec
+     * call, so that timeline profilers like Nsight Systems can attribute
+     * the CUFFT kernels to these calls. The name of a range contains the
+     * function, the type and the geometry of the plan.<br>
+     * <br>
+     * The NVTX library is loaded when the annotations are enabled for
+     * the first time. If it can not be loaded, or the native library
+     * was compiled without support for range annotations, then this
+     * method returns <code>false</code> and has no effect.<br>
+     * <br>
+     * Enabling the NVTX ranges replaces a {@link RangeListener} that
+     * may have been set.
+     *
+     * @param enabled Whether the NVTX ranges are enabled
+     * @return Whether the NVTX ranges are available
+     */
+    public static synchronized boolean setNvtxRangesEnabled(boolean enabled)
+    {
+        if (!enabled)
+        {
+            if (rangeProvider == RANGES_NVTX)
+            {
+                setRangeProviderNative(RANGES_NONE);
+                rangeProvider = RANGES_NONE;
+            }
+            return true;
+        }
+        if (!setRangeProviderNative(RANGES_NVTX))
+        {
+            return false;
+        }
+        rangeProvider = RANGES_NVTX;
+        rangeListener = null;
+        return true;
+    }
+
+    /**
+     * Set the {@link RangeListener} that will be informed about the
+     * ranges of plan creations, work area changes and exec calls. This
+     * replaces the NVTX range annotations if they had been enabled.
+     * If the given listener is <code>null</code>, then the range
+     * annotations are disabled.<br>
+     * <br>
+     * If the native library was compiled without support for range
+     * annotations, then this method returns <code>false</code> and
+     * has no effect.
+     *
+     * @param listener The listener
+     * @return Whether the range annotations are available
+     */
+    public static synchronized boolean setRangeListener(
+        RangeListener listener)
+    {
+        if (listener == null)
+        {
+            if (rangeProvider == RANGES_JAVA)
+            {
+                setRangeProviderNative(RANGES_NONE);
+                rangeProvider = RANGES_NONE;
+            }
+            rangeListener = null;
+            return true;
+        }
+        rangeListener = listener;
+        if (!setRangeProviderNative(RANGES_JAVA))
+        {
+            rangeListener = null;
+            return false;
+        }
+        rangeProvider = RANGES_JAVA;
+        return true;
+    }
+    private static native boolean setRangeProviderNative(int provider);
+
+    /**
+     * Called by the native library when a range is started
+     *
+     * @param name The name of the range
+     */
+    private static void rangeStarted(String name)
+    {
+        RangeListener listener = rangeListener;
+        if (listener == null)
+        {
+            return;
+        }
+        try
+        {
+            listener.rangeStarted(name);
+        }
+        catch (RuntimeException e)
+        {
+            Logger.getLogger(JCufft.class.getName()).log(
+                Level.WARNING, "RangeListener failed", e);
+        }
+    }
+
+    /**
+     * Called by the native library when a range is ended
      */
-    public static final int CUFFT_FORWARD = -1;
+    private static void rangeEnded()
+    {
+        RangeListener listener = rangeListener;
+        if (listener == null)
+        {
+            return;
+        }
+        try
+        {
+            listener.rangeEnded();
+        }
+        catch (RuntimeException e)
+        {
+            Logger.getLogger(JCufft.class.getName()).log(
+                Level.WARNING, "RangeListener failed", e);
+        }
+    }
 
     /**
-     * CUFFT transform direction
+     * Transposes the given number of consecutive row-major matrices with
+     * the given number of rows and columns from the source into the
+     * destination, asynchronously in the given stream. This is used for
+     * converting data between the layouts that are chosen by the
+     * {@link LayoutTuner}, and between the memory orders of a
+     * {@link PermutedPlan}.
+     *
+     * @param src The source, in device memory
+     * @param dst The destination, in device memory. It must not overlap
+     * the source.
+     * @param batch The number of matrices
+     * @param rows The number of rows of each source matrix
+     * @param cols The number of columns of each source matrix
+     * @param elementSize The size of one element, which must be 4, 8
+     * or 16 bytes
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @return The cudaError
      */
-    public static final int CUFFT_INVERSE = 1;
-
+    static int transpose(Pointer src, Pointer dst, long batch,
+        long rows, long cols, int elementSize, cudaStream_t stream)
+    {
+        return transposeNative(
+            src, dst, batch, rows, cols, elementSize, stream);
+    }
+    private static native int transposeNative(Pointer src, Pointer dst,
+        long batch, long rows, long cols, int elementSize,
+        cudaStream_t stream);
 
     /**
-     * The flag that indicates whether the native library has been
-     * loaded
+     * Expands the given number of half spectra of real-to-complex
+     * transforms into full, conjugate-symmetric spectra, on the host.
+     * This is used by {@link HermitianSpectra}.
+     *
+     * @param half The half spectra, as a float or double array
+     * @param full The full spectra, as an array of the same type
+     * @param elementSize The size of one real value, 4 or 8 bytes
+     * @param batch The number of spectra
+     * @param n0 The logical size in the first dimension
+     * @param n1 The logical size in the second dimension
+     * @param n2 The logical size in the last dimension
      */
-    private static boolean initialized = false;
+    static void hermitianExpand(Object half, Object full, int elementSize,
+        long batch, long n0, long n1, long n2)
+    {
+        hermitianExpandNative(half, full, elementSize, batch, n0, n1, n2);
+    }
+    private static native void hermitianExpandNative(Object half,
+        Object full, int elementSize, long batch, long n0, long n1, long n2);
 
     /**
-     * Whether a CudaException should be thrown if a method is about
-     * to return a result code that is not cufftResult.CUFFT_SUCCESS
+     * Expands the given number of half spectra of real-to-complex
+     * transforms into full, conjugate-symmetric spectra, on the device,
+     * asynchronously in the given stream. This is used by
+     * {@link HermitianSpectra}.
+     *
+     * @param half The half spectra, in device memory
+     * @param full The full spectra, in device memory
+     * @param elementSize The size of one real value, 4 or 8 bytes
+     * @param batch The number of spectra
+     * @param n0 The logical size in the first dimension
+     * @param n1 The logical size in the second dimension
+     * @param n2 The logical size in the last dimension
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @return The cudaError
      */
-    private static boolean exceptionsEnabled = false;
-
-    /* Private constructor to prevent instantiation */
-    private JCufft()
+    static int hermitianExpand(Pointer half, Pointer full, int elementSize,
+        long batch, long n0, long n1, long n2, cudaStream_t stream)
     {
+        return hermitianExpandDeviceNative(
+            half, full, elementSize, batch, n0, n1, n2, stream);
     }
+    private static native int hermitianExpandDeviceNative(Pointer half,
+        Pointer full, int elementSize, long batch, long n0, long n1, long n2,
+        cudaStream_t stream);
 
-    // Initialize the native library.
-    static
+    /**
+     * Writes the real input sequences of the real-to-complex transforms
+     * for the given number of DCTs or DSTs into the given work buffer,
+     * asynchronously in the given stream. This is used by
+     * {@link TrigPlan}.
+     *
+     * @param src The input data, in device memory
+     * @param work The work buffer, in device memory
+     * @param kind The ordinal of the {@link TrigPlan.Type}
+     * @param elementSize The size of one real value, 4 or 8 bytes
+     * @param count The number of transforms
+     * @param stride The distance between consecutive elements of one
+     * transform, in elements
+     * @param n The length of the transforms
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @return The cudaError
+     */
+    static int trigPreTwiddle(Pointer src, Pointer work, int kind,
+        int elementSize, long count, long stride, long n, cudaStream_t stream)
     {
-        initialize();
+        return trigPreTwiddleNative(
+            src, work, kind, elementSize, count, stride, n, stream);
     }
+    private static native int trigPreTwiddleNative(Pointer src, Pointer work,
+        int kind, int elementSize, long count, long stride, long n,
+        cudaStream_t stream);
 
     /**
-     * Initializes the native library. Note that this method
-     * does not have to be called explicitly by the user of
-     * the library: The library will automatically be
-     * loaded when this class is loaded.
+     * Computes the given number of DCTs or DSTs from the spectra of the
+     * sequences that have been written with
+     * {@link #trigPreTwiddle(Pointer, Pointer, int, int, long, long, long, cudaStream_t)},
+     * asynchronously in the given stream. This is used by
+     * {@link TrigPlan}.
+     *
+     * @param spectrum The spectra, in device memory
+     * @param dst The output data, in device memory
+     * @param kind The ordinal of the {@link TrigPlan.Type}
+     * @param elementSize The size of one real value, 4 or 8 bytes
+     * @param count The number of transforms
+     * @param stride The distance between consecutive elements of one
+     * transform, in elements
+     * @param n The length of the transforms
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @return The cudaError
      */
-    public static void initialize()
+    static int trigPostTwiddle(Pointer spectrum, Pointer dst, int kind,
+        int elementSize, long count, long stride, long n, cudaStream_t stream)
     {
-        if (!initialized)
-        {
-            String libraryBaseName = "JCufft-" + JCudaVersion.get();
-            String libraryName = 
-                LibUtils.createPlatformLibraryName(libraryBaseName);
-            LibUtilsCuda.loadLibrary(libraryName);
-            initialized = true;
-        }
+        return trigPostTwiddleNative(
+            spectrum, dst, kind, elementSize, count, stride, n, stream);
     }
-
+    private static native int trigPostTwiddleNative(Pointer spectrum,
+        Pointer dst, int kind, int elementSize, long count, long stride,
+        long n, cudaStream_t stream);
 
     /**
-     * Set the specified log level for the JCufft library.<br />
-     * <br />
-     * Currently supported log levels:
-     * <br />
-     * LOG_QUIET: Never print anything <br />
-     * LOG_ERROR: Print error messages <br />
-     * LOG_TRACE: Print a trace of all native function calls <br />
-     *
-     * @param logLevel The log level to use.
+     * Multiplies the first <code>count</code> complex elements of the
+     * given number of rows of the source with the given factors, and
+     * writes the products into the rows of the destination, which are
+     * zero-padded to the destination pitch, asynchronously in the given
+     * stream. This is used by {@link ChirpZPlan}.
+     *
+     * @param src The source, in device memory
+     * @param srcPitch The distance between the source rows, in elements
+     * @param factors The factors, in device memory
+     * @param count The number of elements to multiply in each row
+     * @param dst The destination, in device memory
+     * @param dstPitch The distance between the destination rows, in
+     * elements
+     * @param rows The number of rows
+     * @param elementSize The size of one real value, 4 or 8 bytes
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @return The cudaError
      */
-    public static void setLogLevel(LogLevel logLevel)
+    static int chirpMultiply(Pointer src, long srcPitch, Pointer factors,
+        long count, Pointer dst, long dstPitch, long rows, int elementSize,
+        cudaStream_t stream)
     {
-        setLogLevel(logLevel.ordinal());
+        return chirpMultiplyNative(src, srcPitch, factors, count,
+            dst, dstPitch, rows, elementSize, stream);
     }
-
-    private static native void setLogLevel(int logLevel);
-
+    private static native int chirpMultiplyNative(Pointer src,
+        long srcPitch, Pointer factors, long count, Pointer dst,
+        long dstPitch, long rows, int elementSize, cudaStream_t stream);
 
     /**
-     * Enables or disables exceptions. By default, the methods of this class
-     * only return the cufftResult error code from the underlying CUDA function.
-     * If exceptions are enabled, a CudaException with a detailed error
-     * message will be thrown if a method is about to return a result code
-     * that is not cufftResult.CUFFT_SUCCESS
-     *
-     * @param enabled Whether exceptions are enabled
+     * Informs the {@link MemoryBudget} about the work area of the given
+     * plan and the {@link PlanWarmup} about its geometry if the given
+     * result is cufftResult.CUFFT_SUCCESS, and returns the given result.
+     *
+     * @param plan The plan that was created
+     * @param result The result of the plan creation
+     * @param workSize The size of the work area, or a negative value if
+     * it is not known
+     * @param geometry The geometry of the plan, or <code>null</code>
+     * @return The given result
      */
-    public static void setExceptionsEnabled(boolean enabled)
+    private static int planCreated(
+        cufftHandle plan, int result, long workSize, PlanGeometry geometry)
     {
-        exceptionsEnabled = enabled;
+        return planCreated(plan, result, workSize, geometry, false);
     }
 
     /**
-     * If the given result is different to cufftResult.CUFFT_SUCCESS and
-     * exceptions have been enabled, this method will throw a
-     * CudaException with an error message that corresponds to the
-     * given result code. Otherwise, the given result is simply
-     * returned.
-     *
-     * @param result The result to check
-     * @return The result that was given as the parameter
-     * @throws CudaException If exceptions have been enabled and
-     * the given result code is not cufftResult.CUFFT_SUCCESS
+     * Informs the {@link MemoryBudget} about the work area of the given
+     * plan and the {@link PlanWarmup} about its geometry if the given
+     * result is cufftResult.CUFFT_SUCCESS, stores the geometry in the
+     * plan, and returns the given result.
+     *
+     * @param plan The plan that was created
+     * @param result The result of the plan creation
+     * @param workSize The size of the work area, or a negative value if
+     * it is not known
+     * @param geometry The geometry of the plan, or <code>null</code>
+     * @param plan64 Whether the plan was created with a 64 bit function
+     * @return The given result
      */
-    private static int checkResult(int result)
+    private static int planCreated(cufftHandle plan, int result,
+        long workSize, PlanGeometry geometry, boolean plan64)
     {
-        if (exceptionsEnabled && result != cufftResult.CUFFT_SUCCESS)
+        if (result == cufftResult.CUFFT_SUCCESS)
         {
-            throw new CudaException(cufftResult.stringFor(result));
+            plan.planCreated();
+            MemoryBudget.planCreated(plan, workSize);
+            MemoryBudget.Workspace workspace = plan.getWorkspace();
+            if (workSize < 0 && workspace != null)
+            {
+                workSize = workspace.size;
+            }
+            if (workSize < 0)
+            {
+                long size[] = { -1 };
+                if (cufftGetSizeNative(plan, size) == cufftResult.CUFFT_SUCCESS)
+                {
+                    workSize = size[0];
+                }
+            }
+            plan.setGeometry(geometry, workSize < 0 ? -1 : workSize, plan64);
+            PlanWarmup.planCreated(geometry, workSize);
         }
         return result;
     }
@@ -209,11 +1349,18 @@ public class JCufft
      */
     public static int cufftPlan1d(cufftHandle plan, int nx, int type, int batch)
     {
+        ensureStarted();
         plan.setDimension(1);
         plan.setType(type);
         plan.setSize(nx, 0, 0);
         plan.setBatchSize(batch);
-        return checkResult(cufftPlan1dNative(plan, nx, type, batch));
+        PlanGeometry geometry = PlanWarmup.geometry(() ->
+            PlanGeometry.of1d(nx, type, batch));
+        if (PlanWarmup.takeWarmPlan(geometry, plan))
+        {
+            return planCreated(plan, cufftResult.CUFFT_SUCCESS, plan.getWorkSize(), geometry);
+        }
+        return planCreated(plan, checkResult(cufftPlan1dNative(plan, nx, type, batch)), -1, geometry);
     }
     private static native int cufftPlan1dNative(cufftHandle plan, int nx, int type, int batch);
 
@@ -252,10 +1399,17 @@ public class JCufft
      */
     public static int cufftPlan2d(cufftHandle plan, int nx, int ny, int type)
     {
+        ensureStarted();
         plan.setDimension(2);
         plan.setType(type);
         plan.setSize(nx, ny, 0);
-        return checkResult(cufftPlan2dNative(plan, nx, ny, type));
+        PlanGeometry geometry = PlanWarmup.geometry(() ->
+            PlanGeometry.of2d(nx, ny, type));
+        if (PlanWarmup.takeWarmPlan(geometry, plan))
+        {
+            return planCreated(plan, cufftResult.CUFFT_SUCCESS, plan.getWorkSize(), geometry);
+        }
+        return planCreated(plan, checkResult(cufftPlan2dNative(plan, nx, ny, type)), -1, geometry);
     }
     private static native int cufftPlan2dNative(cufftHandle plan, int nx, int ny, int type);
 
@@ -294,10 +1448,17 @@ public class JCufft
      */
     public static int cufftPlan3d(cufftHandle plan, int nx, int ny, int nz, int type)
     {
+        ensureStarted();
         plan.setDimension(3);
         plan.setType(type);
         plan.setSize(nx, ny, nz);
-        return checkResult(cufftPlan3dNative(plan, nx, ny, nz, type));
+        PlanGeometry geometry = PlanWarmup.geometry(() ->
+            PlanGeometry.of3d(nx, ny, nz, type));
+        if (PlanWarmup.takeWarmPlan(geometry, plan))
+        {
+            return planCreated(plan, cufftResult.CUFFT_SUCCESS, plan.getWorkSize(), geometry);
+        }
+        return planCreated(plan, checkResult(cufftPlan3dNative(plan, nx, ny, nz, type)), -1, geometry);
     }
 
     private static native int cufftPlan3dNative(cufftHandle plan, int nx, int ny, int nz, int type);
@@ -351,7 +1512,15 @@ public class JCufft
         int onembed[], int ostride, int odist,
         int type, int batch)
     {
-        return checkResult(cufftPlanManyNative(plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch));
+        ensureStarted();
+        PlanGeometry geometry = PlanWarmup.geometry(() ->
+            PlanGeometry.ofMany(rank, n, inembed, istride, idist,
+                onembed, ostride, odist, type, batch));
+        if (PlanWarmup.takeWarmPlan(geometry, plan))
+        {
+            return planCreated(plan, cufftResult.CUFFT_SUCCESS, plan.getWorkSize(), geometry);
+        }
+        return planCreated(plan, checkResult(cufftPlanManyNative(plan, rank, n, inembed, istride, idist, onembed, ostride, odist, type, batch)), -1, geometry);
     }
 
     private static native int cufftPlanManyNative(cufftHandle plan, int rank, int n[],
@@ -368,7 +1537,8 @@ public class JCufft
         int batch, /* deprecated - use cufftPlanMany */
         long workSize[])
     {
-        return checkResult(cufftMakePlan1dNative(plan, nx, type, batch, workSize));
+        return planCreated(plan, checkResult(cufftMakePlan1dNative(plan, nx, type, batch, workSize)), workSize[0],
+            PlanWarmup.geometry(() -> PlanGeometry.of1d(nx, type, batch)));
     }
     private static native int cufftMakePlan1dNative(
         cufftHandle plan, int nx, int type,
@@ -381,7 +1551,8 @@ public class JCufft
         cufftHandle plan, int nx, int ny, int type,
         long workSize[])
     {
-        return checkResult(cufftMakePlan2dNative(plan, nx, ny, type, workSize));
+        return planCreated(plan, checkResult(cufftMakePlan2dNative(plan, nx, ny, type, workSize)), workSize[0],
+            PlanWarmup.geometry(() -> PlanGeometry.of2d(nx, ny, type)));
     }
     private static native int cufftMakePlan2dNative(
         cufftHandle plan, int nx, int ny, int type,
@@ -393,7 +1564,8 @@ public class JCufft
         cufftHandle plan, int nx, int ny, int nz, int type,
         long workSize[])
     {
-        return checkResult(cufftMakePlan3dNative(plan, nx, ny, nz, type, workSize));
+        return planCreated(plan, checkResult(cufftMakePlan3dNative(plan, nx, ny, nz, type, workSize)), workSize[0],
+            PlanWarmup.geometry(() -> PlanGeometry.of3d(nx, ny, nz, type)));
     }
     private static native int cufftMakePlan3dNative(
         cufftHandle plan, int nx, int ny, int nz, int type,
@@ -407,11 +1579,14 @@ public class JCufft
         int onembed[], int ostride, int odist,
         int type, int batch, long workSize[])
     {
-        return checkResult(cufftMakePlanManyNative(
+        return planCreated(plan, checkResult(cufftMakePlanManyNative(
             plan, rank, n,
             inembed, istride, idist,
             onembed, ostride, odist,
-            type, batch, workSize));
+            type, batch, workSize)), workSize[0],
+            PlanWarmup.geometry(() -> PlanGeometry.ofMany(rank, n,
+                inembed, istride, idist, onembed, ostride, odist,
+                type, batch)));
     }
     private static native int cufftMakePlanManyNative(
         cufftHandle plan, int rank, int n[],
@@ -434,11 +1609,14 @@ public class JCufft
         long batch, 
         long workSize[])
     {
-        return checkResult(cufftMakePlanManyNative64(
+        return planCreated(plan, checkResult(cufftMakePlanManyNative64(
             plan, rank, n,
             inembed, istride, idist,
             onembed, ostride, odist,
-            type, batch, workSize));
+            type, batch, workSize)), workSize[0],
+            PlanWarmup.geometry(() -> PlanGeometry.ofMany64(rank, n,
+                inembed, istride, idist, onembed, ostride, odist,
+                type, batch)), true);
     }
     private static native int cufftMakePlanManyNative64(
         cufftHandle plan, 
@@ -553,7 +1731,13 @@ public class JCufft
 
     public static int cufftCreate(cufftHandle cufftHandle)
     {
-        return checkResult(cufftCreateNative(cufftHandle));
+        ensureStarted();
+        int result = checkResult(cufftCreateNative(cufftHandle));
+        if (result == cufftResult.CUFFT_SUCCESS)
+        {
+            cufftHandle.planCreated();
+        }
+        return result;
     }
     private static native int cufftCreateNative(cufftHandle cufftHandle);
 
@@ -632,7 +1816,12 @@ public class JCufft
 
     public static int cufftSetAutoAllocation(cufftHandle plan, int autoAllocate)
     {
-        return checkResult(cufftSetAutoAllocationNative(plan, autoAllocate));
+        int result = checkResult(cufftSetAutoAllocationNative(plan, autoAllocate));
+        if (result == cufftResult.CUFFT_SUCCESS)
+        {
+            plan.setAutoAllocation(autoAllocate != 0);
+        }
+        return result;
     }
     private static native int cufftSetAutoAllocationNative(cufftHandle plan, int autoAllocate);
 
@@ -662,10 +1851,22 @@ public class JCufft
      *
      * JCUFFT_INTERNAL_ERROR If an internal JCufft error occurred
      * <pre>
+     * <br>
+     * If the plan is currently used by another thread, then this waits
+     * until the other thread has finished using it. If it is called by
+     * a thread that is currently using the plan, for example, from a
+     * {@link RangeListener} during an exec call, then the plan is
+     * destroyed when that call returns.
      */
     public static int cufftDestroy(cufftHandle plan)
     {
-        return checkResult(cufftDestroyNative(plan));
+        int result = checkResult(cufftDestroyNative(plan));
+        if (result == cufftResult.CUFFT_SUCCESS)
+        {
+            MemoryBudget.planDestroyed(plan);
+            plan.planDestroyed();
+        }
+        return result;
     }
 
     private static native int cufftDestroyNative(cufftHandle plan);
@@ -773,7 +1974,20 @@ public class JCufft
      */
     public static int cufftExecC2C(cufftHandle plan, Pointer cIdata, Pointer cOdata, int direction)
     {
-        return checkResult(cufftExecC2CNative(plan, cIdata, cOdata, direction));
+        MemoryBudget.Workspace workspace = MemoryBudget.workspaceOf(plan);
+        int result = MemoryBudget.acquireWorkspace(plan, workspace);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            return checkResult(result);
+        }
+        try
+        {
+            return checkResult(cufftExecC2CNative(plan, cIdata, cOdata, direction));
+        }
+        finally
+        {
+            MemoryBudget.releaseWorkspace(workspace);
+        }
     }
     private static native int cufftExecC2CNative(cufftHandle plan, Pointer cIdata, Pointer cOdata, int direction);
 
@@ -790,11 +2004,14 @@ public class JCufft
         int cudaResult = 0;
 
         boolean inPlace = (cIdata == cOdata);
+        long transferSizes[] = transferSizes(plan,
+            (long)cIdata.length * Sizeof.FLOAT,
+            (long)cOdata.length * Sizeof.FLOAT, inPlace);
 
         // Allocate space for the input data on the device
         Pointer hostCIdata = Pointer.to(cIdata);
         Pointer deviceCIdata = new Pointer();
-        cudaResult = JCuda.cudaMalloc(deviceCIdata, cIdata.length * Sizeof.FLOAT);
+        cudaResult = JCuda.cudaMalloc(deviceCIdata, transferSizes[0]);
         if (cudaResult != cudaError.cudaSuccess)
         {
             if (exceptionsEnabled)
@@ -819,7 +2036,7 @@ public class JCufft
         {
             hostCOdata = Pointer.to(cOdata);
             deviceCOdata = new Pointer();
-            cudaResult = JCuda.cudaMalloc(deviceCOdata, cOdata.length * Sizeof.FLOAT);
+            cudaResult = JCuda.cudaMalloc(deviceCOdata, transferSizes[1]);
             if (cudaResult != cudaError.cudaSuccess)
             {
                 JCuda.cudaFree(deviceCIdata);
@@ -832,7 +2049,7 @@ public class JCufft
         }
 
         // Copy the host input data to the device
-        cudaResult = JCuda.cudaMemcpy(deviceCIdata, hostCIdata, cIdata.length * Sizeof.FLOAT, cudaMemcpyKind.cudaMemcpyHostToDevice);
+        cudaResult = memcpy(plan, deviceCIdata, hostCIdata, transferSizes[0], cudaMemcpyKind.cudaMemcpyHostToDevice);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceCIdata);
@@ -873,7 +2090,7 @@ public class JCufft
         }
 
         // Copy the device output data to the host
-        cudaResult = JCuda.cudaMemcpy(hostCOdata, deviceCOdata, cOdata.length * Sizeof.FLOAT, cudaMemcpyKind.cudaMemcpyDeviceToHost);
+        cudaResult = memcpy(plan, hostCOdata, deviceCOdata, transferSizes[1], cudaMemcpyKind.cudaMemcpyDeviceToHost);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceCIdata);
@@ -914,6 +2131,68 @@ public class JCufft
     }
 
 
+    /**
+     * Convenience method for {@link JCufft#cufftExecC2C(cufftHandle, Pointer, Pointer, int)}
+     * for complex data that is stored as separate arrays for the real
+     * and imaginary parts. Accepts arrays for input and output data and
+     * automatically performs the host-device and device-host copies.
+     * The data is interleaved and split natively, during the copies
+     * through page-locked staging memory.
+     *
+     * @param plan The plan
+     * @param reIdata The real parts of the input
+     * @param imIdata The imaginary parts of the input
+     * @param reOdata Will store the real parts of the output
+     * @param imOdata Will store the imaginary parts of the output
+     * @param direction The transform direction
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the arrays for the real and
+     * imaginary parts have different lengths
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecC2C(cufftHandle, Pointer, Pointer, int)
+     */
+    public static int cufftExecC2C(cufftHandle plan,
+        float reIdata[], float imIdata[], float reOdata[], float imOdata[],
+        int direction)
+    {
+        return execSplit(plan, cufftType.CUFFT_C2C,
+            reIdata, imIdata, splitLength(reIdata.length, imIdata.length),
+            reOdata, imOdata, splitLength(reOdata.length, imOdata.length),
+            direction);
+    }
+
+
+    /**
+     * Convenience method for {@link JCufft#cufftExecC2C(cufftHandle, Pointer, Pointer, int)}
+     * for many independent signals of the same length. Each row of the
+     * input contains one signal. The plan must have been created for a
+     * batch size that is equal to the number of rows, where the input
+     * and output distances correspond to the row lengths, for example
+     * with {@link #cufftPlan1d(cufftHandle, int, int, int)}.<br>
+     * <br>
+     * The rows are gathered into page-locked staging memory and copied
+     * to the device with a single copy, the transform is executed with
+     * a single exec call, and the results are scattered back into the
+     * output rows. If the input and output are the same array, then
+     * the transform is done in-place on the device.
+     *
+     * @param plan The plan
+     * @param cIdata The input rows
+     * @param cOdata Will store the output rows
+     * @param direction The transform direction
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the numbers of input and
+     * output rows are different, the rows have different lengths, or
+     * the rows do not match the batch size and distances of the plan
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecC2C(cufftHandle, Pointer, Pointer, int)
+     */
+    public static int cufftExecC2C(cufftHandle plan, float cIdata[][], float cOdata[][], int direction)
+    {
+        return execBatched(plan, cufftType.CUFFT_C2C, cIdata, cOdata, direction);
+    }
+
+
 
     /**
      * <pre>
@@ -951,7 +2230,20 @@ public class JCufft
      */
     public static int cufftExecR2C(cufftHandle plan, Pointer rIdata, Pointer cOdata)
     {
-        return checkResult(cufftExecR2CNative(plan, rIdata, cOdata));
+        MemoryBudget.Workspace workspace = MemoryBudget.workspaceOf(plan);
+        int result = MemoryBudget.acquireWorkspace(plan, workspace);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            return checkResult(result);
+        }
+        try
+        {
+            return checkResult(cufftExecR2CNative(plan, rIdata, cOdata));
+        }
+        finally
+        {
+            MemoryBudget.releaseWorkspace(workspace);
+        }
     }
     private static native int cufftExecR2CNative(cufftHandle plan, Pointer rIdata, Pointer cOdata);
 
@@ -969,11 +2261,14 @@ public class JCufft
         int cudaResult = 0;
 
         boolean inPlace = (rIdata == cOdata);
+        long transferSizes[] = transferSizes(plan,
+            (long)rIdata.length * Sizeof.FLOAT,
+            (long)cOdata.length * Sizeof.FLOAT, inPlace);
 
         // Allocate space for the input data on the device
         Pointer hostRIdata = Pointer.to(rIdata);
         Pointer deviceRIdata = new Pointer();
-        cudaResult = JCuda.cudaMalloc(deviceRIdata, rIdata.length * Sizeof.FLOAT);
+        cudaResult = JCuda.cudaMalloc(deviceRIdata, transferSizes[0]);
         if (cudaResult != cudaError.cudaSuccess)
         {
             if (exceptionsEnabled)
@@ -995,7 +2290,7 @@ public class JCufft
         {
             hostCOdata = Pointer.to(cOdata);
             deviceCOdata = new Pointer();
-            cudaResult = JCuda.cudaMalloc(deviceCOdata, cOdata.length * Sizeof.FLOAT);
+            cudaResult = JCuda.cudaMalloc(deviceCOdata, transferSizes[1]);
             if (cudaResult != cudaError.cudaSuccess)
             {
                 JCuda.cudaFree(deviceCOdata);
@@ -1008,7 +2303,7 @@ public class JCufft
         }
 
         // Copy the host input data to the device
-        cudaResult = JCuda.cudaMemcpy(deviceRIdata, hostRIdata, rIdata.length * Sizeof.FLOAT, cudaMemcpyKind.cudaMemcpyHostToDevice);
+        cudaResult = memcpy(plan, deviceRIdata, hostRIdata, transferSizes[0], cudaMemcpyKind.cudaMemcpyHostToDevice);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceRIdata);
@@ -1048,7 +2343,7 @@ public class JCufft
         }
 
         // Copy the device output data to the host
-        cudaResult = JCuda.cudaMemcpy(hostCOdata, deviceCOdata, cOdata.length * Sizeof.FLOAT, cudaMemcpyKind.cudaMemcpyDeviceToHost);
+        cudaResult = memcpy(plan, hostCOdata, deviceCOdata, transferSizes[1], cudaMemcpyKind.cudaMemcpyDeviceToHost);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceRIdata);
@@ -1089,6 +2384,64 @@ public class JCufft
     }
 
 
+    /**
+     * Convenience method for {@link JCufft#cufftExecR2C(cufftHandle, Pointer, Pointer)}
+     * that stores the output as separate arrays for the real and
+     * imaginary parts. Accepts arrays for input and output data and
+     * automatically performs the host-device and device-host copies.
+     * The output is split natively, during the copy through page-locked
+     * staging memory.
+     *
+     * @param plan The plan
+     * @param rIdata The real input
+     * @param reOdata Will store the real parts of the output
+     * @param imOdata Will store the imaginary parts of the output
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the arrays for the real and
+     * imaginary parts have different lengths
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecR2C(cufftHandle, Pointer, Pointer)
+     */
+    public static int cufftExecR2C(cufftHandle plan,
+        float rIdata[], float reOdata[], float imOdata[])
+    {
+        return execSplit(plan, cufftType.CUFFT_R2C,
+            rIdata, null, rIdata.length,
+            reOdata, imOdata, splitLength(reOdata.length, imOdata.length),
+            CUFFT_FORWARD);
+    }
+
+
+    /**
+     * Convenience method for {@link JCufft#cufftExecR2C(cufftHandle, Pointer, Pointer)}
+     * for many independent signals of the same length. Each row of the
+     * input contains one signal. The plan must have been created for a
+     * batch size that is equal to the number of rows, where the input
+     * and output distances correspond to the row lengths, for example
+     * with {@link #cufftPlan1d(cufftHandle, int, int, int)}.<br>
+     * <br>
+     * The rows are gathered into page-locked staging memory and copied
+     * to the device with a single copy, the transform is executed with
+     * a single exec call, and the results are scattered back into the
+     * output rows. If the input and output are the same array, then
+     * the transform is done in-place on the device.
+     *
+     * @param plan The plan
+     * @param rIdata The input rows
+     * @param cOdata Will store the output rows
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the numbers of input and
+     * output rows are different, the rows have different lengths, or
+     * the rows do not match the batch size and distances of the plan
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecR2C(cufftHandle, Pointer, Pointer)
+     */
+    public static int cufftExecR2C(cufftHandle plan, float rIdata[][], float cOdata[][])
+    {
+        return execBatched(plan, cufftType.CUFFT_R2C, rIdata, cOdata, CUFFT_FORWARD);
+    }
+
+
 
 
 
@@ -1130,7 +2483,20 @@ public class JCufft
      */
     public static int cufftExecC2R(cufftHandle plan, Pointer cIdata, Pointer rOdata)
     {
-        return checkResult(cufftExecC2RNative(plan, cIdata, rOdata));
+        MemoryBudget.Workspace workspace = MemoryBudget.workspaceOf(plan);
+        int result = MemoryBudget.acquireWorkspace(plan, workspace);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            return checkResult(result);
+        }
+        try
+        {
+            return checkResult(cufftExecC2RNative(plan, cIdata, rOdata));
+        }
+        finally
+        {
+            MemoryBudget.releaseWorkspace(workspace);
+        }
     }
     private static native int cufftExecC2RNative(cufftHandle plan, Pointer cIdata, Pointer rOdata);
 
@@ -1148,11 +2514,14 @@ public class JCufft
         int cudaResult = 0;
 
         boolean inPlace = (cIdata == rOdata);
+        long transferSizes[] = transferSizes(plan,
+            (long)cIdata.length * Sizeof.FLOAT,
+            (long)rOdata.length * Sizeof.FLOAT, inPlace);
 
         // Allocate space for the input data on the device
         Pointer hostCIdata = Pointer.to(cIdata);
         Pointer deviceCIdata = new Pointer();
-        cudaResult = JCuda.cudaMalloc(deviceCIdata, cIdata.length * Sizeof.FLOAT);
+        cudaResult = JCuda.cudaMalloc(deviceCIdata, transferSizes[0]);
         if (cudaResult != cudaError.cudaSuccess)
         {
             if (exceptionsEnabled)
@@ -1174,7 +2543,7 @@ public class JCufft
         {
             hostROdata = Pointer.to(rOdata);
             deviceROdata = new Pointer();
-            cudaResult = JCuda.cudaMalloc(deviceROdata, rOdata.length * Sizeof.FLOAT);
+            cudaResult = JCuda.cudaMalloc(deviceROdata, transferSizes[1]);
             if (cudaResult != cudaError.cudaSuccess)
             {
                 JCuda.cudaFree(deviceCIdata);
@@ -1187,7 +2556,7 @@ public class JCufft
         }
 
         // Copy the host input data to the device
-        cudaResult = JCuda.cudaMemcpy(deviceCIdata, hostCIdata, cIdata.length * Sizeof.FLOAT, cudaMemcpyKind.cudaMemcpyHostToDevice);
+        cudaResult = memcpy(plan, deviceCIdata, hostCIdata, transferSizes[0], cudaMemcpyKind.cudaMemcpyHostToDevice);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceCIdata);
@@ -1227,7 +2596,7 @@ public class JCufft
         }
 
         // Copy the device output data to the host
-        cudaResult = JCuda.cudaMemcpy(hostROdata, deviceROdata, rOdata.length * Sizeof.FLOAT, cudaMemcpyKind.cudaMemcpyDeviceToHost);
+        cudaResult = memcpy(plan, hostROdata, deviceROdata, transferSizes[1], cudaMemcpyKind.cudaMemcpyDeviceToHost);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceCIdata);
@@ -1268,6 +2637,64 @@ public class JCufft
     }
 
 
+    /**
+     * Convenience method for {@link JCufft#cufftExecC2R(cufftHandle, Pointer, Pointer)}
+     * that takes the input as separate arrays for the real and
+     * imaginary parts. Accepts arrays for input and output data and
+     * automatically performs the host-device and device-host copies.
+     * The input is interleaved natively, during the copy through
+     * page-locked staging memory.
+     *
+     * @param plan The plan
+     * @param reIdata The real parts of the input
+     * @param imIdata The imaginary parts of the input
+     * @param rOdata Will store the real output
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the arrays for the real and
+     * imaginary parts have different lengths
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecC2R(cufftHandle, Pointer, Pointer)
+     */
+    public static int cufftExecC2R(cufftHandle plan,
+        float reIdata[], float imIdata[], float rOdata[])
+    {
+        return execSplit(plan, cufftType.CUFFT_C2R,
+            reIdata, imIdata, splitLength(reIdata.length, imIdata.length),
+            rOdata, null, rOdata.length,
+            CUFFT_INVERSE);
+    }
+
+
+    /**
+     * Convenience method for {@link JCufft#cufftExecC2R(cufftHandle, Pointer, Pointer)}
+     * for many independent signals of the same length. Each row of the
+     * input contains one signal. The plan must have been created for a
+     * batch size that is equal to the number of rows, where the input
+     * and output distances correspond to the row lengths, for example
+     * with {@link #cufftPlan1d(cufftHandle, int, int, int)}.<br>
+     * <br>
+     * The rows are gathered into page-locked staging memory and copied
+     * to the device with a single copy, the transform is executed with
+     * a single exec call, and the results are scattered back into the
+     * output rows. If the input and output are the same array, then
+     * the transform is done in-place on the device.
+     *
+     * @param plan The plan
+     * @param cIdata The input rows
+     * @param rOdata Will store the output rows
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the numbers of input and
+     * output rows are different, the rows have different lengths, or
+     * the rows do not match the batch size and distances of the plan
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecC2R(cufftHandle, Pointer, Pointer)
+     */
+    public static int cufftExecC2R(cufftHandle plan, float cIdata[][], float rOdata[][])
+    {
+        return execBatched(plan, cufftType.CUFFT_C2R, cIdata, rOdata, CUFFT_INVERSE);
+    }
+
+
 
 
 
@@ -1308,7 +2735,20 @@ public class JCufft
      */
     public static int cufftExecZ2Z(cufftHandle plan, Pointer cIdata, Pointer cOdata, int direction)
     {
-        return checkResult(cufftExecZ2ZNative(plan, cIdata, cOdata, direction));
+        MemoryBudget.Workspace workspace = MemoryBudget.workspaceOf(plan);
+        int result = MemoryBudget.acquireWorkspace(plan, workspace);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            return checkResult(result);
+        }
+        try
+        {
+            return checkResult(cufftExecZ2ZNative(plan, cIdata, cOdata, direction));
+        }
+        finally
+        {
+            MemoryBudget.releaseWorkspace(workspace);
+        }
     }
     private static native int cufftExecZ2ZNative(cufftHandle plan, Pointer cIdata, Pointer cOdata, int direction);
 
@@ -1325,11 +2765,14 @@ public class JCufft
         int cudaResult = 0;
 
         boolean inPlace = (cIdata == cOdata);
+        long transferSizes[] = transferSizes(plan,
+            (long)cIdata.length * Sizeof.DOUBLE,
+            (long)cOdata.length * Sizeof.DOUBLE, inPlace);
 
         // Allocate space for the input data on the device
         Pointer hostCIdata = Pointer.to(cIdata);
         Pointer deviceCIdata = new Pointer();
-        cudaResult = JCuda.cudaMalloc(deviceCIdata, cIdata.length * Sizeof.DOUBLE);
+        cudaResult = JCuda.cudaMalloc(deviceCIdata, transferSizes[0]);
         if (cudaResult != cudaError.cudaSuccess)
         {
             if (exceptionsEnabled)
@@ -1354,7 +2797,7 @@ public class JCufft
         {
             hostCOdata = Pointer.to(cOdata);
             deviceCOdata = new Pointer();
-            cudaResult = JCuda.cudaMalloc(deviceCOdata, cOdata.length * Sizeof.DOUBLE);
+            cudaResult = JCuda.cudaMalloc(deviceCOdata, transferSizes[1]);
             if (cudaResult != cudaError.cudaSuccess)
             {
                 JCuda.cudaFree(deviceCIdata);
@@ -1367,7 +2810,7 @@ public class JCufft
         }
 
         // Copy the host input data to the device
-        cudaResult = JCuda.cudaMemcpy(deviceCIdata, hostCIdata, cIdata.length * Sizeof.DOUBLE, cudaMemcpyKind.cudaMemcpyHostToDevice);
+        cudaResult = memcpy(plan, deviceCIdata, hostCIdata, transferSizes[0], cudaMemcpyKind.cudaMemcpyHostToDevice);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceCIdata);
@@ -1408,7 +2851,7 @@ public class JCufft
         }
 
         // Copy the device output data to the host
-        cudaResult = JCuda.cudaMemcpy(hostCOdata, deviceCOdata, cOdata.length * Sizeof.DOUBLE, cudaMemcpyKind.cudaMemcpyDeviceToHost);
+        cudaResult = memcpy(plan, hostCOdata, deviceCOdata, transferSizes[1], cudaMemcpyKind.cudaMemcpyDeviceToHost);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceCIdata);
@@ -1449,6 +2892,68 @@ public class JCufft
     }
 
 
+    /**
+     * Convenience method for {@link JCufft#cufftExecZ2Z(cufftHandle, Pointer, Pointer, int)}
+     * for complex data that is stored as separate arrays for the real
+     * and imaginary parts. Accepts arrays for input and output data and
+     * automatically performs the host-device and device-host copies.
+     * The data is interleaved and split natively, during the copies
+     * through page-locked staging memory.
+     *
+     * @param plan The plan
+     * @param reIdata The real parts of the input
+     * @param imIdata The imaginary parts of the input
+     * @param reOdata Will store the real parts of the output
+     * @param imOdata Will store the imaginary parts of the output
+     * @param direction The transform direction
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the arrays for the real and
+     * imaginary parts have different lengths
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecZ2Z(cufftHandle, Pointer, Pointer, int)
+     */
+    public static int cufftExecZ2Z(cufftHandle plan,
+        double reIdata[], double imIdata[], double reOdata[], double imOdata[],
+        int direction)
+    {
+        return execSplit(plan, cufftType.CUFFT_Z2Z,
+            reIdata, imIdata, splitLength(reIdata.length, imIdata.length),
+            reOdata, imOdata, splitLength(reOdata.length, imOdata.length),
+            direction);
+    }
+
+
+    /**
+     * Convenience method for {@link JCufft#cufftExecZ2Z(cufftHandle, Pointer, Pointer, int)}
+     * for many independent signals of the same length. Each row of the
+     * input contains one signal. The plan must have been created for a
+     * batch size that is equal to the number of rows, where the input
+     * and output distances correspond to the row lengths, for example
+     * with {@link #cufftPlan1d(cufftHandle, int, int, int)}.<br>
+     * <br>
+     * The rows are gathered into page-locked staging memory and copied
+     * to the device with a single copy, the transform is executed with
+     * a single exec call, and the results are scattered back into the
+     * output rows. If the input and output are the same array, then
+     * the transform is done in-place on the device.
+     *
+     * @param plan The plan
+     * @param cIdata The input rows
+     * @param cOdata Will store the output rows
+     * @param direction The transform direction
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the numbers of input and
+     * output rows are different, the rows have different lengths, or
+     * the rows do not match the batch size and distances of the plan
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecZ2Z(cufftHandle, Pointer, Pointer, int)
+     */
+    public static int cufftExecZ2Z(cufftHandle plan, double cIdata[][], double cOdata[][], int direction)
+    {
+        return execBatched(plan, cufftType.CUFFT_Z2Z, cIdata, cOdata, direction);
+    }
+
+
 
     /**
      * <pre>
@@ -1487,7 +2992,20 @@ public class JCufft
      */
     public static int cufftExecD2Z(cufftHandle plan, Pointer rIdata, Pointer cOdata)
     {
-        return checkResult(cufftExecD2ZNative(plan, rIdata, cOdata));
+        MemoryBudget.Workspace workspace = MemoryBudget.workspaceOf(plan);
+        int result = MemoryBudget.acquireWorkspace(plan, workspace);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            return checkResult(result);
+        }
+        try
+        {
+            return checkResult(cufftExecD2ZNative(plan, rIdata, cOdata));
+        }
+        finally
+        {
+            MemoryBudget.releaseWorkspace(workspace);
+        }
     }
     private static native int cufftExecD2ZNative(cufftHandle plan, Pointer rIdata, Pointer cOdata);
 
@@ -1505,11 +3023,14 @@ public class JCufft
         int cudaResult = 0;
 
         boolean inPlace = (rIdata == cOdata);
+        long transferSizes[] = transferSizes(plan,
+            (long)rIdata.length * Sizeof.DOUBLE,
+            (long)cOdata.length * Sizeof.DOUBLE, inPlace);
 
         // Allocate space for the input data on the device
         Pointer hostRIdata = Pointer.to(rIdata);
         Pointer deviceRIdata = new Pointer();
-        cudaResult = JCuda.cudaMalloc(deviceRIdata, rIdata.length * Sizeof.DOUBLE);
+        cudaResult = JCuda.cudaMalloc(deviceRIdata, transferSizes[0]);
         if (cudaResult != cudaError.cudaSuccess)
         {
             if (exceptionsEnabled)
@@ -1531,7 +3052,7 @@ public class JCufft
         {
             hostCOdata = Pointer.to(cOdata);
             deviceCOdata = new Pointer();
-            cudaResult = JCuda.cudaMalloc(deviceCOdata, cOdata.length * Sizeof.DOUBLE);
+            cudaResult = JCuda.cudaMalloc(deviceCOdata, transferSizes[1]);
             if (cudaResult != cudaError.cudaSuccess)
             {
                 JCuda.cudaFree(deviceCOdata);
@@ -1544,7 +3065,7 @@ public class JCufft
         }
 
         // Copy the host input data to the device
-        cudaResult = JCuda.cudaMemcpy(deviceRIdata, hostRIdata, rIdata.length * Sizeof.DOUBLE, cudaMemcpyKind.cudaMemcpyHostToDevice);
+        cudaResult = memcpy(plan, deviceRIdata, hostRIdata, transferSizes[0], cudaMemcpyKind.cudaMemcpyHostToDevice);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceRIdata);
@@ -1584,7 +3105,7 @@ public class JCufft
         }
 
         // Copy the device output data to the host
-        cudaResult = JCuda.cudaMemcpy(hostCOdata, deviceCOdata, cOdata.length * Sizeof.DOUBLE, cudaMemcpyKind.cudaMemcpyDeviceToHost);
+        cudaResult = memcpy(plan, hostCOdata, deviceCOdata, transferSizes[1], cudaMemcpyKind.cudaMemcpyDeviceToHost);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceRIdata);
@@ -1625,6 +3146,64 @@ public class JCufft
     }
 
 
+    /**
+     * Convenience method for {@link JCufft#cufftExecD2Z(cufftHandle, Pointer, Pointer)}
+     * that stores the output as separate arrays for the real and
+     * imaginary parts. Accepts arrays for input and output data and
+     * automatically performs the host-device and device-host copies.
+     * The output is split natively, during the copy through page-locked
+     * staging memory.
+     *
+     * @param plan The plan
+     * @param rIdata The real input
+     * @param reOdata Will store the real parts of the output
+     * @param imOdata Will store the imaginary parts of the output
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the arrays for the real and
+     * imaginary parts have different lengths
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecD2Z(cufftHandle, Pointer, Pointer)
+     */
+    public static int cufftExecD2Z(cufftHandle plan,
+        double rIdata[], double reOdata[], double imOdata[])
+    {
+        return execSplit(plan, cufftType.CUFFT_D2Z,
+            rIdata, null, rIdata.length,
+            reOdata, imOdata, splitLength(reOdata.length, imOdata.length),
+            CUFFT_FORWARD);
+    }
+
+
+    /**
+     * Convenience method for {@link JCufft#cufftExecD2Z(cufftHandle, Pointer, Pointer)}
+     * for many independent signals of the same length. Each row of the
+     * input contains one signal. The plan must have been created for a
+     * batch size that is equal to the number of rows, where the input
+     * and output distances correspond to the row lengths, for example
+     * with {@link #cufftPlan1d(cufftHandle, int, int, int)}.<br>
+     * <br>
+     * The rows are gathered into page-locked staging memory and copied
+     * to the device with a single copy, the transform is executed with
+     * a single exec call, and the results are scattered back into the
+     * output rows. If the input and output are the same array, then
+     * the transform is done in-place on the device.
+     *
+     * @param plan The plan
+     * @param rIdata The input rows
+     * @param cOdata Will store the output rows
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the numbers of input and
+     * output rows are different, the rows have different lengths, or
+     * the rows do not match the batch size and distances of the plan
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecD2Z(cufftHandle, Pointer, Pointer)
+     */
+    public static int cufftExecD2Z(cufftHandle plan, double rIdata[][], double cOdata[][])
+    {
+        return execBatched(plan, cufftType.CUFFT_D2Z, rIdata, cOdata, CUFFT_FORWARD);
+    }
+
+
 
 
 
@@ -1664,7 +3243,20 @@ public class JCufft
      */
     public static int cufftExecZ2D(cufftHandle plan, Pointer cIdata, Pointer rOdata)
     {
-        return checkResult(cufftExecZ2DNative(plan, cIdata, rOdata));
+        MemoryBudget.Workspace workspace = MemoryBudget.workspaceOf(plan);
+        int result = MemoryBudget.acquireWorkspace(plan, workspace);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            return checkResult(result);
+        }
+        try
+        {
+            return checkResult(cufftExecZ2DNative(plan, cIdata, rOdata));
+        }
+        finally
+        {
+            MemoryBudget.releaseWorkspace(workspace);
+        }
     }
     private static native int cufftExecZ2DNative(cufftHandle plan, Pointer cIdata, Pointer rOdata);
 
@@ -1682,11 +3274,14 @@ public class JCufft
         int cudaResult = 0;
 
         boolean inPlace = (cIdata == rOdata);
+        long transferSizes[] = transferSizes(plan,
+            (long)cIdata.length * Sizeof.DOUBLE,
+            (long)rOdata.length * Sizeof.DOUBLE, inPlace);
 
         // Allocate space for the input data on the device
         Pointer hostCIdata = Pointer.to(cIdata);
         Pointer deviceCIdata = new Pointer();
-        cudaResult = JCuda.cudaMalloc(deviceCIdata, cIdata.length * Sizeof.DOUBLE);
+        cudaResult = JCuda.cudaMalloc(deviceCIdata, transferSizes[0]);
         if (cudaResult != cudaError.cudaSuccess)
         {
             if (exceptionsEnabled)
@@ -1708,7 +3303,7 @@ public class JCufft
         {
             hostROdata = Pointer.to(rOdata);
             deviceROdata = new Pointer();
-            cudaResult = JCuda.cudaMalloc(deviceROdata, rOdata.length * Sizeof.DOUBLE);
+            cudaResult = JCuda.cudaMalloc(deviceROdata, transferSizes[1]);
             if (cudaResult != cudaError.cudaSuccess)
             {
                 JCuda.cudaFree(deviceCIdata);
@@ -1721,7 +3316,7 @@ public class JCufft
         }
 
         // Copy the host input data to the device
-        cudaResult = JCuda.cudaMemcpy(deviceCIdata, hostCIdata, cIdata.length * Sizeof.DOUBLE, cudaMemcpyKind.cudaMemcpyHostToDevice);
+        cudaResult = memcpy(plan, deviceCIdata, hostCIdata, transferSizes[0], cudaMemcpyKind.cudaMemcpyHostToDevice);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceCIdata);
@@ -1761,7 +3356,7 @@ public class JCufft
         }
 
         // Copy the device output data to the host
-        cudaResult = JCuda.cudaMemcpy(hostROdata, deviceROdata, rOdata.length * Sizeof.DOUBLE, cudaMemcpyKind.cudaMemcpyDeviceToHost);
+        cudaResult = memcpy(plan, hostROdata, deviceROdata, transferSizes[1], cudaMemcpyKind.cudaMemcpyDeviceToHost);
         if (cudaResult != cudaError.cudaSuccess)
         {
             JCuda.cudaFree(deviceCIdata);
@@ -1801,6 +3396,64 @@ public class JCufft
         return result;
     }
 
+
+    /**
+     * Convenience method for {@link JCufft#cufftExecZ2D(cufftHandle, Pointer, Pointer)}
+     * that takes the input as separate arrays for the real and
+     * imaginary parts. Accepts arrays for input and output data and
+     * automatically performs the host-device and device-host copies.
+     * The input is interleaved natively, during the copy through
+     * page-locked staging memory.
+     *
+     * @param plan The plan
+     * @param reIdata The real parts of the input
+     * @param imIdata The imaginary parts of the input
+     * @param rOdata Will store the real output
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the arrays for the real and
+     * imaginary parts have different lengths
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecZ2D(cufftHandle, Pointer, Pointer)
+     */
+    public static int cufftExecZ2D(cufftHandle plan,
+        double reIdata[], double imIdata[], double rOdata[])
+    {
+        return execSplit(plan, cufftType.CUFFT_Z2D,
+            reIdata, imIdata, splitLength(reIdata.length, imIdata.length),
+            rOdata, null, rOdata.length,
+            CUFFT_INVERSE);
+    }
+
+
+    /**
+     * Convenience method for {@link JCufft#cufftExecZ2D(cufftHandle, Pointer, Pointer)}
+     * for many independent signals of the same length. Each row of the
+     * input contains one signal. The plan must have been created for a
+     * batch size that is equal to the number of rows, where the input
+     * and output distances correspond to the row lengths, for example
+     * with {@link #cufftPlan1d(cufftHandle, int, int, int)}.<br>
+     * <br>
+     * The rows are gathered into page-locked staging memory and copied
+     * to the device with a single copy, the transform is executed with
+     * a single exec call, and the results are scattered back into the
+     * output rows. If the input and output are the same array, then
+     * the transform is done in-place on the device.
+     *
+     * @param plan The plan
+     * @param cIdata The input rows
+     * @param rOdata Will store the output rows
+     * @return The cufftResult code
+     * @throws IllegalArgumentException If the numbers of input and
+     * output rows are different, the rows have different lengths, or
+     * the rows do not match the batch size and distances of the plan
+     *
+     * @see jcuda.jcufft.JCufft#cufftExecZ2D(cufftHandle, Pointer, Pointer)
+     */
+    public static int cufftExecZ2D(cufftHandle plan, double cIdata[][], double rOdata[][])
+    {
+        return execBatched(plan, cufftType.CUFFT_Z2D, cIdata, rOdata, CUFFT_INVERSE);
+    }
+
 }
 
 
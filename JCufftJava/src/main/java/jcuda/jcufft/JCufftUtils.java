@@ -0,0 +1,137 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import jcuda.CudaException;
+import jcuda.Pointer;
+import jcuda.Sizeof;
+import jcuda.runtime.cudaError;
+
+/**
+ * Package-private utility methods shared by the JCufft helper classes
+ */
+class JCufftUtils
+{
+    /**
+     * Throws a CudaException if the given CUDA runtime result is not
+     * cudaError.cudaSuccess
+     *
+     * @param cudaResult The result of a JCuda runtime call
+     * @throws CudaException If the result indicates an error
+     */
+    static void checkCuda(int cudaResult)
+    {
+        if (cudaResult != cudaError.cudaSuccess)
+        {
+            throw new CudaException(
+                "JCuda error: "+cudaError.stringFor(cudaResult));
+        }
+    }
+
+    /**
+     * Throws a CudaException if the given result is not
+     * cufftResult.CUFFT_SUCCESS
+     *
+     * @param result The cufftResult
+     * @throws CudaException If the result indicates an error
+     */
+    static void checkCufft(int result)
+    {
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            throw new CudaException(cufftResult.stringFor(result));
+        }
+    }
+
+    /**
+     * Returns whether the given cufftType is a double precision type
+     *
+     * @param type The cufftType
+     * @return Whether the type is CUFFT_D2Z, CUFFT_Z2D or CUFFT_Z2Z
+     */
+    static boolean isDoublePrecision(int type)
+    {
+        return
+            type == cufftType.CUFFT_D2Z ||
+            type == cufftType.CUFFT_Z2D ||
+            type == cufftType.CUFFT_Z2Z;
+    }
+
+    /**
+     * Returns the size of a single real value for the given cufftType,
+     * in bytes
+     *
+     * @param type The cufftType
+     * @return The size of a float or double value
+     */
+    static int elementSize(int type)
+    {
+        return isDoublePrecision(type) ? Sizeof.DOUBLE : Sizeof.FLOAT;
+    }
+
+    /**
+     * Executes the given plan with the exec function that corresponds
+     * to the given cufftType. The direction is ignored for real
+     * transforms.
+     *
+     * @param plan The plan
+     * @param type The cufftType of the plan
+     * @param idata The input data, in device memory
+     * @param odata The output data, in device memory
+     * @param direction The direction, for complex-to-complex transforms
+     * @return The cufftResult
+     */
+    static int exec(cufftHandle plan, int type,
+        Pointer idata, Pointer odata, int direction)
+    {
+        switch (type)
+        {
+            case cufftType.CUFFT_C2C:
+                return JCufft.cufftExecC2C(plan, idata, odata, direction);
+            case cufftType.CUFFT_R2C:
+                return JCufft.cufftExecR2C(plan, idata, odata);
+            case cufftType.CUFFT_C2R:
+                return JCufft.cufftExecC2R(plan, idata, odata);
+            case cufftType.CUFFT_Z2Z:
+                return JCufft.cufftExecZ2Z(plan, idata, odata, direction);
+            case cufftType.CUFFT_D2Z:
+                return JCufft.cufftExecD2Z(plan, idata, odata);
+            case cufftType.CUFFT_Z2D:
+                return JCufft.cufftExecZ2D(plan, idata, odata);
+        }
+        return cufftResult.CUFFT_INVALID_TYPE;
+    }
+
+    /**
+     * Private constructor to prevent instantiation.
+     */
+    private JCufftUtils()
+    {
+    }
+}
@@ -0,0 +1,229 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicLongArray;
+
+/**
+ * A histogram for latency values, in nanoseconds.<br>
+ * <br>
+ * Values are counted in log-linear buckets: Each power of two is
+ * divided into a fixed number of linear sub-buckets, so that the
+ * relative error of a reported percentile is bounded (about 3%),
+ * independent of the magnitude of the values. Recording a value is
+ * lock-free and does not allocate memory, so that it may be used
+ * on latency-critical paths and from multiple threads.
+ */
+public class LatencyHistogram
+{
+    /**
+     * The number of bits for the linear sub-buckets
+     */
+    private static final int SUB_BUCKET_BITS = 5;
+
+    /**
+     * The number of linear sub-buckets per power of two
+     */
+    private static final int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+    /**
+     * The counts of all buckets
+     */
+    private final AtomicLongArray counts;
+
+    /**
+     * The total number of recorded values
+     */
+    private final AtomicLong totalCount = new AtomicLong();
+
+    /**
+     * The sum of all recorded values
+     */
+    private final AtomicLong totalSum = new AtomicLong();
+
+    /**
+     * The maximum recorded value
+     */
+    private final AtomicLong maxValue = new AtomicLong();
+
+    /**
+     * Creates a new, empty histogram
+     */
+    public LatencyHistogram()
+    {
+        counts = new AtomicLongArray((64 - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT);
+    }
+
+    /**
+     * Record the given value. Negative values are counted as 0.
+     *
+     * @param value The value, in nanoseconds
+     */
+    public void record(long value)
+    {
+        long v = Math.max(0, value);
+        counts.incrementAndGet(bucketIndex(v));
+        totalCount.incrementAndGet();
+        totalSum.addAndGet(v);
+        long max = maxValue.get();
+        while (v > max && !maxValue.compareAndSet(max, v))
+        {
+            max = maxValue.get();
+        }
+    }
+
+    /**
+     * Returns the number of recorded values
+     *
+     * @return The number of recorded values
+     */
+    public long getCount()
+    {
+        return totalCount.get();
+    }
+
+    /**
+     * Returns the maximum recorded value
+     *
+     * @return The maximum value, in nanoseconds
+     */
+    public long getMax()
+    {
+        return maxValue.get();
+    }
+
+    /**
+     * Returns the mean of the recorded values, or 0 if no
+     * values have been recorded
+     *
+     * @return The mean value, in nanoseconds
+     */
+    public double getMean()
+    {
+        long count = totalCount.get();
+        if (count == 0)
+        {
+            return 0;
+        }
+        return (double)totalSum.get() / count;
+    }
+
+    /**
+     * Returns the value at the given percentile. This is the upper
+     * bound of the bucket that contains the requested percentile,
+     * or 0 if no values have been recorded.
+     *
+     * @param percentile The percentile, in [0, 100]
+     * @return The value, in nanoseconds
+     */
+    public long getPercentile(double percentile)
+    {
+        long count = totalCount.get();
+        if (count == 0)
+        {
+            return 0;
+        }
+        double p = Math.min(100.0, Math.max(0.0, percentile));
+        long target = Math.max(1, (long)Math.ceil(p / 100.0 * count));
+        long cumulative = 0;
+        for (int i = 0; i < counts.length(); i++)
+        {
+            cumulative += counts.get(i);
+            if (cumulative >= target)
+            {
+                return Math.min(bucketUpperBound(i), maxValue.get());
+            }
+        }
+        return maxValue.get();
+    }
+
+    /**
+     * Reset this histogram. This should not be called while other
+     * threads are recording values.
+     */
+    public void reset()
+    {
+        for (int i = 0; i < counts.length(); i++)
+        {
+            counts.set(i, 0);
+        }
+        totalCount.set(0);
+        totalSum.set(0);
+        maxValue.set(0);
+    }
+
+    /**
+     * Returns the index of the bucket for the given non-negative value
+     *
+     * @param value The value
+     * @return The bucket index
+     */
+    private static int bucketIndex(long value)
+    {
+        if (value < SUB_BUCKET_COUNT)
+        {
+            return (int)value;
+        }
+        int exponent = 63 - Long.numberOfLeadingZeros(value);
+        int shift = exponent - SUB_BUCKET_BITS;
+        int subBucket = (int)(value >>> shift) - SUB_BUCKET_COUNT;
+        return ((shift + 1) << SUB_BUCKET_BITS) + subBucket;
+    }
+
+    /**
+     * Returns the largest value that falls into the bucket with
+     * the given index
+     *
+     * @param index The bucket index
+     * @return The upper bound of the bucket
+     */
+    private static long bucketUpperBound(int index)
+    {
+        if (index < SUB_BUCKET_COUNT)
+        {
+            return index;
+        }
+        int shift = (index >>> SUB_BUCKET_BITS) - 1;
+        long subBucket = index & (SUB_BUCKET_COUNT - 1);
+        long lower = (SUB_BUCKET_COUNT + subBucket) << shift;
+        return lower + (1L << shift) - 1;
+    }
+
+    @Override
+    public String toString()
+    {
+        return "LatencyHistogram[count=" + getCount() +
+            ",mean=" + (long)getMean() +
+            ",p50=" + getPercentile(50) +
+            ",p99=" + getPercentile(99) +
+            ",p99.9=" + getPercentile(99.9) +
+            ",max=" + getMax() + "]";
+    }
+}
@@ -0,0 +1,828 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Locale;
+import java.util.Properties;
+import java.util.logging.Level;
+import java.util.logging.Logger;
+
+import jcuda.CudaException;
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaDeviceProp;
+import jcuda.runtime.cudaEvent_t;
+import jcuda.runtime.cudaMemcpyKind;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * A tuner for the data layout of batched multi-dimensional transforms.<br>
+ * <br>
+ * The speed of a batched transform that is created with
+ * <code>cufftMakePlanMany</code> depends on whether the batches are
+ * stored {@link Layout#CONTIGUOUS contiguously} or
+ * {@link Layout#INTERLEAVED interleaved}, and on whether the batch is
+ * computed with a single plan or split into several executions of a
+ * plan for a smaller batch. The {@link #tune(int, long[], int, long)}
+ * method benchmarks these candidates for a logical transform on the
+ * current device, and returns a {@link TunedPlan} for the fastest one.
+ * The caller must store the data in the {@link TunedPlan#getLayout()
+ * layout of the tuned plan}, or convert it with
+ * {@link TunedPlan#toInputLayout} and {@link TunedPlan#fromOutputLayout},
+ * which transpose the data on the device.<br>
+ * <br>
+ * The results of the benchmarks are stored in a properties file, so
+ * that each logical transform is only benchmarked once per device.
+ * The file is given by the system property <code>jcufft.layouts</code>,
+ * and defaults to <code>.jcufft/layouts.properties</code> in the home
+ * directory of the user. It may be changed with
+ * {@link #setPersistenceFile(File)}.
+ */
+public final class LayoutTuner
+{
+    /**
+     * The logger used in this class
+     */
+    private static final Logger logger =
+        Logger.getLogger(LayoutTuner.class.getName());
+
+    /**
+     * The data layout of a batched transform
+     */
+    public enum Layout
+    {
+        /**
+         * The elements of each batch are stored contiguously, and the
+         * batches are stored one after another. This corresponds to a
+         * stride of 1 and a distance of the number of elements of one
+         * transform.
+         */
+        CONTIGUOUS,
+
+        /**
+         * The i-th elements of all batches are stored contiguously.
+         * This corresponds to a stride of the batch size and a
+         * distance of 1.
+         */
+        INTERLEAVED
+    }
+
+    /**
+     * The number of executions before the measurement of a candidate
+     */
+    private static final int WARMUP_RUNS = 1;
+
+    /**
+     * The number of measured executions of a candidate
+     */
+    private static final int MEASURED_RUNS = 5;
+
+    /**
+     * The maximum number of executions that a batch may be split into
+     */
+    private static final int MAX_SPLIT = 8;
+
+    /**
+     * The file that the tuning results are stored in, or
+     * <code>null</code> if they are not persisted
+     */
+    private static File persistenceFile = defaultPersistenceFile();
+
+    /**
+     * The tuning results, or <code>null</code> if they have not been
+     * read yet
+     */
+    private static Properties results = null;
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private LayoutTuner()
+    {
+    }
+
+    /**
+     * A plan for a logical batched transform, together with the layout
+     * and the batch split that have been chosen by the tuner
+     */
+    public static final class TunedPlan implements AutoCloseable
+    {
+        /**
+         * The plan, for one part of the batch
+         */
+        private final cufftHandle plan;
+
+        /**
+         * The geometry of the plan
+         */
+        private final PlanGeometry geometry;
+
+        /**
+         * The layout
+         */
+        private final Layout layout;
+
+        /**
+         * The total batch size
+         */
+        private final long batch;
+
+        /**
+         * The batch size of the plan
+         */
+        private final long subBatch;
+
+        /**
+         * The number of input elements of one transform
+         */
+        private final long inputElements;
+
+        /**
+         * The number of output elements of one transform
+         */
+        private final long outputElements;
+
+        /**
+         * Creates a new tuned plan
+         *
+         * @param plan The plan
+         * @param candidate The candidate
+         */
+        TunedPlan(cufftHandle plan, Candidate candidate)
+        {
+            this.plan = plan;
+            this.geometry = candidate.geometry;
+            this.layout = candidate.layout;
+            this.batch = candidate.batch;
+            this.subBatch = candidate.geometry.getBatch();
+            this.inputElements = candidate.inputElements;
+            this.outputElements = candidate.outputElements;
+        }
+
+        /**
+         * Returns the plan. It computes the transforms of
+         * {@link #getSubBatch()} batches.
+         *
+         * @return The plan
+         */
+        public cufftHandle getPlan()
+        {
+            return plan;
+        }
+
+        /**
+         * Returns the geometry of the plan
+         *
+         * @return The geometry
+         */
+        public PlanGeometry getGeometry()
+        {
+            return geometry;
+        }
+
+        /**
+         * Returns the layout that the input and output data must have
+         *
+         * @return The layout
+         */
+        public Layout getLayout()
+        {
+            return layout;
+        }
+
+        /**
+         * Returns the total batch size
+         *
+         * @return The batch size
+         */
+        public long getBatch()
+        {
+            return batch;
+        }
+
+        /**
+         * Returns the batch size of the plan
+         *
+         * @return The batch size of the plan
+         */
+        public long getSubBatch()
+        {
+            return subBatch;
+        }
+
+        /**
+         * Returns the number of executions of the plan that are required
+         * for the total batch
+         *
+         * @return The number of executions
+         */
+        public long getExecutionCount()
+        {
+            return batch / subBatch;
+        }
+
+        /**
+         * Executes the transforms of the total batch. The input and
+         * output data must be stored in the {@link #getLayout() layout}
+         * of this plan.
+         *
+         * @param idata The input data, in device memory
+         * @param odata The output data, in device memory
+         * @param direction The direction, for complex-to-complex
+         * transforms
+         * @return The cufftResult
+         */
+        public int exec(Pointer idata, Pointer odata, int direction)
+        {
+            int type = geometry.getType();
+            long inputStep = geometry.getInputElementSize() *
+                (layout == Layout.CONTIGUOUS ?
+                    subBatch * inputElements : subBatch);
+            long outputStep = geometry.getOutputElementSize() *
+                (layout == Layout.CONTIGUOUS ?
+                    subBatch * outputElements : subBatch);
+            for (long i = 0; i < getExecutionCount(); i++)
+            {
+                int result = JCufftUtils.exec(plan, type,
+                    idata.withByteOffset(i * inputStep),
+                    odata.withByteOffset(i * outputStep), direction);
+                if (result != cufftResult.CUFFT_SUCCESS)
+                {
+                    return result;
+                }
+            }
+            return cufftResult.CUFFT_SUCCESS;
+        }
+
+        /**
+         * Converts input data from the given layout into the layout of
+         * this plan, asynchronously in the given stream
+         *
+         * @param src The source, in device memory
+         * @param srcLayout The layout of the source
+         * @param dst The destination, in device memory. It must not
+         * overlap the source.
+         * @param stream The stream, or <code>null</code> for the default
+         * stream
+         * @throws CudaException If the conversion fails
+         */
+        public void toInputLayout(Pointer src, Layout srcLayout,
+            Pointer dst, cudaStream_t stream)
+        {
+            convert(src, srcLayout, dst, layout, inputElements, batch,
+                geometry.getInputElementSize(), stream);
+        }
+
+        /**
+         * Converts output data from the layout of this plan into the
+         * given layout, asynchronously in the given stream
+         *
+         * @param src The source, in device memory
+         * @param dst The destination, in device memory. It must not
+         * overlap the source.
+         * @param dstLayout The layout of the destination
+         * @param stream The stream, or <code>null</code> for the default
+         * stream
+         * @throws CudaException If the conversion fails
+         */
+        public void fromOutputLayout(Pointer src,
+            Pointer dst, Layout dstLayout, cudaStream_t stream)
+        {
+            convert(src, layout, dst, dstLayout, outputElements, batch,
+                geometry.getOutputElementSize(), stream);
+        }
+
+        /**
+         * Destroys the plan
+         */
+        @Override
+        public void close()
+        {
+            plan.close();
+        }
+
+        @Override
+        public String toString()
+        {
+            return "TunedPlan[layout=" + layout + ",batch=" + batch +
+                ",subBatch=" + subBatch + ",geometry=" + geometry + "]";
+        }
+    }
+
+    /**
+     * A candidate layout and batch split
+     */
+    private static final class Candidate
+    {
+        /**
+         * The layout
+         */
+        final Layout layout;
+
+        /**
+         * The total batch size
+         */
+        final long batch;
+
+        /**
+         * The number of input elements of one transform
+         */
+        final long inputElements;
+
+        /**
+         * The number of output elements of one transform
+         */
+        final long outputElements;
+
+        /**
+         * The geometry of the plan for one part of the batch
+         */
+        final PlanGeometry geometry;
+
+        /**
+         * Creates a new candidate
+         *
+         * @param rank The rank
+         * @param n The sizes
+         * @param type The cufftType
+         * @param batch The total batch size
+         * @param layout The layout
+         * @param subBatch The batch size of the plan
+         */
+        Candidate(int rank, long n[], int type, long batch,
+            Layout layout, long subBatch)
+        {
+            this.layout = layout;
+            this.batch = batch;
+            long inembed[] = n.clone();
+            long onembed[] = n.clone();
+            if (type == cufftType.CUFFT_R2C || type == cufftType.CUFFT_D2Z)
+            {
+                onembed[rank - 1] = n[rank - 1] / 2 + 1;
+            }
+            if (type == cufftType.CUFFT_C2R || type == cufftType.CUFFT_Z2D)
+            {
+                inembed[rank - 1] = n[rank - 1] / 2 + 1;
+            }
+            this.inputElements = product(inembed);
+            this.outputElements = product(onembed);
+            if (layout == Layout.CONTIGUOUS)
+            {
+                this.geometry = PlanGeometry.ofMany64(rank, n.clone(),
+                    inembed, 1, inputElements, onembed, 1, outputElements,
+                    type, subBatch);
+            }
+            else
+            {
+                this.geometry = PlanGeometry.ofMany64(rank, n.clone(),
+                    inembed, batch, 1, onembed, batch, 1,
+                    type, subBatch);
+            }
+        }
+
+        /**
+         * Returns the value that describes this candidate in the
+         * tuning results
+         *
+         * @return The value
+         */
+        String value()
+        {
+            return layout + "," + geometry.getBatch();
+        }
+    }
+
+    /**
+     * Returns a plan for the given logical batched transform, using the
+     * fastest layout and batch split on the current device. If the
+     * transform has not been tuned on this device yet, all candidates
+     * are benchmarked, and the result is stored in the persistence file.
+     * The benchmark allocates device memory for the input and output
+     * data of the whole batch.
+     *
+     * @param rank The rank, 1, 2 or 3
+     * @param n The size of each dimension
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The tuned plan
+     * @throws IllegalArgumentException If the parameters are not valid
+     * @throws CudaException If no candidate could be created
+     */
+    public static TunedPlan tune(int rank, long n[], int type, long batch)
+    {
+        if (rank < 1 || rank > 3 || n == null || n.length < rank)
+        {
+            throw new IllegalArgumentException(
+                "Invalid rank or sizes for tuning: " + rank);
+        }
+        if (batch <= 0)
+        {
+            throw new IllegalArgumentException(
+                "The batch size must be positive, but is " + batch);
+        }
+        long sizes[] = new long[rank];
+        System.arraycopy(n, 0, sizes, 0, rank);
+
+        String key = key(sizes, type, batch);
+        Candidate best = lookup(key, rank, sizes, type, batch);
+        if (best == null)
+        {
+            best = PlanWarmup.uncounted(() -> benchmark(rank, sizes, type, batch));
+            store(key, best);
+        }
+        cufftHandle plan = new cufftHandle();
+        JCufftUtils.checkCufft(best.geometry.createPlan(plan));
+        return new TunedPlan(plan, best);
+    }
+
+    /**
+     * Converts the given batched data from one layout into another,
+     * asynchronously in the given stream. Converting between the
+     * contiguous and the interleaved layout is a transpose, which is
+     * done with a tiled transpose kernel.
+     *
+     * @param src The source, in device memory
+     * @param srcLayout The layout of the source
+     * @param dst The destination, in device memory. It must not overlap
+     * the source.
+     * @param dstLayout The layout of the destination
+     * @param elements The number of elements of one batch
+     * @param batch The batch size
+     * @param elementSize The size of one element, which must be 4, 8 or
+     * 16 bytes
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @throws CudaException If the conversion fails
+     */
+    public static void convert(Pointer src, Layout srcLayout,
+        Pointer dst, Layout dstLayout, long elements, long batch,
+        int elementSize, cudaStream_t stream)
+    {
+        if (srcLayout == dstLayout)
+        {
+            checkCuda(JCuda.cudaMemcpyAsync(dst, src,
+                elements * batch * elementSize,
+                cudaMemcpyKind.cudaMemcpyDeviceToDevice, stream));
+        }
+        else if (srcLayout == Layout.CONTIGUOUS)
+        {
+            checkCuda(JCufft.transpose(
+                src, dst, 1, batch, elements, elementSize, stream));
+        }
+        else
+        {
+            checkCuda(JCufft.transpose(
+                src, dst, 1, elements, batch, elementSize, stream));
+        }
+    }
+
+    /**
+     * Set the file that the tuning results are stored in. The results
+     * are read from this file when the next transform is tuned.
+     *
+     * @param file The file, or <code>null</code> if the results should
+     * not be persisted
+     */
+    public static synchronized void setPersistenceFile(File file)
+    {
+        persistenceFile = file;
+        results = null;
+    }
+
+    /**
+     * Returns the file that the tuning results are stored in
+     *
+     * @return The file, or <code>null</code>
+     */
+    public static synchronized File getPersistenceFile()
+    {
+        return persistenceFile;
+    }
+
+    /**
+     * Returns the default persistence file
+     *
+     * @return The file
+     */
+    private static File defaultPersistenceFile()
+    {
+        String name = System.getProperty("jcufft.layouts");
+        if (name != null)
+        {
+            return new File(name);
+        }
+        return new File(new File(
+            System.getProperty("user.home"), ".jcufft"), "layouts.properties");
+    }
+
+    /**
+     * Benchmarks all candidates for the given transform, and returns
+     * the fastest one
+     *
+     * @param rank The rank
+     * @param n The sizes
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The fastest candidate
+     * @throws CudaException If no candidate could be measured
+     */
+    private static Candidate benchmark(
+        int rank, long n[], int type, long batch)
+    {
+        List<Candidate> candidates = new ArrayList<Candidate>();
+        for (int split = 1; split <= MAX_SPLIT; split *= 2)
+        {
+            if (batch % split != 0)
+            {
+                break;
+            }
+            for (Layout layout : Layout.values())
+            {
+                candidates.add(new Candidate(
+                    rank, n, type, batch, layout, batch / split));
+            }
+        }
+        Candidate first = candidates.get(0);
+        long inputBytes = first.inputElements * batch *
+            first.geometry.getInputElementSize();
+        long outputBytes = first.outputElements * batch *
+            first.geometry.getOutputElementSize();
+        long bufferBytes = inputBytes + outputBytes;
+
+        Pointer input = new Pointer();
+        Pointer output = new Pointer();
+        cudaEvent_t start = new cudaEvent_t();
+        cudaEvent_t stop = new cudaEvent_t();
+        MemoryBudget.reserve(
+            MemoryBudget.Category.POOL, bufferBytes, "LayoutTuner");
+        try
+        {
+            checkCuda(JCuda.cudaMalloc(input, inputBytes));
+            checkCuda(JCuda.cudaMalloc(output, outputBytes));
+            checkCuda(JCuda.cudaMemset(input, 0, inputBytes));
+            checkCuda(JCuda.cudaEventCreate(start));
+            checkCuda(JCuda.cudaEventCreate(stop));
+
+            Candidate best = null;
+            float bestMs = Float.MAX_VALUE;
+            for (Candidate candidate : candidates)
+            {
+                float ms = measure(candidate, input, output, start, stop);
+                logger.fine("Layout " + candidate.value() + " for " +
+                    candidate.geometry + ": " + ms + " ms");
+                if (ms < bestMs)
+                {
+                    bestMs = ms;
+                    best = candidate;
+                }
+            }
+            if (best == null)
+            {
+                throw new CudaException(
+                    "No plan could be created for tuning " + first.geometry);
+            }
+            return best;
+        }
+        finally
+        {
+            JCuda.cudaEventDestroy(start);
+            JCuda.cudaEventDestroy(stop);
+            JCuda.cudaFree(input);
+            JCuda.cudaFree(output);
+            MemoryBudget.release(
+                MemoryBudget.Category.POOL, bufferBytes, "LayoutTuner");
+        }
+    }
+
+    /**
+     * Measures the average time of executing the given candidate for
+     * the total batch
+     *
+     * @param candidate The candidate
+     * @param input The input memory
+     * @param output The output memory
+     * @param start The start event
+     * @param stop The stop event
+     * @return The time in milliseconds, or <code>Float.MAX_VALUE</code>
+     * if the plan could not be created or executed
+     */
+    private static float measure(Candidate candidate,
+        Pointer input, Pointer output, cudaEvent_t start, cudaEvent_t stop)
+    {
+        cufftHandle plan = new cufftHandle();
+        if (candidate.geometry.createPlan(plan) != cufftResult.CUFFT_SUCCESS)
+        {
+            return Float.MAX_VALUE;
+        }
+        TunedPlan tunedPlan = new TunedPlan(plan, candidate);
+        try
+        {
+            for (int i = 0; i < WARMUP_RUNS; i++)
+            {
+                if (tunedPlan.exec(input, output, JCufft.CUFFT_FORWARD) !=
+                    cufftResult.CUFFT_SUCCESS)
+                {
+                    return Float.MAX_VALUE;
+                }
+            }
+            checkCuda(JCuda.cudaEventRecord(start, null));
+            for (int i = 0; i < MEASURED_RUNS; i++)
+            {
+                tunedPlan.exec(input, output, JCufft.CUFFT_FORWARD);
+            }
+            checkCuda(JCuda.cudaEventRecord(stop, null));
+            checkCuda(JCuda.cudaEventSynchronize(stop));
+            float ms[] = { 0.0f };
+            checkCuda(JCuda.cudaEventElapsedTime(ms, start, stop));
+            return ms[0] / MEASURED_RUNS;
+        }
+        finally
+        {
+            tunedPlan.close();
+        }
+    }
+
+    /**
+     * Returns the key for the given transform on the current device
+     *
+     * @param n The sizes
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The key
+     */
+    private static String key(long n[], int type, long batch)
+    {
+        int device[] = { 0 };
+        checkCuda(JCuda.cudaGetDevice(device));
+        cudaDeviceProp prop = new cudaDeviceProp();
+        checkCuda(JCuda.cudaGetDeviceProperties(prop, device[0]));
+        StringBuilder sb = new StringBuilder();
+        sb.append(prop.getName().trim().replace(' ', '_'));
+        sb.append('.').append(cufftType.stringFor(type));
+        sb.append('.');
+        for (int i = 0; i < n.length; i++)
+        {
+            if (i > 0)
+            {
+                sb.append('x');
+            }
+            sb.append(n[i]);
+        }
+        sb.append(".batch").append(batch);
+        return sb.toString().toLowerCase(Locale.ENGLISH);
+    }
+
+    /**
+     * Returns the candidate that has been stored for the given key, or
+     * <code>null</code> if there is no valid result for the key
+     *
+     * @param key The key
+     * @param rank The rank
+     * @param n The sizes
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The candidate
+     */
+    private static synchronized Candidate lookup(
+        String key, int rank, long n[], int type, long batch)
+    {
+        String value = results().getProperty(key);
+        if (value == null)
+        {
+            return null;
+        }
+        String tokens[] = value.split(",");
+        try
+        {
+            Layout layout = Layout.valueOf(tokens[0].trim());
+            long subBatch = Long.parseLong(tokens[1].trim());
+            if (subBatch <= 0 || batch % subBatch != 0)
+            {
+                return null;
+            }
+            return new Candidate(rank, n, type, batch, layout, subBatch);
+        }
+        catch (RuntimeException e)
+        {
+            logger.fine("Ignoring invalid tuning result " + key + "=" + value);
+            return null;
+        }
+    }
+
+    /**
+     * Stores the given candidate as the result for the given key, and
+     * writes the results to the persistence file
+     *
+     * @param key The key
+     * @param candidate The candidate
+     */
+    private static synchronized void store(String key, Candidate candidate)
+    {
+        Properties properties = results();
+        properties.setProperty(key, candidate.value());
+        File file = persistenceFile;
+        if (file == null)
+        {
+            return;
+        }
+        try
+        {
+            File parent = file.getAbsoluteFile().getParentFile();
+            Files.createDirectories(parent.toPath());
+            File temp = File.createTempFile("jcufft", ".tmp", parent);
+            try (OutputStream stream = Files.newOutputStream(temp.toPath()))
+            {
+                properties.store(stream, "JCufft layout tuning results");
+            }
+            Files.move(temp.toPath(), file.toPath(),
+                StandardCopyOption.REPLACE_EXISTING);
+        }
+        catch (IOException e)
+        {
+            logger.log(Level.WARNING,
+                "Could not store the tuning results in " + file, e);
+        }
+    }
+
+    /**
+     * Returns the tuning results, reading them from the persistence
+     * file if necessary
+     *
+     * @return The results
+     */
+    private static synchronized Properties results()
+    {
+        if (results != null)
+        {
+            return results;
+        }
+        results = new Properties();
+        File file = persistenceFile;
+        if (file == null || !file.exists())
+        {
+            return results;
+        }
+        try (InputStream stream = Files.newInputStream(file.toPath()))
+        {
+            results.load(stream);
+        }
+        catch (IOException e)
+        {
+            logger.log(Level.WARNING,
+                "Could not read the tuning results from " + file, e);
+        }
+        return results;
+    }
+
+    /**
+     * Returns the product of the given values
+     *
+     * @param values The values
+     * @return The product
+     */
+    private static long product(long values[])
+    {
+        long result = 1;
+        for (long value : values)
+        {
+            result *= value;
+        }
+        return result;
+    }
+}
@@ -0,0 +1,195 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.io.IOException;
+import java.io.InterruptedIOException;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentMap;
+import java.util.concurrent.LinkedBlockingQueue;
+
+/**
+ * A {@link SlabTransport} that connects several ranks within one
+ * process, for example, threads that use different devices, or that
+ * test a distributed transform on a single device.<br>
+ * <br>
+ * The messages are copied into queues on the heap when they are sent.
+ * <br>
+ * Usage example:
+ * <pre><code>
+ * List&lt;SlabTransport&gt; transports = LoopbackTransport.create(4);
+ * // Run one SlabFft3d for each transport, in its own thread
+ * </code></pre>
+ */
+public final class LoopbackTransport implements SlabTransport
+{
+    /**
+     * The message queues, for each source, destination and tag
+     */
+    private final ConcurrentMap<List<Integer>, BlockingQueue<byte[]>> queues;
+
+    /**
+     * The rank
+     */
+    private final int rank;
+
+    /**
+     * The number of ranks
+     */
+    private final int size;
+
+    /**
+     * Creates a new transport
+     *
+     * @param queues The queues that are shared by all ranks
+     * @param rank The rank
+     * @param size The number of ranks
+     */
+    private LoopbackTransport(
+        ConcurrentMap<List<Integer>, BlockingQueue<byte[]>> queues,
+        int rank, int size)
+    {
+        this.queues = queues;
+        this.rank = rank;
+        this.size = size;
+    }
+
+    /**
+     * Creates the given number of connected transports. The transport
+     * at index i has the rank i.
+     *
+     * @param size The number of ranks
+     * @return The transports
+     * @throws IllegalArgumentException If the size is not positive
+     */
+    public static List<SlabTransport> create(int size)
+    {
+        if (size < 1)
+        {
+            throw new IllegalArgumentException(
+                "The size must be positive, but is " + size);
+        }
+        ConcurrentMap<List<Integer>, BlockingQueue<byte[]>> queues =
+            new ConcurrentHashMap<List<Integer>, BlockingQueue<byte[]>>();
+        List<SlabTransport> transports = new ArrayList<SlabTransport>();
+        for (int i = 0; i < size; i++)
+        {
+            transports.add(new LoopbackTransport(queues, i, size));
+        }
+        return transports;
+    }
+
+    @Override
+    public int getRank()
+    {
+        return rank;
+    }
+
+    @Override
+    public int getSize()
+    {
+        return size;
+    }
+
+    @Override
+    public void send(int destination, int tag, ByteBuffer data)
+        throws IOException
+    {
+        checkRank(destination);
+        byte message[] = new byte[data.remaining()];
+        data.duplicate().get(message);
+        queue(rank, destination, tag).add(message);
+    }
+
+    @Override
+    public void receive(int source, int tag, ByteBuffer data)
+        throws IOException
+    {
+        checkRank(source);
+        byte message[];
+        try
+        {
+            message = queue(source, rank, tag).take();
+        }
+        catch (InterruptedException e)
+        {
+            Thread.currentThread().interrupt();
+            throw new InterruptedIOException(
+                "Interrupted while receiving from rank " + source);
+        }
+        if (message.length != data.remaining())
+        {
+            throw new IOException("Expected " + data.remaining() +
+                " bytes from rank " + source + " with tag " + tag +
+                ", but received " + message.length);
+        }
+        data.duplicate().put(message);
+    }
+
+    /**
+     * Returns the queue for the given source, destination and tag
+     *
+     * @param source The source
+     * @param destination The destination
+     * @param tag The tag
+     * @return The queue
+     */
+    private BlockingQueue<byte[]> queue(int source, int destination, int tag)
+    {
+        return queues.computeIfAbsent(
+            Arrays.asList(source, destination, tag),
+            k -> new LinkedBlockingQueue<byte[]>());
+    }
+
+    /**
+     * Throws an IllegalArgumentException if the given rank is not valid
+     *
+     * @param r The rank
+     */
+    private void checkRank(int r)
+    {
+        if (r < 0 || r >= size)
+        {
+            throw new IllegalArgumentException(
+                "The rank must be between 0 and " + (size - 1) +
+                ", but is " + r);
+        }
+    }
+
+    @Override
+    public String toString()
+    {
+        return "LoopbackTransport[rank=" + rank + ",size=" + size + "]";
+    }
+}
@@ -0,0 +1,830 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CopyOnWriteArrayList;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLong;
+
+import jcuda.CudaException;
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaError;
+
+/**
+ * Global accounting of the memory that is used by JCufft.<br>
+ * <br>
+ * The memory budget keeps track of the work areas of all plans that
+ * are created with the plan functions of {@link JCufft}, as well as the
+ * device memory pools and the page-locked staging memory that are owned
+ * by the JCufft helper classes. A budget for the device memory can be
+ * set with {@link #setBudget(long)}.<br>
+ * <br>
+ * Plans that are created with
+ * {@link #createManagedPlan(PlanGeometry, cufftHandle)} do not
+ * allocate their work area automatically. Instead, the work area is
+ * allocated by the memory budget when the plan is executed for the
+ * first time. When a new allocation would exceed the budget, or the
+ * device runs out of memory, the work areas of the least recently used
+ * managed plans that are not currently executing are released. They
+ * are attached again with <code>cufftSetWorkArea</code> when the
+ * respective plan is executed the next time. Only if no work area can
+ * be released any more, the allocation fails.<br>
+ * <br>
+ * The current usage may be queried for each {@link Category}, and
+ * allocation events may be observed with a {@link Listener}.
+ */
+public final class MemoryBudget
+{
+    /**
+     * The categories of memory that are tracked
+     */
+    public enum Category
+    {
+        /**
+         * The work areas of plans, in device memory
+         */
+        WORKSPACE,
+
+        /**
+         * Device memory that is owned by JCufft helper classes
+         */
+        POOL,
+
+        /**
+         * Page-locked host memory that is owned by JCufft helper classes.
+         * This does not count against the device memory budget.
+         */
+        STAGING
+    }
+
+    /**
+     * The types of memory events
+     */
+    public enum EventType
+    {
+        /**
+         * Memory was allocated or reserved
+         */
+        ALLOCATE,
+
+        /**
+         * Memory was freed or released
+         */
+        RELEASE,
+
+        /**
+         * The work area of an idle plan was released due to memory pressure
+         */
+        EVICT
+    }
+
+    /**
+     * An event that is generated for each change of the memory usage
+     */
+    public static final class Event
+    {
+        /**
+         * The event type
+         */
+        private final EventType type;
+
+        /**
+         * The category
+         */
+        private final Category category;
+
+        /**
+         * The number of bytes
+         */
+        private final long bytes;
+
+        /**
+         * The device memory usage after the event
+         */
+        private final long deviceUsage;
+
+        /**
+         * A description of the owner of the memory
+         */
+        private final String owner;
+
+        /**
+         * The time of the event, via System#currentTimeMillis
+         */
+        private final long timeMillis;
+
+        /**
+         * Creates a new event
+         */
+        Event(EventType type, Category category, long bytes,
+            long deviceUsage, String owner)
+        {
+            this.type = type;
+            this.category = category;
+            this.bytes = bytes;
+            this.deviceUsage = deviceUsage;
+            this.owner = owner;
+            this.timeMillis = System.currentTimeMillis();
+        }
+
+        /**
+         * Returns the event type
+         *
+         * @return The event type
+         */
+        public EventType getType()
+        {
+            return type;
+        }
+
+        /**
+         * Returns the memory category
+         *
+         * @return The category
+         */
+        public Category getCategory()
+        {
+            return category;
+        }
+
+        /**
+         * Returns the number of bytes that were allocated or released
+         *
+         * @return The number of bytes
+         */
+        public long getBytes()
+        {
+            return bytes;
+        }
+
+        /**
+         * Returns the total device memory usage after this event
+         *
+         * @return The device memory usage, in bytes
+         */
+        public long getDeviceUsage()
+        {
+            return deviceUsage;
+        }
+
+        /**
+         * Returns a description of the owner of the memory
+         *
+         * @return The owner
+         */
+        public String getOwner()
+        {
+            return owner;
+        }
+
+        /**
+         * Returns the time of the event, as via System#currentTimeMillis
+         *
+         * @return The time of the event
+         */
+        public long getTimeMillis()
+        {
+            return timeMillis;
+        }
+
+        @Override
+        public String toString()
+        {
+            return "Event[" + type + "," + category + ",bytes=" + bytes +
+                ",deviceUsage=" + deviceUsage + ",owner=" + owner + "]";
+        }
+    }
+
+    /**
+     * Interface for classes that want to be informed about memory events
+     */
+    public interface Listener
+    {
+        /**
+         * Will be called for each memory event. This is called while
+         * the memory budget is locked, and should return quickly.
+         *
+         * @param event The event
+         */
+        void memoryEvent(Event event);
+    }
+
+    /**
+     * The work area of a plan
+     */
+    static final class Workspace
+    {
+        /**
+         * The state value for a work area that is not attached
+         */
+        static final int DETACHED = -1;
+
+        /**
+         * The size of the work area, in bytes
+         */
+        final long size;
+
+        /**
+         * Whether the work area is allocated by the memory budget (or
+         * automatically by CUFFT, otherwise)
+         */
+        final boolean managed;
+
+        /**
+         * A description of the plan
+         */
+        final String owner;
+
+        /**
+         * The work area memory, for managed work areas
+         */
+        final Pointer pointer = new Pointer();
+
+        /**
+         * The state: DETACHED, or the number of threads that are
+         * currently executing the plan
+         */
+        final AtomicInteger state;
+
+        /**
+         * The time of the last use, via System#nanoTime
+         */
+        volatile long lastUse;
+
+        /**
+         * Whether the plan was destroyed while it was executed. The
+         * work area is then released by the last thread that is
+         * executing the plan.
+         */
+        volatile boolean destroyed;
+
+        /**
+         * Creates a new work area description
+         */
+        Workspace(long size, boolean managed, String owner)
+        {
+            this.size = size;
+            this.managed = managed;
+            this.owner = owner;
+            this.state = new AtomicInteger(managed ? DETACHED : 0);
+        }
+    }
+
+    /**
+     * The maximum number of recent events that are kept
+     */
+    private static final int MAX_RECENT_EVENTS = 256;
+
+    /**
+     * The budget for the device memory, in bytes
+     */
+    private static long budget = Long.MAX_VALUE;
+
+    /**
+     * The usage of each category, in bytes
+     */
+    private static final AtomicLong usage[] =
+    {
+        new AtomicLong(), new AtomicLong(), new AtomicLong()
+    };
+
+    /**
+     * All managed work areas. Only accessed while holding the lock.
+     */
+    private static final List<Workspace> managedWorkspaces =
+        new ArrayList<Workspace>();
+
+    /**
+     * The ring of recent events. Only accessed while holding the lock.
+     */
+    private static final Event recentEvents[] = new Event[MAX_RECENT_EVENTS];
+
+    /**
+     * The total number of events
+     */
+    private static long eventCount = 0;
+
+    /**
+     * The number of evictions
+     */
+    private static final AtomicLong evictionCount = new AtomicLong();
+
+    /**
+     * The listeners
+     */
+    private static final List<Listener> listeners =
+        new CopyOnWriteArrayList<Listener>();
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private MemoryBudget()
+    {
+    }
+
+    /**
+     * Set the budget for the device memory that is used by JCufft. This
+     * includes the work areas of all plans that have been created with
+     * the JCufft plan functions, and the device memory pools of the
+     * JCufft helper classes. When the usage already exceeds the given
+     * budget, then idle managed work areas are released.
+     *
+     * @param bytes The budget, in bytes. A value that is not positive
+     * disables the budget.
+     */
+    public static synchronized void setBudget(long bytes)
+    {
+        budget = bytes > 0 ? bytes : Long.MAX_VALUE;
+        evictUntilAvailable(0, null);
+    }
+
+    /**
+     * Returns the budget for the device memory
+     *
+     * @return The budget, in bytes, or Long.MAX_VALUE if no budget is set
+     */
+    public static synchronized long getBudget()
+    {
+        return budget;
+    }
+
+    /**
+     * Returns the current usage of the given category
+     *
+     * @param category The category
+     * @return The usage, in bytes
+     */
+    public static long getUsage(Category category)
+    {
+        return usage[category.ordinal()].get();
+    }
+
+    /**
+     * Returns the current usage of device memory, which is the sum of
+     * the {@link Category#WORKSPACE} and {@link Category#POOL} usage
+     *
+     * @return The device memory usage, in bytes
+     */
+    public static long getDeviceUsage()
+    {
+        return getUsage(Category.WORKSPACE) + getUsage(Category.POOL);
+    }
+
+    /**
+     * Returns the size of the work area of the given plan, as far as it
+     * is known to the memory budget
+     *
+     * @param plan The plan
+     * @return The work area size, in bytes
+     */
+    public static long getWorkspaceSize(cufftHandle plan)
+    {
+        Workspace workspace = plan.getWorkspace();
+        return workspace == null ? 0 : workspace.size;
+    }
+
+    /**
+     * Returns whether the work area of the given plan is currently
+     * allocated. This is always <code>true</code> for plans whose
+     * work area is allocated automatically by CUFFT.
+     *
+     * @param plan The plan
+     * @return Whether the work area is allocated
+     */
+    public static boolean isWorkspaceAttached(cufftHandle plan)
+    {
+        Workspace workspace = plan.getWorkspace();
+        return workspace == null || workspace.state.get() != Workspace.DETACHED;
+    }
+
+    /**
+     * Returns the number of work areas that have been released due
+     * to memory pressure
+     *
+     * @return The number of evictions
+     */
+    public static long getEvictionCount()
+    {
+        return evictionCount.get();
+    }
+
+    /**
+     * Returns the most recent memory events, oldest first
+     *
+     * @return The recent events
+     */
+    public static synchronized List<Event> getRecentEvents()
+    {
+        int count = (int)Math.min(eventCount, MAX_RECENT_EVENTS);
+        List<Event> result = new ArrayList<Event>(count);
+        for (long i = eventCount - count; i < eventCount; i++)
+        {
+            result.add(recentEvents[(int)(i % MAX_RECENT_EVENTS)]);
+        }
+        return result;
+    }
+
+    /**
+     * Add the given listener to be informed about memory events
+     *
+     * @param listener The listener
+     */
+    public static void addListener(Listener listener)
+    {
+        if (listener != null)
+        {
+            listeners.add(listener);
+        }
+    }
+
+    /**
+     * Remove the given listener
+     *
+     * @param listener The listener
+     */
+    public static void removeListener(Listener listener)
+    {
+        listeners.remove(listener);
+    }
+
+    /**
+     * Creates a plan with the given geometry whose work area is managed
+     * by the memory budget. The work area is allocated when the plan is
+     * executed for the first time, and may be released when the plan is
+     * idle and memory is required for other purposes.
+     *
+     * @param geometry The geometry
+     * @param plan The plan that will be created
+     * @return The cufftResult
+     */
+    public static int createManagedPlan(PlanGeometry geometry, cufftHandle plan)
+    {
+        int result = JCufft.cufftCreate(plan);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            return result;
+        }
+        result = JCufft.cufftSetAutoAllocation(plan, 0);
+        long workSize[] = { 0 };
+        if (result == cufftResult.CUFFT_SUCCESS)
+        {
+            result = geometry.makePlan(plan, workSize);
+        }
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            JCufft.cufftDestroy(plan);
+            return result;
+        }
+        Workspace workspace =
+            new Workspace(workSize[0], true, geometry.toString());
+        synchronized (MemoryBudget.class)
+        {
+            managedWorkspaces.add(workspace);
+        }
+        plan.setWorkspace(workspace);
+        return result;
+    }
+
+    /**
+     * Reserve the given number of bytes in the given category. For the
+     * device memory categories, idle work areas are released when the
+     * reservation would otherwise exceed the budget.
+     *
+     * @param category The category
+     * @param bytes The number of bytes
+     * @param owner A description of the owner of the memory
+     * @throws CudaException If the reservation would exceed the budget
+     */
+    public static synchronized void reserve(
+        Category category, long bytes, String owner)
+    {
+        if (category != Category.STAGING &&
+            !evictUntilAvailable(bytes, null))
+        {
+            throw new CudaException("Reserving " + bytes + " bytes for " +
+                owner + " exceeds the device memory budget of " + budget +
+                " bytes, current usage is " + getDeviceUsage() + " bytes");
+        }
+        usage[category.ordinal()].addAndGet(bytes);
+        fireEvent(EventType.ALLOCATE, category, bytes, owner);
+    }
+
+    /**
+     * Release the given number of bytes from the given category
+     *
+     * @param category The category
+     * @param bytes The number of bytes
+     * @param owner A description of the owner of the memory
+     */
+    public static synchronized void release(
+        Category category, long bytes, String owner)
+    {
+        usage[category.ordinal()].addAndGet(-bytes);
+        fireEvent(EventType.RELEASE, category, bytes, owner);
+    }
+
+    /**
+     * Will be called by JCufft when a plan with an automatically
+     * allocated work area was created.
+     *
+     * @param plan The plan
+     * @param workSize The size of the work area, or a negative value
+     * if the size should be obtained with <code>cufftGetSize</code>
+     */
+    static void planCreated(cufftHandle plan, long workSize)
+    {
+        if (!plan.isAutoAllocation() || plan.getWorkspace() != null)
+        {
+            return;
+        }
+        long size = workSize;
+        if (size < 0)
+        {
+            long result[] = { 0 };
+            if (JCufft.cufftGetSize(plan, result) != cufftResult.CUFFT_SUCCESS)
+            {
+                return;
+            }
+            size = result[0];
+        }
+        Workspace workspace = new Workspace(size, false, plan.toString());
+        plan.setWorkspace(workspace);
+        synchronized (MemoryBudget.class)
+        {
+            usage[Category.WORKSPACE.ordinal()].addAndGet(size);
+            fireEvent(EventType.ALLOCATE, Category.WORKSPACE, size,
+                workspace.owner);
+            evictUntilAvailable(0, null);
+        }
+    }
+
+    /**
+     * Will be called by JCufft when the given plan was destroyed. If
+     * the plan is still executed, which may be the case when it was
+     * destroyed by the thread that is executing it, then a managed
+     * work area is only released by the last call to
+     * {@link #releaseWorkspace(Workspace)}.
+     *
+     * @param plan The plan
+     */
+    static void planDestroyed(cufftHandle plan)
+    {
+        Workspace workspace = plan.getWorkspace();
+        if (workspace == null)
+        {
+            return;
+        }
+        plan.setWorkspace(null);
+        synchronized (MemoryBudget.class)
+        {
+            if (workspace.managed)
+            {
+                managedWorkspaces.remove(workspace);
+                workspace.destroyed = true;
+                if (!workspace.state.compareAndSet(0, Workspace.DETACHED))
+                {
+                    // The work area is either not attached, or still
+                    // in use and released when the last use ends
+                    return;
+                }
+                JCuda.cudaFree(workspace.pointer);
+            }
+            usage[Category.WORKSPACE.ordinal()].addAndGet(-workspace.size);
+            fireEvent(EventType.RELEASE, Category.WORKSPACE,
+                workspace.size, workspace.owner);
+        }
+    }
+
+    /**
+     * Returns the work area of the given plan, which has to be passed
+     * to {@link #acquireWorkspace(cufftHandle, Workspace)} and
+     * {@link #releaseWorkspace(Workspace)}
+     *
+     * @param plan The plan, may be <code>null</code>
+     * @return The work area, or <code>null</code> if it is not tracked
+     */
+    static Workspace workspaceOf(cufftHandle plan)
+    {
+        return plan == null ? null : plan.getWorkspace();
+    }
+
+    /**
+     * Will be called by JCufft before the given plan is executed. If
+     * the plan has a managed work area that is not attached, then it
+     * is allocated and attached. The work area is protected from being
+     * released until {@link #releaseWorkspace(Workspace)} is called.
+     *
+     * @param plan The plan
+     * @param workspace The work area of the plan, from
+     * {@link #workspaceOf(cufftHandle)}
+     * @return The cufftResult
+     */
+    static int acquireWorkspace(cufftHandle plan, Workspace workspace)
+    {
+        if (workspace == null || !workspace.managed)
+        {
+            return cufftResult.CUFFT_SUCCESS;
+        }
+        workspace.lastUse = System.nanoTime();
+        while (true)
+        {
+            int state = workspace.state.get();
+            if (state == Workspace.DETACHED)
+            {
+                int result = attach(plan, workspace);
+                if (result != cufftResult.CUFFT_SUCCESS)
+                {
+                    return result;
+                }
+            }
+            else if (workspace.state.compareAndSet(state, state + 1))
+            {
+                return cufftResult.CUFFT_SUCCESS;
+            }
+        }
+    }
+
+    /**
+     * Will be called by JCufft after the given plan was executed. If
+     * the plan was destroyed in the meantime and this was the last use
+     * of the work area, then the work area is released.
+     *
+     * @param workspace The work area that was passed to
+     * {@link #acquireWorkspace(cufftHandle, Workspace)}
+     */
+    static void releaseWorkspace(Workspace workspace)
+    {
+        if (workspace == null || !workspace.managed)
+        {
+            return;
+        }
+        if (workspace.state.decrementAndGet() == 0 && workspace.destroyed)
+        {
+            synchronized (MemoryBudget.class)
+            {
+                if (!workspace.state.compareAndSet(0, Workspace.DETACHED))
+                {
+                    return;
+                }
+                JCuda.cudaFree(workspace.pointer);
+                usage[Category.WORKSPACE.ordinal()].addAndGet(-workspace.size);
+                fireEvent(EventType.RELEASE, Category.WORKSPACE,
+                    workspace.size, workspace.owner);
+            }
+        }
+    }
+
+    /**
+     * Allocate and attach the given work area of the given plan, if it
+     * is not attached yet
+     *
+     * @param plan The plan
+     * @param workspace The work area
+     * @return The cufftResult
+     */
+    private static synchronized int attach(
+        cufftHandle plan, Workspace workspace)
+    {
+        if (workspace.state.get() != Workspace.DETACHED)
+        {
+            return cufftResult.CUFFT_SUCCESS;
+        }
+        if (workspace.destroyed)
+        {
+            return cufftResult.CUFFT_INVALID_PLAN;
+        }
+        if (workspace.size > 0)
+        {
+            if (!evictUntilAvailable(workspace.size, workspace))
+            {
+                return cufftResult.CUFFT_ALLOC_FAILED;
+            }
+            int cudaResult = JCuda.cudaMalloc(workspace.pointer, workspace.size);
+            while (cudaResult == cudaError.cudaErrorMemoryAllocation &&
+                evictOne(workspace))
+            {
+                cudaResult = JCuda.cudaMalloc(workspace.pointer, workspace.size);
+            }
+            if (cudaResult != cudaError.cudaSuccess)
+            {
+                return cufftResult.CUFFT_ALLOC_FAILED;
+            }
+            int result = JCufft.cufftSetWorkArea(plan, workspace.pointer);
+            if (result != cufftResult.CUFFT_SUCCESS)
+            {
+                JCuda.cudaFree(workspace.pointer);
+                return result;
+            }
+            usage[Category.WORKSPACE.ordinal()].addAndGet(workspace.size);
+            fireEvent(EventType.ALLOCATE, Category.WORKSPACE,
+                workspace.size, workspace.owner);
+        }
+        workspace.state.set(0);
+        return cufftResult.CUFFT_SUCCESS;
+    }
+
+    /**
+     * Release idle managed work areas until the given number of bytes
+     * can be allocated without exceeding the budget. Must be called
+     * while holding the lock.
+     *
+     * @param bytes The number of bytes
+     * @param exclude A work area that may not be released
+     * @return Whether the bytes can be allocated within the budget
+     */
+    private static boolean evictUntilAvailable(long bytes, Workspace exclude)
+    {
+        while (getDeviceUsage() + bytes > budget)
+        {
+            if (!evictOne(exclude))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Release the least recently used managed work area that is attached
+     * and not currently in use. Must be called while holding the lock.
+     *
+     * @param exclude A work area that may not be released
+     * @return Whether a work area was released
+     */
+    private static boolean evictOne(Workspace exclude)
+    {
+        Workspace candidate = null;
+        for (Workspace workspace : managedWorkspaces)
+        {
+            if (workspace != exclude && workspace.size > 0 &&
+                workspace.state.get() == 0 &&
+                (candidate == null || workspace.lastUse < candidate.lastUse))
+            {
+                candidate = workspace;
+            }
+        }
+        if (candidate == null ||
+            !candidate.state.compareAndSet(0, Workspace.DETACHED))
+        {
+            return false;
+        }
+        // cudaFree implicitly waits for pending work that may use the area
+        JCuda.cudaFree(candidate.pointer);
+        usage[Category.WORKSPACE.ordinal()].addAndGet(-candidate.size);
+        evictionCount.incrementAndGet();
+        fireEvent(EventType.EVICT, Category.WORKSPACE,
+            candidate.size, candidate.owner);
+        return true;
+    }
+
+    /**
+     * Record the given event and inform all listeners. Must be called
+     * while holding the lock.
+     *
+     * @param type The event type
+     * @param category The category
+     * @param bytes The number of bytes
+     * @param owner The owner
+     */
+    private static void fireEvent(EventType type, Category category,
+        long bytes, String owner)
+    {
+        Event event = new Event(type, category, bytes,
+            getDeviceUsage(), owner);
+        recentEvents[(int)(eventCount % MAX_RECENT_EVENTS)] = event;
+        eventCount++;
+        for (Listener listener : listeners)
+        {
+            listener.memoryEvent(event);
+        }
+    }
+}
@@ -0,0 +1,263 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.InputStream;
+import java.net.JarURLConnection;
+import java.net.URL;
+import java.net.URLConnection;
+import java.nio.file.AtomicMoveNotSupportedException;
+import java.nio.file.FileAlreadyExistsException;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+import java.util.jar.JarEntry;
+import java.util.logging.Level;
+import java.util.logging.Logger;
+import java.util.zip.CRC32;
+
+import jcuda.LibUtils;
+
+/**
+ * Loads the native library from a directory that is shared between
+ * processes, instead of extracting it from the JAR for each process.<br>
+ * <br>
+ * The library is stored in a subdirectory whose name consists of the
+ * CRC32 and the size of the library resource. When the resource is
+ * contained in a JAR, the CRC32 is taken from the JAR entry, so that
+ * the resource does not have to be read at all when it was already
+ * extracted by an earlier process. A new version of the library is
+ * therefore extracted into a new subdirectory. The extraction writes
+ * a temporary file and moves it to its final name, so that processes
+ * that start at the same time never load a partially written file.
+ * Before a file from the cache is loaded, its CRC32 is verified, and
+ * it is extracted again if it was truncated or overwritten.<br>
+ * <br>
+ * The directory is given by the system property
+ * <code>jcufft.nativeCache</code>, and defaults to
+ * <code>${user.home}/.jcufft/natives</code>.
+ */
+final class NativeLibraryCache
+{
+    /**
+     * The logger used in this class
+     */
+    private static final Logger logger =
+        Logger.getLogger(NativeLibraryCache.class.getName());
+
+    /**
+     * The name of the system property for the cache directory
+     */
+    private static final String DIRECTORY_PROPERTY = "jcufft.nativeCache";
+
+    /**
+     * The path of the native libraries inside the JAR
+     */
+    private static final String LIBRARY_PATH_IN_JAR = "/lib/";
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private NativeLibraryCache()
+    {
+    }
+
+    /**
+     * Tries to load the native library with the given name from the
+     * cache, extracting it into the cache if necessary. Returns
+     * <code>false</code> if the library is not contained as a resource,
+     * or could not be extracted, so that the caller can fall back to
+     * the default loading procedure.
+     *
+     * @param libraryName The platform-specific library name, without
+     * prefix or extension
+     * @return Whether the library was loaded
+     * @throws UnsatisfiedLinkError If the library was found but could
+     * not be loaded
+     */
+    static boolean load(String libraryName)
+    {
+        String fileName = LibUtils.createLibraryFileName(libraryName);
+        URL url = NativeLibraryCache.class.getResource(
+            LIBRARY_PATH_IN_JAR + fileName);
+        if (url == null)
+        {
+            return false;
+        }
+        try
+        {
+            File file = cachedFile(url, fileName);
+            System.load(file.getAbsolutePath());
+            return true;
+        }
+        catch (IOException e)
+        {
+            logger.log(Level.WARNING,
+                "Could not use the native library cache for " + fileName, e);
+            return false;
+        }
+    }
+
+    /**
+     * Returns the cache file for the given resource, extracting it if it
+     * does not exist yet
+     *
+     * @param url The URL of the resource
+     * @param fileName The file name of the library
+     * @return The file
+     * @throws IOException If the resource can not be read, or the file
+     * can not be written
+     */
+    private static File cachedFile(URL url, String fileName)
+        throws IOException
+    {
+        URLConnection connection = url.openConnection();
+        long crc = -1;
+        long size = -1;
+        if (connection instanceof JarURLConnection)
+        {
+            JarEntry entry = ((JarURLConnection)connection).getJarEntry();
+            crc = entry.getCrc();
+            size = entry.getSize();
+        }
+        if (crc == -1 || size == -1)
+        {
+            CRC32 checksum = new CRC32();
+            try (InputStream stream = url.openStream())
+            {
+                size = update(checksum, stream);
+            }
+            crc = checksum.getValue();
+        }
+        File directory = new File(directory(),
+            String.format("%08x-%d", crc, size));
+        File file = new File(directory, fileName);
+        if (file.length() == size)
+        {
+            if (checksum(file) == crc)
+            {
+                return file;
+            }
+            logger.warning("The cached library " + file + " is damaged, " +
+                "extracting it again");
+        }
+
+        Files.createDirectories(directory.toPath());
+        File temp = File.createTempFile(fileName, ".tmp", directory);
+        try
+        {
+            try (InputStream stream = connection.getInputStream())
+            {
+                Files.copy(stream, temp.toPath(),
+                    StandardCopyOption.REPLACE_EXISTING);
+            }
+            try
+            {
+                // Atomically replaces a damaged file on all platforms
+                // that support atomic moves
+                Files.move(temp.toPath(), file.toPath(),
+                    StandardCopyOption.ATOMIC_MOVE);
+            }
+            catch (AtomicMoveNotSupportedException e)
+            {
+                Files.move(temp.toPath(), file.toPath(),
+                    StandardCopyOption.REPLACE_EXISTING);
+            }
+        }
+        catch (FileAlreadyExistsException e)
+        {
+            // Another process extracted the library in the meantime
+        }
+        finally
+        {
+            Files.deleteIfExists(temp.toPath());
+        }
+        if (file.length() != size || checksum(file) != crc)
+        {
+            throw new IOException("Could not extract " + file);
+        }
+        return file;
+    }
+
+    /**
+     * Computes the CRC32 of the given file
+     *
+     * @param file The file
+     * @return The CRC32
+     * @throws IOException If the file can not be read
+     */
+    private static long checksum(File file) throws IOException
+    {
+        CRC32 checksum = new CRC32();
+        try (InputStream stream = Files.newInputStream(file.toPath()))
+        {
+            update(checksum, stream);
+        }
+        return checksum.getValue();
+    }
+
+    /**
+     * Updates the given checksum with all bytes of the given stream
+     *
+     * @param checksum The checksum
+     * @param stream The stream
+     * @return The number of bytes that have been read
+     * @throws IOException If the stream can not be read
+     */
+    private static long update(CRC32 checksum, InputStream stream)
+        throws IOException
+    {
+        long size = 0;
+        byte buffer[] = new byte[65536];
+        int read;
+        while ((read = stream.read(buffer)) != -1)
+        {
+            checksum.update(buffer, 0, read);
+            size += read;
+        }
+        return size;
+    }
+
+    /**
+     * Returns the cache directory
+     *
+     * @return The directory
+     */
+    private static File directory()
+    {
+        String name = System.getProperty(DIRECTORY_PROPERTY);
+        if (name != null)
+        {
+            return new File(name);
+        }
+        return new File(new File(
+            System.getProperty("user.home"), ".jcufft"), "natives");
+    }
+}
@@ -0,0 +1,605 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+import static jcuda.jcufft.JCufftUtils.checkCufft;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaMemcpyKind;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * A batched 1D transform that is computed at a
+ * {@link SizeAdvisor#nextFastLength(int) fast length}, for convolutions
+ * and correlations.<br>
+ * <br>
+ * A PaddedPlan has a logical length and a padded length, which is the
+ * next fast length that is not smaller than the logical length. The
+ * {@link #forward(Pointer, int, Pointer) forward} transform copies the
+ * input into an internal device buffer, zero-pads it to the padded
+ * length, and computes the spectrum of the padded length. The
+ * {@link #inverse(Pointer, Pointer) inverse} transform computes the
+ * inverse of such a spectrum into the internal buffer, and crops the
+ * result to the logical length.<br>
+ * <br>
+ * The spectra thus have {@link #getSpectrumLength()} elements, and
+ * describe the frequencies <code>k/paddedLength</code>. They are only
+ * meaningful for operations that are invariant to zero-padding, like
+ * the multiplication of spectra for a linear convolution or
+ * correlation. As for all CUFFT transforms, the results are not
+ * normalized: The result of an inverse transform has to be multiplied
+ * with {@link #getScale()}.<br>
+ * <br>
+ * Usage example for the linear convolution of real signals with
+ * 1000 elements and a kernel with 37 elements:
+ * <pre><code>
+ * PaddedPlan p = PaddedPlan.forConvolution(
+ *     1000, 37, cufftType.CUFFT_R2C, 1);
+ * p.forward(signal, 1000, signalSpectrum);
+ * p.forward(kernel, 37, kernelSpectrum);
+ * // Multiply the spectra, and scale with p.getScale()
+ * p.inverse(signalSpectrum, result); // 1036 elements
+ * p.close();
+ * </code></pre>
+ * For real transforms, a PaddedPlan owns a real-to-complex plan for the
+ * forward transform and a complex-to-real plan for the inverse transform.
+ * All transforms and copies are enqueued on the
+ * {@link #setStream(cudaStream_t) stream} of this object. The methods
+ * of a PaddedPlan may not be called concurrently with other operations
+ * on the same stream that use the internal buffer.
+ */
+public class PaddedPlan implements AutoCloseable
+{
+    /**
+     * The native resources of a PaddedPlan. This is the cleanup action
+     * that is registered in the {@link ResourceReclaimer}, and thus must
+     * not refer to the PaddedPlan.
+     */
+    private static final class Resources implements Runnable
+    {
+        /**
+         * The plan for the forward transform
+         */
+        final cufftHandle forwardPlan = new cufftHandle();
+
+        /**
+         * The plan for the inverse transform. This is the same as the
+         * forward plan for complex transforms.
+         */
+        cufftHandle inversePlan;
+
+        /**
+         * The padded device buffer
+         */
+        final Pointer buffer = new Pointer();
+
+        /**
+         * The number of bytes of device memory that have been reserved
+         * in the {@link MemoryBudget}
+         */
+        long deviceBytes = 0;
+
+        /**
+         * Releases all resources
+         */
+        @Override
+        public void run()
+        {
+            JCuda.cudaFree(buffer);
+            forwardPlan.close();
+            if (inversePlan != null && inversePlan != forwardPlan)
+            {
+                inversePlan.close();
+            }
+            MemoryBudget.release(
+                MemoryBudget.Category.POOL, deviceBytes, "PaddedPlan");
+            deviceBytes = 0;
+        }
+    }
+
+    /**
+     * The logical length
+     */
+    private final int length;
+
+    /**
+     * The padded length
+     */
+    private final int paddedLength;
+
+    /**
+     * The number of elements from the end of the padded inverse result
+     * that are placed at the beginning of the cropped result. This is
+     * 0, except for correlations, where these elements are the results
+     * for the negative lags.
+     */
+    private final int leadingLength;
+
+    /**
+     * The cufftType of the forward transform
+     */
+    private final int type;
+
+    /**
+     * The batch size
+     */
+    private final int batch;
+
+    /**
+     * The size of a single time domain element, in bytes
+     */
+    private final int elementSize;
+
+    /**
+     * The stream, or <code>null</code> for the default stream
+     */
+    private cudaStream_t stream = null;
+
+    /**
+     * The index from which on all elements of each row of the buffer
+     * are known to be zero
+     */
+    private int zeroFrom;
+
+    /**
+     * Whether this object has been destroyed
+     */
+    private boolean destroyed = false;
+
+    /**
+     * The native resources of this object
+     */
+    private final Resources resources;
+
+    /**
+     * The registration of the resources in the {@link ResourceReclaimer}
+     */
+    private final ResourceReclaimer.Registration registration;
+
+    /**
+     * Creates a padded plan for batched transforms with the given
+     * length. The padded length will be the next fast length.
+     *
+     * @param length The length
+     * @param type The cufftType. For the real types, the forward and
+     * the inverse type may be given equivalently.
+     * @param batch The batch size
+     * @return The padded plan
+     * @throws IllegalArgumentException If the length or the batch size
+     * is not positive
+     * @throws jcuda.CudaException If the plans or the buffer can not
+     * be created
+     */
+    public static PaddedPlan create1d(int length, int type, int batch)
+    {
+        return new PaddedPlan(length, 0, type, batch);
+    }
+
+    /**
+     * Creates a padded plan for the linear convolution of signals with
+     * the given length and kernels with the given length. The logical
+     * length will be <code>signalLength + kernelLength - 1</code>, which
+     * is the length of the full linear convolution. The signals and the
+     * kernels are transformed with {@link #forward(Pointer, int, Pointer)},
+     * passing their respective length.
+     *
+     * @param signalLength The signal length
+     * @param kernelLength The kernel length
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The padded plan
+     * @throws IllegalArgumentException If any length or the batch size
+     * is not positive
+     * @throws jcuda.CudaException If the plans or the buffer can not
+     * be created
+     */
+    public static PaddedPlan forConvolution(
+        int signalLength, int kernelLength, int type, int batch)
+    {
+        return new PaddedPlan(
+            convolutionLength(signalLength, kernelLength), 0, type, batch);
+    }
+
+    /**
+     * Creates a padded plan for the cross-correlation of signals with
+     * the given length and templates with the given length. The logical
+     * length will be <code>signalLength + templateLength - 1</code>.
+     * When the signal spectrum is multiplied with the conjugate of the
+     * template spectrum, the result of the inverse transform contains
+     * the correlation for the lags <code>-(templateLength-1)</code> to
+     * <code>signalLength-1</code>, in this order. This is the same as
+     * the "full" correlation of common numerical libraries.
+     *
+     * @param signalLength The signal length
+     * @param templateLength The template length
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The padded plan
+     * @throws IllegalArgumentException If any length or the batch size
+     * is not positive
+     * @throws jcuda.CudaException If the plans or the buffer can not
+     * be created
+     */
+    public static PaddedPlan forCorrelation(
+        int signalLength, int templateLength, int type, int batch)
+    {
+        return new PaddedPlan(
+            convolutionLength(signalLength, templateLength),
+            templateLength - 1, type, batch);
+    }
+
+    /**
+     * Returns the length of the full linear convolution of the given
+     * lengths
+     *
+     * @param a The first length
+     * @param b The second length
+     * @return The convolution length
+     * @throws IllegalArgumentException If a length is not positive, or
+     * the result does not fit into an <code>int</code>
+     */
+    private static int convolutionLength(int a, int b)
+    {
+        if (a <= 0 || b <= 0)
+        {
+            throw new IllegalArgumentException(
+                "The lengths must be positive, but are " + a + " and " + b);
+        }
+        long result = (long)a + b - 1;
+        if (result > Integer.MAX_VALUE)
+        {
+            throw new IllegalArgumentException(
+                "The convolution length for " + a + " and " + b +
+                " is too large");
+        }
+        return (int)result;
+    }
+
+    /**
+     * Creates a new padded plan
+     *
+     * @param length The logical length
+     * @param leadingLength The leading length
+     * @param type The cufftType
+     * @param batch The batch size
+     */
+    private PaddedPlan(int length, int leadingLength, int type, int batch)
+    {
+        if (length <= 0 || batch <= 0)
+        {
+            throw new IllegalArgumentException(
+                "The length and the batch size must be positive, but are " +
+                length + " and " + batch);
+        }
+        this.length = length;
+        this.paddedLength = SizeAdvisor.nextFastLength(length);
+        this.leadingLength = leadingLength;
+        this.type = forwardType(type);
+        this.batch = batch;
+        int realSize = JCufftUtils.elementSize(type);
+        this.elementSize = isComplex() ? 2 * realSize : realSize;
+
+        this.resources = new Resources();
+        this.registration = ResourceReclaimer.register(this, resources);
+        try
+        {
+            checkCufft(JCufft.cufftPlan1d(
+                resources.forwardPlan, paddedLength, this.type, batch));
+            if (isComplex())
+            {
+                resources.inversePlan = resources.forwardPlan;
+            }
+            else
+            {
+                resources.inversePlan = new cufftHandle();
+                checkCufft(JCufft.cufftPlan1d(resources.inversePlan,
+                    paddedLength, inverseType(this.type), batch));
+            }
+            long bufferBytes = (long)paddedLength * batch * elementSize;
+            MemoryBudget.reserve(
+                MemoryBudget.Category.POOL, bufferBytes, "PaddedPlan");
+            resources.deviceBytes = bufferBytes;
+            checkCuda(JCuda.cudaMalloc(resources.buffer, bufferBytes));
+            checkCuda(JCuda.cudaMemset(resources.buffer, 0, bufferBytes));
+            zeroFrom = 0;
+        }
+        catch (RuntimeException e)
+        {
+            destroy();
+            throw e;
+        }
+    }
+
+    /**
+     * Returns the forward type for the given cufftType
+     *
+     * @param type The cufftType
+     * @return The forward type
+     * @throws IllegalArgumentException If the type is not valid
+     */
+    private static int forwardType(int type)
+    {
+        switch (type)
+        {
+            case cufftType.CUFFT_C2C:
+            case cufftType.CUFFT_Z2Z:
+            case cufftType.CUFFT_R2C:
+            case cufftType.CUFFT_D2Z:
+                return type;
+            case cufftType.CUFFT_C2R:
+                return cufftType.CUFFT_R2C;
+            case cufftType.CUFFT_Z2D:
+                return cufftType.CUFFT_D2Z;
+        }
+        throw new IllegalArgumentException("Invalid cufftType: " + type);
+    }
+
+    /**
+     * Returns the inverse type for the given forward type
+     *
+     * @param type The forward type
+     * @return The inverse type
+     */
+    private static int inverseType(int type)
+    {
+        switch (type)
+        {
+            case cufftType.CUFFT_R2C:
+                return cufftType.CUFFT_C2R;
+            case cufftType.CUFFT_D2Z:
+                return cufftType.CUFFT_Z2D;
+        }
+        return type;
+    }
+
+    /**
+     * Returns whether this plan computes complex-to-complex transforms
+     *
+     * @return Whether the transforms are complex
+     */
+    private boolean isComplex()
+    {
+        return type == cufftType.CUFFT_C2C || type == cufftType.CUFFT_Z2Z;
+    }
+
+    /**
+     * Set the stream for all transforms and copies of this plan
+     *
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @throws jcuda.CudaException If the stream can not be set
+     */
+    public synchronized void setStream(cudaStream_t stream)
+    {
+        checkNotDestroyed();
+        checkCufft(JCufft.cufftSetStream(resources.forwardPlan, stream));
+        if (resources.inversePlan != resources.forwardPlan)
+        {
+            checkCufft(JCufft.cufftSetStream(resources.inversePlan, stream));
+        }
+        this.stream = stream;
+    }
+
+    /**
+     * Computes the forward transforms of the given input, which contains
+     * {@link #getLength()} time domain elements for each batch.
+     *
+     * @param idata The input data, in device memory
+     * @param odata The output data, in device memory, with
+     * {@link #getSpectrumLength()} complex elements for each batch
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public void forward(Pointer idata, Pointer odata)
+    {
+        forward(idata, length, odata);
+    }
+
+    /**
+     * Computes the forward transforms of the given input, which contains
+     * the given number of time domain elements for each batch. The input
+     * is zero-padded to the padded length.
+     *
+     * @param idata The input data, in device memory
+     * @param inputLength The number of input elements of each batch
+     * @param odata The output data, in device memory, with
+     * {@link #getSpectrumLength()} complex elements for each batch
+     * @throws IllegalArgumentException If the input length is not
+     * positive or larger than the padded length
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public synchronized void forward(
+        Pointer idata, int inputLength, Pointer odata)
+    {
+        checkNotDestroyed();
+        if (inputLength <= 0 || inputLength > paddedLength)
+        {
+            throw new IllegalArgumentException(
+                "The input length must be in [1," + paddedLength +
+                "], but is " + inputLength);
+        }
+        long pitch = (long)paddedLength * elementSize;
+        if (zeroFrom > inputLength)
+        {
+            checkCuda(JCuda.cudaMemset2DAsync(
+                resources.buffer.withByteOffset(
+                    (long)inputLength * elementSize), pitch, 0,
+                (long)(zeroFrom - inputLength) * elementSize, batch,
+                stream));
+        }
+        long rowBytes = (long)inputLength * elementSize;
+        checkCuda(JCuda.cudaMemcpy2DAsync(resources.buffer, pitch,
+            idata, rowBytes, rowBytes, batch,
+            cudaMemcpyKind.cudaMemcpyDeviceToDevice, stream));
+        zeroFrom = inputLength;
+        checkCufft(JCufftUtils.exec(resources.forwardPlan, type,
+            resources.buffer, odata, JCufft.CUFFT_FORWARD));
+    }
+
+    /**
+     * Computes the inverse transforms of the given spectra, and crops
+     * the results to {@link #getLength()} time domain elements for each
+     * batch. For real transforms, the input data is overwritten.
+     *
+     * @param idata The input data, in device memory, with
+     * {@link #getSpectrumLength()} complex elements for each batch
+     * @param odata The output data, in device memory
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public synchronized void inverse(Pointer idata, Pointer odata)
+    {
+        checkNotDestroyed();
+        checkCufft(JCufftUtils.exec(resources.inversePlan,
+            inverseType(type), idata, resources.buffer,
+            JCufft.CUFFT_INVERSE));
+        zeroFrom = paddedLength;
+
+        long pitch = (long)paddedLength * elementSize;
+        long rowBytes = (long)length * elementSize;
+        long leadingBytes = (long)leadingLength * elementSize;
+        if (leadingBytes > 0)
+        {
+            checkCuda(JCuda.cudaMemcpy2DAsync(odata, rowBytes,
+                resources.buffer.withByteOffset(pitch - leadingBytes),
+                pitch, leadingBytes, batch,
+                cudaMemcpyKind.cudaMemcpyDeviceToDevice, stream));
+        }
+        checkCuda(JCuda.cudaMemcpy2DAsync(
+            odata.withByteOffset(leadingBytes), rowBytes,
+            resources.buffer, pitch, rowBytes - leadingBytes, batch,
+            cudaMemcpyKind.cudaMemcpyDeviceToDevice, stream));
+    }
+
+    /**
+     * Returns the logical length
+     *
+     * @return The length
+     */
+    public int getLength()
+    {
+        return length;
+    }
+
+    /**
+     * Returns the padded length, which is the transform length of the
+     * underlying plans
+     *
+     * @return The padded length
+     */
+    public int getPaddedLength()
+    {
+        return paddedLength;
+    }
+
+    /**
+     * Returns the number of complex elements of the spectrum of each
+     * batch. This is the padded length for complex transforms, and
+     * <code>paddedLength/2+1</code> for real transforms.
+     *
+     * @return The spectrum length
+     */
+    public int getSpectrumLength()
+    {
+        return isComplex() ? paddedLength : paddedLength / 2 + 1;
+    }
+
+    /**
+     * Returns the factor that the results of a forward and an inverse
+     * transform have to be multiplied with, which is
+     * <code>1.0/paddedLength</code>
+     *
+     * @return The scale
+     */
+    public double getScale()
+    {
+        return 1.0 / paddedLength;
+    }
+
+    /**
+     * Returns the cufftType of the forward transform
+     *
+     * @return The cufftType
+     */
+    public int getType()
+    {
+        return type;
+    }
+
+    /**
+     * Returns the batch size
+     *
+     * @return The batch size
+     */
+    public int getBatch()
+    {
+        return batch;
+    }
+
+    /**
+     * Throws an IllegalStateException if this object has been destroyed
+     */
+    private void checkNotDestroyed()
+    {
+        if (destroyed)
+        {
+            throw new IllegalStateException("The PaddedPlan was destroyed");
+        }
+    }
+
+    /**
+     * Releases the plans and the buffer of this object
+     */
+    public synchronized void destroy()
+    {
+        if (destroyed)
+        {
+            return;
+        }
+        destroyed = true;
+        registration.clean();
+    }
+
+    /**
+     * Equivalent to {@link #destroy()}
+     */
+    @Override
+    public void close()
+    {
+        destroy();
+    }
+
+    @Override
+    public String toString()
+    {
+        return "PaddedPlan[type=" + cufftType.stringFor(type) +
+            ",length=" + length + ",paddedLength=" + paddedLength +
+            ",batch=" + batch + "]";
+    }
+}
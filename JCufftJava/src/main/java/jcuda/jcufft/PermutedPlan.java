@@ -0,0 +1,625 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+import static jcuda.jcufft.JCufftUtils.checkCufft;
+
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Deque;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * A 2D or 3D transform for data that is not stored in row-major order,
+ * for example, column-major data from Fortran or MATLAB.<br>
+ * <br>
+ * The memory order of the input and of the output is given as an
+ * array that contains the indices of the logical dimensions, from the
+ * slowest-varying to the fastest-varying dimension. The row-major order
+ * that is assumed by <code>cufftPlan2d</code> and
+ * <code>cufftPlan3d</code> is <code>{0, 1, 2}</code>, and the
+ * column-major order is <code>{2, 1, 0}</code>.<br>
+ * <br>
+ * Since a multi-dimensional transform is separable, the transform of
+ * data in any memory order can be computed with a plan whose sizes
+ * are given in this memory order. The result then has the same memory
+ * order as the input. No data has to be rearranged in this case. When
+ * the output order differs from the input order, the result of the
+ * plan is written into an internal buffer, and permuted into the
+ * output order with at most two tiled transposes on the device.<br>
+ * <br>
+ * For real-to-complex transforms, the dimension that is halved in the
+ * complex output is the dimension that varies fastest in the input.
+ * For complex-to-real transforms, this dimension is halved in the
+ * complex input. It is returned by {@link #getHalvedDimension()}.<br>
+ * <br>
+ * Usage example for column-major data:
+ * <pre><code>
+ * PermutedPlan p = PermutedPlan.createColumnMajor(
+ *     new int[] { nx, ny, nz }, cufftType.CUFFT_C2C);
+ * p.exec(input, output, JCufft.CUFFT_FORWARD);
+ * p.close();
+ * </code></pre>
+ */
+public class PermutedPlan implements AutoCloseable
+{
+    /**
+     * The native resources of a PermutedPlan. This is the cleanup action
+     * that is registered in the {@link ResourceReclaimer}, and thus must
+     * not refer to the PermutedPlan.
+     */
+    private static final class Resources implements Runnable
+    {
+        /**
+         * The plan
+         */
+        final cufftHandle plan = new cufftHandle();
+
+        /**
+         * The buffers for the result of the plan and for the
+         * intermediate result of the transposes
+         */
+        final Pointer buffers[] = { new Pointer(), new Pointer() };
+
+        /**
+         * The number of bytes of device memory that have been reserved
+         * in the {@link MemoryBudget}
+         */
+        long deviceBytes = 0;
+
+        /**
+         * Releases all resources
+         */
+        @Override
+        public void run()
+        {
+            JCuda.cudaFree(buffers[0]);
+            JCuda.cudaFree(buffers[1]);
+            plan.close();
+            MemoryBudget.release(
+                MemoryBudget.Category.POOL, deviceBytes, "PermutedPlan");
+            deviceBytes = 0;
+        }
+    }
+
+    /**
+     * The operation that moves the slowest-varying dimension to the
+     * fastest-varying position, which is a single transpose
+     */
+    private static final char ROTATE = 'R';
+
+    /**
+     * The operation that swaps the two fastest-varying dimensions, which
+     * is a batched transpose
+     */
+    private static final char SWAP = 'S';
+
+    /**
+     * The logical sizes
+     */
+    private final int n[];
+
+    /**
+     * The input order
+     */
+    private final int inputOrder[];
+
+    /**
+     * The output order
+     */
+    private final int outputOrder[];
+
+    /**
+     * The cufftType
+     */
+    private final int type;
+
+    /**
+     * The logical sizes of the output of the plan
+     */
+    private final long outputSizes[];
+
+    /**
+     * The operations that permute the output of the plan from the
+     * input order into the output order
+     */
+    private final char operations[];
+
+    /**
+     * The stream, or <code>null</code> for the default stream
+     */
+    private cudaStream_t stream = null;
+
+    /**
+     * Whether this object has been destroyed
+     */
+    private boolean destroyed = false;
+
+    /**
+     * The native resources of this object
+     */
+    private final Resources resources;
+
+    /**
+     * The registration of the resources in the {@link ResourceReclaimer}
+     */
+    private final ResourceReclaimer.Registration registration;
+
+    /**
+     * Returns the row-major order for the given rank
+     *
+     * @param rank The rank
+     * @return The order <code>{0, 1, ..., rank-1}</code>
+     */
+    public static int[] rowMajor(int rank)
+    {
+        int order[] = new int[rank];
+        for (int i = 0; i < rank; i++)
+        {
+            order[i] = i;
+        }
+        return order;
+    }
+
+    /**
+     * Returns the column-major order for the given rank
+     *
+     * @param rank The rank
+     * @return The order <code>{rank-1, ..., 1, 0}</code>
+     */
+    public static int[] columnMajor(int rank)
+    {
+        int order[] = new int[rank];
+        for (int i = 0; i < rank; i++)
+        {
+            order[i] = rank - 1 - i;
+        }
+        return order;
+    }
+
+    /**
+     * Creates a plan for input and output data in column-major order.
+     * This does not require any transposes.
+     *
+     * @param n The logical sizes, with 2 or 3 elements
+     * @param type The cufftType
+     * @return The plan
+     * @throws IllegalArgumentException If the sizes are not valid
+     * @throws jcuda.CudaException If the plan can not be created
+     */
+    public static PermutedPlan createColumnMajor(int n[], int type)
+    {
+        int order[] = columnMajor(n.length);
+        return new PermutedPlan(n, order, order, type);
+    }
+
+    /**
+     * Creates a plan for input and output data in the given orders
+     *
+     * @param n The logical sizes, with 2 or 3 elements
+     * @param inputOrder The memory order of the input
+     * @param outputOrder The memory order of the output
+     * @param type The cufftType
+     * @return The plan
+     * @throws IllegalArgumentException If the sizes or the orders are
+     * not valid
+     * @throws jcuda.CudaException If the plan or the buffers can not be
+     * created
+     */
+    public static PermutedPlan create(
+        int n[], int inputOrder[], int outputOrder[], int type)
+    {
+        return new PermutedPlan(n, inputOrder, outputOrder, type);
+    }
+
+    /**
+     * Creates a new plan
+     *
+     * @param n The logical sizes
+     * @param inputOrder The input order
+     * @param outputOrder The output order
+     * @param type The cufftType
+     */
+    private PermutedPlan(
+        int n[], int inputOrder[], int outputOrder[], int type)
+    {
+        if (n.length < 2 || n.length > 3)
+        {
+            throw new IllegalArgumentException(
+                "Only 2D and 3D transforms are supported, but the rank is " +
+                n.length);
+        }
+        validateOrder(inputOrder, n.length);
+        validateOrder(outputOrder, n.length);
+        this.n = n.clone();
+        this.inputOrder = inputOrder.clone();
+        this.outputOrder = outputOrder.clone();
+        this.type = type;
+        this.outputSizes = new long[n.length];
+        for (int i = 0; i < n.length; i++)
+        {
+            outputSizes[i] = n[i];
+        }
+        int halved = getHalvedDimension();
+        if (halved != -1 &&
+            (type == cufftType.CUFFT_R2C || type == cufftType.CUFFT_D2Z))
+        {
+            outputSizes[halved] = n[halved] / 2 + 1;
+        }
+        this.operations = operations(this.inputOrder, this.outputOrder);
+
+        this.resources = new Resources();
+        this.registration = ResourceReclaimer.register(this, resources);
+        try
+        {
+            int sizes[] = new int[n.length];
+            for (int i = 0; i < n.length; i++)
+            {
+                sizes[i] = n[inputOrder[i]];
+            }
+            if (n.length == 2)
+            {
+                checkCufft(JCufft.cufftPlan2d(
+                    resources.plan, sizes[0], sizes[1], type));
+            }
+            else
+            {
+                checkCufft(JCufft.cufftPlan3d(
+                    resources.plan, sizes[0], sizes[1], sizes[2], type));
+            }
+            if (operations.length > 0)
+            {
+                long bytes = getOutputBytes();
+                long totalBytes = bytes * Math.min(2, operations.length);
+                MemoryBudget.reserve(
+                    MemoryBudget.Category.POOL, totalBytes, "PermutedPlan");
+                resources.deviceBytes = totalBytes;
+                for (int i = 0; i < Math.min(2, operations.length); i++)
+                {
+                    checkCuda(JCuda.cudaMalloc(resources.buffers[i], bytes));
+                }
+            }
+        }
+        catch (RuntimeException e)
+        {
+            destroy();
+            throw e;
+        }
+    }
+
+    /**
+     * Validates the given order
+     *
+     * @param order The order
+     * @param rank The rank
+     * @throws IllegalArgumentException If the order is not a
+     * permutation of the dimensions
+     */
+    private static void validateOrder(int order[], int rank)
+    {
+        boolean seen[] = new boolean[rank];
+        if (order.length != rank)
+        {
+            throw new IllegalArgumentException(
+                "The order must have " + rank + " elements, but has " +
+                order.length);
+        }
+        for (int d : order)
+        {
+            if (d < 0 || d >= rank || seen[d])
+            {
+                throw new IllegalArgumentException(
+                    "The order is not a permutation of the dimensions: " +
+                    Arrays.toString(order));
+            }
+            seen[d] = true;
+        }
+    }
+
+    /**
+     * Computes the shortest sequence of operations that permutes data
+     * from the given input order into the given output order, with a
+     * breadth-first search over the orders
+     *
+     * @param inputOrder The input order
+     * @param outputOrder The output order
+     * @return The operations
+     */
+    private static char[] operations(int inputOrder[], int outputOrder[])
+    {
+        List<Integer> start = toList(inputOrder);
+        List<Integer> goal = toList(outputOrder);
+        Map<List<Integer>, List<Integer>> previous =
+            new HashMap<List<Integer>, List<Integer>>();
+        Map<List<Integer>, Character> previousOperation =
+            new HashMap<List<Integer>, Character>();
+        Deque<List<Integer>> queue = new ArrayDeque<List<Integer>>();
+        previous.put(start, null);
+        queue.add(start);
+        while (!queue.isEmpty() && !previous.containsKey(goal))
+        {
+            List<Integer> order = queue.poll();
+            for (char operation : new char[] { ROTATE, SWAP })
+            {
+                if (operation == SWAP && order.size() != 3)
+                {
+                    continue;
+                }
+                List<Integer> next = apply(operation, order);
+                if (!previous.containsKey(next))
+                {
+                    previous.put(next, order);
+                    previousOperation.put(next, operation);
+                    queue.add(next);
+                }
+            }
+        }
+        StringBuilder sb = new StringBuilder();
+        for (List<Integer> order = goal; previous.get(order) != null;
+            order = previous.get(order))
+        {
+            sb.append(previousOperation.get(order));
+        }
+        return sb.reverse().toString().toCharArray();
+    }
+
+    /**
+     * Returns the order that results from applying the given operation
+     * to the given order
+     *
+     * @param operation The operation
+     * @param order The order
+     * @return The new order
+     */
+    private static List<Integer> apply(char operation, List<Integer> order)
+    {
+        List<Integer> result = new ArrayList<Integer>(order);
+        if (operation == ROTATE)
+        {
+            result.add(result.remove(0));
+        }
+        else
+        {
+            result.add(1, result.remove(2));
+        }
+        return result;
+    }
+
+    /**
+     * Returns the given array as a list
+     *
+     * @param array The array
+     * @return The list
+     */
+    private static List<Integer> toList(int array[])
+    {
+        List<Integer> list = new ArrayList<Integer>();
+        for (int value : array)
+        {
+            list.add(value);
+        }
+        return list;
+    }
+
+    /**
+     * Set the stream for the transform and the transposes of this plan
+     *
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @throws jcuda.CudaException If the stream can not be set
+     */
+    public synchronized void setStream(cudaStream_t stream)
+    {
+        checkNotDestroyed();
+        checkCufft(JCufft.cufftSetStream(resources.plan, stream));
+        this.stream = stream;
+    }
+
+    /**
+     * Executes this plan. The input must be stored in the input order,
+     * and the output will be stored in the output order.
+     *
+     * @param idata The input data, in device memory
+     * @param odata The output data, in device memory
+     * @param direction The direction, for complex-to-complex transforms
+     * @throws jcuda.CudaException If the transform or the transposes fail
+     */
+    public synchronized void exec(Pointer idata, Pointer odata, int direction)
+    {
+        checkNotDestroyed();
+        if (operations.length == 0)
+        {
+            checkCufft(JCufftUtils.exec(
+                resources.plan, type, idata, odata, direction));
+            return;
+        }
+        checkCufft(JCufftUtils.exec(
+            resources.plan, type, idata, resources.buffers[0], direction));
+        int elementSize = outputElementSize();
+        List<Integer> order = toList(inputOrder);
+        Pointer src = resources.buffers[0];
+        for (int i = 0; i < operations.length; i++)
+        {
+            Pointer dst = i == operations.length - 1 ?
+                odata : resources.buffers[(i + 1) % 2];
+            long s0 = outputSizes[order.get(0)];
+            long s1 = outputSizes[order.get(1)];
+            long s2 = order.size() == 3 ? outputSizes[order.get(2)] : 1;
+            if (operations[i] == ROTATE)
+            {
+                checkCuda(JCufft.transpose(
+                    src, dst, 1, s0, s1 * s2, elementSize, stream));
+            }
+            else
+            {
+                checkCuda(JCufft.transpose(
+                    src, dst, s0, s1, s2, elementSize, stream));
+            }
+            order = apply(operations[i], order);
+            src = dst;
+        }
+    }
+
+    /**
+     * Returns the logical sizes
+     *
+     * @return The sizes
+     */
+    public int[] getSizes()
+    {
+        return n.clone();
+    }
+
+    /**
+     * Returns the input order
+     *
+     * @return The input order
+     */
+    public int[] getInputOrder()
+    {
+        return inputOrder.clone();
+    }
+
+    /**
+     * Returns the output order
+     *
+     * @return The output order
+     */
+    public int[] getOutputOrder()
+    {
+        return outputOrder.clone();
+    }
+
+    /**
+     * Returns the logical dimension that is halved in the complex data
+     * of a real transform, or -1 for complex transforms
+     *
+     * @return The halved dimension
+     */
+    public int getHalvedDimension()
+    {
+        if (type == cufftType.CUFFT_C2C || type == cufftType.CUFFT_Z2Z)
+        {
+            return -1;
+        }
+        return inputOrder[inputOrder.length - 1];
+    }
+
+    /**
+     * Returns the number of transposes that are performed for each
+     * execution. This is 0 if the input and the output order are equal.
+     *
+     * @return The number of transposes
+     */
+    public int getTransposeCount()
+    {
+        return operations.length;
+    }
+
+    /**
+     * Returns the number of bytes of the output of the plan
+     *
+     * @return The number of bytes
+     */
+    private long getOutputBytes()
+    {
+        long elements = 1;
+        for (long size : outputSizes)
+        {
+            elements *= size;
+        }
+        return elements * outputElementSize();
+    }
+
+    /**
+     * Returns the size of one output element, in bytes
+     *
+     * @return The element size
+     */
+    private int outputElementSize()
+    {
+        int size = JCufftUtils.elementSize(type);
+        if (type == cufftType.CUFFT_C2R || type == cufftType.CUFFT_Z2D)
+        {
+            return size;
+        }
+        return 2 * size;
+    }
+
+    /**
+     * Throws an IllegalStateException if this object has been destroyed
+     */
+    private void checkNotDestroyed()
+    {
+        if (destroyed)
+        {
+            throw new IllegalStateException("The PermutedPlan was destroyed");
+        }
+    }
+
+    /**
+     * Releases the plan and the buffers of this object
+     */
+    public synchronized void destroy()
+    {
+        if (destroyed)
+        {
+            return;
+        }
+        destroyed = true;
+        registration.clean();
+    }
+
+    /**
+     * Equivalent to {@link #destroy()}
+     */
+    @Override
+    public void close()
+    {
+        destroy();
+    }
+
+    @Override
+    public String toString()
+    {
+        return "PermutedPlan[type=" + cufftType.stringFor(type) +
+            ",n=" + Arrays.toString(n) +
+            ",inputOrder=" + Arrays.toString(inputOrder) +
+            ",outputOrder=" + Arrays.toString(outputOrder) +
+            ",transposes=" + operations.length + "]";
+    }
+}
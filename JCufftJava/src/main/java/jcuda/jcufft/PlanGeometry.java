@@ -0,0 +1,792 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.util.Arrays;
+
+/**
+ * An immutable description of the geometry of a plan, consisting of
+ * the parameters of <code>cufftPlanMany</code>: The rank, the sizes,
+ * the optional advanced data layout, the cufftType and the batch size.
+ * <br>
+ * <br>
+ * Instances of this class may be used as keys in maps. They are
+ * created with the static factory methods, and may be used to create
+ * plans with {@link #createPlan(cufftHandle)}.
+ */
+public final class PlanGeometry
+{
+    /**
+     * The rank of the transform
+     */
+    private final int rank;
+
+    /**
+     * The size of each dimension
+     */
+    private final long n[];
+
+    /**
+     * The storage dimensions of the input data, or <code>null</code>
+     */
+    private final long inembed[];
+
+    /**
+     * The input stride
+     */
+    private final long istride;
+
+    /**
+     * The input distance
+     */
+    private final long idist;
+
+    /**
+     * The storage dimensions of the output data, or <code>null</code>
+     */
+    private final long onembed[];
+
+    /**
+     * The output stride
+     */
+    private final long ostride;
+
+    /**
+     * The output distance
+     */
+    private final long odist;
+
+    /**
+     * The cufftType
+     */
+    private final int type;
+
+    /**
+     * The batch size
+     */
+    private final long batch;
+
+    /**
+     * Whether the geometry requires the 64 bit plan functions
+     */
+    private final boolean requires64;
+
+    /**
+     * The hash code
+     */
+    private final int hashCode;
+
+    /**
+     * Creates a new geometry. See {@link #ofMany64} for the parameters.
+     */
+    private PlanGeometry(int rank, long n[],
+        long inembed[], long istride, long idist,
+        long onembed[], long ostride, long odist,
+        int type, long batch)
+    {
+        if (rank < 1 || rank > 3)
+        {
+            throw new IllegalArgumentException(
+                "The rank must be 1, 2 or 3, but is " + rank);
+        }
+        if (n == null)
+        {
+            throw new NullPointerException("The sizes are null");
+        }
+        if (n.length < rank)
+        {
+            throw new IllegalArgumentException(
+                "Expected " + rank + " sizes, but found " + n.length);
+        }
+        this.rank = rank;
+        this.n = Arrays.copyOf(n, rank);
+        // CUFFT uses the basic data layout for input and output, and
+        // ignores all other layout parameters, if either embed is null
+        boolean basic = inembed == null || onembed == null;
+        this.inembed = basic ? null : Arrays.copyOf(inembed, rank);
+        this.onembed = basic ? null : Arrays.copyOf(onembed, rank);
+        this.istride = this.inembed == null ? 1 : istride;
+        this.idist = this.inembed == null ? 0 : idist;
+        this.ostride = this.onembed == null ? 1 : ostride;
+        this.odist = this.onembed == null ? 0 : odist;
+        this.type = type;
+        this.batch = batch;
+        this.requires64 = !fitsInt(this.n) || !fitsInt(this.inembed) ||
+            !fitsInt(this.onembed) || !fitsInt(
+                this.istride, this.idist, this.ostride, this.odist, batch);
+
+        int h = rank;
+        h = 31 * h + Arrays.hashCode(this.n);
+        h = 31 * h + Arrays.hashCode(this.inembed);
+        h = 31 * h + Long.hashCode(this.istride);
+        h = 31 * h + Long.hashCode(this.idist);
+        h = 31 * h + Arrays.hashCode(this.onembed);
+        h = 31 * h + Long.hashCode(this.ostride);
+        h = 31 * h + Long.hashCode(this.odist);
+        h = 31 * h + type;
+        h = 31 * h + Long.hashCode(batch);
+        this.hashCode = h;
+    }
+
+    /**
+     * Creates the geometry of a 1D plan, as created with
+     * {@link JCufft#cufftPlan1d(cufftHandle, int, int, int)}
+     *
+     * @param nx The transform size
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The geometry
+     */
+    public static PlanGeometry of1d(int nx, int type, int batch)
+    {
+        return new PlanGeometry(1, new long[] { nx },
+            null, 1, 0, null, 1, 0, type, batch);
+    }
+
+    /**
+     * Creates the geometry of a 2D plan, as created with
+     * {@link JCufft#cufftPlan2d(cufftHandle, int, int, int)}
+     *
+     * @param nx The transform size in x
+     * @param ny The transform size in y
+     * @param type The cufftType
+     * @return The geometry
+     */
+    public static PlanGeometry of2d(int nx, int ny, int type)
+    {
+        return new PlanGeometry(2, new long[] { nx, ny },
+            null, 1, 0, null, 1, 0, type, 1);
+    }
+
+    /**
+     * Creates the geometry of a 3D plan, as created with
+     * {@link JCufft#cufftPlan3d(cufftHandle, int, int, int, int)}
+     *
+     * @param nx The transform size in x
+     * @param ny The transform size in y
+     * @param nz The transform size in z
+     * @param type The cufftType
+     * @return The geometry
+     */
+    public static PlanGeometry of3d(int nx, int ny, int nz, int type)
+    {
+        return new PlanGeometry(3, new long[] { nx, ny, nz },
+            null, 1, 0, null, 1, 0, type, 1);
+    }
+
+    /**
+     * Creates the geometry of a plan, as created with
+     * {@link JCufft#cufftPlanMany}. If one of the embed arrays is
+     * <code>null</code>, then both of them, as well as the strides
+     * and distances, are ignored, as in CUFFT.
+     *
+     * @param rank The rank
+     * @param n The size of each dimension
+     * @param inembed The input storage dimensions, or <code>null</code>
+     * @param istride The input stride
+     * @param idist The input distance
+     * @param onembed The output storage dimensions, or <code>null</code>
+     * @param ostride The output stride
+     * @param odist The output distance
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The geometry
+     */
+    public static PlanGeometry ofMany(int rank, int n[],
+        int inembed[], int istride, int idist,
+        int onembed[], int ostride, int odist,
+        int type, int batch)
+    {
+        return new PlanGeometry(rank, toLong(n),
+            toLong(inembed), istride, idist,
+            toLong(onembed), ostride, odist, type, batch);
+    }
+
+    /**
+     * Creates the geometry of a plan, as created with
+     * {@link JCufft#cufftMakePlanMany64}. See
+     * {@link #ofMany(int, int[], int[], int, int, int[], int, int, int, int)}
+     * for the parameters.
+     *
+     * @param rank The rank
+     * @param n The size of each dimension
+     * @param inembed The input storage dimensions, or <code>null</code>
+     * @param istride The input stride
+     * @param idist The input distance
+     * @param onembed The output storage dimensions, or <code>null</code>
+     * @param ostride The output stride
+     * @param odist The output distance
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The geometry
+     */
+    public static PlanGeometry ofMany64(int rank, long n[],
+        long inembed[], long istride, long idist,
+        long onembed[], long ostride, long odist,
+        int type, long batch)
+    {
+        return new PlanGeometry(rank, n,
+            inembed, istride, idist,
+            onembed, ostride, odist, type, batch);
+    }
+
+    /**
+     * Returns a geometry that is equal to this one, but with the
+     * given batch size
+     *
+     * @param newBatch The batch size
+     * @return The new geometry
+     */
+    public PlanGeometry withBatch(long newBatch)
+    {
+        return new PlanGeometry(rank, n,
+            inembed, istride, idist,
+            onembed, ostride, odist, type, newBatch);
+    }
+
+    /**
+     * Creates a plan with this geometry. The plan is created with
+     * <code>cufftPlanMany</code>, or with <code>cufftCreate</code> and
+     * <code>cufftMakePlanMany64</code> if any parameter exceeds the
+     * range of an <code>int</code>.
+     *
+     * @param plan The plan that will be created
+     * @return The cufftResult
+     */
+    public int createPlan(cufftHandle plan)
+    {
+        if (!requires64)
+        {
+            return JCufft.cufftPlanMany(plan, rank, toInt(n),
+                toInt(inembed), (int)istride, (int)idist,
+                toInt(onembed), (int)ostride, (int)odist,
+                type, (int)batch);
+        }
+        int result = JCufft.cufftCreate(plan);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            return result;
+        }
+        result = makePlan(plan, new long[1]);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            JCufft.cufftDestroy(plan);
+        }
+        return result;
+    }
+
+    /**
+     * Makes a plan with this geometry, for a handle that was created
+     * with <code>cufftCreate</code>. The plan is made with
+     * <code>cufftMakePlanMany</code>, or with
+     * <code>cufftMakePlanMany64</code> if any parameter exceeds the
+     * range of an <code>int</code>.
+     *
+     * @param plan The plan
+     * @param workSize Will store the size of the work area, in bytes
+     * @return The cufftResult
+     */
+    public int makePlan(cufftHandle plan, long workSize[])
+    {
+        if (!requires64)
+        {
+            return JCufft.cufftMakePlanMany(plan, rank, toInt(n),
+                toInt(inembed), (int)istride, (int)idist,
+                toInt(onembed), (int)ostride, (int)odist,
+                type, (int)batch, workSize);
+        }
+        return JCufft.cufftMakePlanMany64(plan, rank, n.clone(),
+            inembed == null ? null : inembed.clone(), istride, idist,
+            onembed == null ? null : onembed.clone(), ostride, odist,
+            type, batch, workSize);
+    }
+
+    /**
+     * Computes the size of the work area of a plan with this geometry,
+     * without creating the plan. The size is computed with
+     * <code>cufftEstimateMany</code>, or with
+     * <code>cufftGetSizeMany64</code> for a temporary handle if any
+     * parameter exceeds the range of an <code>int</code>. The results
+     * are cached in the native library, see
+     * {@link JCufft#setEstimateCacheEnabled(boolean)}.
+     *
+     * @param workSize Will store the size of the work area, in bytes
+     * @return The cufftResult
+     */
+    public int estimate(long workSize[])
+    {
+        if (!requires64)
+        {
+            return JCufft.cufftEstimateMany(rank, toInt(n),
+                toInt(inembed), (int)istride, (int)idist,
+                toInt(onembed), (int)ostride, (int)odist,
+                type, (int)batch, workSize);
+        }
+        cufftHandle plan = new cufftHandle();
+        int result = JCufft.cufftCreate(plan);
+        if (result != cufftResult.CUFFT_SUCCESS)
+        {
+            return result;
+        }
+        try
+        {
+            return JCufft.cufftGetSizeMany64(plan, rank, n.clone(),
+                inembed == null ? null : inembed.clone(), istride, idist,
+                onembed == null ? null : onembed.clone(), ostride, odist,
+                type, batch, workSize);
+        }
+        finally
+        {
+            JCufft.cufftDestroy(plan);
+        }
+    }
+
+    /**
+     * Returns the rank
+     *
+     * @return The rank
+     */
+    public int getRank()
+    {
+        return rank;
+    }
+
+    /**
+     * Returns a copy of the sizes of the dimensions
+     *
+     * @return The sizes
+     */
+    public long[] getSizes()
+    {
+        return n.clone();
+    }
+
+    /**
+     * Returns the size of the given dimension
+     *
+     * @param dimension The dimension
+     * @return The size
+     * @throws IndexOutOfBoundsException If the dimension is not
+     * smaller than the rank
+     */
+    public long getSize(int dimension)
+    {
+        return n[dimension];
+    }
+
+    /**
+     * Returns a copy of the input storage dimensions, or
+     * <code>null</code> if the basic data layout is used
+     *
+     * @return The input storage dimensions
+     */
+    public long[] getInembed()
+    {
+        return inembed == null ? null : inembed.clone();
+    }
+
+    /**
+     * Returns the input stride
+     *
+     * @return The input stride
+     */
+    public long getIstride()
+    {
+        return istride;
+    }
+
+    /**
+     * Returns the input distance
+     *
+     * @return The input distance
+     */
+    public long getIdist()
+    {
+        return idist;
+    }
+
+    /**
+     * Returns a copy of the output storage dimensions, or
+     * <code>null</code> if the basic data layout is used
+     *
+     * @return The output storage dimensions
+     */
+    public long[] getOnembed()
+    {
+        return onembed == null ? null : onembed.clone();
+    }
+
+    /**
+     * Returns the output stride
+     *
+     * @return The output stride
+     */
+    public long getOstride()
+    {
+        return ostride;
+    }
+
+    /**
+     * Returns the output distance
+     *
+     * @return The output distance
+     */
+    public long getOdist()
+    {
+        return odist;
+    }
+
+    /**
+     * Returns the cufftType
+     *
+     * @return The cufftType
+     */
+    public int getType()
+    {
+        return type;
+    }
+
+    /**
+     * Returns the batch size
+     *
+     * @return The batch size
+     */
+    public long getBatch()
+    {
+        return batch;
+    }
+
+    /**
+     * Returns whether plans with this geometry have to be created with
+     * the 64 bit plan functions
+     *
+     * @return Whether the geometry requires the 64 bit functions
+     */
+    public boolean requires64()
+    {
+        return requires64;
+    }
+
+    /**
+     * Returns the number of elements of a single transform, which is
+     * the product of all sizes
+     *
+     * @return The number of elements
+     */
+    public long getElementCount()
+    {
+        long result = 1;
+        for (long s : n)
+        {
+            result *= s;
+        }
+        return result;
+    }
+
+    /**
+     * Returns the number of complex elements of a single transform
+     * in the non-redundant half of a Hermitian spectrum. This is the
+     * product of all sizes, where the last size is replaced with
+     * <code>n[rank-1]/2+1</code>.
+     *
+     * @return The number of complex elements
+     */
+    long getHalfSpectrumElementCount()
+    {
+        long result = n[rank - 1] / 2 + 1;
+        for (int i = 0; i < rank - 1; i++)
+        {
+            result *= n[i];
+        }
+        return result;
+    }
+
+    /**
+     * Returns the number of input elements that are read by a transform
+     * with this geometry, from the first element of the first batch up
+     * to and including the last element of the last batch
+     *
+     * @return The input extent, in input elements
+     */
+    long getInputExtent()
+    {
+        if (inembed == null)
+        {
+            return batch * getInputDistance();
+        }
+        boolean half = type == cufftType.CUFFT_C2R ||
+            type == cufftType.CUFFT_Z2D;
+        return extent(inembed, istride, idist, half);
+    }
+
+    /**
+     * Returns the number of output elements that are written by a
+     * transform with this geometry, from the first element of the first
+     * batch up to and including the last element of the last batch
+     *
+     * @return The output extent, in output elements
+     */
+    long getOutputExtent()
+    {
+        if (onembed == null)
+        {
+            return batch * getOutputDistance();
+        }
+        boolean half = type == cufftType.CUFFT_R2C ||
+            type == cufftType.CUFFT_D2Z;
+        return extent(onembed, ostride, odist, half);
+    }
+
+    /**
+     * Returns the extent of the data with the given advanced layout,
+     * in elements
+     *
+     * @param embed The storage dimensions
+     * @param stride The stride
+     * @param dist The distance
+     * @param half Whether the data is the non-redundant half of a
+     * Hermitian spectrum, with <code>n[rank-1]/2+1</code> elements in
+     * the last dimension
+     * @return The extent
+     */
+    private long extent(long embed[], long stride, long dist, boolean half)
+    {
+        if (batch <= 0)
+        {
+            return 0;
+        }
+        long last = 0;
+        long pitch = 1;
+        for (int i = rank - 1; i >= 0; i--)
+        {
+            long size = (half && i == rank - 1) ? n[i] / 2 + 1 : n[i];
+            last += (size - 1) * pitch;
+            pitch *= embed[i];
+        }
+        return (batch - 1) * dist + last * stride + 1;
+    }
+
+    /**
+     * Returns whether the input of the transform is complex
+     *
+     * @return Whether the input is complex
+     */
+    private boolean isComplexInput()
+    {
+        return type != cufftType.CUFFT_R2C && type != cufftType.CUFFT_D2Z;
+    }
+
+    /**
+     * Returns whether the output of the transform is complex
+     *
+     * @return Whether the output is complex
+     */
+    private boolean isComplexOutput()
+    {
+        return type != cufftType.CUFFT_C2R && type != cufftType.CUFFT_Z2D;
+    }
+
+    /**
+     * Returns the size of a single input element, in bytes
+     *
+     * @return The input element size
+     */
+    public int getInputElementSize()
+    {
+        int size = JCufftUtils.elementSize(type);
+        return isComplexInput() ? 2 * size : size;
+    }
+
+    /**
+     * Returns the size of a single output element, in bytes
+     *
+     * @return The output element size
+     */
+    public int getOutputElementSize()
+    {
+        int size = JCufftUtils.elementSize(type);
+        return isComplexOutput() ? 2 * size : size;
+    }
+
+    /**
+     * Returns the distance between the first input elements of two
+     * consecutive batches, in input elements. For the basic data layout,
+     * this is the number of input elements of a single (out-of-place)
+     * transform.
+     *
+     * @return The input distance
+     */
+    public long getInputDistance()
+    {
+        if (inembed != null)
+        {
+            return idist;
+        }
+        if (type == cufftType.CUFFT_C2R || type == cufftType.CUFFT_Z2D)
+        {
+            return getHalfSpectrumElementCount();
+        }
+        return getElementCount();
+    }
+
+    /**
+     * Returns the distance between the first output elements of two
+     * consecutive batches, in output elements. For the basic data layout,
+     * this is the number of output elements of a single (out-of-place)
+     * transform.
+     *
+     * @return The output distance
+     */
+    public long getOutputDistance()
+    {
+        if (onembed != null)
+        {
+            return odist;
+        }
+        if (type == cufftType.CUFFT_R2C || type == cufftType.CUFFT_D2Z)
+        {
+            return getHalfSpectrumElementCount();
+        }
+        return getElementCount();
+    }
+
+    @Override
+    public int hashCode()
+    {
+        return hashCode;
+    }
+
+    @Override
+    public boolean equals(Object object)
+    {
+        if (this == object)
+        {
+            return true;
+        }
+        if (!(object instanceof PlanGeometry))
+        {
+            return false;
+        }
+        PlanGeometry other = (PlanGeometry)object;
+        return
+            rank == other.rank &&
+            type == other.type &&
+            batch == other.batch &&
+            istride == other.istride &&
+            idist == other.idist &&
+            ostride == other.ostride &&
+            odist == other.odist &&
+            Arrays.equals(n, other.n) &&
+            Arrays.equals(inembed, other.inembed) &&
+            Arrays.equals(onembed, other.onembed);
+    }
+
+    @Override
+    public String toString()
+    {
+        String result = "PlanGeometry[rank=" + rank +
+            ",n=" + Arrays.toString(n) +
+            ",type=" + cufftType.stringFor(type) +
+            ",batch=" + batch;
+        if (inembed != null)
+        {
+            result += ",inembed=" + Arrays.toString(inembed) +
+                ",istride=" + istride + ",idist=" + idist;
+        }
+        if (onembed != null)
+        {
+            result += ",onembed=" + Arrays.toString(onembed) +
+                ",ostride=" + ostride + ",odist=" + odist;
+        }
+        return result + "]";
+    }
+
+    /**
+     * Converts the given array to a long array
+     *
+     * @param array The array, may be <code>null</code>
+     * @return The result, or <code>null</code>
+     */
+    private static long[] toLong(int array[])
+    {
+        if (array == null)
+        {
+            return null;
+        }
+        long result[] = new long[array.length];
+        for (int i = 0; i < array.length; i++)
+        {
+            result[i] = array[i];
+        }
+        return result;
+    }
+
+    /**
+     * Converts the given array to an int array. The caller is
+     * responsible for checking that the values fit into an int.
+     *
+     * @param array The array, may be <code>null</code>
+     * @return The result, or <code>null</code>
+     */
+    private static int[] toInt(long array[])
+    {
+        if (array == null)
+        {
+            return null;
+        }
+        int result[] = new int[array.length];
+        for (int i = 0; i < array.length; i++)
+        {
+            result[i] = (int)array[i];
+        }
+        return result;
+    }
+
+    /**
+     * Returns whether all given values fit into an int
+     *
+     * @param values The values, may be <code>null</code>
+     * @return Whether the values fit into an int
+     */
+    private static boolean fitsInt(long ... values)
+    {
+        if (values == null)
+        {
+            return true;
+        }
+        for (long v : values)
+        {
+            if (v < Integer.MIN_VALUE || v > Integer.MAX_VALUE)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,413 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.util.Arrays;
+
+/**
+ * An immutable snapshot of the execution statistics of a single plan,
+ * as returned by {@link JCufft#getPlanStatistics(cufftHandle)}.<br>
+ * <br>
+ * The device times are measured with CUDA events that are recorded on
+ * the stream of the plan around each exec call, and collected lazily.
+ * Executions whose events have not completed yet when the snapshot is
+ * taken are not contained in the device time histogram. When more
+ * executions are in flight than there are event pairs, these executions
+ * are only counted as {@link #getUntimedCount() untimed}.<br>
+ * <br>
+ * The transfer times are the times of the host-device copies that are
+ * done by the array overloads of the exec methods.<br>
+ * <br>
+ * All times are given in nanoseconds. The percentiles are computed from
+ * log-linear histograms, and thus have a relative error of at most
+ * 12.5 percent.
+ */
+public final class PlanStatistics
+{
+    /**
+     * The number of sub-buckets per power of two in the histograms
+     */
+    private static final int SUB_BUCKET_BITS = 3;
+
+    /**
+     * The number of sub-buckets per power of two in the histograms
+     */
+    private static final int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    /**
+     * The number of values before the histogram buckets in the
+     * array that is returned by the native method
+     */
+    private static final int HEADER_SIZE = 11;
+
+    /**
+     * The number of successful executions
+     */
+    private final long execCount;
+
+    /**
+     * The number of failed executions
+     */
+    private final long failedCount;
+
+    /**
+     * The number of bytes that have been read and written by the
+     * successful executions
+     */
+    private final long bytesMoved;
+
+    /**
+     * The number of executions for which no device time was measured
+     */
+    private final long untimedCount;
+
+    /**
+     * The device time histogram
+     */
+    private final Histogram deviceTime;
+
+    /**
+     * The number of bytes that have been transferred
+     */
+    private final long transferBytes;
+
+    /**
+     * The transfer time histogram
+     */
+    private final Histogram transferTime;
+
+    /**
+     * Creates a new snapshot from the given data that was obtained
+     * from the native library
+     *
+     * @param data The data
+     */
+    PlanStatistics(long data[])
+    {
+        int buckets = (data.length - HEADER_SIZE) / 2;
+        this.execCount = data[0];
+        this.failedCount = data[1];
+        this.bytesMoved = data[2];
+        this.untimedCount = data[3];
+        this.deviceTime = new Histogram(data[4], data[5], data[6],
+            Arrays.copyOfRange(data, HEADER_SIZE, HEADER_SIZE + buckets));
+        this.transferBytes = data[7];
+        this.transferTime = new Histogram(data[8], data[9], data[10],
+            Arrays.copyOfRange(data, HEADER_SIZE + buckets, data.length));
+    }
+
+    /**
+     * Returns the number of successful executions of the plan
+     *
+     * @return The number of executions
+     */
+    public long getExecCount()
+    {
+        return execCount;
+    }
+
+    /**
+     * Returns the number of executions of the plan that did not
+     * return cufftResult.CUFFT_SUCCESS
+     *
+     * @return The number of failed executions
+     */
+    public long getFailedCount()
+    {
+        return failedCount;
+    }
+
+    /**
+     * Returns the number of bytes that have been read and written by
+     * the successful executions. This is computed from the size and
+     * type of the plan, assuming that each input and output element
+     * is accessed once.
+     *
+     * @return The number of bytes
+     */
+    public long getBytesMoved()
+    {
+        return bytesMoved;
+    }
+
+    /**
+     * Returns the number of successful executions for which no device
+     * time could be measured
+     *
+     * @return The number of untimed executions
+     */
+    public long getUntimedCount()
+    {
+        return untimedCount;
+    }
+
+    /**
+     * Returns the number of executions for which the device time has
+     * been recorded
+     *
+     * @return The number of timed executions
+     */
+    public long getTimedCount()
+    {
+        return deviceTime.count;
+    }
+
+    /**
+     * Returns the total device time of all timed executions
+     *
+     * @return The total device time, in nanoseconds
+     */
+    public long getTotalDeviceTime()
+    {
+        return deviceTime.total;
+    }
+
+    /**
+     * Returns the mean device time of the timed executions, or 0 if
+     * no execution has been timed
+     *
+     * @return The mean device time, in nanoseconds
+     */
+    public double getMeanDeviceTime()
+    {
+        return deviceTime.mean();
+    }
+
+    /**
+     * Returns the maximum device time of the timed executions
+     *
+     * @return The maximum device time, in nanoseconds
+     */
+    public long getMaxDeviceTime()
+    {
+        return deviceTime.max;
+    }
+
+    /**
+     * Returns an upper bound for the given percentile of the device
+     * times of the timed executions, or 0 if no execution has been
+     * timed
+     *
+     * @param percentile The percentile, between 0.0 and 100.0
+     * @return The device time percentile, in nanoseconds
+     * @throws IllegalArgumentException If the percentile is not
+     * between 0.0 and 100.0
+     */
+    public long getDeviceTimePercentile(double percentile)
+    {
+        return deviceTime.percentile(percentile);
+    }
+
+    /**
+     * Returns the number of host-device transfers that have been
+     * recorded for the plan
+     *
+     * @return The number of transfers
+     */
+    public long getTransferCount()
+    {
+        return transferTime.count;
+    }
+
+    /**
+     * Returns the number of bytes that have been transferred between
+     * the host and the device for the plan
+     *
+     * @return The number of bytes
+     */
+    public long getTransferBytes()
+    {
+        return transferBytes;
+    }
+
+    /**
+     * Returns the total time of all recorded transfers
+     *
+     * @return The total transfer time, in nanoseconds
+     */
+    public long getTotalTransferTime()
+    {
+        return transferTime.total;
+    }
+
+    /**
+     * Returns the maximum time of a single recorded transfer
+     *
+     * @return The maximum transfer time, in nanoseconds
+     */
+    public long getMaxTransferTime()
+    {
+        return transferTime.max;
+    }
+
+    /**
+     * Returns an upper bound for the given percentile of the transfer
+     * times, or 0 if no transfer has been recorded
+     *
+     * @param percentile The percentile, between 0.0 and 100.0
+     * @return The transfer time percentile, in nanoseconds
+     * @throws IllegalArgumentException If the percentile is not
+     * between 0.0 and 100.0
+     */
+    public long getTransferTimePercentile(double percentile)
+    {
+        return transferTime.percentile(percentile);
+    }
+
+    @Override
+    public String toString()
+    {
+        return "PlanStatistics["+
+            "execCount="+execCount+","+
+            "failedCount="+failedCount+","+
+            "bytesMoved="+bytesMoved+","+
+            "untimedCount="+untimedCount+","+
+            "meanDeviceTime="+(long)getMeanDeviceTime()+","+
+            "p50DeviceTime="+getDeviceTimePercentile(50)+","+
+            "p99DeviceTime="+getDeviceTimePercentile(99)+","+
+            "maxDeviceTime="+getMaxDeviceTime()+","+
+            "transferCount="+getTransferCount()+","+
+            "transferBytes="+transferBytes+","+
+            "totalTransferTime="+getTotalTransferTime()+"]";
+    }
+
+    /**
+     * A snapshot of a log-linear histogram. Values below SUB_BUCKETS
+     * have their own bucket. Above that, each power of two is divided
+     * into SUB_BUCKETS buckets of equal size.
+     */
+    private static final class Histogram
+    {
+        /**
+         * The number of recorded values
+         */
+        private final long count;
+
+        /**
+         * The sum of the recorded values
+         */
+        private final long total;
+
+        /**
+         * The maximum recorded value
+         */
+        private final long max;
+
+        /**
+         * The counts of the buckets
+         */
+        private final long buckets[];
+
+        /**
+         * Creates a new histogram
+         *
+         * @param count The number of values
+         * @param total The sum of the values
+         * @param max The maximum value
+         * @param buckets The bucket counts
+         */
+        Histogram(long count, long total, long max, long buckets[])
+        {
+            this.count = count;
+            this.total = total;
+            this.max = max;
+            this.buckets = buckets;
+        }
+
+        /**
+         * Returns the mean of the values
+         *
+         * @return The mean
+         */
+        double mean()
+        {
+            if (count == 0)
+            {
+                return 0;
+            }
+            return (double)total / count;
+        }
+
+        /**
+         * Returns the upper bound of the bucket that contains the
+         * given percentile of the values, limited to the maximum
+         *
+         * @param percentile The percentile
+         * @return The value
+         */
+        long percentile(double percentile)
+        {
+            if (percentile < 0.0 || percentile > 100.0)
+            {
+                throw new IllegalArgumentException(
+                    "The percentile must be between 0 and 100, but is "+
+                    percentile);
+            }
+            long bucketTotal = 0;
+            for (long c : buckets)
+            {
+                bucketTotal += c;
+            }
+            if (bucketTotal == 0)
+            {
+                return 0;
+            }
+            long rank = (long)Math.ceil(percentile / 100.0 * bucketTotal);
+            rank = Math.max(1, rank);
+            long cumulative = 0;
+            for (int i = 0; i < buckets.length; i++)
+            {
+                cumulative += buckets[i];
+                if (cumulative >= rank)
+                {
+                    return Math.min(max, upperBound(i));
+                }
+            }
+            return max;
+        }
+
+        /**
+         * Returns the largest value that is recorded in the bucket with
+         * the given index
+         *
+         * @param index The bucket index
+         * @return The upper bound
+         */
+        private static long upperBound(int index)
+        {
+            if (index < SUB_BUCKETS)
+            {
+                return index;
+            }
+            int shift = index / SUB_BUCKETS - 1;
+            long subBucket = index % SUB_BUCKETS + SUB_BUCKETS;
+            return ((subBucket + 1) << shift) - 1;
+        }
+    }
+}
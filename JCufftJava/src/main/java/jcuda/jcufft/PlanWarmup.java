@@ -0,0 +1,700 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.io.BufferedReader;
+import java.io.BufferedWriter;
+import java.io.File;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Queue;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.function.Supplier;
+import java.util.logging.Level;
+import java.util.logging.Logger;
+
+import jcuda.runtime.JCuda;
+
+/**
+ * Pre-building of plans, to avoid the planning latency when a geometry
+ * is used for the first time.<br>
+ * <br>
+ * All geometries of the plans that are created in a process are
+ * recorded, together with the size of their work areas and the number
+ * of plans that have been created with them. They can be written to a
+ * file with {@link #export(File)}. When the file is passed to
+ * {@link #warmUp(File)} in a later process, plans for these geometries
+ * are created in parallel in background threads. When a plan is then
+ * created with {@link JCufft#cufftPlan1d}, {@link JCufft#cufftPlan2d},
+ * {@link JCufft#cufftPlan3d} or {@link JCufft#cufftPlanMany} for one
+ * of these geometries, on the device that the warm-up was started on,
+ * the handle receives the pre-built plan instead of planning a new
+ * one.<br>
+ * <br>
+ * When the system property <code>jcufft.warmup</code> is set to a file
+ * name, then the warm-up is started from this file when JCufft is
+ * initialized, if the file exists, and the geometries are exported to
+ * this file when the JVM shuts down.<br>
+ * <br>
+ * The warm-up respects the budget of the {@link MemoryBudget}: Plans
+ * whose work areas would exceed the budget are not pre-built. Plans
+ * that are pre-built but never used keep their work areas until they
+ * are released with {@link #discardWarmPlans()}.
+ */
+public final class PlanWarmup
+{
+    /**
+     * The logger used in this class
+     */
+    private static final Logger logger =
+        Logger.getLogger(PlanWarmup.class.getName());
+
+    /**
+     * The name of the system property for the warm-up file
+     */
+    private static final String WARMUP_PROPERTY = "jcufft.warmup";
+
+    /**
+     * The first line of a warm-up file
+     */
+    private static final String HEADER = "# JCufft plan geometries, version 1";
+
+    /**
+     * The maximum number of geometries that are recorded
+     */
+    private static final int MAX_GEOMETRIES = 1024;
+
+    /**
+     * A recorded geometry
+     */
+    private static final class Usage
+    {
+        /**
+         * The size of the work area, in bytes, or -1 if it is not known
+         */
+        final AtomicLong workSize = new AtomicLong(-1);
+
+        /**
+         * The number of plans that have been created with the geometry
+         */
+        final AtomicLong count = new AtomicLong();
+    }
+
+    /**
+     * The recorded geometries
+     */
+    private static final Map<PlanGeometry, Usage> usages =
+        new ConcurrentHashMap<PlanGeometry, Usage>();
+
+    /**
+     * The pre-built plans, for each device
+     */
+    private static final Map<Integer, Map<PlanGeometry, Queue<cufftHandle>>>
+        warmPlans = new ConcurrentHashMap<Integer,
+            Map<PlanGeometry, Queue<cufftHandle>>>();
+
+    /**
+     * The number of pre-built plans that have not been taken yet
+     */
+    private static final AtomicInteger warmPlanCount = new AtomicInteger();
+
+    /**
+     * Whether the current thread is building warm plans, in which case
+     * the plans that it creates are not taken from the warm plans, and
+     * not counted as uses
+     */
+    private static final ThreadLocal<Boolean> warming =
+        new ThreadLocal<Boolean>();
+
+    /**
+     * Whether the startup warm-up has been started
+     */
+    private static boolean startupDone = false;
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private PlanWarmup()
+    {
+    }
+
+    /**
+     * Writes the geometries of all plans that have been created in this
+     * process, and the geometries that have been read for a warm-up, to
+     * the given file. The geometries are sorted by the number of plans
+     * that have been created with them, in descending order.
+     *
+     * @param file The file
+     * @throws IOException If the file can not be written
+     */
+    public static void export(File file) throws IOException
+    {
+        List<Map.Entry<PlanGeometry, Usage>> entries =
+            new ArrayList<Map.Entry<PlanGeometry, Usage>>(usages.entrySet());
+        Collections.sort(entries, (e0, e1) ->
+            Long.compare(e1.getValue().count.get(), e0.getValue().count.get()));
+        File parent = file.getAbsoluteFile().getParentFile();
+        File temp = File.createTempFile("jcufft", ".tmp", parent);
+        try (BufferedWriter writer = Files.newBufferedWriter(
+            temp.toPath(), StandardCharsets.UTF_8))
+        {
+            writer.write(HEADER);
+            writer.newLine();
+            writer.write("# type rank n inembed istride idist " +
+                "onembed ostride odist batch workSize count");
+            writer.newLine();
+            for (Map.Entry<PlanGeometry, Usage> entry : entries)
+            {
+                writer.write(format(entry.getKey(), entry.getValue()));
+                writer.newLine();
+            }
+        }
+        Files.move(temp.toPath(), file.toPath(),
+            StandardCopyOption.REPLACE_EXISTING);
+    }
+
+    /**
+     * Reads the geometries from the given file, which must have been
+     * written with {@link #export(File)}. Lines that can not be parsed
+     * are skipped. The geometries are also recorded, so that they are
+     * contained in the next export.
+     *
+     * @param file The file
+     * @return The geometries, in the order of the file
+     * @throws IOException If the file can not be read
+     */
+    public static List<PlanGeometry> read(File file) throws IOException
+    {
+        Map<PlanGeometry, long[]> result =
+            new LinkedHashMap<PlanGeometry, long[]>();
+        try (BufferedReader reader = Files.newBufferedReader(
+            file.toPath(), StandardCharsets.UTF_8))
+        {
+            String line = null;
+            while ((line = reader.readLine()) != null)
+            {
+                line = line.trim();
+                if (line.isEmpty() || line.startsWith("#"))
+                {
+                    continue;
+                }
+                try
+                {
+                    parse(line, result);
+                }
+                catch (IllegalArgumentException e)
+                {
+                    logger.log(Level.WARNING,
+                        "Skipping invalid geometry in " + file + ": " + line);
+                }
+            }
+        }
+        for (Map.Entry<PlanGeometry, long[]> entry : result.entrySet())
+        {
+            Usage usage = usage(entry.getKey());
+            if (usage != null)
+            {
+                usage.workSize.compareAndSet(-1, entry.getValue()[0]);
+                usage.count.addAndGet(entry.getValue()[1]);
+            }
+        }
+        return new ArrayList<PlanGeometry>(result.keySet());
+    }
+
+    /**
+     * Reads the geometries from the given file, and pre-builds plans
+     * for them in the background. See {@link #warmUp(Collection)}.
+     *
+     * @param file The file
+     * @return A future that is completed with the number of plans that
+     * have been pre-built
+     * @throws IOException If the file can not be read
+     */
+    public static CompletableFuture<Integer> warmUp(File file)
+        throws IOException
+    {
+        return warmUp(read(file));
+    }
+
+    /**
+     * Pre-builds one plan for each of the given geometries, in parallel
+     * background threads, on the device that is current for the calling
+     * thread. Geometries whose plans fail to build are skipped. When the
+     * work area of a plan would exceed the {@link MemoryBudget}, then no
+     * further plans are built.
+     *
+     * @param geometries The geometries
+     * @return A future that is completed with the number of plans that
+     * have been pre-built
+     */
+    public static CompletableFuture<Integer> warmUp(
+        Collection<PlanGeometry> geometries)
+    {
+        List<PlanGeometry> list = new ArrayList<PlanGeometry>(geometries);
+        if (list.isEmpty())
+        {
+            return CompletableFuture.completedFuture(0);
+        }
+        int device[] = { 0 };
+        JCuda.cudaGetDevice(device);
+        int threads = Math.min(list.size(),
+            Math.max(1, Runtime.getRuntime().availableProcessors() / 2));
+        AtomicInteger threadCounter = new AtomicInteger();
+        ExecutorService executor = Executors.newFixedThreadPool(threads, r ->
+        {
+            Thread thread = new Thread(r,
+                "JCufft plan warm-up " + threadCounter.incrementAndGet());
+            thread.setDaemon(true);
+            return thread;
+        });
+        AtomicInteger built = new AtomicInteger();
+        CompletableFuture<?> futures[] = new CompletableFuture<?>[list.size()];
+        for (int i = 0; i < list.size(); i++)
+        {
+            PlanGeometry geometry = list.get(i);
+            futures[i] = CompletableFuture.runAsync(() ->
+            {
+                if (build(geometry, device[0]))
+                {
+                    built.incrementAndGet();
+                }
+            }, executor);
+        }
+        return CompletableFuture.allOf(futures).handle((v, t) ->
+        {
+            executor.shutdown();
+            return built.get();
+        });
+    }
+
+    /**
+     * Returns the number of pre-built plans that have not been taken yet
+     *
+     * @return The number of warm plans
+     */
+    public static int getWarmPlanCount()
+    {
+        return warmPlanCount.get();
+    }
+
+    /**
+     * Destroys all pre-built plans that have not been taken yet
+     */
+    public static void discardWarmPlans()
+    {
+        for (Map<PlanGeometry, Queue<cufftHandle>> plans : warmPlans.values())
+        {
+            for (Queue<cufftHandle> queue : plans.values())
+            {
+                cufftHandle plan = null;
+                while ((plan = queue.poll()) != null)
+                {
+                    warmPlanCount.decrementAndGet();
+                    JCufft.cufftDestroy(plan);
+                }
+            }
+        }
+    }
+
+    /**
+     * Returns the geometries of all plans that have been created in this
+     * process, or read for a warm-up
+     *
+     * @return The geometries
+     */
+    public static List<PlanGeometry> getRecordedGeometries()
+    {
+        return new ArrayList<PlanGeometry>(usages.keySet());
+    }
+
+    /**
+     * Will be called when JCufft is initialized, to start the warm-up
+     * from the file that is given by the system property, and register
+     * the shutdown hook for exporting the geometries to this file.
+     */
+    static synchronized void startup()
+    {
+        if (startupDone)
+        {
+            return;
+        }
+        startupDone = true;
+        String fileName = System.getProperty(WARMUP_PROPERTY);
+        if (fileName == null)
+        {
+            return;
+        }
+        File file = new File(fileName);
+        if (file.exists())
+        {
+            try
+            {
+                warmUp(file);
+            }
+            catch (IOException | RuntimeException e)
+            {
+                logger.log(Level.WARNING,
+                    "Could not start the warm-up from " + file, e);
+            }
+        }
+        Runtime.getRuntime().addShutdownHook(new Thread(() ->
+        {
+            try
+            {
+                export(file);
+            }
+            catch (IOException e)
+            {
+                logger.log(Level.WARNING,
+                    "Could not export the plan geometries to " + file, e);
+            }
+        }, "JCufft plan geometry export"));
+    }
+
+    /**
+     * Creates a geometry with the given factory, returning
+     * <code>null</code> if the parameters are not valid
+     *
+     * @param factory The factory
+     * @return The geometry, or <code>null</code>
+     */
+    static PlanGeometry geometry(Supplier<PlanGeometry> factory)
+    {
+        try
+        {
+            return factory.get();
+        }
+        catch (RuntimeException e)
+        {
+            return null;
+        }
+    }
+
+    /**
+     * Will be called by JCufft after a plan was created successfully
+     *
+     * @param geometry The geometry of the plan, or <code>null</code>
+     * @param workSize The size of the work area, or a negative value if
+     * it is not known
+     */
+    static void planCreated(PlanGeometry geometry, long workSize)
+    {
+        if (geometry == null)
+        {
+            return;
+        }
+        boolean counted = warming.get() == null;
+        Usage usage = counted ? usage(geometry) : usages.get(geometry);
+        if (usage == null)
+        {
+            return;
+        }
+        if (workSize >= 0)
+        {
+            usage.workSize.set(workSize);
+        }
+        if (counted)
+        {
+            usage.count.incrementAndGet();
+        }
+    }
+
+    /**
+     * Tries to transfer a pre-built plan for the given geometry, which
+     * was built on the device that is current for the calling thread,
+     * to the given handle.
+     *
+     * @param geometry The geometry, or <code>null</code>
+     * @param plan The handle that should receive the plan
+     * @return Whether a pre-built plan has been transferred
+     */
+    static boolean takeWarmPlan(PlanGeometry geometry, cufftHandle plan)
+    {
+        if (geometry == null || warmPlanCount.get() == 0 ||
+            warming.get() != null)
+        {
+            return false;
+        }
+        // The device is determined in the same way as in warmUp
+        int device[] = { 0 };
+        JCuda.cudaGetDevice(device);
+        Map<PlanGeometry, Queue<cufftHandle>> plans = warmPlans.get(device[0]);
+        if (plans == null)
+        {
+            return false;
+        }
+        Queue<cufftHandle> queue = plans.get(geometry);
+        if (queue == null)
+        {
+            return false;
+        }
+        cufftHandle warmPlan = queue.poll();
+        if (warmPlan == null)
+        {
+            return false;
+        }
+        warmPlanCount.decrementAndGet();
+        plan.adopt(warmPlan);
+        return true;
+    }
+
+    /**
+     * Obtains a value from the given supplier on the current thread,
+     * without counting the plans that are created by the supplier as
+     * uses, and without handing out pre-built plans to it. This is used
+     * for plans that are only created for internal measurements.
+     *
+     * @param supplier The supplier
+     * @return The value
+     */
+    static <T> T uncounted(Supplier<T> supplier)
+    {
+        if (warming.get() != null)
+        {
+            return supplier.get();
+        }
+        warming.set(Boolean.TRUE);
+        try
+        {
+            return supplier.get();
+        }
+        finally
+        {
+            warming.remove();
+        }
+    }
+
+    /**
+     * Returns the usage for the given geometry, creating it if necessary.
+     * Returns <code>null</code> if the maximum number of geometries has
+     * been reached.
+     *
+     * @param geometry The geometry
+     * @return The usage
+     */
+    private static Usage usage(PlanGeometry geometry)
+    {
+        Usage usage = usages.get(geometry);
+        if (usage != null)
+        {
+            return usage;
+        }
+        if (usages.size() >= MAX_GEOMETRIES)
+        {
+            return null;
+        }
+        Usage newUsage = new Usage();
+        usage = usages.putIfAbsent(geometry, newUsage);
+        return usage != null ? usage : newUsage;
+    }
+
+    /**
+     * Builds a warm plan for the given geometry on the given device
+     *
+     * @param geometry The geometry
+     * @param device The device
+     * @return Whether the plan was built
+     */
+    private static boolean build(PlanGeometry geometry, int device)
+    {
+        Usage usage = usages.get(geometry);
+        long workSize = usage == null ? -1 : usage.workSize.get();
+        if (workSize > 0 && MemoryBudget.getDeviceUsage() + workSize >
+            MemoryBudget.getBudget())
+        {
+            logger.fine("Skipping warm-up of " + geometry +
+                " due to the memory budget");
+            return false;
+        }
+        warming.set(Boolean.TRUE);
+        try
+        {
+            JCuda.cudaSetDevice(device);
+            cufftHandle plan = new cufftHandle();
+            int result = geometry.createPlan(plan);
+            if (result != cufftResult.CUFFT_SUCCESS)
+            {
+                logger.fine("Warm-up of " + geometry + " failed: " +
+                    cufftResult.stringFor(result));
+                return false;
+            }
+            warmPlans.computeIfAbsent(device,
+                d -> new ConcurrentHashMap<PlanGeometry, Queue<cufftHandle>>())
+                .computeIfAbsent(geometry,
+                    g -> new ConcurrentLinkedQueue<cufftHandle>()).add(plan);
+            warmPlanCount.incrementAndGet();
+            return true;
+        }
+        catch (RuntimeException e)
+        {
+            logger.log(Level.FINE, "Warm-up of " + geometry + " failed", e);
+            return false;
+        }
+        finally
+        {
+            warming.remove();
+        }
+    }
+
+    /**
+     * Returns the line of a warm-up file for the given geometry
+     *
+     * @param g The geometry
+     * @param usage The usage
+     * @return The line
+     */
+    private static String format(PlanGeometry g, Usage usage)
+    {
+        return cufftType.stringFor(g.getType()) + " " +
+            g.getRank() + " " +
+            format(g.getSizes()) + " " +
+            format(g.getInembed()) + " " +
+            g.getIstride() + " " + g.getIdist() + " " +
+            format(g.getOnembed()) + " " +
+            g.getOstride() + " " + g.getOdist() + " " +
+            g.getBatch() + " " +
+            usage.workSize.get() + " " +
+            usage.count.get();
+    }
+
+    /**
+     * Returns the given array as a comma-separated string, or "-" if
+     * it is <code>null</code>
+     *
+     * @param array The array
+     * @return The string
+     */
+    private static String format(long array[])
+    {
+        if (array == null)
+        {
+            return "-";
+        }
+        StringBuilder sb = new StringBuilder();
+        for (int i = 0; i < array.length; i++)
+        {
+            if (i > 0)
+            {
+                sb.append(",");
+            }
+            sb.append(array[i]);
+        }
+        return sb.toString();
+    }
+
+    /**
+     * Parses a line of a warm-up file, and puts the geometry together
+     * with its work size and count into the given map
+     *
+     * @param line The line
+     * @param result The map
+     * @throws IllegalArgumentException If the line can not be parsed
+     */
+    private static void parse(String line, Map<PlanGeometry, long[]> result)
+    {
+        String tokens[] = line.split("\\s+");
+        if (tokens.length != 12)
+        {
+            throw new IllegalArgumentException("Invalid line: " + line);
+        }
+        int type = parseType(tokens[0]);
+        int rank = Integer.parseInt(tokens[1]);
+        PlanGeometry geometry = PlanGeometry.ofMany64(rank,
+            parseArray(tokens[2]),
+            parseArray(tokens[3]),
+            Long.parseLong(tokens[4]),
+            Long.parseLong(tokens[5]),
+            parseArray(tokens[6]),
+            Long.parseLong(tokens[7]),
+            Long.parseLong(tokens[8]),
+            type,
+            Long.parseLong(tokens[9]));
+        long workSize = Long.parseLong(tokens[10]);
+        long count = Long.parseLong(tokens[11]);
+        result.put(geometry, new long[] { workSize, count });
+    }
+
+    /**
+     * Parses the given cufftType name
+     *
+     * @param name The name
+     * @return The cufftType
+     * @throws IllegalArgumentException If the name is not valid
+     */
+    private static int parseType(String name)
+    {
+        int types[] = {
+            cufftType.CUFFT_R2C, cufftType.CUFFT_C2R, cufftType.CUFFT_C2C,
+            cufftType.CUFFT_D2Z, cufftType.CUFFT_Z2D, cufftType.CUFFT_Z2Z };
+        for (int type : types)
+        {
+            if (cufftType.stringFor(type).equals(name))
+            {
+                return type;
+            }
+        }
+        throw new IllegalArgumentException("Invalid type: " + name);
+    }
+
+    /**
+     * Parses a comma-separated array, or "-" for <code>null</code>
+     *
+     * @param string The string
+     * @return The array
+     * @throws NumberFormatException If the string can not be parsed
+     */
+    private static long[] parseArray(String string)
+    {
+        if (string.equals("-"))
+        {
+            return null;
+        }
+        String tokens[] = string.split(",");
+        long result[] = new long[tokens.length];
+        for (int i = 0; i < tokens.length; i++)
+        {
+            result[i] = Long.parseLong(tokens[i]);
+        }
+        return result;
+    }
+}
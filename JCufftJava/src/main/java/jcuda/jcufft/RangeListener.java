@@ -0,0 +1,60 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+/**
+ * Interface for classes that want to be informed about the ranges of
+ * JCufft calls, for example, to forward them to a profiler or tracing
+ * system. See {@link JCufft#setRangeListener(RangeListener)}.<br>
+ * <br>
+ * A range is started before each plan creation, each change of a work
+ * area, and each exec call, and ended after the call returned. The
+ * name of a range consists of the function name, the type and the
+ * geometry of the plan, for example
+ * <code>"cufftExecR2C R2C 512x512 batch 4 (plan 3)"</code>.<br>
+ * <br>
+ * The methods are called on the thread that performs the call.
+ * Ranges on one thread are properly nested. Exceptions that are
+ * thrown by the methods are logged and otherwise ignored.
+ */
+public interface RangeListener
+{
+    /**
+     * Will be called before a JCufft call is performed
+     *
+     * @param name The name of the range
+     */
+    void rangeStarted(String name);
+
+    /**
+     * Will be called after the JCufft call that started the most
+     * recent range on the calling thread returned
+     */
+    void rangeEnded();
+}
@@ -0,0 +1,295 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.ReferenceQueue;
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.logging.Level;
+import java.util.logging.Logger;
+
+import jcuda.runtime.JCuda;
+
+/**
+ * Releases the native resources of JCufft objects that became
+ * unreachable without being closed.<br>
+ * <br>
+ * Objects that own native resources, like a {@link cufftHandle} with
+ * a plan, or a {@link StreamingTransform}, register a cleanup action
+ * here. When such an object is closed explicitly, the action is
+ * executed immediately. When it becomes phantom reachable instead,
+ * the action is executed by a background daemon thread, so that the
+ * resources are not leaked until the process terminates.<br>
+ * <br>
+ * The counters of this class allow detecting such leaks: The number of
+ * {@link #getReclaimedCount() reclaimed} objects should usually be 0.
+ */
+public final class ResourceReclaimer
+{
+    /**
+     * The logger used in this class
+     */
+    private static final Logger logger =
+        Logger.getLogger(ResourceReclaimer.class.getName());
+
+    /**
+     * The registration of a cleanup action for one object
+     */
+    static final class Registration extends PhantomReference<Object>
+    {
+        /**
+         * The cleanup action. It must not refer to the object.
+         */
+        private final Runnable action;
+
+        /**
+         * The device that was current when the object was registered
+         */
+        private final int device;
+
+        /**
+         * Whether this registration has already been processed
+         */
+        private final AtomicBoolean done = new AtomicBoolean();
+
+        /**
+         * Creates a new registration
+         *
+         * @param referent The object
+         * @param action The cleanup action
+         * @param device The device
+         */
+        Registration(Object referent, Runnable action, int device)
+        {
+            super(referent, queue);
+            this.action = action;
+            this.device = device;
+        }
+
+        /**
+         * Executes the cleanup action, if it was not executed yet,
+         * and counts the object as closed
+         */
+        void clean()
+        {
+            if (finish(closedCount))
+            {
+                action.run();
+            }
+        }
+
+        /**
+         * Removes this registration without executing the cleanup
+         * action, because the resources have already been released
+         * explicitly, and counts the object as closed
+         */
+        void deregister()
+        {
+            finish(closedCount);
+        }
+
+        /**
+         * Executes the cleanup action for an object that became
+         * unreachable, if it was not executed yet
+         */
+        private void reclaim()
+        {
+            if (finish(reclaimedCount))
+            {
+                JCuda.cudaSetDevice(device);
+                action.run();
+            }
+        }
+
+        /**
+         * Marks this registration as done, if it was not done yet
+         *
+         * @param counter The counter to increment
+         * @return Whether this registration was not done yet
+         */
+        private boolean finish(AtomicLong counter)
+        {
+            if (!done.compareAndSet(false, true))
+            {
+                return false;
+            }
+            registrations.remove(this);
+            clear();
+            counter.incrementAndGet();
+            return true;
+        }
+    }
+
+    /**
+     * The queue of registrations whose objects became phantom reachable
+     */
+    private static final ReferenceQueue<Object> queue =
+        new ReferenceQueue<Object>();
+
+    /**
+     * The pending registrations. They have to be kept reachable until
+     * they are processed.
+     */
+    private static final Set<Registration> registrations =
+        ConcurrentHashMap.newKeySet();
+
+    /**
+     * The number of objects that have been registered
+     */
+    private static final AtomicLong registeredCount = new AtomicLong();
+
+    /**
+     * The number of objects that have been closed explicitly
+     */
+    private static final AtomicLong closedCount = new AtomicLong();
+
+    /**
+     * The number of objects that have been reclaimed after they
+     * became unreachable
+     */
+    private static final AtomicLong reclaimedCount = new AtomicLong();
+
+    /**
+     * The thread that reclaims unreachable objects, created lazily
+     */
+    private static Thread thread;
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private ResourceReclaimer()
+    {
+    }
+
+    /**
+     * Register the given cleanup action for the given object
+     *
+     * @param referent The object
+     * @param action The cleanup action. It must not refer to the object,
+     * because the object could otherwise never become unreachable.
+     * @return The registration
+     */
+    static Registration register(Object referent, Runnable action)
+    {
+        ensureThread();
+        int device[] = { 0 };
+        JCuda.cudaGetDevice(device);
+        Registration registration =
+            new Registration(referent, action, device[0]);
+        registrations.add(registration);
+        registeredCount.incrementAndGet();
+        return registration;
+    }
+
+    /**
+     * Start the reclaim thread if it is not running yet
+     */
+    private static synchronized void ensureThread()
+    {
+        if (thread != null)
+        {
+            return;
+        }
+        thread = new Thread(new Runnable()
+        {
+            @Override
+            public void run()
+            {
+                while (true)
+                {
+                    try
+                    {
+                        Registration registration =
+                            (Registration)queue.remove();
+                        registration.reclaim();
+                    }
+                    catch (InterruptedException e)
+                    {
+                        // Keep running: Other threads must not be able
+                        // to stop the reclamation
+                    }
+                    catch (RuntimeException e)
+                    {
+                        logger.log(Level.WARNING,
+                            "Could not reclaim JCufft resources", e);
+                    }
+                }
+            }
+        }, "JCufft resource reclaimer");
+        thread.setDaemon(true);
+        thread.start();
+    }
+
+    /**
+     * Returns the number of objects that have been registered
+     *
+     * @return The number of registered objects
+     */
+    public static long getRegisteredCount()
+    {
+        return registeredCount.get();
+    }
+
+    /**
+     * Returns the number of objects that have been closed explicitly
+     *
+     * @return The number of closed objects
+     */
+    public static long getClosedCount()
+    {
+        return closedCount.get();
+    }
+
+    /**
+     * Returns the number of objects whose resources have been released
+     * by the reclaim thread, because they became unreachable without
+     * being closed. Each of them indicates a missing call to
+     * <code>close</code> or <code>cufftDestroy</code>.
+     *
+     * @return The number of reclaimed objects
+     */
+    public static long getReclaimedCount()
+    {
+        return reclaimedCount.get();
+    }
+
+    /**
+     * Returns the number of objects that have been registered and
+     * are neither closed nor reclaimed yet
+     *
+     * @return The number of live objects
+     */
+    public static long getLiveCount()
+    {
+        return registrations.size();
+    }
+}
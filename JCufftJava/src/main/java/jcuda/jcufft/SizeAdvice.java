@@ -0,0 +1,195 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.util.Locale;
+
+/**
+ * The result of {@link SizeAdvisor#advise(int, int, int)}: A comparison
+ * of the execution time and the memory requirements of a 1D transform
+ * at its original length and at the next fast length.<br>
+ * <br>
+ * The times are average execution times that have been measured with
+ * CUDA events on the current device. The memory sizes include the
+ * input and output buffers and the work area of the plan.
+ */
+public final class SizeAdvice
+{
+    /**
+     * The original length
+     */
+    private final int length;
+
+    /**
+     * The next fast length
+     */
+    private final int fastLength;
+
+    /**
+     * The average execution time at the original length, in nanoseconds
+     */
+    private final long timeNanos;
+
+    /**
+     * The average execution time at the fast length, in nanoseconds
+     */
+    private final long fastTimeNanos;
+
+    /**
+     * The memory required at the original length, in bytes
+     */
+    private final long memoryBytes;
+
+    /**
+     * The memory required at the fast length, in bytes
+     */
+    private final long fastMemoryBytes;
+
+    /**
+     * Creates a new advice
+     *
+     * @param length The original length
+     * @param fastLength The fast length
+     * @param timeNanos The time at the original length
+     * @param fastTimeNanos The time at the fast length
+     * @param memoryBytes The memory at the original length
+     * @param fastMemoryBytes The memory at the fast length
+     */
+    SizeAdvice(int length, int fastLength, long timeNanos,
+        long fastTimeNanos, long memoryBytes, long fastMemoryBytes)
+    {
+        this.length = length;
+        this.fastLength = fastLength;
+        this.timeNanos = timeNanos;
+        this.fastTimeNanos = fastTimeNanos;
+        this.memoryBytes = memoryBytes;
+        this.fastMemoryBytes = fastMemoryBytes;
+    }
+
+    /**
+     * Returns the original length
+     *
+     * @return The length
+     */
+    public int getLength()
+    {
+        return length;
+    }
+
+    /**
+     * Returns the next fast length, which is the smallest length that
+     * is not smaller than the original length and only has the prime
+     * factors 2, 3, 5 and 7
+     *
+     * @return The fast length
+     */
+    public int getFastLength()
+    {
+        return fastLength;
+    }
+
+    /**
+     * Returns the average execution time at the original length
+     *
+     * @return The time, in nanoseconds
+     */
+    public long getTimeNanos()
+    {
+        return timeNanos;
+    }
+
+    /**
+     * Returns the average execution time at the fast length
+     *
+     * @return The time, in nanoseconds
+     */
+    public long getFastTimeNanos()
+    {
+        return fastTimeNanos;
+    }
+
+    /**
+     * Returns the predicted speedup of padding to the fast length. This
+     * is the ratio of the time at the original length and the time at
+     * the fast length. A value that is not greater than 1.0 means that
+     * padding is not worthwhile.
+     *
+     * @return The speedup
+     */
+    public double getSpeedup()
+    {
+        if (fastTimeNanos <= 0)
+        {
+            return 1.0;
+        }
+        return (double)timeNanos / fastTimeNanos;
+    }
+
+    /**
+     * Returns the memory that is required at the original length
+     *
+     * @return The memory size, in bytes
+     */
+    public long getMemoryBytes()
+    {
+        return memoryBytes;
+    }
+
+    /**
+     * Returns the memory that is required at the fast length
+     *
+     * @return The memory size, in bytes
+     */
+    public long getFastMemoryBytes()
+    {
+        return fastMemoryBytes;
+    }
+
+    /**
+     * Returns the additional memory that is required for padding to
+     * the fast length. This may be negative when the plan for the fast
+     * length needs a smaller work area.
+     *
+     * @return The additional memory size, in bytes
+     */
+    public long getAdditionalMemoryBytes()
+    {
+        return fastMemoryBytes - memoryBytes;
+    }
+
+    @Override
+    public String toString()
+    {
+        return "SizeAdvice[length=" + length + ",fastLength=" + fastLength +
+            ",timeNanos=" + timeNanos + ",fastTimeNanos=" + fastTimeNanos +
+            ",speedup=" + String.format(Locale.ENGLISH, "%.2f",
+            getSpeedup()) + ",additionalMemoryBytes=" +
+            getAdditionalMemoryBytes() + "]";
+    }
+}
@@ -0,0 +1,304 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+import static jcuda.jcufft.JCufftUtils.checkCufft;
+
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaEvent_t;
+
+/**
+ * Methods for choosing transform lengths that can be computed
+ * efficiently.<br>
+ * <br>
+ * CUFFT has optimized kernels for lengths of the form
+ * 2<sup>a</sup>&middot;3<sup>b</sup>&middot;5<sup>c</sup>&middot;7<sup>d</sup>.
+ * Transforms of lengths that contain larger prime factors are computed
+ * with slower algorithms, and may be several times slower than a
+ * transform of a slightly larger fast length. For convolutions and
+ * correlations, where the input is zero-padded anyway, the input may
+ * be padded to the {@link #nextFastLength(long) next fast length}
+ * without changing the result. The {@link PaddedPlan} class offers
+ * such transforms.<br>
+ * <br>
+ * Whether padding is worthwhile depends on the device and the length.
+ * The {@link #advise(int, int, int)} method measures it.
+ */
+public final class SizeAdvisor
+{
+    /**
+     * The number of executions before the measurement
+     */
+    private static final int WARMUP_RUNS = 2;
+
+    /**
+     * The number of measured executions
+     */
+    private static final int MEASURED_RUNS = 10;
+
+    /**
+     * The advices that have been computed, for each device
+     */
+    private static final Map<Integer, Map<PlanGeometry, SizeAdvice>> advices =
+        new ConcurrentHashMap<Integer, Map<PlanGeometry, SizeAdvice>>();
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private SizeAdvisor()
+    {
+    }
+
+    /**
+     * Returns whether the given length only has the prime factors
+     * 2, 3, 5 and 7
+     *
+     * @param length The length
+     * @return Whether the length is a fast length
+     */
+    public static boolean isFastLength(long length)
+    {
+        if (length <= 0)
+        {
+            return false;
+        }
+        long n = length;
+        for (int p = 2; p <= 7; p++)
+        {
+            while (n % p == 0)
+            {
+                n /= p;
+            }
+        }
+        return n == 1;
+    }
+
+    /**
+     * Returns the smallest length that is not smaller than the given
+     * length, and only has the prime factors 2, 3, 5 and 7
+     *
+     * @param length The length
+     * @return The next fast length
+     * @throws IllegalArgumentException If the length is not positive
+     */
+    public static long nextFastLength(long length)
+    {
+        if (length <= 0)
+        {
+            throw new IllegalArgumentException(
+                "The length must be positive, but is " + length);
+        }
+        long limit = Long.MAX_VALUE / 7;
+        long best = Long.MAX_VALUE;
+        for (long p7 = 1; ; p7 *= 7)
+        {
+            for (long p75 = p7; ; p75 *= 5)
+            {
+                for (long p753 = p75; ; p753 *= 3)
+                {
+                    long n = p753;
+                    while (n < length && n <= limit)
+                    {
+                        n *= 2;
+                    }
+                    if (n >= length)
+                    {
+                        best = Math.min(best, n);
+                    }
+                    if (p753 >= length || p753 > limit)
+                    {
+                        break;
+                    }
+                }
+                if (p75 >= length || p75 > limit)
+                {
+                    break;
+                }
+            }
+            if (p7 >= length || p7 > limit)
+            {
+                break;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * Returns the smallest length that is not smaller than the given
+     * length, and only has the prime factors 2, 3, 5 and 7
+     *
+     * @param length The length
+     * @return The next fast length
+     * @throws IllegalArgumentException If the length is not positive,
+     * or the next fast length does not fit into an <code>int</code>
+     */
+    public static int nextFastLength(int length)
+    {
+        long result = nextFastLength((long)length);
+        if (result > Integer.MAX_VALUE)
+        {
+            throw new IllegalArgumentException(
+                "The next fast length for " + length + " is too large");
+        }
+        return (int)result;
+    }
+
+    /**
+     * Measures the execution time and the memory requirements of a
+     * 1D transform with the given parameters, at the given length and
+     * at the {@link #nextFastLength(int) next fast length}, on the
+     * current device.<br>
+     * <br>
+     * The measurement creates temporary plans and device buffers, and
+     * executes each plan several times. The result is cached, so that
+     * the measurement is only done once for each device and set of
+     * parameters. The temporary plans are not recorded by the
+     * {@link PlanWarmup}.
+     *
+     * @param length The transform length
+     * @param type The cufftType
+     * @param batch The batch size
+     * @return The advice
+     * @throws IllegalArgumentException If the length or the batch size
+     * is not positive
+     * @throws jcuda.CudaException If the measurement fails
+     */
+    public static SizeAdvice advise(int length, int type, int batch)
+    {
+        if (length <= 0 || batch <= 0)
+        {
+            throw new IllegalArgumentException(
+                "The length and the batch size must be positive, but are " +
+                length + " and " + batch);
+        }
+        int device[] = { 0 };
+        checkCuda(JCuda.cudaGetDevice(device));
+        Map<PlanGeometry, SizeAdvice> deviceAdvices =
+            advices.computeIfAbsent(device[0],
+                d -> new ConcurrentHashMap<PlanGeometry, SizeAdvice>());
+        PlanGeometry geometry = PlanGeometry.of1d(length, type, batch);
+        SizeAdvice advice = deviceAdvices.get(geometry);
+        if (advice != null)
+        {
+            return advice;
+        }
+        int fastLength = nextFastLength(length);
+        long measurement[] = PlanWarmup.uncounted(() -> measure(geometry));
+        long fastMeasurement[] = measurement;
+        if (fastLength != length)
+        {
+            PlanGeometry fastGeometry =
+                PlanGeometry.of1d(fastLength, type, batch);
+            fastMeasurement =
+                PlanWarmup.uncounted(() -> measure(fastGeometry));
+        }
+        advice = new SizeAdvice(length, fastLength,
+            measurement[0], fastMeasurement[0],
+            measurement[1], fastMeasurement[1]);
+        deviceAdvices.put(geometry, advice);
+        return advice;
+    }
+
+    /**
+     * Clears all cached advices
+     */
+    public static void clear()
+    {
+        advices.clear();
+    }
+
+    /**
+     * Measures the given geometry, and returns an array containing the
+     * average execution time in nanoseconds and the memory size in bytes
+     *
+     * @param geometry The geometry
+     * @return The measurement
+     */
+    private static long[] measure(PlanGeometry geometry)
+    {
+        long inputBytes = geometry.getInputDistance() *
+            geometry.getBatch() * geometry.getInputElementSize();
+        long outputBytes = geometry.getOutputDistance() *
+            geometry.getBatch() * geometry.getOutputElementSize();
+        long bufferBytes = inputBytes + outputBytes;
+
+        cufftHandle plan = new cufftHandle();
+        Pointer input = new Pointer();
+        Pointer output = new Pointer();
+        cudaEvent_t start = new cudaEvent_t();
+        cudaEvent_t stop = new cudaEvent_t();
+        MemoryBudget.reserve(
+            MemoryBudget.Category.POOL, bufferBytes, "SizeAdvisor");
+        try
+        {
+            checkCufft(geometry.createPlan(plan));
+            long workSize[] = { 0 };
+            checkCufft(JCufft.cufftGetSize(plan, workSize));
+            checkCuda(JCuda.cudaMalloc(input, inputBytes));
+            checkCuda(JCuda.cudaMalloc(output, outputBytes));
+            checkCuda(JCuda.cudaMemset(input, 0, inputBytes));
+            checkCuda(JCuda.cudaEventCreate(start));
+            checkCuda(JCuda.cudaEventCreate(stop));
+
+            int type = geometry.getType();
+            for (int i = 0; i < WARMUP_RUNS; i++)
+            {
+                checkCufft(JCufftUtils.exec(
+                    plan, type, input, output, JCufft.CUFFT_FORWARD));
+            }
+            checkCuda(JCuda.cudaEventRecord(start, null));
+            for (int i = 0; i < MEASURED_RUNS; i++)
+            {
+                checkCufft(JCufftUtils.exec(
+                    plan, type, input, output, JCufft.CUFFT_FORWARD));
+            }
+            checkCuda(JCuda.cudaEventRecord(stop, null));
+            checkCuda(JCuda.cudaEventSynchronize(stop));
+            float ms[] = { 0.0f };
+            checkCuda(JCuda.cudaEventElapsedTime(ms, start, stop));
+            long timeNanos = (long)(ms[0] * 1e6 / MEASURED_RUNS);
+            return new long[] { timeNanos, bufferBytes + workSize[0] };
+        }
+        finally
+        {
+            JCuda.cudaEventDestroy(start);
+            JCuda.cudaEventDestroy(stop);
+            JCuda.cudaFree(input);
+            JCuda.cudaFree(output);
+            plan.close();
+            MemoryBudget.release(
+                MemoryBudget.Category.POOL, bufferBytes, "SizeAdvisor");
+        }
+    }
+}
@@ -0,0 +1,661 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+import static jcuda.jcufft.JCufftUtils.checkCufft;
+
+import java.io.IOException;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaEvent_t;
+import jcuda.runtime.cudaMemcpyKind;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * A complex 3D transform of sizes <code>nx*ny*nz</code> that is
+ * distributed over several processes, each owning a slab of the data.
+ * <br>
+ * <br>
+ * The processes are connected with a {@link SlabTransport}. With
+ * <code>P</code> processes, both <code>nx</code> and <code>ny</code>
+ * must be divisible by <code>P</code>. The process with rank
+ * <code>r</code> owns two slabs:
+ * <ul>
+ *   <li>
+ *     The <b>x-slab</b> with the planes <code>x = r*nx/P ...
+ *     (r+1)*nx/P-1</code>, stored in the order <code>(x, y, z)</code>,
+ *     with <code>z</code> varying fastest
+ *   </li>
+ *   <li>
+ *     The <b>y-slab</b> with the planes <code>y = r*ny/P ...
+ *     (r+1)*ny/P-1</code>, stored in the transposed order
+ *     <code>(y, x, z)</code>
+ *   </li>
+ * </ul>
+ * Both slabs have the same number of elements. The forward transform
+ * reads the x-slab and writes the y-slab, and the inverse transform
+ * reads the y-slab and writes the x-slab. Keeping the output in the
+ * transposed order saves a second global exchange, and is sufficient
+ * for element-wise operations in the frequency domain.<br>
+ * <br>
+ * The forward transform computes batched 2D transforms of the
+ * <code>(y, z)</code> planes of the x-slab, exchanges the blocks of
+ * the result between all processes, and computes 1D transforms along
+ * <code>x</code> in the y-slab. The inverse transform does the same in
+ * the reverse order. The first step is split into chunks of planes.
+ * While the transforms of one chunk are computed, the result of the
+ * previous chunk is copied to page-locked host memory in a second
+ * stream, and sent to the other processes. The received blocks are
+ * copied into the slab while the remaining blocks are received.<br>
+ * <br>
+ * All processes must create their plans with the same sizes, and call
+ * the exec method in the same order.
+ */
+public class SlabFft3d implements AutoCloseable
+{
+    /**
+     * The native resources of a SlabFft3d. This is the cleanup action
+     * that is registered in the {@link ResourceReclaimer}, and thus must
+     * not refer to the SlabFft3d.
+     */
+    private static final class Resources implements Runnable
+    {
+        /**
+         * The plan for the 2D transforms of one chunk of planes
+         */
+        final cufftHandle planePlan = new cufftHandle();
+
+        /**
+         * The plan for the 1D transforms along x in one y-plane
+         */
+        final cufftHandle linePlan = new cufftHandle();
+
+        /**
+         * The stream for the transforms
+         */
+        final cudaStream_t computeStream = new cudaStream_t();
+
+        /**
+         * The stream for the copies between the device and the host
+         */
+        final cudaStream_t copyStream = new cudaStream_t();
+
+        /**
+         * The events that are recorded after the transforms of each
+         * chunk
+         */
+        final cudaEvent_t computeEvents[];
+
+        /**
+         * The events that are recorded after the copies of each chunk
+         */
+        final cudaEvent_t copyEvents[];
+
+        /**
+         * The page-locked host memory for the blocks that are sent
+         */
+        final Pointer sendBuffer = new Pointer();
+
+        /**
+         * The page-locked host memory for the blocks that are received
+         */
+        final Pointer receiveBuffer = new Pointer();
+
+        /**
+         * The number of bytes of host memory that have been reserved
+         * in the {@link MemoryBudget}
+         */
+        long hostBytes = 0;
+
+        /**
+         * Creates new resources
+         *
+         * @param chunks The number of chunks
+         */
+        Resources(int chunks)
+        {
+            computeEvents = new cudaEvent_t[chunks];
+            copyEvents = new cudaEvent_t[chunks];
+            for (int i = 0; i < chunks; i++)
+            {
+                computeEvents[i] = new cudaEvent_t();
+                copyEvents[i] = new cudaEvent_t();
+            }
+        }
+
+        /**
+         * Releases all resources
+         */
+        @Override
+        public void run()
+        {
+            JCuda.cudaStreamSynchronize(computeStream);
+            JCuda.cudaStreamSynchronize(copyStream);
+            JCuda.cudaFreeHost(sendBuffer);
+            JCuda.cudaFreeHost(receiveBuffer);
+            planePlan.close();
+            linePlan.close();
+            for (int i = 0; i < computeEvents.length; i++)
+            {
+                JCuda.cudaEventDestroy(computeEvents[i]);
+                JCuda.cudaEventDestroy(copyEvents[i]);
+            }
+            JCuda.cudaStreamDestroy(computeStream);
+            JCuda.cudaStreamDestroy(copyStream);
+            MemoryBudget.release(
+                MemoryBudget.Category.STAGING, hostBytes, "SlabFft3d");
+            hostBytes = 0;
+        }
+    }
+
+    /**
+     * The default number of chunks
+     */
+    private static final int DEFAULT_CHUNKS = 4;
+
+    /**
+     * The transport
+     */
+    private final SlabTransport transport;
+
+    /**
+     * The global sizes
+     */
+    private final int nx;
+    private final int ny;
+    private final int nz;
+
+    /**
+     * The cufftType
+     */
+    private final int type;
+
+    /**
+     * The number of x-planes in the x-slab of each process
+     */
+    private final int localX;
+
+    /**
+     * The number of y-planes in the y-slab of each process
+     */
+    private final int localY;
+
+    /**
+     * The number of chunks that the first step is split into
+     */
+    private final int chunks;
+
+    /**
+     * Whether this object has been destroyed
+     */
+    private boolean destroyed = false;
+
+    /**
+     * The native resources of this object
+     */
+    private final Resources resources;
+
+    /**
+     * The registration of the resources in the {@link ResourceReclaimer}
+     */
+    private final ResourceReclaimer.Registration registration;
+
+    /**
+     * Creates a distributed transform with a default number of chunks
+     *
+     * @param transport The transport
+     * @param nx The global size in x
+     * @param ny The global size in y
+     * @param nz The global size in z
+     * @param type The cufftType, CUFFT_C2C or CUFFT_Z2Z
+     * @return The transform
+     * @throws IllegalArgumentException If the arguments are not valid
+     * @throws jcuda.CudaException If the plans, streams or buffers can
+     * not be created
+     */
+    public static SlabFft3d create(
+        SlabTransport transport, int nx, int ny, int nz, int type)
+    {
+        return new SlabFft3d(transport, nx, ny, nz, type, DEFAULT_CHUNKS);
+    }
+
+    /**
+     * Creates a distributed transform. The given number of chunks is
+     * reduced to the largest number that divides the number of planes
+     * in both slabs.
+     *
+     * @param transport The transport
+     * @param nx The global size in x
+     * @param ny The global size in y
+     * @param nz The global size in z
+     * @param type The cufftType, CUFFT_C2C or CUFFT_Z2Z
+     * @param chunks The number of chunks
+     * @return The transform
+     * @throws IllegalArgumentException If the arguments are not valid
+     * @throws jcuda.CudaException If the plans, streams or buffers can
+     * not be created
+     */
+    public static SlabFft3d create(SlabTransport transport,
+        int nx, int ny, int nz, int type, int chunks)
+    {
+        return new SlabFft3d(transport, nx, ny, nz, type, chunks);
+    }
+
+    /**
+     * Creates a new transform
+     *
+     * @param transport The transport
+     * @param nx The global size in x
+     * @param ny The global size in y
+     * @param nz The global size in z
+     * @param type The cufftType
+     * @param chunks The requested number of chunks
+     */
+    private SlabFft3d(SlabTransport transport,
+        int nx, int ny, int nz, int type, int chunks)
+    {
+        int size = transport.getSize();
+        if (nx < 1 || ny < 1 || nz < 1 || chunks < 1)
+        {
+            throw new IllegalArgumentException(
+                "The sizes and the number of chunks must be positive");
+        }
+        if (nx % size != 0 || ny % size != 0)
+        {
+            throw new IllegalArgumentException("The sizes " + nx +
+                " and " + ny + " must be divisible by the number of " +
+                "processes, " + size);
+        }
+        if (type != cufftType.CUFFT_C2C && type != cufftType.CUFFT_Z2Z)
+        {
+            throw new IllegalArgumentException(
+                "The type must be CUFFT_C2C or CUFFT_Z2Z, but is " +
+                cufftType.stringFor(type));
+        }
+        this.transport = transport;
+        this.nx = nx;
+        this.ny = ny;
+        this.nz = nz;
+        this.type = type;
+        this.localX = nx / size;
+        this.localY = ny / size;
+        int c = Math.min(chunks, Math.min(localX, localY));
+        while (localX % c != 0 || localY % c != 0)
+        {
+            c--;
+        }
+        this.chunks = c;
+
+        this.resources = new Resources(this.chunks);
+        this.registration = ResourceReclaimer.register(this, resources);
+        try
+        {
+            checkCuda(JCuda.cudaStreamCreateWithFlags(
+                resources.computeStream, JCuda.cudaStreamNonBlocking));
+            checkCuda(JCuda.cudaStreamCreateWithFlags(
+                resources.copyStream, JCuda.cudaStreamNonBlocking));
+            for (int i = 0; i < this.chunks; i++)
+            {
+                checkCuda(JCuda.cudaEventCreateWithFlags(
+                    resources.computeEvents[i],
+                    JCuda.cudaEventDisableTiming));
+                checkCuda(JCuda.cudaEventCreateWithFlags(
+                    resources.copyEvents[i],
+                    JCuda.cudaEventDisableTiming));
+            }
+            checkCufft(JCufft.cufftPlanMany(resources.planePlan, 2,
+                new int[] { ny, nz }, null, 1, ny * nz, null, 1, ny * nz,
+                type, localX / this.chunks));
+            checkCufft(JCufft.cufftPlanMany(resources.linePlan, 1,
+                new int[] { nx }, new int[] { nx }, nz, 1,
+                new int[] { nx }, nz, 1, type, nz));
+            checkCufft(JCufft.cufftSetStream(
+                resources.planePlan, resources.computeStream));
+            checkCufft(JCufft.cufftSetStream(
+                resources.linePlan, resources.computeStream));
+            long bytes = getLocalElementCount() * complexSize();
+            MemoryBudget.reserve(
+                MemoryBudget.Category.STAGING, 2 * bytes, "SlabFft3d");
+            resources.hostBytes = 2 * bytes;
+            checkCuda(JCuda.cudaHostAlloc(resources.sendBuffer,
+                bytes, JCuda.cudaHostAllocDefault));
+            checkCuda(JCuda.cudaHostAlloc(resources.receiveBuffer,
+                bytes, JCuda.cudaHostAllocDefault));
+        }
+        catch (RuntimeException e)
+        {
+            destroy();
+            throw e;
+        }
+    }
+
+    /**
+     * Executes the transform, and waits until it is complete.<br>
+     * <br>
+     * For the forward direction, the input is the x-slab, and the
+     * output is the y-slab. For the inverse direction, the input is the
+     * y-slab, and the output is the x-slab. In both cases, the input is
+     * overwritten. The inverse transform is not normalized.
+     *
+     * @param xSlab The x-slab, in device memory
+     * @param ySlab The y-slab, in device memory
+     * @param direction The direction, CUFFT_FORWARD or CUFFT_INVERSE
+     * @throws IOException If the communication fails
+     * @throws jcuda.CudaException If a transform or a copy fails
+     */
+    public synchronized void exec(Pointer xSlab, Pointer ySlab, int direction)
+        throws IOException
+    {
+        checkNotDestroyed();
+        if (direction == JCufft.CUFFT_FORWARD)
+        {
+            exchange(xSlab, localX, ny, ySlab, localY, nx, direction);
+            transformLines(ySlab, 0, localY, direction);
+        }
+        else
+        {
+            exchange(ySlab, localY, nx, xSlab, localX, ny, direction);
+            transformPlanes(xSlab, 0, localX, direction);
+        }
+        checkCuda(JCuda.cudaStreamSynchronize(resources.computeStream));
+    }
+
+    /**
+     * Transforms the source in chunks, and exchanges the blocks of the
+     * result between all processes, so that the destination contains
+     * the blocks in the transposed order. The source has the order
+     * <code>(a, b, z)</code>, with <code>srcLead</code> local planes
+     * in <code>a</code>, and <code>srcCols</code> elements in
+     * <code>b</code>. The destination has the order
+     * <code>(b, a, z)</code>, with <code>dstLead</code> local planes in
+     * <code>b</code>, and <code>dstCols</code> elements in
+     * <code>a</code>. When this method returns, the compute stream
+     * waits for the copies into the destination.
+     *
+     * @param src The source
+     * @param srcLead The number of planes in the source
+     * @param srcCols The global size of the second source dimension
+     * @param dst The destination
+     * @param dstLead The number of planes in the destination
+     * @param dstCols The global size of the second destination dimension
+     * @param direction The direction
+     * @throws IOException If the communication fails
+     */
+    private void exchange(Pointer src, int srcLead, int srcCols,
+        Pointer dst, int dstLead, int dstCols, int direction)
+        throws IOException
+    {
+        int size = transport.getSize();
+        int rank = transport.getRank();
+        long complexSize = complexSize();
+        int chunkPlanes = srcLead / chunks;
+        long rowBytes = (long)nz * complexSize;
+        long blockBytes = (long)chunkPlanes * dstLead * rowBytes;
+        for (int c = 0; c < chunks; c++)
+        {
+            if (direction == JCufft.CUFFT_FORWARD)
+            {
+                transformPlanes(src, c * chunkPlanes, chunkPlanes, direction);
+            }
+            else
+            {
+                transformLines(src, c * chunkPlanes, chunkPlanes, direction);
+            }
+            checkCuda(JCuda.cudaEventRecord(
+                resources.computeEvents[c], resources.computeStream));
+        }
+        for (int c = 0; c < chunks; c++)
+        {
+            checkCuda(JCuda.cudaStreamWaitEvent(
+                resources.copyStream, resources.computeEvents[c], 0));
+            for (int q = 0; q < size; q++)
+            {
+                long offset = ((long)c * size + q) * blockBytes;
+                long srcOffset =
+                    ((long)c * chunkPlanes * srcCols + (long)q * dstLead) *
+                    rowBytes;
+                checkCuda(JCuda.cudaMemcpy2DAsync(
+                    resources.sendBuffer.withByteOffset(offset),
+                    dstLead * rowBytes,
+                    src.withByteOffset(srcOffset), srcCols * rowBytes,
+                    dstLead * rowBytes, chunkPlanes,
+                    cudaMemcpyKind.cudaMemcpyDeviceToHost,
+                    resources.copyStream));
+            }
+            checkCuda(JCuda.cudaEventRecord(
+                resources.copyEvents[c], resources.copyStream));
+        }
+        for (int c = 0; c < chunks; c++)
+        {
+            checkCuda(JCuda.cudaEventSynchronize(resources.copyEvents[c]));
+            for (int i = 1; i <= size; i++)
+            {
+                int q = (rank + i) % size;
+                long offset = ((long)c * size + q) * blockBytes;
+                transport.send(q, c,
+                    resources.sendBuffer.getByteBuffer(offset, blockBytes));
+            }
+        }
+        for (int i = 0; i < size; i++)
+        {
+            int p = (rank + size - i) % size;
+            for (int c = 0; c < chunks; c++)
+            {
+                long offset = ((long)c * size + p) * blockBytes;
+                transport.receive(p, c,
+                    resources.receiveBuffer.getByteBuffer(offset, blockBytes));
+                for (int j = 0; j < chunkPlanes; j++)
+                {
+                    long plane = (long)p * srcLead + c * chunkPlanes + j;
+                    checkCuda(JCuda.cudaMemcpy2DAsync(
+                        dst.withByteOffset(plane * rowBytes),
+                        dstCols * rowBytes,
+                        resources.receiveBuffer.withByteOffset(
+                            offset + j * dstLead * rowBytes),
+                        rowBytes, rowBytes, dstLead,
+                        cudaMemcpyKind.cudaMemcpyHostToDevice,
+                        resources.copyStream));
+                }
+            }
+        }
+        checkCuda(JCuda.cudaEventRecord(
+            resources.copyEvents[0], resources.copyStream));
+        checkCuda(JCuda.cudaStreamWaitEvent(
+            resources.computeStream, resources.copyEvents[0], 0));
+    }
+
+    /**
+     * Computes the 2D transforms of the given planes of the x-slab
+     *
+     * @param xSlab The x-slab
+     * @param first The first plane
+     * @param count The number of planes, a multiple of the planes per
+     * chunk
+     * @param direction The direction
+     */
+    private void transformPlanes(
+        Pointer xSlab, int first, int count, int direction)
+    {
+        int chunkPlanes = localX / chunks;
+        long planeBytes = (long)ny * nz * complexSize();
+        for (int x = first; x < first + count; x += chunkPlanes)
+        {
+            Pointer p = xSlab.withByteOffset(x * planeBytes);
+            checkCufft(JCufftUtils.exec(
+                resources.planePlan, type, p, p, direction));
+        }
+    }
+
+    /**
+     * Computes the 1D transforms along x in the given planes of the
+     * y-slab
+     *
+     * @param ySlab The y-slab
+     * @param first The first plane
+     * @param count The number of planes
+     * @param direction The direction
+     */
+    private void transformLines(
+        Pointer ySlab, int first, int count, int direction)
+    {
+        long planeBytes = (long)nx * nz * complexSize();
+        for (int y = first; y < first + count; y++)
+        {
+            Pointer p = ySlab.withByteOffset(y * planeBytes);
+            checkCufft(JCufftUtils.exec(
+                resources.linePlan, type, p, p, direction));
+        }
+    }
+
+    /**
+     * Returns the size of one complex element, in bytes
+     *
+     * @return The size
+     */
+    private int complexSize()
+    {
+        return 2 * JCufftUtils.elementSize(type);
+    }
+
+    /**
+     * Returns the number of complex elements of the x-slab and of the
+     * y-slab of this process
+     *
+     * @return The number of elements
+     */
+    public long getLocalElementCount()
+    {
+        return (long)localX * ny * nz;
+    }
+
+    /**
+     * Returns the first x-plane of the x-slab of this process
+     *
+     * @return The first x-plane
+     */
+    public int getLocalXStart()
+    {
+        return transport.getRank() * localX;
+    }
+
+    /**
+     * Returns the number of x-planes of the x-slab of this process
+     *
+     * @return The number of x-planes
+     */
+    public int getLocalXCount()
+    {
+        return localX;
+    }
+
+    /**
+     * Returns the first y-plane of the y-slab of this process
+     *
+     * @return The first y-plane
+     */
+    public int getLocalYStart()
+    {
+        return transport.getRank() * localY;
+    }
+
+    /**
+     * Returns the number of y-planes of the y-slab of this process
+     *
+     * @return The number of y-planes
+     */
+    public int getLocalYCount()
+    {
+        return localY;
+    }
+
+    /**
+     * Returns the number of chunks that the first step of each transform
+     * is split into
+     *
+     * @return The number of chunks
+     */
+    public int getChunkCount()
+    {
+        return chunks;
+    }
+
+    /**
+     * Returns the global sizes
+     *
+     * @return The sizes <code>{nx, ny, nz}</code>
+     */
+    public int[] getSizes()
+    {
+        return new int[] { nx, ny, nz };
+    }
+
+    /**
+     * Throws an IllegalStateException if this object has been destroyed
+     */
+    private void checkNotDestroyed()
+    {
+        if (destroyed)
+        {
+            throw new IllegalStateException("The SlabFft3d was destroyed");
+        }
+    }
+
+    /**
+     * Releases the plans, streams and buffers of this object
+     */
+    public synchronized void destroy()
+    {
+        if (destroyed)
+        {
+            return;
+        }
+        destroyed = true;
+        registration.clean();
+    }
+
+    /**
+     * Equivalent to {@link #destroy()}
+     */
+    @Override
+    public void close()
+    {
+        destroy();
+    }
+
+    @Override
+    public String toString()
+    {
+        return "SlabFft3d[type=" + cufftType.stringFor(type) +
+            ",n=" + nx + "x" + ny + "x" + nz +
+            ",rank=" + transport.getRank() + "/" + transport.getSize() +
+            ",chunks=" + chunks + "]";
+    }
+}
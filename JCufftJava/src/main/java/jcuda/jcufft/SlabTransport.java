@@ -0,0 +1,91 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+
+/**
+ * The communication layer of a {@link SlabFft3d}, which connects the
+ * processes that take part in a distributed transform.<br>
+ * <br>
+ * Each process has a rank between 0 and {@link #getSize()}-1.
+ * Messages are identified by their source, destination and tag, and
+ * messages with the same source, destination and tag must be received
+ * in the order in which they have been sent. Messages from a process
+ * to itself must be supported.<br>
+ * <br>
+ * Implementations may, for example, use MPI, sockets or shared
+ * memory. The {@link LoopbackTransport} connects several ranks within
+ * one process.
+ */
+public interface SlabTransport
+{
+    /**
+     * Returns the rank of this process
+     *
+     * @return The rank
+     */
+    int getRank();
+
+    /**
+     * Returns the number of processes
+     *
+     * @return The number of processes
+     */
+    int getSize();
+
+    /**
+     * Sends the remaining bytes of the given buffer to the given
+     * process. This method must not wait until the message has been
+     * received, because all processes send their messages before they
+     * receive the messages of the others. It may not refer to the
+     * buffer after it returned. The position of the buffer is not
+     * modified.
+     *
+     * @param destination The rank of the destination
+     * @param tag The tag
+     * @param data The data
+     * @throws IOException If the message can not be sent
+     */
+    void send(int destination, int tag, ByteBuffer data) throws IOException;
+
+    /**
+     * Receives a message from the given process into the remaining
+     * bytes of the given buffer, blocking until the message has been
+     * received. The message must have exactly the size of the remaining
+     * bytes. The position of the buffer is not modified.
+     *
+     * @param source The rank of the source
+     * @param tag The tag
+     * @param data The buffer for the data
+     * @throws IOException If the message can not be received
+     */
+    void receive(int source, int tag, ByteBuffer data) throws IOException;
+}
@@ -0,0 +1,182 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import java.util.ArrayDeque;
+import java.util.Deque;
+import java.util.HashMap;
+import java.util.Map;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaError;
+
+/**
+ * A pool of page-locked host buffers, for the copies of the array
+ * overloads that have to convert the data on the host.<br>
+ * <br>
+ * The buffer sizes are rounded up to powers of two, and a limited
+ * number of buffers of each size is retained after it was released.
+ * The retained memory is accounted in the
+ * {@link MemoryBudget.Category#STAGING} category.
+ */
+final class StagingPool
+{
+    /**
+     * A page-locked host buffer
+     */
+    static final class Buffer
+    {
+        /**
+         * The pointer to the page-locked memory
+         */
+        final Pointer pointer = new Pointer();
+
+        /**
+         * The size of the buffer, in bytes
+         */
+        final long size;
+
+        /**
+         * Creates a new buffer with the given size. The memory is not
+         * allocated yet.
+         *
+         * @param size The size
+         */
+        Buffer(long size)
+        {
+            this.size = size;
+        }
+    }
+
+    /**
+     * The minimum size of a buffer
+     */
+    private static final long MIN_SIZE = 64 * 1024;
+
+    /**
+     * The maximum number of buffers of each size that are retained
+     */
+    private static final int MAX_RETAINED = 4;
+
+    /**
+     * The free buffers, for each size
+     */
+    private static final Map<Long, Deque<Buffer>> freeBuffers =
+        new HashMap<Long, Deque<Buffer>>();
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private StagingPool()
+    {
+    }
+
+    /**
+     * Obtains a buffer with at least the given size, allocating it if
+     * no free buffer is available
+     *
+     * @param bytes The minimum size
+     * @return The buffer, or <code>null</code> if the page-locked memory
+     * could not be allocated
+     */
+    static Buffer acquire(long bytes)
+    {
+        long size = Math.max(MIN_SIZE, Long.highestOneBit(bytes - 1) << 1);
+        synchronized (freeBuffers)
+        {
+            Deque<Buffer> buffers = freeBuffers.get(size);
+            if (buffers != null && !buffers.isEmpty())
+            {
+                return buffers.pop();
+            }
+        }
+        Buffer buffer = new Buffer(size);
+        int cudaResult = JCuda.cudaHostAlloc(
+            buffer.pointer, size, JCuda.cudaHostAllocDefault);
+        if (cudaResult != cudaError.cudaSuccess)
+        {
+            return null;
+        }
+        MemoryBudget.reserve(
+            MemoryBudget.Category.STAGING, size, "StagingPool");
+        return buffer;
+    }
+
+    /**
+     * Returns the given buffer to the pool. If the maximum number of
+     * buffers of its size is already retained, it is freed.
+     *
+     * @param buffer The buffer
+     */
+    static void release(Buffer buffer)
+    {
+        synchronized (freeBuffers)
+        {
+            Deque<Buffer> buffers = freeBuffers.computeIfAbsent(
+                buffer.size, s -> new ArrayDeque<Buffer>());
+            if (buffers.size() < MAX_RETAINED)
+            {
+                buffers.push(buffer);
+                return;
+            }
+        }
+        free(buffer);
+    }
+
+    /**
+     * Frees all buffers that are currently retained
+     */
+    static void clear()
+    {
+        synchronized (freeBuffers)
+        {
+            for (Deque<Buffer> buffers : freeBuffers.values())
+            {
+                for (Buffer buffer : buffers)
+                {
+                    free(buffer);
+                }
+            }
+            freeBuffers.clear();
+        }
+    }
+
+    /**
+     * Frees the memory of the given buffer
+     *
+     * @param buffer The buffer
+     */
+    private static void free(Buffer buffer)
+    {
+        JCuda.cudaFreeHost(buffer.pointer);
+        MemoryBudget.release(
+            MemoryBudget.Category.STAGING, buffer.size, "StagingPool");
+    }
+}
@@ -0,0 +1,743 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.DoubleBuffer;
+import java.nio.FloatBuffer;
+import java.util.concurrent.atomic.AtomicLong;
+
+import jcuda.CudaException;
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaError;
+import jcuda.runtime.cudaEvent_t;
+import jcuda.runtime.cudaMemcpyKind;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * A streaming FFT with bounded latency, for continuous input.<br>
+ * <br>
+ * A StreamingTransform is built on a plan that has been created by the
+ * caller. It associates the plan with its own CUDA stream, and owns a
+ * ring of frames, each consisting of page-locked input and output
+ * memory, device input and output memory, and a completion event.
+ * All resources are allocated at construction time. In the steady
+ * state, neither {@link #push(float[])} nor {@link #poll(float[])}
+ * allocate any memory or synchronize with the device.<br>
+ * <br>
+ * The ring is a single-producer/single-consumer queue: One thread may
+ * push samples, and one (possibly different) thread may poll the
+ * resulting spectra. When all frames of the ring are in flight, a
+ * pushed frame is dropped, and the number of dropped frames is
+ * counted. The latency from push to poll of each frame is recorded
+ * in a {@link LatencyHistogram}.<br>
+ * <br>
+ * Usage example:
+ * <pre><code>
+ * cufftHandle plan = new cufftHandle();
+ * JCufft.cufftPlan1d(plan, 1024, cufftType.CUFFT_C2C, 1);
+ * StreamingTransform s = new StreamingTransform(plan,
+ *     cufftType.CUFFT_C2C, JCufft.CUFFT_FORWARD, 2048, 2048, 8);
+ *
+ * // Producer thread
+ * s.push(samples);
+ *
+ * // Consumer thread
+ * if (s.poll(spectrum)) { ... }
+ *
+ * s.close();
+ * plan.close();
+ * </code></pre>
+ * If a StreamingTransform becomes unreachable without being closed,
+ * its resources are released by the {@link ResourceReclaimer}.
+ */
+public class StreamingTransform implements AutoCloseable
+{
+    /**
+     * A single frame of the ring
+     */
+    private static class Frame
+    {
+        /**
+         * The page-locked input memory
+         */
+        Pointer hostInput = new Pointer();
+
+        /**
+         * The page-locked output memory
+         */
+        Pointer hostOutput = new Pointer();
+
+        /**
+         * The device input memory
+         */
+        Pointer deviceInput = new Pointer();
+
+        /**
+         * The device output memory
+         */
+        Pointer deviceOutput = new Pointer();
+
+        /**
+         * The event that is recorded after the output was copied
+         * to the host
+         */
+        cudaEvent_t done = new cudaEvent_t();
+
+        /**
+         * The view on the host input memory, either a FloatBuffer
+         * or a DoubleBuffer
+         */
+        FloatBuffer floatInput;
+        DoubleBuffer doubleInput;
+
+        /**
+         * The view on the host output memory, either a FloatBuffer
+         * or a DoubleBuffer
+         */
+        FloatBuffer floatOutput;
+        DoubleBuffer doubleOutput;
+
+        /**
+         * The time stamp of the push of this frame, via System#nanoTime
+         */
+        long pushTime;
+    }
+
+    /**
+     * The native resources of a StreamingTransform. This is the cleanup
+     * action that is registered in the {@link ResourceReclaimer}, and
+     * thus must not refer to the StreamingTransform.
+     */
+    private static final class Resources implements Runnable
+    {
+        /**
+         * The stream
+         */
+        final cudaStream_t stream = new cudaStream_t();
+
+        /**
+         * The plan that has been associated with the stream, or
+         * <code>null</code>. It is associated with the default stream
+         * again when the resources are released.
+         */
+        cufftHandle boundPlan;
+
+        /**
+         * The frames
+         */
+        final Frame frames[];
+
+        /**
+         * The number of bytes of page-locked memory that have been
+         * reserved in the {@link MemoryBudget}
+         */
+        long stagingBytes = 0;
+
+        /**
+         * The number of bytes of device memory that have been reserved
+         * in the {@link MemoryBudget}
+         */
+        long deviceBytes = 0;
+
+        /**
+         * Creates new resources with the given number of frames
+         *
+         * @param depth The number of frames
+         */
+        Resources(int depth)
+        {
+            this.frames = new Frame[depth];
+        }
+
+        /**
+         * Waits for all pending work in the stream, and releases
+         * all resources
+         */
+        @Override
+        public void run()
+        {
+            JCuda.cudaStreamSynchronize(stream);
+            if (boundPlan != null)
+            {
+                try
+                {
+                    JCufft.cufftSetStream(boundPlan, new cudaStream_t());
+                }
+                catch (CudaException e)
+                {
+                    // The plan has already been destroyed by the caller
+                }
+                boundPlan = null;
+            }
+            for (Frame frame : frames)
+            {
+                if (frame == null)
+                {
+                    continue;
+                }
+                JCuda.cudaFreeHost(frame.hostInput);
+                JCuda.cudaFreeHost(frame.hostOutput);
+                JCuda.cudaFree(frame.deviceInput);
+                JCuda.cudaFree(frame.deviceOutput);
+                JCuda.cudaEventDestroy(frame.done);
+            }
+            JCuda.cudaStreamDestroy(stream);
+            MemoryBudget.release(
+                MemoryBudget.Category.STAGING, stagingBytes, "StreamingTransform");
+            MemoryBudget.release(
+                MemoryBudget.Category.POOL, deviceBytes, "StreamingTransform");
+            stagingBytes = 0;
+            deviceBytes = 0;
+        }
+    }
+
+    /**
+     * The plan
+     */
+    private final cufftHandle plan;
+
+    /**
+     * The cufftType of the plan
+     */
+    private final int type;
+
+    /**
+     * The direction, for complex-to-complex transforms
+     */
+    private final int direction;
+
+    /**
+     * The number of real values of one input frame
+     */
+    private final int inputLength;
+
+    /**
+     * The number of real values of one output frame
+     */
+    private final int outputLength;
+
+    /**
+     * Whether the plan is a double precision plan
+     */
+    private final boolean doublePrecision;
+
+    /**
+     * The stream that the plan is associated with
+     */
+    private final cudaStream_t stream;
+
+    /**
+     * The frames of the ring
+     */
+    private final Frame frames[];
+
+    /**
+     * The index of the next frame to be written by the producer
+     */
+    private final AtomicLong head = new AtomicLong();
+
+    /**
+     * The index of the next frame to be read by the consumer
+     */
+    private final AtomicLong tail = new AtomicLong();
+
+    /**
+     * The number of frames that have been dropped
+     */
+    private final AtomicLong droppedFrames = new AtomicLong();
+
+    /**
+     * The number of frames that have been delivered
+     */
+    private final AtomicLong deliveredFrames = new AtomicLong();
+
+    /**
+     * The number of delivered frames that exceeded the deadline
+     */
+    private final AtomicLong missedDeadlines = new AtomicLong();
+
+    /**
+     * The deadline for a single frame, in nanoseconds, or 0
+     * if there is no deadline
+     */
+    private volatile long deadlineNanos = 0;
+
+    /**
+     * The histogram of the push-to-poll latencies
+     */
+    private final LatencyHistogram latencies = new LatencyHistogram();
+
+    /**
+     * Whether this object has been destroyed
+     */
+    private boolean destroyed = false;
+
+    /**
+     * The native resources of this object
+     */
+    private final Resources resources;
+
+    /**
+     * The registration of the resources in the {@link ResourceReclaimer}
+     */
+    private final ResourceReclaimer.Registration registration;
+
+    /**
+     * Creates a new streaming transform for the given plan.
+     *
+     * @param plan The plan. It must have been created by the caller,
+     * and it must not be executed by any other thread while this object
+     * is in use. Its stream will be set to a stream that is owned by
+     * this object, and set to the default stream again when this
+     * object is destroyed.
+     * @param type The cufftType of the plan
+     * @param direction The direction, for complex-to-complex transforms
+     * @param inputLength The number of float or double values of one
+     * input frame
+     * @param outputLength The number of float or double values of one
+     * output frame
+     * @param depth The number of frames that may be in flight at the
+     * same time
+     * @throws IllegalArgumentException If any length is not positive
+     * @throws jcuda.CudaException If the resources can not be allocated
+     */
+    public StreamingTransform(cufftHandle plan, int type, int direction,
+        int inputLength, int outputLength, int depth)
+    {
+        if (plan == null)
+        {
+            throw new NullPointerException("The plan is null");
+        }
+        if (inputLength <= 0 || outputLength <= 0 || depth <= 0)
+        {
+            throw new IllegalArgumentException(
+                "The lengths and the depth must be positive, but are " +
+                inputLength + ", " + outputLength + " and " + depth);
+        }
+        this.plan = plan;
+        this.type = type;
+        this.direction = direction;
+        this.inputLength = inputLength;
+        this.outputLength = outputLength;
+        this.doublePrecision = JCufftUtils.isDoublePrecision(type);
+
+        this.resources = new Resources(depth);
+        this.stream = resources.stream;
+        this.frames = resources.frames;
+        this.registration = ResourceReclaimer.register(this, resources);
+        try
+        {
+            checkCuda(JCuda.cudaStreamCreateWithFlags(
+                stream, JCuda.cudaStreamNonBlocking));
+            JCufftUtils.checkCufft(JCufft.cufftSetStream(plan, stream));
+            resources.boundPlan = plan;
+            for (int i = 0; i < depth; i++)
+            {
+                frames[i] = new Frame();
+                allocate(frames[i]);
+            }
+        }
+        catch (RuntimeException e)
+        {
+            destroy();
+            throw e;
+        }
+    }
+
+    /**
+     * Allocates all resources of the given frame
+     *
+     * @param frame The frame
+     */
+    private void allocate(Frame frame)
+    {
+        int elementSize = JCufftUtils.elementSize(type);
+        long inputBytes = (long)inputLength * elementSize;
+        long outputBytes = (long)outputLength * elementSize;
+
+        MemoryBudget.reserve(MemoryBudget.Category.STAGING,
+            inputBytes + outputBytes, "StreamingTransform");
+        resources.stagingBytes += inputBytes + outputBytes;
+        checkCuda(JCuda.cudaHostAlloc(frame.hostInput, inputBytes,
+            JCuda.cudaHostAllocDefault));
+        checkCuda(JCuda.cudaHostAlloc(frame.hostOutput, outputBytes,
+            JCuda.cudaHostAllocDefault));
+        MemoryBudget.reserve(MemoryBudget.Category.POOL,
+            inputBytes + outputBytes, "StreamingTransform");
+        resources.deviceBytes += inputBytes + outputBytes;
+        checkCuda(JCuda.cudaMalloc(frame.deviceInput, inputBytes));
+        checkCuda(JCuda.cudaMalloc(frame.deviceOutput, outputBytes));
+        checkCuda(JCuda.cudaEventCreateWithFlags(frame.done,
+            JCuda.cudaEventDisableTiming));
+
+        ByteBuffer input = frame.hostInput.getByteBuffer(0, inputBytes)
+            .order(ByteOrder.nativeOrder());
+        ByteBuffer output = frame.hostOutput.getByteBuffer(0, outputBytes)
+            .order(ByteOrder.nativeOrder());
+        if (doublePrecision)
+        {
+            frame.doubleInput = input.asDoubleBuffer();
+            frame.doubleOutput = output.asDoubleBuffer();
+        }
+        else
+        {
+            frame.floatInput = input.asFloatBuffer();
+            frame.floatOutput = output.asFloatBuffer();
+        }
+    }
+
+    /**
+     * Set the deadline for a single frame. Frames whose push-to-poll
+     * latency exceeds this deadline are counted as
+     * {@link #getMissedDeadlineCount() missed deadlines}.
+     *
+     * @param deadlineNanos The deadline, in nanoseconds, or 0 to
+     * disable the deadline
+     */
+    public void setDeadline(long deadlineNanos)
+    {
+        this.deadlineNanos = deadlineNanos;
+    }
+
+    /**
+     * Push the given single precision samples. They will be copied into
+     * the next free frame, and the transform of this frame will be
+     * enqueued on the stream. If no frame is free, then the samples
+     * are dropped, and <code>false</code> is returned.<br>
+     * <br>
+     * This method may only be called by a single producer thread.
+     *
+     * @param samples The samples, containing at least the input length
+     * of this streaming transform
+     * @return Whether the samples have been accepted
+     * @throws IllegalArgumentException If the plan is a double precision
+     * plan, or the array is too small
+     */
+    public boolean push(float samples[])
+    {
+        if (doublePrecision)
+        {
+            throw new IllegalArgumentException(
+                "Expected double samples for " + cufftType.stringFor(type));
+        }
+        checkLength(samples.length, inputLength);
+        long h = head.get();
+        if (h - tail.get() >= frames.length)
+        {
+            droppedFrames.incrementAndGet();
+            return false;
+        }
+        Frame frame = frames[(int)(h % frames.length)];
+        frame.floatInput.clear();
+        frame.floatInput.put(samples, 0, inputLength);
+        submit(frame);
+        head.lazySet(h + 1);
+        return true;
+    }
+
+    /**
+     * Push the given double precision samples. See {@link #push(float[])}
+     * for details.
+     *
+     * @param samples The samples, containing at least the input length
+     * of this streaming transform
+     * @return Whether the samples have been accepted
+     * @throws IllegalArgumentException If the plan is a single precision
+     * plan, or the array is too small
+     */
+    public boolean push(double samples[])
+    {
+        if (!doublePrecision)
+        {
+            throw new IllegalArgumentException(
+                "Expected float samples for " + cufftType.stringFor(type));
+        }
+        checkLength(samples.length, inputLength);
+        long h = head.get();
+        if (h - tail.get() >= frames.length)
+        {
+            droppedFrames.incrementAndGet();
+            return false;
+        }
+        Frame frame = frames[(int)(h % frames.length)];
+        frame.doubleInput.clear();
+        frame.doubleInput.put(samples, 0, inputLength);
+        submit(frame);
+        head.lazySet(h + 1);
+        return true;
+    }
+
+    /**
+     * Enqueue the copies and the transform of the given frame
+     *
+     * @param frame The frame
+     */
+    private void submit(Frame frame)
+    {
+        int elementSize = JCufftUtils.elementSize(type);
+        frame.pushTime = System.nanoTime();
+        checkCuda(JCuda.cudaMemcpyAsync(frame.deviceInput, frame.hostInput,
+            (long)inputLength * elementSize,
+            cudaMemcpyKind.cudaMemcpyHostToDevice, stream));
+        JCufftUtils.checkCufft(JCufftUtils.exec(plan, type,
+            frame.deviceInput, frame.deviceOutput, direction));
+        checkCuda(JCuda.cudaMemcpyAsync(frame.hostOutput, frame.deviceOutput,
+            (long)outputLength * elementSize,
+            cudaMemcpyKind.cudaMemcpyDeviceToHost, stream));
+        checkCuda(JCuda.cudaEventRecord(frame.done, stream));
+    }
+
+    /**
+     * Poll the oldest frame. If the transform of the oldest frame has
+     * been completed, its result will be written into the given array,
+     * and <code>true</code> is returned. Otherwise, <code>false</code>
+     * is returned immediately.<br>
+     * <br>
+     * This method may only be called by a single consumer thread.
+     *
+     * @param spectrum The array that will receive the result, containing
+     * at least the output length of this streaming transform
+     * @return Whether a result was written into the given array
+     * @throws IllegalArgumentException If the plan is a double precision
+     * plan, or the array is too small
+     */
+    public boolean poll(float spectrum[])
+    {
+        if (doublePrecision)
+        {
+            throw new IllegalArgumentException(
+                "Expected double spectrum for " + cufftType.stringFor(type));
+        }
+        checkLength(spectrum.length, outputLength);
+        long t = tail.get();
+        Frame frame = completedFrame(t);
+        if (frame == null)
+        {
+            return false;
+        }
+        frame.floatOutput.clear();
+        frame.floatOutput.get(spectrum, 0, outputLength);
+        deliver(frame, t);
+        return true;
+    }
+
+    /**
+     * Poll the oldest frame. See {@link #poll(float[])} for details.
+     *
+     * @param spectrum The array that will receive the result, containing
+     * at least the output length of this streaming transform
+     * @return Whether a result was written into the given array
+     * @throws IllegalArgumentException If the plan is a single precision
+     * plan, or the array is too small
+     */
+    public boolean poll(double spectrum[])
+    {
+        if (!doublePrecision)
+        {
+            throw new IllegalArgumentException(
+                "Expected float spectrum for " + cufftType.stringFor(type));
+        }
+        checkLength(spectrum.length, outputLength);
+        long t = tail.get();
+        Frame frame = completedFrame(t);
+        if (frame == null)
+        {
+            return false;
+        }
+        frame.doubleOutput.clear();
+        frame.doubleOutput.get(spectrum, 0, outputLength);
+        deliver(frame, t);
+        return true;
+    }
+
+    /**
+     * Returns the frame with the given index if it has been pushed and
+     * its transform is complete, or <code>null</code> otherwise
+     *
+     * @param index The frame index
+     * @return The frame, or <code>null</code>
+     */
+    private Frame completedFrame(long index)
+    {
+        if (index == head.get())
+        {
+            return null;
+        }
+        Frame frame = frames[(int)(index % frames.length)];
+        int status = JCuda.cudaEventQuery(frame.done);
+        if (status == cudaError.cudaErrorNotReady)
+        {
+            return null;
+        }
+        checkCuda(status);
+        return frame;
+    }
+
+    /**
+     * Record the latency of the given frame and release it for
+     * the producer
+     *
+     * @param frame The frame
+     * @param index The index of the frame
+     */
+    private void deliver(Frame frame, long index)
+    {
+        long latency = System.nanoTime() - frame.pushTime;
+        latencies.record(latency);
+        long deadline = deadlineNanos;
+        if (deadline > 0 && latency > deadline)
+        {
+            missedDeadlines.incrementAndGet();
+        }
+        deliveredFrames.incrementAndGet();
+        tail.lazySet(index + 1);
+    }
+
+    /**
+     * Make sure that the given array length is at least the
+     * given frame length
+     *
+     * @param arrayLength The array length
+     * @param frameLength The frame length
+     * @throws IllegalArgumentException If the array is too small
+     */
+    private static void checkLength(int arrayLength, int frameLength)
+    {
+        if (arrayLength < frameLength)
+        {
+            throw new IllegalArgumentException(
+                "Array length is " + arrayLength +
+                ", expected at least " + frameLength);
+        }
+    }
+
+    /**
+     * Returns the stream that the plan was associated with
+     *
+     * @return The stream
+     */
+    public cudaStream_t getStream()
+    {
+        return stream;
+    }
+
+    /**
+     * Returns the number of frames that are currently in flight,
+     * meaning that they have been pushed but not yet polled
+     *
+     * @return The number of frames in flight
+     */
+    public int getFramesInFlight()
+    {
+        return (int)(head.get() - tail.get());
+    }
+
+    /**
+     * Returns the number of frames that have been dropped because
+     * all frames of the ring were in flight
+     *
+     * @return The number of dropped frames
+     */
+    public long getDroppedFrameCount()
+    {
+        return droppedFrames.get();
+    }
+
+    /**
+     * Returns the number of frames that have been polled
+     *
+     * @return The number of delivered frames
+     */
+    public long getDeliveredFrameCount()
+    {
+        return deliveredFrames.get();
+    }
+
+    /**
+     * Returns the number of delivered frames whose latency exceeded
+     * the {@link #setDeadline(long) deadline}
+     *
+     * @return The number of missed deadlines
+     */
+    public long getMissedDeadlineCount()
+    {
+        return missedDeadlines.get();
+    }
+
+    /**
+     * Returns the histogram of the push-to-poll latencies of all
+     * delivered frames. Percentiles may be obtained with
+     * {@link LatencyHistogram#getPercentile(double)}.
+     *
+     * @return The latency histogram
+     */
+    public LatencyHistogram getLatencyHistogram()
+    {
+        return latencies;
+    }
+
+    /**
+     * Waits for all pending transforms, and releases all resources
+     * of this object. This does not destroy the plan, but associates
+     * it with the default stream again.
+     */
+    public synchronized void destroy()
+    {
+        if (destroyed)
+        {
+            return;
+        }
+        destroyed = true;
+        registration.clean();
+    }
+
+    /**
+     * Equivalent to {@link #destroy()}
+     */
+    @Override
+    public void close()
+    {
+        destroy();
+    }
+
+    @Override
+    public String toString()
+    {
+        return "StreamingTransform[type=" + cufftType.stringFor(type) +
+            ",depth=" + frames.length +
+            ",delivered=" + getDeliveredFrameCount() +
+            ",dropped=" + getDroppedFrameCount() +
+            ",latency=" + latencies + "]";
+    }
+}
@@ -0,0 +1,709 @@
+/*
+ * JCufft - Java bindings for CUFFT, the NVIDIA CUDA FFT library,
+ * to be used with JCuda
+ *
+ * Copyright (c) 2008-2015 Marco Hutter - http://www.jcuda.org
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+package jcuda.jcufft;
+
+import static jcuda.jcufft.JCufftUtils.checkCuda;
+import static jcuda.jcufft.JCufftUtils.checkCufft;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaMemcpyKind;
+import jcuda.runtime.cudaStream_t;
+
+/**
+ * A plan for discrete cosine and sine transforms (DCT and DST) of the
+ * types I to IV, in 1D, or separable in 2D and 3D, computed with
+ * real-to-complex transforms on the device.<br>
+ * <br>
+ * The transforms are unnormalized, and use the same definitions as
+ * the REDFT00 to RODFT11 transforms of FFTW. For example, the DCT-II
+ * of a sequence <code>x</code> of length <code>n</code> is
+ * <pre><code>
+ * y[k] = 2 * sum(j=0..n-1) x[j] * cos(pi * (j + 1/2) * k / n)
+ * </code></pre>
+ * Applying a transform and its {@link Type#getInverse() inverse}
+ * multiplies the data with the {@link Type#getNormalization(int)
+ * normalization} factor, for each dimension.<br>
+ * <br>
+ * Each dimension is transformed with one batched real-to-complex
+ * transform of the length <code>2n</code> (or <code>2(n-1)</code> for
+ * the DCT-I and <code>2(n+1)</code> for the DST-I), with a pre-twiddle
+ * kernel that writes the zero-padded, modulated input sequences, and a
+ * post-twiddle kernel that computes the result from their spectra. The
+ * types other than DCT-I and DCT-II require two real sequences per
+ * transform. The kernels read and write the data with strides, so that
+ * no transposes are required for the dimensions other than the last
+ * one. The input and the output may be the same memory.<br>
+ * <br>
+ * The real-to-complex plans and the work buffers are created once,
+ * when the plan is created, and reused for all executions, like for
+ * a regular CUFFT plan. Dimensions with the same size and type share
+ * the same real-to-complex plan.<br>
+ * <br>
+ * Usage example for a 2D DCT-II of single precision data:
+ * <pre><code>
+ * TrigPlan p = TrigPlan.create(new int[] { ny, nx },
+ *     TrigPlan.Type.DCT_II, cufftType.CUFFT_R2C, 1);
+ * p.exec(input, output);
+ * p.close();
+ * </code></pre>
+ */
+public class TrigPlan implements AutoCloseable
+{
+    /**
+     * The types of the transforms
+     */
+    public enum Type
+    {
+        /**
+         * The DCT-I (REDFT00), which requires a size of at least 2
+         */
+        DCT_I,
+
+        /**
+         * The DCT-II (REDFT10), which is commonly called "the DCT"
+         */
+        DCT_II,
+
+        /**
+         * The DCT-III (REDFT01), which is the inverse of the DCT-II
+         */
+        DCT_III,
+
+        /**
+         * The DCT-IV (REDFT11)
+         */
+        DCT_IV,
+
+        /**
+         * The DST-I (RODFT00)
+         */
+        DST_I,
+
+        /**
+         * The DST-II (RODFT10)
+         */
+        DST_II,
+
+        /**
+         * The DST-III (RODFT01), which is the inverse of the DST-II
+         */
+        DST_III,
+
+        /**
+         * The DST-IV (RODFT11)
+         */
+        DST_IV;
+
+        /**
+         * Returns the type of the inverse transform. This is the type
+         * itself for the types I and IV.
+         *
+         * @return The inverse type
+         */
+        public Type getInverse()
+        {
+            switch (this)
+            {
+                case DCT_II: return DCT_III;
+                case DCT_III: return DCT_II;
+                case DST_II: return DST_III;
+                case DST_III: return DST_II;
+                default: return this;
+            }
+        }
+
+        /**
+         * Returns the factor by which a transform of this type and its
+         * inverse scale data of the given size
+         *
+         * @param n The size
+         * @return The normalization factor
+         */
+        public long getNormalization(int n)
+        {
+            return getLength(n);
+        }
+
+        /**
+         * Returns the length of the real-to-complex transform that is
+         * used for the given size
+         *
+         * @param n The size
+         * @return The length
+         */
+        long getLength(long n)
+        {
+            switch (this)
+            {
+                case DCT_I: return 2 * (n - 1);
+                case DST_I: return 2 * (n + 1);
+                default: return 2 * n;
+            }
+        }
+
+        /**
+         * Returns the number of real sequences that are transformed for
+         * each transform of this type
+         *
+         * @return The number of sequences, 1 or 2
+         */
+        int getParts()
+        {
+            return this == DCT_I || this == DCT_II ? 1 : 2;
+        }
+    }
+
+    /**
+     * The native resources of a TrigPlan. This is the cleanup action
+     * that is registered in the {@link ResourceReclaimer}, and thus must
+     * not refer to the TrigPlan.
+     */
+    private static final class Resources implements Runnable
+    {
+        /**
+         * The real-to-complex plans
+         */
+        final List<cufftHandle> plans = new ArrayList<cufftHandle>();
+
+        /**
+         * The buffer for the real input sequences
+         */
+        final Pointer work = new Pointer();
+
+        /**
+         * The buffer for the spectra of the input sequences
+         */
+        final Pointer spectrum = new Pointer();
+
+        /**
+         * The number of bytes of device memory that have been reserved
+         * in the {@link MemoryBudget}
+         */
+        long deviceBytes = 0;
+
+        /**
+         * Releases all resources
+         */
+        @Override
+        public void run()
+        {
+            JCuda.cudaFree(work);
+            JCuda.cudaFree(spectrum);
+            for (cufftHandle plan : plans)
+            {
+                plan.close();
+            }
+            plans.clear();
+            MemoryBudget.release(
+                MemoryBudget.Category.POOL, deviceBytes, "TrigPlan");
+            deviceBytes = 0;
+        }
+    }
+
+    /**
+     * The transform of one dimension
+     */
+    private static final class Pass
+    {
+        /**
+         * The type
+         */
+        final Type type;
+
+        /**
+         * The number of transforms
+         */
+        final long count;
+
+        /**
+         * The distance between consecutive elements of one transform
+         */
+        final long stride;
+
+        /**
+         * The size of the dimension
+         */
+        final long n;
+
+        /**
+         * The real-to-complex plan
+         */
+        final cufftHandle plan;
+
+        /**
+         * Creates a new pass
+         *
+         * @param type The type
+         * @param count The number of transforms
+         * @param stride The stride
+         * @param n The size
+         * @param plan The plan
+         */
+        Pass(Type type, long count, long stride, long n, cufftHandle plan)
+        {
+            this.type = type;
+            this.count = count;
+            this.stride = stride;
+            this.n = n;
+            this.plan = plan;
+        }
+    }
+
+    /**
+     * The sizes
+     */
+    private final int n[];
+
+    /**
+     * The types for the dimensions
+     */
+    private final Type types[];
+
+    /**
+     * The cufftType of the real-to-complex transforms
+     */
+    private final int realType;
+
+    /**
+     * The batch size
+     */
+    private final int batch;
+
+    /**
+     * The passes, from the last dimension to the first
+     */
+    private final List<Pass> passes = new ArrayList<Pass>();
+
+    /**
+     * The stream, or <code>null</code> for the default stream
+     */
+    private cudaStream_t stream = null;
+
+    /**
+     * Whether this object has been destroyed
+     */
+    private boolean destroyed = false;
+
+    /**
+     * The native resources of this object
+     */
+    private final Resources resources;
+
+    /**
+     * The registration of the resources in the {@link ResourceReclaimer}
+     */
+    private final ResourceReclaimer.Registration registration;
+
+    /**
+     * Creates a plan that applies the given type of transform in all
+     * dimensions
+     *
+     * @param n The sizes, with 1, 2 or 3 elements
+     * @param type The type
+     * @param realType The cufftType of the real-to-complex transforms,
+     * CUFFT_R2C for single precision data or CUFFT_D2Z for double
+     * precision data
+     * @param batch The number of transforms
+     * @return The plan
+     * @throws IllegalArgumentException If the arguments are not valid
+     * @throws jcuda.CudaException If the plans or the buffers can not
+     * be created
+     */
+    public static TrigPlan create(int n[], Type type, int realType, int batch)
+    {
+        Type types[] = new Type[n.length];
+        Arrays.fill(types, type);
+        return new TrigPlan(n, types, realType, batch);
+    }
+
+    /**
+     * Creates a plan that applies the given types of transforms in the
+     * respective dimensions
+     *
+     * @param n The sizes, with 1, 2 or 3 elements
+     * @param types The types, one for each dimension
+     * @param realType The cufftType of the real-to-complex transforms,
+     * CUFFT_R2C for single precision data or CUFFT_D2Z for double
+     * precision data
+     * @param batch The number of transforms
+     * @return The plan
+     * @throws IllegalArgumentException If the arguments are not valid
+     * @throws jcuda.CudaException If the plans or the buffers can not
+     * be created
+     */
+    public static TrigPlan create(
+        int n[], Type types[], int realType, int batch)
+    {
+        return new TrigPlan(n, types, realType, batch);
+    }
+
+    /**
+     * Creates a new plan
+     *
+     * @param n The sizes
+     * @param types The types
+     * @param realType The cufftType
+     * @param batch The batch size
+     */
+    private TrigPlan(int n[], Type types[], int realType, int batch)
+    {
+        if (n.length < 1 || n.length > 3)
+        {
+            throw new IllegalArgumentException(
+                "The rank must be 1, 2 or 3, but is " + n.length);
+        }
+        if (types.length != n.length)
+        {
+            throw new IllegalArgumentException(
+                "Expected " + n.length + " types, but got " + types.length);
+        }
+        if (realType != cufftType.CUFFT_R2C && realType != cufftType.CUFFT_D2Z)
+        {
+            throw new IllegalArgumentException(
+                "The type must be CUFFT_R2C or CUFFT_D2Z, but is " +
+                cufftType.stringFor(realType));
+        }
+        if (batch < 1)
+        {
+            throw new IllegalArgumentException(
+                "The batch size must be positive, but is " + batch);
+        }
+        long total = batch;
+        for (int i = 0; i < n.length; i++)
+        {
+            int minimum = types[i] == Type.DCT_I ? 2 : 1;
+            if (n[i] < minimum)
+            {
+                throw new IllegalArgumentException("The size " + i +
+                    " must be at least " + minimum + " for the " +
+                    types[i] + ", but is " + n[i]);
+            }
+            total *= n[i];
+        }
+        this.n = n.clone();
+        this.types = types.clone();
+        this.realType = realType;
+        this.batch = batch;
+
+        this.resources = new Resources();
+        this.registration = ResourceReclaimer.register(this, resources);
+        try
+        {
+            int elementSize = JCufftUtils.elementSize(realType);
+            Map<List<Long>, cufftHandle> plans =
+                new HashMap<List<Long>, cufftHandle>();
+            long workBytes = 0;
+            long spectrumBytes = 0;
+            long stride = 1;
+            for (int i = n.length - 1; i >= 0; i--)
+            {
+                Type type = types[i];
+                long count = total / n[i];
+                long m = type.getLength(n[i]);
+                long sequences = type.getParts() * count;
+                if (m > Integer.MAX_VALUE || sequences > Integer.MAX_VALUE)
+                {
+                    throw new IllegalArgumentException(
+                        "The transform is too large: " + sequences +
+                        " sequences of length " + m);
+                }
+                List<Long> key = Arrays.asList(m, sequences);
+                cufftHandle plan = plans.get(key);
+                if (plan == null)
+                {
+                    plan = new cufftHandle();
+                    resources.plans.add(plan);
+                    checkCufft(JCufft.cufftPlan1d(
+                        plan, (int)m, realType, (int)sequences));
+                    plans.put(key, plan);
+                }
+                passes.add(new Pass(type, count, stride, n[i], plan));
+                workBytes = Math.max(workBytes,
+                    sequences * m * elementSize);
+                spectrumBytes = Math.max(spectrumBytes,
+                    sequences * (m / 2 + 1) * 2 * elementSize);
+                stride *= n[i];
+            }
+            MemoryBudget.reserve(MemoryBudget.Category.POOL,
+                workBytes + spectrumBytes, "TrigPlan");
+            resources.deviceBytes = workBytes + spectrumBytes;
+            checkCuda(JCuda.cudaMalloc(resources.work, workBytes));
+            checkCuda(JCuda.cudaMalloc(resources.spectrum, spectrumBytes));
+        }
+        catch (RuntimeException e)
+        {
+            destroy();
+            throw e;
+        }
+    }
+
+    /**
+     * Set the stream for this plan
+     *
+     * @param stream The stream, or <code>null</code> for the default
+     * stream
+     * @throws jcuda.CudaException If the stream can not be set
+     */
+    public synchronized void setStream(cudaStream_t stream)
+    {
+        checkNotDestroyed();
+        for (cufftHandle plan : resources.plans)
+        {
+            checkCufft(JCufft.cufftSetStream(plan, stream));
+        }
+        this.stream = stream;
+    }
+
+    /**
+     * Executes this plan, asynchronously in the stream of this plan.
+     * The input and the output may be the same memory.
+     *
+     * @param idata The input data, in device memory
+     * @param odata The output data, in device memory
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public synchronized void exec(Pointer idata, Pointer odata)
+    {
+        checkNotDestroyed();
+        int elementSize = JCufftUtils.elementSize(realType);
+        Pointer src = idata;
+        for (Pass pass : passes)
+        {
+            int kind = pass.type.ordinal();
+            checkCuda(JCufft.trigPreTwiddle(src, resources.work, kind,
+                elementSize, pass.count, pass.stride, pass.n, stream));
+            checkCufft(JCufftUtils.exec(pass.plan, realType,
+                resources.work, resources.spectrum, JCufft.CUFFT_FORWARD));
+            checkCuda(JCufft.trigPostTwiddle(resources.spectrum, odata, kind,
+                elementSize, pass.count, pass.stride, pass.n, stream));
+            src = odata;
+        }
+    }
+
+    /**
+     * Executes this plan for the given host data, and waits until the
+     * result has been copied back to the host
+     *
+     * @param idata The input data
+     * @param odata The output data
+     * @throws IllegalArgumentException If the plan is not a single
+     * precision plan, or the arrays are too small
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public void exec(float idata[], float odata[])
+    {
+        if (realType != cufftType.CUFFT_R2C)
+        {
+            throw new IllegalArgumentException(
+                "The plan is not a single precision plan");
+        }
+        execHost(Pointer.to(idata), idata.length,
+            Pointer.to(odata), odata.length);
+    }
+
+    /**
+     * Executes this plan for the given host data, and waits until the
+     * result has been copied back to the host
+     *
+     * @param idata The input data
+     * @param odata The output data
+     * @throws IllegalArgumentException If the plan is not a double
+     * precision plan, or the arrays are too small
+     * @throws jcuda.CudaException If the transform fails
+     */
+    public void exec(double idata[], double odata[])
+    {
+        if (realType != cufftType.CUFFT_D2Z)
+        {
+            throw new IllegalArgumentException(
+                "The plan is not a double precision plan");
+        }
+        execHost(Pointer.to(idata), idata.length,
+            Pointer.to(odata), odata.length);
+    }
+
+    /**
+     * Implementation of the exec methods for host data
+     *
+     * @param idata The input data
+     * @param inputLength The length of the input array
+     * @param odata The output data
+     * @param outputLength The length of the output array
+     */
+    private synchronized void execHost(
+        Pointer idata, int inputLength, Pointer odata, int outputLength)
+    {
+        checkNotDestroyed();
+        long elements = getElementCount();
+        if (inputLength < elements || outputLength < elements)
+        {
+            throw new IllegalArgumentException(
+                "The arrays must have at least " + elements +
+                " elements, but have " + inputLength + " and " +
+                outputLength);
+        }
+        long bytes = elements * JCufftUtils.elementSize(realType);
+        Pointer data = new Pointer();
+        try
+        {
+            checkCuda(JCuda.cudaMalloc(data, bytes));
+            checkCuda(JCuda.cudaMemcpyAsync(data, idata, bytes,
+                cudaMemcpyKind.cudaMemcpyHostToDevice, stream));
+            exec(data, data);
+            checkCuda(JCuda.cudaMemcpyAsync(odata, data, bytes,
+                cudaMemcpyKind.cudaMemcpyDeviceToHost, stream));
+            checkCuda(JCuda.cudaStreamSynchronize(stream));
+        }
+        finally
+        {
+            JCuda.cudaFree(data);
+        }
+    }
+
+    /**
+     * Returns the sizes
+     *
+     * @return The sizes
+     */
+    public int[] getSizes()
+    {
+        return n.clone();
+    }
+
+    /**
+     * Returns the types for the dimensions
+     *
+     * @return The types
+     */
+    public Type[] getTypes()
+    {
+        return types.clone();
+    }
+
+    /**
+     * Returns the cufftType of the real-to-complex transforms
+     *
+     * @return The cufftType
+     */
+    public int getRealType()
+    {
+        return realType;
+    }
+
+    /**
+     * Returns the batch size
+     *
+     * @return The batch size
+     */
+    public int getBatch()
+    {
+        return batch;
+    }
+
+    /**
+     * Returns the number of real values of the input and the output,
+     * for all transforms of the batch
+     *
+     * @return The number of elements
+     */
+    public long getElementCount()
+    {
+        long elements = batch;
+        for (int size : n)
+        {
+            elements *= size;
+        }
+        return elements;
+    }
+
+    /**
+     * Returns the factor by which this plan and a plan with the inverse
+     * types scale the data
+     *
+     * @return The normalization factor
+     */
+    public double getNormalization()
+    {
+        double factor = 1.0;
+        for (int i = 0; i < n.length; i++)
+        {
+            factor *= types[i].getNormalization(n[i]);
+        }
+        return factor;
+    }
+
+    /**
+     * Throws an IllegalStateException if this object has been destroyed
+     */
+    private void checkNotDestroyed()
+    {
+        if (destroyed)
+        {
+            throw new IllegalStateException("The TrigPlan was destroyed");
+        }
+    }
+
+    /**
+     * Releases the plans and the buffers of this object
+     */
+    public synchronized void destroy()
+    {
+        if (destroyed)
+        {
+            return;
+        }
+        destroyed = true;
+        registration.clean();
+    }
+
+    /**
+     * Equivalent to {@link #destroy()}
+     */
+    @Override
+    public void close()
+    {
+        destroy();
+    }
+
+    @Override
+    public String toString()
+    {
+        return "TrigPlan[types=" + Arrays.toString(types) +
+            ",n=" + Arrays.toString(n) +
+            ",realType=" + cufftType.stringFor(realType) +
+            ",batch=" + batch + "]";
+    }
+}
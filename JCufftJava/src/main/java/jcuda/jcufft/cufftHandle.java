@@ -29,14 +29,66 @@
 package jcuda.jcufft;
 
 /**
- * A handle type used to store and access CUFFT plans
+ * A handle type used to store and access CUFFT plans.<br>
+ * <br>
+ * A plan should be destroyed with {@link JCufft#cufftDestroy(cufftHandle)}
+ * or {@link #close()} when it is no longer needed. The plan of a handle
+ * that becomes unreachable without being destroyed is destroyed by the
+ * {@link ResourceReclaimer}.<br>
+ * <br>
+ * A handle may be shared between threads. The native library keeps
+ * track of the plans that are alive, so that a plan is only destroyed
+ * after all functions that are using it in other threads have returned,
+ * and all functions that are called with a handle whose plan has been
+ * destroyed, or was never created, return CUFFT_INVALID_PLAN.
  */
-public class cufftHandle
+public class cufftHandle implements AutoCloseable
 {
     /**
-     * The plan id, written by native methods
+     * The cleanup action that destroys a plan for which the handle
+     * became unreachable. It must not refer to the handle.
      */
-    private int plan;
+    private static final class PlanCleanup implements Runnable
+    {
+        /**
+         * The token of the plan. It is updated when the handle
+         * receives a new plan.
+         */
+        volatile long token;
+
+        /**
+         * The work area of the plan
+         */
+        volatile MemoryBudget.Workspace workspace;
+
+        /**
+         * Creates a new cleanup action for the given plan
+         *
+         * @param token The token of the plan
+         * @param workspace The work area
+         */
+        PlanCleanup(long token, MemoryBudget.Workspace workspace)
+        {
+            this.token = token;
+            this.workspace = workspace;
+        }
+
+        @Override
+        public void run()
+        {
+            cufftHandle handle = new cufftHandle(token);
+            handle.setWorkspace(workspace);
+            JCufft.cufftDestroy(handle);
+        }
+    }
+
+    /**
+     * The token that identifies the plan in the handle table of the
+     * native library, written by native methods. It consists of the
+     * index of a slot in the table and the generation of the slot, so
+     * that the token of a destroyed plan is never valid again.
+     */
+    private long token;
 
     /**
      * The dimension of this plan
@@ -68,6 +120,72 @@ public class cufftHandle
      */
     private int batchSize = 0;
 
+    /**
+     * The complete geometry of this plan, or <code>null</code> if it
+     * is not known
+     */
+    private volatile PlanGeometry geometry;
+
+    /**
+     * The size of the work area of this plan, or -1 if it is not known
+     */
+    private volatile long workSize = -1;
+
+    /**
+     * Whether this plan was created with the 64 bit plan functions
+     */
+    private volatile boolean plan64;
+
+    /**
+     * Whether CUFFT allocates the work area of this plan automatically
+     */
+    private boolean autoAllocation = true;
+
+    /**
+     * The work area of this plan, as tracked by the {@link MemoryBudget}
+     */
+    private volatile MemoryBudget.Workspace workspace;
+
+    /**
+     * The cleanup action for the plan, if a plan has been created
+     */
+    private PlanCleanup cleanup;
+
+    /**
+     * The registration of the cleanup action in the {@link ResourceReclaimer}
+     */
+    private ResourceReclaimer.Registration registration;
+
+    /**
+     * Creates a new, uninitialized handle
+     */
+    public cufftHandle()
+    {
+    }
+
+    /**
+     * Creates a handle for the given existing plan token
+     *
+     * @param token The token of the plan
+     */
+    cufftHandle(long token)
+    {
+        this.token = token;
+    }
+
+    /**
+     * Destroys the plan of this handle, if a plan has been created and
+     * not destroyed yet. Otherwise, this method has no effect.
+     */
+    @Override
+    public void close()
+    {
+        if (registration != null)
+        {
+            JCufft.cufftDestroy(this);
+        }
+    }
+
     /**
      * Returns a String representation of this JCufftHandle
      *
@@ -75,11 +193,18 @@ public class cufftHandle
      */
     public String toString()
     {
+        PlanGeometry currentGeometry = geometry;
+        if (dim == 0 && currentGeometry != null)
+        {
+            return "cufftHandle[token="+Long.toHexString(token)+
+                ",geometry="+currentGeometry+",workSize="+workSize+
+                ",plan64="+plan64+"]";
+        }
         if (dim == 0)
         {
             return "cufftHandle[uninitialized]";
         }
-        String result = "cufftHandle[id="+plan+",dim="+dim+",type="+cufftType.stringFor(type)+", size=";
+        String result = "cufftHandle[token="+Long.toHexString(token)+",dim="+dim+",type="+cufftType.stringFor(type)+", size=";
         switch (dim)
         {
             case 1:
@@ -98,6 +223,156 @@ public class cufftHandle
         return result;
     }
 
+    /**
+     * Returns the complete geometry of this plan. This is available for
+     * all plans that have been created with one of the plan functions
+     * of {@link JCufft}, including the cufftMakePlanMany and
+     * cufftMakePlanMany64 functions. It is <code>null</code> if no plan
+     * has been created for this handle, or the plan was destroyed.
+     *
+     * @return The geometry, or <code>null</code>
+     */
+    public PlanGeometry getGeometry()
+    {
+        return geometry;
+    }
+
+    /**
+     * Returns the size of the work area of this plan, in bytes, or -1
+     * if it is not known
+     *
+     * @return The work size
+     */
+    public long getWorkSize()
+    {
+        return workSize;
+    }
+
+    /**
+     * Returns whether this plan was created with
+     * {@link JCufft#cufftMakePlanMany64}
+     *
+     * @return Whether this is a 64 bit plan
+     */
+    public boolean isPlan64()
+    {
+        return plan64;
+    }
+
+    /**
+     * Will be called by JCufft after a plan was created for this handle,
+     * to store its geometry
+     *
+     * @param geometry The geometry, or <code>null</code>
+     * @param workSize The work size, or -1
+     * @param plan64 Whether this is a 64 bit plan
+     */
+    void setGeometry(PlanGeometry geometry, long workSize, boolean plan64)
+    {
+        this.geometry = geometry;
+        this.workSize = workSize;
+        this.plan64 = plan64;
+    }
+
+    /**
+     * Set whether CUFFT allocates the work area of this plan automatically
+     *
+     * @param autoAllocation Whether the work area is allocated automatically
+     */
+    void setAutoAllocation(boolean autoAllocation)
+    {
+        this.autoAllocation = autoAllocation;
+    }
+
+    /**
+     * Returns whether CUFFT allocates the work area of this plan
+     * automatically
+     *
+     * @return Whether the work area is allocated automatically
+     */
+    boolean isAutoAllocation()
+    {
+        return autoAllocation;
+    }
+
+    /**
+     * Set the work area of this plan
+     *
+     * @param workspace The work area
+     */
+    void setWorkspace(MemoryBudget.Workspace workspace)
+    {
+        this.workspace = workspace;
+        if (cleanup != null)
+        {
+            cleanup.workspace = workspace;
+        }
+    }
+
+    /**
+     * Returns the work area of this plan
+     *
+     * @return The work area, or <code>null</code> if it is not tracked
+     */
+    MemoryBudget.Workspace getWorkspace()
+    {
+        return workspace;
+    }
+
+    /**
+     * Will be called by JCufft after a plan was created for this handle,
+     * to register it in the {@link ResourceReclaimer}
+     */
+    void planCreated()
+    {
+        if (registration == null)
+        {
+            cleanup = new PlanCleanup(token, workspace);
+            registration = ResourceReclaimer.register(this, cleanup);
+        }
+        else
+        {
+            // The handle was planned again, and refers to a new plan
+            cleanup.token = token;
+        }
+    }
+
+    /**
+     * Takes over the plan of the given handle, which is a pre-built plan
+     * of the {@link PlanWarmup}. The given handle will no longer refer
+     * to the plan afterwards.
+     *
+     * @param other The other handle
+     */
+    void adopt(cufftHandle other)
+    {
+        setGeometry(other.geometry, other.workSize, other.plan64);
+        other.planDestroyed();
+        this.token = other.token;
+        if (cleanup != null)
+        {
+            cleanup.token = token;
+        }
+        this.autoAllocation = other.autoAllocation;
+        setWorkspace(other.workspace);
+        other.token = 0;
+        other.workspace = null;
+    }
+
+    /**
+     * Will be called by JCufft after the plan of this handle was destroyed
+     */
+    void planDestroyed()
+    {
+        setGeometry(null, -1, false);
+        if (registration != null)
+        {
+            registration.deregister();
+            registration = null;
+            cleanup = null;
+        }
+    }
+
     /**
      * Set the batch size of this plan
      *
@@ -0,0 +1,202 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assume.assumeTrue;
+
+import java.util.Random;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Tests for the array overloads of the exec functions that receive one
+ * signal per row of a 2D array. The results are compared to the ones
+ * of the overloads for a single array that contains all signals. The
+ * array overloads always copy the data to the device, so these
+ * comparisons are only run against the real CUFFT library (see
+ * {@link JCufftTestUtils#DEVICE}).
+ */
+public class BatchedArrayTest
+{
+    private static final int SIZE = 80;
+    private static final int BATCH = 5;
+
+    private final Random random = new Random(0);
+    private cufftHandle plan;
+
+    @Before
+    public void setUp()
+    {
+        JCufft.setExceptionsEnabled(false);
+        plan = new cufftHandle();
+    }
+
+    @After
+    public void tearDown()
+    {
+        JCufft.cufftDestroy(plan);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testDifferentRowCountsAreRejected()
+    {
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, BATCH));
+        JCufft.cufftExecC2C(plan, new float[BATCH][2 * SIZE],
+            new float[BATCH - 1][2 * SIZE], JCufft.CUFFT_FORWARD);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testDifferentRowLengthsAreRejected()
+    {
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, 2));
+        float input[][] = { new float[2 * SIZE], new float[2 * SIZE - 2] };
+        JCufft.cufftExecC2C(plan, input, new float[2][2 * SIZE],
+            JCufft.CUFFT_FORWARD);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testTooFewRowsAreRejected()
+    {
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, BATCH));
+        JCufft.cufftExecC2C(plan, new float[BATCH - 1][2 * SIZE],
+            new float[BATCH - 1][2 * SIZE], JCufft.CUFFT_FORWARD);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testMoreRowsThanBatchAreRejected()
+    {
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, BATCH));
+        JCufft.cufftExecC2C(plan, new float[BATCH + 1][2 * SIZE],
+            new float[BATCH + 1][2 * SIZE], JCufft.CUFFT_FORWARD);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testPaddedRowsAreRejected()
+    {
+        // The plan reads the signals at a distance of 2*SIZE floats, so
+        // padded rows would be misaligned after the first one
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, BATCH));
+        JCufft.cufftExecC2C(plan, new float[BATCH][2 * SIZE + 2],
+            new float[BATCH][2 * SIZE + 2], JCufft.CUFFT_FORWARD);
+    }
+
+    @Test
+    public void testC2C()
+    {
+        assumeDevice();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, BATCH));
+        float input[][] = randomRows(BATCH, 2 * SIZE);
+        float expected[] = new float[2 * SIZE * BATCH];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecC2C(
+            plan, flatten(input), expected, JCufft.CUFFT_FORWARD));
+
+        float output[][] = new float[BATCH][2 * SIZE];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecC2C(
+            plan, input, output, JCufft.CUFFT_FORWARD));
+        assertArrayEquals(expected, flatten(output), 1e-5f);
+    }
+
+    @Test
+    public void testC2CInPlace()
+    {
+        assumeDevice();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, BATCH));
+        float data[][] = randomRows(BATCH, 2 * SIZE);
+        float expected[] = new float[2 * SIZE * BATCH];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecC2C(
+            plan, flatten(data), expected, JCufft.CUFFT_FORWARD));
+
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecC2C(
+            plan, data, data, JCufft.CUFFT_FORWARD));
+        assertArrayEquals(expected, flatten(data), 1e-5f);
+    }
+
+    @Test
+    public void testR2C()
+    {
+        assumeDevice();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_R2C, BATCH));
+        int halfSize = SIZE / 2 + 1;
+        float input[][] = randomRows(BATCH, SIZE);
+        float expected[] = new float[2 * halfSize * BATCH];
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftExecR2C(plan, flatten(input), expected));
+
+        float output[][] = new float[BATCH][2 * halfSize];
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftExecR2C(plan, input, output));
+        assertArrayEquals(expected, flatten(output), 1e-5f);
+    }
+
+    @Test
+    public void testZ2Z()
+    {
+        assumeDevice();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_Z2Z, BATCH));
+        double input[][] = new double[BATCH][2 * SIZE];
+        double flat[] = new double[2 * SIZE * BATCH];
+        for (int b = 0; b < BATCH; b++)
+        {
+            for (int i = 0; i < 2 * SIZE; i++)
+            {
+                input[b][i] = random.nextDouble() - 0.5;
+                flat[b * 2 * SIZE + i] = input[b][i];
+            }
+        }
+        double expected[] = new double[flat.length];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecZ2Z(
+            plan, flat, expected, JCufft.CUFFT_INVERSE));
+
+        double output[][] = new double[BATCH][2 * SIZE];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecZ2Z(
+            plan, input, output, JCufft.CUFFT_INVERSE));
+        for (int b = 0; b < BATCH; b++)
+        {
+            for (int i = 0; i < 2 * SIZE; i++)
+            {
+                assertEquals(expected[b * 2 * SIZE + i], output[b][i], 1e-12);
+            }
+        }
+    }
+
+    private static void assumeDevice()
+    {
+        assumeTrue(JCufftTestUtils.DEVICE &&
+            JCufftTestUtils.isDeviceAvailable());
+    }
+
+    private float[][] randomRows(int rows, int length)
+    {
+        float result[][] = new float[rows][length];
+        for (int r = 0; r < rows; r++)
+        {
+            for (int i = 0; i < length; i++)
+            {
+                result[r][i] = random.nextFloat() - 0.5f;
+            }
+        }
+        return result;
+    }
+
+    private static float[] flatten(float rows[][])
+    {
+        int length = rows[0].length;
+        float result[] = new float[rows.length * length];
+        for (int r = 0; r < rows.length; r++)
+        {
+            System.arraycopy(rows[r], 0, result, r * length, length);
+        }
+        return result;
+    }
+}
@@ -0,0 +1,135 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assume.assumeTrue;
+
+import java.util.Random;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+
+/**
+ * Tests for the {@link ChirpZPlan}. The DFT of a prime length is
+ * compared to the one of a regular CUFFT plan, and a zoomed spectrum
+ * is compared to a direct evaluation of the z-transform. The chirp
+ * multiplications operate on device memory, so these tests are only
+ * run against the real CUFFT library (see
+ * {@link JCufftTestUtils#DEVICE}).
+ */
+public class ChirpZPlanTest
+{
+    private final Random random = new Random(0);
+
+    @Before
+    public void setUp()
+    {
+        assumeTrue(JCufftTestUtils.DEVICE &&
+            JCufftTestUtils.isDeviceAvailable());
+        JCufft.setExceptionsEnabled(false);
+        ChirpZPlan.clearChirpCache();
+    }
+
+    @Test
+    public void testPrimeLengthDft()
+    {
+        int n = 1009;
+        int batch = 2;
+        double input[] = randomDoubles(2 * n * batch);
+
+        double expected[] = new double[input.length];
+        cufftHandle plan = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, n, cufftType.CUFFT_Z2Z, batch));
+        try
+        {
+            assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecZ2Z(
+                plan, input, expected, JCufft.CUFFT_FORWARD));
+        }
+        finally
+        {
+            JCufft.cufftDestroy(plan);
+        }
+
+        double output[] = new double[input.length];
+        try (ChirpZPlan chirpZ =
+            ChirpZPlan.createDft(n, cufftType.CUFFT_Z2Z, batch))
+        {
+            assertEquals(n, chirpZ.getOutputLength());
+            exec(chirpZ, input, output);
+        }
+        for (int i = 0; i < expected.length; i++)
+        {
+            assertEquals("At " + i, expected[i], output[i], 1e-9);
+        }
+    }
+
+    @Test
+    public void testZoom()
+    {
+        int n = 101;
+        int m = 40;
+        int batch = 3;
+        double f0 = 0.1;
+        double df = 0.0025;
+        double input[] = randomDoubles(2 * n * batch);
+        double output[] = new double[2 * m * batch];
+        try (ChirpZPlan chirpZ = ChirpZPlan.create(
+            n, m, f0, df, cufftType.CUFFT_Z2Z, batch))
+        {
+            exec(chirpZ, input, output);
+        }
+        for (int b = 0; b < batch; b++)
+        {
+            for (int k = 0; k < m; k++)
+            {
+                double re = 0;
+                double im = 0;
+                for (int j = 0; j < n; j++)
+                {
+                    double angle = -2 * Math.PI * j * (f0 + k * df);
+                    double xr = input[2 * (b * n + j)];
+                    double xi = input[2 * (b * n + j) + 1];
+                    re += xr * Math.cos(angle) - xi * Math.sin(angle);
+                    im += xr * Math.sin(angle) + xi * Math.cos(angle);
+                }
+                int index = 2 * (b * m + k);
+                assertEquals("Real part at " + k, re, output[index], 1e-9);
+                assertEquals("Imaginary part at " + k,
+                    im, output[index + 1], 1e-9);
+            }
+        }
+    }
+
+    /**
+     * Executes the given plan for the given host data, and waits until
+     * the result has been copied back to the host
+     */
+    private static void exec(ChirpZPlan plan, double input[], double output[])
+    {
+        Pointer deviceInput = JCufftTestUtils.toDevice(input);
+        Pointer deviceOutput = JCufftTestUtils.toDevice(output);
+        try
+        {
+            plan.exec(deviceInput, deviceOutput);
+            JCufftTestUtils.toHost(deviceOutput, output);
+        }
+        finally
+        {
+            JCuda.cudaFree(deviceInput);
+            JCuda.cudaFree(deviceOutput);
+        }
+    }
+
+    private double[] randomDoubles(int n)
+    {
+        double result[] = new double[n];
+        for (int i = 0; i < n; i++)
+        {
+            result[i] = random.nextDouble() - 0.5;
+        }
+        return result;
+    }
+}
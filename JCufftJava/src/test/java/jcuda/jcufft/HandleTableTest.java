@@ -0,0 +1,176 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotEquals;
+import static org.junit.Assume.assumeTrue;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import jcuda.Pointer;
+import jcuda.Sizeof;
+
+/**
+ * Tests for the validation of plans through the native handle table.
+ * Plans that have never been created, or that have been destroyed,
+ * have to be rejected with CUFFT_INVALID_PLAN, also when their slot
+ * in the table has been reused by another plan.
+ */
+public class HandleTableTest
+{
+    private static final int SIZE = 64;
+
+    @Before
+    public void setUp()
+    {
+        JCufft.setExceptionsEnabled(false);
+    }
+
+    @Test
+    public void testNeverCreatedPlanIsRejected()
+    {
+        cufftHandle plan = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_INVALID_PLAN,
+            JCufft.cufftGetSize(plan, new long[1]));
+        assertEquals(cufftResult.CUFFT_INVALID_PLAN,
+            JCufft.cufftExecC2C(plan, new Pointer(), new Pointer(),
+                JCufft.CUFFT_FORWARD));
+        assertEquals(cufftResult.CUFFT_INVALID_PLAN,
+            JCufft.cufftDestroy(plan));
+    }
+
+    @Test
+    public void testDestroyedPlanIsRejected()
+    {
+        cufftHandle plan = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, 1));
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftGetSize(plan, new long[1]));
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftDestroy(plan));
+
+        assertEquals(cufftResult.CUFFT_INVALID_PLAN,
+            JCufft.cufftGetSize(plan, new long[1]));
+        assertEquals(cufftResult.CUFFT_INVALID_PLAN,
+            JCufft.cufftExecC2C(plan, new Pointer(), new Pointer(),
+                JCufft.CUFFT_FORWARD));
+        assertEquals(cufftResult.CUFFT_INVALID_PLAN,
+            JCufft.cufftDestroy(plan));
+    }
+
+    @Test
+    public void testReusedTokenIsRejected()
+    {
+        cufftHandle planA = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(planA, SIZE, cufftType.CUFFT_C2C, 1));
+        long tokenA = JCufftTestUtils.getToken(planA);
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftDestroy(planA));
+
+        // The slot of the destroyed plan is reused for the next plan,
+        // but with a different generation
+        cufftHandle planB = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(planB, SIZE, cufftType.CUFFT_C2C, 1));
+        try
+        {
+            long tokenB = JCufftTestUtils.getToken(planB);
+            assertEquals(tokenA & 0xFFFFFFFFL, tokenB & 0xFFFFFFFFL);
+            assertNotEquals(tokenA, tokenB);
+
+            cufftHandle stale = new cufftHandle(tokenA);
+            assertEquals(cufftResult.CUFFT_INVALID_PLAN,
+                JCufft.cufftGetSize(stale, new long[1]));
+            assertEquals(cufftResult.CUFFT_INVALID_PLAN,
+                JCufft.cufftDestroy(stale));
+            assertEquals(cufftResult.CUFFT_SUCCESS,
+                JCufft.cufftGetSize(planB, new long[1]));
+        }
+        finally
+        {
+            assertEquals(cufftResult.CUFFT_SUCCESS,
+                JCufft.cufftDestroy(planB));
+        }
+    }
+
+    @Test(timeout = 10000)
+    public void testDestroyDuringExecIsDeferred()
+    {
+        cufftHandle plan = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, 1));
+        destroyDuringExec(plan, SIZE);
+    }
+
+    @Test(timeout = 10000)
+    public void testDestroyDuringExecOfManagedPlanIsDeferred()
+    {
+        // The managed work area is allocated with the CUDA runtime
+        assumeTrue(JCufftTestUtils.isDeviceAvailable());
+        long usage = MemoryBudget.getUsage(MemoryBudget.Category.WORKSPACE);
+        int size = 1021;
+        cufftHandle plan = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS, MemoryBudget.createManagedPlan(
+            PlanGeometry.of1d(size, cufftType.CUFFT_C2C, 1), plan));
+        destroyDuringExec(plan, size);
+
+        // The work area was released after the exec call returned
+        assertEquals(usage,
+            MemoryBudget.getUsage(MemoryBudget.Category.WORKSPACE));
+    }
+
+    /**
+     * Executes the given C2C plan, and destroys it from a range listener
+     * while the exec call is in progress on the same thread. The plan
+     * is destroyed in any case.
+     *
+     * @param plan The plan
+     * @param size The size of the plan
+     */
+    private static void destroyDuringExec(final cufftHandle plan, int size)
+    {
+        final int destroyResult[] = { -1 };
+        RangeListener listener = new RangeListener()
+        {
+            @Override
+            public void rangeStarted(String name)
+            {
+                // The thread that destroys the plan still holds the
+                // reference of the exec call
+                if (name.startsWith("cufftExecC2C") && destroyResult[0] == -1)
+                {
+                    destroyResult[0] = JCufft.cufftDestroy(plan);
+                }
+            }
+
+            @Override
+            public void rangeEnded()
+            {
+                // Nothing to do here
+            }
+        };
+        boolean available = JCufft.setRangeListener(listener);
+        if (!available)
+        {
+            JCufft.cufftDestroy(plan);
+        }
+        assumeTrue(available);
+
+        Pointer data = JCufftTestUtils.allocate(2L * size * Sizeof.FLOAT);
+        int execResult = -1;
+        try
+        {
+            execResult = JCufft.cufftExecC2C(
+                plan, data, data, JCufft.CUFFT_FORWARD);
+        }
+        finally
+        {
+            JCufft.setRangeListener(null);
+            JCufftTestUtils.free(data);
+        }
+        assertEquals(cufftResult.CUFFT_SUCCESS, destroyResult[0]);
+        assertEquals(cufftResult.CUFFT_SUCCESS, execResult);
+        assertEquals(cufftResult.CUFFT_INVALID_PLAN,
+            JCufft.cufftGetSize(plan, new long[1]));
+    }
+}
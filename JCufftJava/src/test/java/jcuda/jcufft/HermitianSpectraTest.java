@@ -0,0 +1,174 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+
+import java.util.Random;
+
+import org.junit.Test;
+
+/**
+ * Tests for the host methods of the {@link HermitianSpectra}. The half
+ * spectra are taken from full spectra of real signals that are computed
+ * with a plain DFT, so the expansion has to reproduce these full spectra.
+ */
+public class HermitianSpectraTest
+{
+    private final Random random = new Random(0);
+
+    @Test
+    public void testExpand1d()
+    {
+        checkExpand(new int[] { 8 }, 2);
+    }
+
+    @Test
+    public void testExpand1dOddSize()
+    {
+        checkExpand(new int[] { 7 }, 1);
+    }
+
+    @Test
+    public void testExpand2d()
+    {
+        checkExpand(new int[] { 3, 5 }, 1);
+    }
+
+    @Test
+    public void testExpand3d()
+    {
+        checkExpand(new int[] { 3, 4, 6 }, 2);
+    }
+
+    @Test
+    public void testExpandDouble()
+    {
+        int n[] = { 5, 4 };
+        int batch = 2;
+        double full[] = spectra(n, batch);
+        double half[] = half(full, n, batch);
+        double expanded[] = new double[full.length];
+        HermitianSpectra.expand(half, expanded, n, batch);
+        assertArrayEquals(full, expanded, 1e-12);
+    }
+
+    @Test
+    public void testExpandKnownSpectrum()
+    {
+        // The spectrum of a real signal of length 4
+        float half[] = { 1, 0, 2, 3, 4, 0 };
+        float full[] = new float[8];
+        HermitianSpectra.expand(half, full, new int[] { 4 }, 1);
+        assertArrayEquals(new float[] { 1, 0, 2, 3, 4, 0, 2, -3 }, full, 0);
+    }
+
+    @Test
+    public void testCompressIsInverseOfExpand()
+    {
+        int n[] = { 4, 3, 6 };
+        int batch = 2;
+        float half[] = toFloat(half(spectra(n, batch), n, batch));
+        float full[] = new float[(int)(2 * batch *
+            HermitianSpectra.getFullLength(n))];
+        HermitianSpectra.expand(half, full, n, batch);
+        float compressed[] = new float[half.length];
+        HermitianSpectra.compress(full, compressed, n, batch);
+        assertArrayEquals(half, compressed, 0);
+    }
+
+    @Test
+    public void testLengths()
+    {
+        int n[] = { 3, 4, 6 };
+        assertEquals(3 * 4 * 4, HermitianSpectra.getHalfLength(n));
+        assertEquals(3 * 4 * 6, HermitianSpectra.getFullLength(n));
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testTooSmallFullArrayIsRejected()
+    {
+        int n[] = { 8 };
+        HermitianSpectra.expand(new float[2 * 5], new float[2 * 8 - 1], n, 1);
+    }
+
+    private void checkExpand(int n[], int batch)
+    {
+        double full[] = spectra(n, batch);
+        float half[] = toFloat(half(full, n, batch));
+        float expanded[] = new float[full.length];
+        HermitianSpectra.expand(half, expanded, n, batch);
+        assertArrayEquals(toFloat(full), expanded, 1e-5f);
+    }
+
+    /**
+     * Computes the full spectra of random real signals with the given
+     * sizes, as interleaved complex values, with a plain DFT
+     */
+    private double[] spectra(int n[], int batch)
+    {
+        long sizes[] = HermitianSpectra.sizes(n);
+        int s0 = (int)sizes[0];
+        int s1 = (int)sizes[1];
+        int s2 = (int)sizes[2];
+        int length = s0 * s1 * s2;
+        double result[] = new double[2 * length * batch];
+        for (int b = 0; b < batch; b++)
+        {
+            double signal[] = new double[length];
+            for (int i = 0; i < length; i++)
+            {
+                signal[i] = random.nextDouble() - 0.5;
+            }
+            for (int k = 0; k < length; k++)
+            {
+                int k0 = k / (s1 * s2);
+                int k1 = (k / s2) % s1;
+                int k2 = k % s2;
+                double re = 0;
+                double im = 0;
+                for (int j = 0; j < length; j++)
+                {
+                    int j0 = j / (s1 * s2);
+                    int j1 = (j / s2) % s1;
+                    int j2 = j % s2;
+                    double angle = -2 * Math.PI * (
+                        (double)k0 * j0 / s0 +
+                        (double)k1 * j1 / s1 +
+                        (double)k2 * j2 / s2);
+                    re += signal[j] * Math.cos(angle);
+                    im += signal[j] * Math.sin(angle);
+                }
+                result[2 * (b * length + k)] = re;
+                result[2 * (b * length + k) + 1] = im;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns the non-redundant halves of the given full spectra
+     */
+    private static double[] half(double full[], int n[], int batch)
+    {
+        long sizes[] = HermitianSpectra.sizes(n);
+        int rows = (int)(sizes[0] * sizes[1]);
+        int s2 = (int)sizes[2];
+        int h2 = s2 / 2 + 1;
+        double result[] = new double[2 * rows * h2 * batch];
+        for (int r = 0; r < rows * batch; r++)
+        {
+            System.arraycopy(full, 2 * r * s2, result, 2 * r * h2, 2 * h2);
+        }
+        return result;
+    }
+
+    private static float[] toFloat(double array[])
+    {
+        float result[] = new float[array.length];
+        for (int i = 0; i < array.length; i++)
+        {
+            result[i] = (float)array[i];
+        }
+        return result;
+    }
+}
@@ -0,0 +1,163 @@
+package jcuda.jcufft;
+
+import java.lang.reflect.Field;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+import jcuda.Pointer;
+import jcuda.Sizeof;
+import jcuda.runtime.JCuda;
+import jcuda.runtime.cudaError;
+import jcuda.runtime.cudaMemcpyKind;
+
+/**
+ * Utility methods for the JCufft tests.<br>
+ * <br>
+ * By default, the tests are intended to run against the CPU stand-in
+ * for CUFFT (see the JCUFFT_STUB_BACKEND CMake option of JCufftJNI),
+ * which operates on host memory. In this case, the memory that is
+ * passed to the exec functions is allocated as direct buffers. When
+ * the system property <code>jcufft.test.device</code> is
+ * <code>true</code>, the memory is allocated on the device instead,
+ * for running the same tests against the real CUFFT library. Tests
+ * for the array overloads, which always copy the data to the device,
+ * are only run in this case.
+ */
+class JCufftTestUtils
+{
+    /**
+     * Whether the tests run against the real CUFFT library, with
+     * device memory
+     */
+    static final boolean DEVICE =
+        Boolean.getBoolean("jcufft.test.device");
+
+    /**
+     * Returns whether the CUDA runtime can be called. This does not
+     * require a CUDA capable device.
+     *
+     * @return Whether the runtime is available
+     */
+    static boolean isRuntimeAvailable()
+    {
+        try
+        {
+            int device[] = { 0 };
+            JCuda.cudaGetDevice(device);
+            return true;
+        }
+        catch (Throwable t)
+        {
+            return false;
+        }
+    }
+
+    /**
+     * Returns whether a CUDA capable device is available
+     *
+     * @return Whether a device is available
+     */
+    static boolean isDeviceAvailable()
+    {
+        try
+        {
+            int count[] = { 0 };
+            return JCuda.cudaGetDeviceCount(count) == cudaError.cudaSuccess &&
+                count[0] > 0;
+        }
+        catch (Throwable t)
+        {
+            return false;
+        }
+    }
+
+    /**
+     * Allocate the given number of bytes for the data of an exec call
+     *
+     * @param bytes The number of bytes
+     * @return The pointer to the memory
+     */
+    static Pointer allocate(long bytes)
+    {
+        if (DEVICE)
+        {
+            Pointer pointer = new Pointer();
+            JCuda.cudaMalloc(pointer, bytes);
+            return pointer;
+        }
+        ByteBuffer buffer = ByteBuffer.allocateDirect((int)bytes);
+        buffer.order(ByteOrder.nativeOrder());
+        return Pointer.to(buffer);
+    }
+
+    /**
+     * Free the given memory
+     *
+     * @param pointer The pointer to the memory
+     */
+    static void free(Pointer pointer)
+    {
+        if (DEVICE)
+        {
+            JCuda.cudaFree(pointer);
+        }
+    }
+
+    /**
+     * Allocate device memory and copy the given data into it. This is
+     * only used by the tests that require a device.
+     *
+     * @param data The data
+     * @return The pointer to the device memory
+     */
+    static Pointer toDevice(double data[])
+    {
+        long bytes = (long)data.length * Sizeof.DOUBLE;
+        Pointer pointer = new Pointer();
+        JCuda.cudaMalloc(pointer, bytes);
+        JCuda.cudaMemcpy(pointer, Pointer.to(data), bytes,
+            cudaMemcpyKind.cudaMemcpyHostToDevice);
+        return pointer;
+    }
+
+    /**
+     * Copy the given device memory into the given array
+     *
+     * @param pointer The pointer to the device memory
+     * @param data The array
+     */
+    static void toHost(Pointer pointer, double data[])
+    {
+        JCuda.cudaMemcpy(Pointer.to(data), pointer,
+            (long)data.length * Sizeof.DOUBLE,
+            cudaMemcpyKind.cudaMemcpyDeviceToHost);
+    }
+
+    /**
+     * Returns the token that identifies the plan of the given handle
+     * in the native handle table
+     *
+     * @param plan The plan
+     * @return The token
+     */
+    static long getToken(cufftHandle plan)
+    {
+        try
+        {
+            Field field = cufftHandle.class.getDeclaredField("token");
+            field.setAccessible(true);
+            return field.getLong(plan);
+        }
+        catch (ReflectiveOperationException e)
+        {
+            throw new AssertionError("Could not read the token", e);
+        }
+    }
+
+    /**
+     * Private constructor to prevent instantiation
+     */
+    private JCufftTestUtils()
+    {
+    }
+}
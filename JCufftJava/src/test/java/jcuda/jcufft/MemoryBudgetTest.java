@@ -0,0 +1,101 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+import jcuda.Pointer;
+import jcuda.Sizeof;
+
+/**
+ * Tests for the eviction of managed work areas by the
+ * {@link MemoryBudget}. The work areas are allocated with the CUDA
+ * runtime, so these tests require a CUDA capable device.
+ */
+public class MemoryBudgetTest
+{
+    private static final int SIZE = 1021;
+    private static final int BATCH = 4;
+
+    private cufftHandle planA;
+    private cufftHandle planB;
+    private Pointer input;
+    private Pointer output;
+
+    @Before
+    public void setUp()
+    {
+        assumeTrue(JCufftTestUtils.isDeviceAvailable());
+        JCufft.setExceptionsEnabled(false);
+        PlanGeometry geometry =
+            PlanGeometry.of1d(SIZE, cufftType.CUFFT_C2C, BATCH);
+        planA = new cufftHandle();
+        planB = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            MemoryBudget.createManagedPlan(geometry, planA));
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            MemoryBudget.createManagedPlan(geometry, planB));
+        long bytes = (long)SIZE * BATCH * 2 * Sizeof.FLOAT;
+        input = JCufftTestUtils.allocate(bytes);
+        output = JCufftTestUtils.allocate(bytes);
+    }
+
+    @After
+    public void tearDown()
+    {
+        MemoryBudget.setBudget(0);
+        if (planA != null)
+        {
+            JCufft.cufftDestroy(planA);
+            JCufft.cufftDestroy(planB);
+            JCufftTestUtils.free(input);
+            JCufftTestUtils.free(output);
+        }
+    }
+
+    @Test
+    public void testWorkAreaIsAttachedOnFirstExec()
+    {
+        assertFalse(MemoryBudget.isWorkspaceAttached(planA));
+        assertEquals(cufftResult.CUFFT_SUCCESS, exec(planA));
+        assertTrue(MemoryBudget.isWorkspaceAttached(planA));
+    }
+
+    @Test
+    public void testEvictionAndReattach()
+    {
+        long size = MemoryBudget.getWorkspaceSize(planA);
+        assumeTrue(size > 0);
+
+        // Only one of the work areas fits into the budget
+        MemoryBudget.setBudget(
+            MemoryBudget.getDeviceUsage() + size + size / 2);
+        long evictions = MemoryBudget.getEvictionCount();
+
+        assertEquals(cufftResult.CUFFT_SUCCESS, exec(planA));
+        assertTrue(MemoryBudget.isWorkspaceAttached(planA));
+        assertFalse(MemoryBudget.isWorkspaceAttached(planB));
+
+        assertEquals(cufftResult.CUFFT_SUCCESS, exec(planB));
+        assertFalse(MemoryBudget.isWorkspaceAttached(planA));
+        assertTrue(MemoryBudget.isWorkspaceAttached(planB));
+        assertEquals(evictions + 1, MemoryBudget.getEvictionCount());
+
+        assertEquals(cufftResult.CUFFT_SUCCESS, exec(planA));
+        assertTrue(MemoryBudget.isWorkspaceAttached(planA));
+        assertFalse(MemoryBudget.isWorkspaceAttached(planB));
+        assertEquals(evictions + 2, MemoryBudget.getEvictionCount());
+        assertTrue(MemoryBudget.getDeviceUsage() <= MemoryBudget.getBudget());
+    }
+
+    private int exec(cufftHandle plan)
+    {
+        return JCufft.cufftExecC2C(plan, input, output,
+            JCufft.CUFFT_FORWARD);
+    }
+}
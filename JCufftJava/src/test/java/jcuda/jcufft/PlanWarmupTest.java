@@ -0,0 +1,85 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotEquals;
+import static org.junit.Assume.assumeTrue;
+
+import java.util.Collections;
+import java.util.concurrent.TimeUnit;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Tests for the adoption of pre-built plans from the {@link PlanWarmup}
+ */
+public class PlanWarmupTest
+{
+    @Before
+    public void setUp()
+    {
+        assumeTrue(JCufftTestUtils.isRuntimeAvailable());
+        JCufft.setExceptionsEnabled(false);
+        PlanWarmup.discardWarmPlans();
+    }
+
+    @After
+    public void tearDown()
+    {
+        PlanWarmup.discardWarmPlans();
+    }
+
+    @Test
+    public void testWarmPlanIsAdopted() throws Exception
+    {
+        PlanGeometry geometry =
+            PlanGeometry.of1d(120, cufftType.CUFFT_C2C, 3);
+        int built = PlanWarmup.warmUp(Collections.singletonList(geometry))
+            .get(30, TimeUnit.SECONDS);
+        assertEquals(1, built);
+        assertEquals(1, PlanWarmup.getWarmPlanCount());
+
+        cufftHandle plan = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, 120, cufftType.CUFFT_C2C, 3));
+        try
+        {
+            assertEquals(0, PlanWarmup.getWarmPlanCount());
+            assertEquals(geometry, plan.getGeometry());
+
+            // The adopted plan keeps the work size of the warm plan
+            long workSize[] = { -1 };
+            assertEquals(cufftResult.CUFFT_SUCCESS,
+                JCufft.cufftGetSize(plan, workSize));
+            assertEquals(workSize[0], plan.getWorkSize());
+        }
+        finally
+        {
+            assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftDestroy(plan));
+        }
+    }
+
+    @Test
+    public void testOtherGeometryIsNotAdopted() throws Exception
+    {
+        PlanGeometry geometry =
+            PlanGeometry.of1d(120, cufftType.CUFFT_C2C, 3);
+        PlanWarmup.warmUp(Collections.singletonList(geometry))
+            .get(30, TimeUnit.SECONDS);
+        assertEquals(1, PlanWarmup.getWarmPlanCount());
+
+        cufftHandle plan = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, 120, cufftType.CUFFT_C2C, 2));
+        try
+        {
+            assertEquals(1, PlanWarmup.getWarmPlanCount());
+            assertNotEquals(geometry, plan.getGeometry());
+        }
+        finally
+        {
+            assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftDestroy(plan));
+        }
+    }
+}
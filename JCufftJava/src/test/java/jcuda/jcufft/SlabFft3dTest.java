@@ -0,0 +1,198 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assume.assumeTrue;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+import jcuda.Pointer;
+import jcuda.runtime.JCuda;
+
+/**
+ * Tests for the {@link SlabFft3d}. Two ranks that are connected with a
+ * {@link LoopbackTransport} run in two threads, and their slabs are
+ * compared to the result of a single 3D plan for the global data. The
+ * slabs are in device memory, so these tests are only run against the
+ * real CUFFT library (see {@link JCufftTestUtils#DEVICE}).
+ */
+public class SlabFft3dTest
+{
+    private static final int RANKS = 2;
+    private static final int NX = 8;
+    private static final int NY = 8;
+    private static final int NZ = 5;
+
+    private final Random random = new Random(0);
+    private ExecutorService executor;
+
+    @Before
+    public void setUp()
+    {
+        assumeTrue(JCufftTestUtils.DEVICE &&
+            JCufftTestUtils.isDeviceAvailable());
+        JCufft.setExceptionsEnabled(false);
+        executor = Executors.newFixedThreadPool(RANKS);
+    }
+
+    @After
+    public void tearDown()
+    {
+        if (executor != null)
+        {
+            executor.shutdownNow();
+        }
+    }
+
+    @Test
+    public void testForward() throws Exception
+    {
+        check(1);
+    }
+
+    @Test
+    public void testForwardWithChunks() throws Exception
+    {
+        check(4);
+    }
+
+    private void check(int chunks) throws Exception
+    {
+        double global[] = new double[2 * NX * NY * NZ];
+        for (int i = 0; i < global.length; i++)
+        {
+            global[i] = random.nextDouble() - 0.5;
+        }
+        double expected[] = new double[global.length];
+        cufftHandle plan = new cufftHandle();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan3d(plan, NX, NY, NZ, cufftType.CUFFT_Z2Z));
+        try
+        {
+            assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecZ2Z(
+                plan, global, expected, JCufft.CUFFT_FORWARD));
+        }
+        finally
+        {
+            JCufft.cufftDestroy(plan);
+        }
+
+        List<SlabTransport> transports = LoopbackTransport.create(RANKS);
+        List<SlabFft3d> ffts = new ArrayList<SlabFft3d>();
+        List<Pointer> xSlabs = new ArrayList<Pointer>();
+        List<Pointer> ySlabs = new ArrayList<Pointer>();
+        try
+        {
+            int localX = NX / RANKS;
+            int localY = NY / RANKS;
+            int slabLength = 2 * localX * NY * NZ;
+            for (int r = 0; r < RANKS; r++)
+            {
+                SlabFft3d fft = SlabFft3d.create(transports.get(r),
+                    NX, NY, NZ, cufftType.CUFFT_Z2Z, chunks);
+                ffts.add(fft);
+                assertEquals(chunks, fft.getChunkCount());
+                assertEquals(r * localX, fft.getLocalXStart());
+                assertEquals(r * localY, fft.getLocalYStart());
+
+                // The x-slab is a contiguous part of the global data
+                double xSlab[] = new double[slabLength];
+                System.arraycopy(global, r * slabLength, xSlab, 0, slabLength);
+                xSlabs.add(JCufftTestUtils.toDevice(xSlab));
+                ySlabs.add(JCufftTestUtils.toDevice(new double[slabLength]));
+            }
+
+            execAll(ffts, xSlabs, ySlabs, JCufft.CUFFT_FORWARD);
+
+            // The y-slab of rank r contains the planes y = r*localY ...
+            // in the order (y, x, z)
+            for (int r = 0; r < RANKS; r++)
+            {
+                double ySlab[] = new double[slabLength];
+                JCufftTestUtils.toHost(ySlabs.get(r), ySlab);
+                for (int yl = 0; yl < localY; yl++)
+                {
+                    for (int x = 0; x < NX; x++)
+                    {
+                        for (int z = 0; z < NZ; z++)
+                        {
+                            int y = r * localY + yl;
+                            int g = 2 * ((x * NY + y) * NZ + z);
+                            int l = 2 * ((yl * NX + x) * NZ + z);
+                            String message = "Rank " + r + " at (" +
+                                x + "," + y + "," + z + ")";
+                            assertEquals(message,
+                                expected[g], ySlab[l], 1e-10);
+                            assertEquals(message,
+                                expected[g + 1], ySlab[l + 1], 1e-10);
+                        }
+                    }
+                }
+            }
+
+            // The inverse transform restores the scaled x-slabs
+            execAll(ffts, xSlabs, ySlabs, JCufft.CUFFT_INVERSE);
+            double scale = NX * NY * NZ;
+            for (int r = 0; r < RANKS; r++)
+            {
+                double xSlab[] = new double[slabLength];
+                JCufftTestUtils.toHost(xSlabs.get(r), xSlab);
+                for (int i = 0; i < slabLength; i++)
+                {
+                    assertEquals("Rank " + r + " at " + i,
+                        global[r * slabLength + i] * scale, xSlab[i], 1e-9);
+                }
+            }
+        }
+        finally
+        {
+            for (SlabFft3d fft : ffts)
+            {
+                fft.destroy();
+            }
+            for (Pointer pointer : xSlabs)
+            {
+                JCuda.cudaFree(pointer);
+            }
+            for (Pointer pointer : ySlabs)
+            {
+                JCuda.cudaFree(pointer);
+            }
+        }
+    }
+
+    /**
+     * Executes the given transforms of all ranks, each in its own
+     * thread, because the ranks exchange data with each other
+     */
+    private void execAll(List<SlabFft3d> ffts,
+        List<Pointer> xSlabs, List<Pointer> ySlabs, int direction)
+        throws Exception
+    {
+        List<Future<?>> futures = new ArrayList<Future<?>>();
+        for (int r = 0; r < RANKS; r++)
+        {
+            SlabFft3d fft = ffts.get(r);
+            Pointer xSlab = xSlabs.get(r);
+            Pointer ySlab = ySlabs.get(r);
+            futures.add(executor.submit(() ->
+            {
+                fft.exec(xSlab, ySlab, direction);
+                return null;
+            }));
+        }
+        for (Future<?> future : futures)
+        {
+            future.get(30, TimeUnit.SECONDS);
+        }
+    }
+}
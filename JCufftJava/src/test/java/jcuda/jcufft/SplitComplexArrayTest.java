@@ -0,0 +1,202 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assume.assumeTrue;
+
+import java.util.Random;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Tests for the array overloads of the exec functions that receive
+ * split complex data, with separate arrays for the real and imaginary
+ * parts. The results are compared to the ones of the overloads for
+ * interleaved complex data. The array overloads always copy the data
+ * to the device, so these comparisons are only run against the real
+ * CUFFT library (see {@link JCufftTestUtils#DEVICE}).
+ */
+public class SplitComplexArrayTest
+{
+    private static final int SIZE = 96;
+    private static final int BATCH = 3;
+
+    private final Random random = new Random(0);
+    private cufftHandle plan;
+
+    @Before
+    public void setUp()
+    {
+        JCufft.setExceptionsEnabled(false);
+        plan = new cufftHandle();
+    }
+
+    @After
+    public void tearDown()
+    {
+        JCufft.cufftDestroy(plan);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testDifferentLengthsAreRejected()
+    {
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, 1));
+        JCufft.cufftExecC2C(plan, new float[SIZE], new float[SIZE - 1],
+            new float[SIZE], new float[SIZE], JCufft.CUFFT_FORWARD);
+    }
+
+    @Test
+    public void testC2C()
+    {
+        assumeDevice();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2C, BATCH));
+        float input[] = randomFloats(2 * SIZE * BATCH);
+        float expected[] = new float[input.length];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecC2C(
+            plan, input, expected, JCufft.CUFFT_FORWARD));
+
+        float re[] = real(input);
+        float im[] = imaginary(input);
+        float reOut[] = new float[re.length];
+        float imOut[] = new float[im.length];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecC2C(
+            plan, re, im, reOut, imOut, JCufft.CUFFT_FORWARD));
+        assertArrayEquals(real(expected), reOut, 1e-5f);
+        assertArrayEquals(imaginary(expected), imOut, 1e-5f);
+    }
+
+    @Test
+    public void testR2C()
+    {
+        assumeDevice();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_R2C, BATCH));
+        float input[] = randomFloats(SIZE * BATCH);
+        float expected[] = new float[2 * (SIZE / 2 + 1) * BATCH];
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftExecR2C(plan, input, expected));
+
+        float reOut[] = new float[expected.length / 2];
+        float imOut[] = new float[expected.length / 2];
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftExecR2C(plan, input, reOut, imOut));
+        assertArrayEquals(real(expected), reOut, 1e-5f);
+        assertArrayEquals(imaginary(expected), imOut, 1e-5f);
+    }
+
+    @Test
+    public void testC2R()
+    {
+        assumeDevice();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_C2R, BATCH));
+        float input[] = hermitian(SIZE, BATCH);
+        float expected[] = new float[SIZE * BATCH];
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftExecC2R(plan, input.clone(), expected));
+
+        float output[] = new float[SIZE * BATCH];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecC2R(
+            plan, real(input), imaginary(input), output));
+        assertArrayEquals(expected, output, 1e-4f);
+    }
+
+    @Test
+    public void testZ2Z()
+    {
+        assumeDevice();
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, cufftType.CUFFT_Z2Z, BATCH));
+        double input[] = randomDoubles(2 * SIZE * BATCH);
+        double expected[] = new double[input.length];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecZ2Z(
+            plan, input, expected, JCufft.CUFFT_INVERSE));
+
+        double re[] = new double[SIZE * BATCH];
+        double im[] = new double[SIZE * BATCH];
+        for (int i = 0; i < re.length; i++)
+        {
+            re[i] = input[2 * i];
+            im[i] = input[2 * i + 1];
+        }
+        double reOut[] = new double[re.length];
+        double imOut[] = new double[im.length];
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftExecZ2Z(
+            plan, re, im, reOut, imOut, JCufft.CUFFT_INVERSE));
+        for (int i = 0; i < re.length; i++)
+        {
+            assertEquals(expected[2 * i], reOut[i], 1e-12);
+            assertEquals(expected[2 * i + 1], imOut[i], 1e-12);
+        }
+    }
+
+    private static void assumeDevice()
+    {
+        assumeTrue(JCufftTestUtils.DEVICE &&
+            JCufftTestUtils.isDeviceAvailable());
+    }
+
+    private float[] randomFloats(int n)
+    {
+        float result[] = new float[n];
+        for (int i = 0; i < n; i++)
+        {
+            result[i] = random.nextFloat() - 0.5f;
+        }
+        return result;
+    }
+
+    private double[] randomDoubles(int n)
+    {
+        double result[] = new double[n];
+        for (int i = 0; i < n; i++)
+        {
+            result[i] = random.nextDouble() - 0.5;
+        }
+        return result;
+    }
+
+    /**
+     * Returns the half spectra of random real signals with the given
+     * size, as interleaved complex values
+     */
+    private float[] hermitian(int size, int batch)
+    {
+        int halfSize = size / 2 + 1;
+        float result[] = randomFloats(2 * halfSize * batch);
+        for (int b = 0; b < batch; b++)
+        {
+            // The DC and Nyquist values of a real signal are real
+            result[2 * b * halfSize + 1] = 0;
+            if (size % 2 == 0)
+            {
+                result[2 * (b * halfSize + halfSize - 1) + 1] = 0;
+            }
+        }
+        return result;
+    }
+
+    private static float[] real(float interleaved[])
+    {
+        float result[] = new float[interleaved.length / 2];
+        for (int i = 0; i < result.length; i++)
+        {
+            result[i] = interleaved[2 * i];
+        }
+        return result;
+    }
+
+    private static float[] imaginary(float interleaved[])
+    {
+        float result[] = new float[interleaved.length / 2];
+        for (int i = 0; i < result.length; i++)
+        {
+            result[i] = interleaved[2 * i + 1];
+        }
+        return result;
+    }
+}
@@ -0,0 +1,122 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNull;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Tests for the validation of the sizes of the Java arrays that are
+ * passed to the array overloads of the exec functions. Arrays that
+ * are smaller than the data that is touched by the plan have to be
+ * rejected before any memory is allocated on the device.
+ */
+public class TransferSizeTest
+{
+    private static final int SIZE = 16;
+    private static final int BATCH = 2;
+
+    private cufftHandle plan;
+
+    @Before
+    public void setUp()
+    {
+        JCufft.setExceptionsEnabled(false);
+        plan = new cufftHandle();
+    }
+
+    @After
+    public void tearDown()
+    {
+        JCufft.cufftDestroy(plan);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testTooSmallInputIsRejected()
+    {
+        createPlan1d(cufftType.CUFFT_C2C);
+        JCufft.cufftExecC2C(plan, new float[2 * SIZE * BATCH - 2],
+            new float[2 * SIZE * BATCH], JCufft.CUFFT_FORWARD);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testTooSmallOutputIsRejected()
+    {
+        createPlan1d(cufftType.CUFFT_C2C);
+        JCufft.cufftExecC2C(plan, new float[2 * SIZE * BATCH],
+            new float[2 * SIZE * BATCH - 2], JCufft.CUFFT_FORWARD);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testTooSmallHalfSpectrumIsRejected()
+    {
+        createPlan1d(cufftType.CUFFT_R2C);
+        JCufft.cufftExecR2C(plan, new float[SIZE * BATCH],
+            new float[2 * (SIZE / 2 + 1) * BATCH - 2]);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testTooSmallInPlaceArrayIsRejected()
+    {
+        // An in-place R2C transform writes more than it reads
+        createPlan1d(cufftType.CUFFT_R2C);
+        float data[] = new float[SIZE * BATCH];
+        JCufft.cufftExecR2C(plan, data, data);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testTooSmallStridedInputIsRejected()
+    {
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftPlanMany(plan,
+            1, new int[] { SIZE }, new int[] { SIZE }, 2, 2 * SIZE,
+            new int[] { SIZE }, 1, SIZE, cufftType.CUFFT_C2C, BATCH));
+
+        // The input reaches from the first element of the first signal
+        // up to the last element of the second signal
+        long extent = 2 * SIZE + (SIZE - 1) * 2 + 1;
+        assertEquals(extent, plan.getGeometry().getInputExtent());
+        JCufft.cufftExecC2C(plan, new float[2 * (int)extent - 2],
+            new float[2 * SIZE * BATCH], JCufft.CUFFT_FORWARD);
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void testTooSmallStridedOutputIsRejected64()
+    {
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftCreate(plan));
+        long workSize[] = { 0 };
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftMakePlanMany64(
+            plan, 1, new long[] { SIZE }, new long[] { SIZE }, 1, SIZE,
+            new long[] { SIZE }, 3, 3 * SIZE, cufftType.CUFFT_C2C, BATCH,
+            workSize));
+
+        long extent = 3 * SIZE + (SIZE - 1) * 3 + 1;
+        assertEquals(extent, plan.getGeometry().getOutputExtent());
+        JCufft.cufftExecC2C(plan, new float[2 * SIZE * BATCH],
+            new float[2 * (int)extent - 2], JCufft.CUFFT_FORWARD);
+    }
+
+    @Test
+    public void testMissingEmbedUsesBasicLayout()
+    {
+        // When one of the embeds is null, CUFFT ignores the other
+        // embed, and all strides and distances
+        assertEquals(cufftResult.CUFFT_SUCCESS, JCufft.cufftPlanMany(plan,
+            1, new int[] { SIZE }, new int[] { SIZE }, 2, 2 * SIZE,
+            null, 3, 3 * SIZE, cufftType.CUFFT_C2C, BATCH));
+        PlanGeometry geometry = plan.getGeometry();
+        assertNull(geometry.getInembed());
+        assertNull(geometry.getOnembed());
+        assertEquals(SIZE * BATCH, geometry.getInputExtent());
+        assertEquals(SIZE * BATCH, geometry.getOutputExtent());
+        assertEquals(PlanGeometry.of1d(SIZE, cufftType.CUFFT_C2C, BATCH),
+            geometry);
+    }
+
+    private void createPlan1d(int type)
+    {
+        assertEquals(cufftResult.CUFFT_SUCCESS,
+            JCufft.cufftPlan1d(plan, SIZE, type, BATCH));
+    }
+}
@@ -0,0 +1,238 @@
+package jcuda.jcufft;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assume.assumeTrue;
+
+import java.util.Random;
+
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Tests for the {@link TrigPlan}. The results are compared to direct
+ * evaluations of the sums that define the transforms, as given for the
+ * REDFT00 to RODFT11 transforms of FFTW. The twiddle kernels operate
+ * on device memory, so these tests are only run against the real CUFFT
+ * library (see {@link JCufftTestUtils#DEVICE}).
+ */
+public class TrigPlanTest
+{
+    private final Random random = new Random(0);
+
+    @Before
+    public void setUp()
+    {
+        assumeTrue(JCufftTestUtils.DEVICE &&
+            JCufftTestUtils.isDeviceAvailable());
+        JCufft.setExceptionsEnabled(false);
+    }
+
+    @Test
+    public void testAllTypesEvenSize()
+    {
+        for (TrigPlan.Type type : TrigPlan.Type.values())
+        {
+            check1d(type, 16, 3);
+        }
+    }
+
+    @Test
+    public void testAllTypesOddSize()
+    {
+        for (TrigPlan.Type type : TrigPlan.Type.values())
+        {
+            check1d(type, 17, 2);
+        }
+    }
+
+    @Test
+    public void testSmallestSizes()
+    {
+        for (TrigPlan.Type type : TrigPlan.Type.values())
+        {
+            check1d(type, type == TrigPlan.Type.DCT_I ? 2 : 1, 1);
+        }
+    }
+
+    @Test
+    public void testSeparable2d()
+    {
+        int ny = 6;
+        int nx = 9;
+        int batch = 2;
+        TrigPlan.Type types[] = { TrigPlan.Type.DST_III, TrigPlan.Type.DCT_II };
+        double input[] = randomDoubles(ny * nx * batch);
+        double output[] = new double[input.length];
+        try (TrigPlan plan = TrigPlan.create(new int[] { ny, nx }, types,
+            cufftType.CUFFT_D2Z, batch))
+        {
+            plan.exec(input, output);
+        }
+
+        double expected[] = input.clone();
+        for (int b = 0; b < batch; b++)
+        {
+            int offset = b * ny * nx;
+            for (int y = 0; y < ny; y++)
+            {
+                transform(types[1], expected, offset + y * nx, 1, nx);
+            }
+            for (int x = 0; x < nx; x++)
+            {
+                transform(types[0], expected, offset + x, nx, ny);
+            }
+        }
+        assertClose(expected, output, "2D " + types[0] + "/" + types[1]);
+    }
+
+    @Test
+    public void testInverseIsNormalized()
+    {
+        int n = 12;
+        for (TrigPlan.Type type : TrigPlan.Type.values())
+        {
+            double input[] = randomDoubles(n);
+            double output[] = new double[n];
+            try (TrigPlan forward = TrigPlan.create(
+                    new int[] { n }, type, cufftType.CUFFT_D2Z, 1);
+                TrigPlan inverse = TrigPlan.create(
+                    new int[] { n }, type.getInverse(), cufftType.CUFFT_D2Z, 1))
+            {
+                forward.exec(input, output);
+                inverse.exec(output, output);
+            }
+            double scale = type.getNormalization(n);
+            for (int i = 0; i < n; i++)
+            {
+                assertEquals(type + " at " + i,
+                    input[i] * scale, output[i], 1e-9 * scale);
+            }
+        }
+    }
+
+    private void check1d(TrigPlan.Type type, int n, int batch)
+    {
+        double input[] = randomDoubles(n * batch);
+        double output[] = new double[input.length];
+        try (TrigPlan plan = TrigPlan.create(
+            new int[] { n }, type, cufftType.CUFFT_D2Z, batch))
+        {
+            plan.exec(input, output);
+        }
+        double expected[] = input.clone();
+        for (int b = 0; b < batch; b++)
+        {
+            transform(type, expected, b * n, 1, n);
+        }
+        assertClose(expected, output, type + " of size " + n);
+    }
+
+    private static void assertClose(
+        double expected[], double actual[], String message)
+    {
+        for (int i = 0; i < expected.length; i++)
+        {
+            assertEquals(message + " at " + i,
+                expected[i], actual[i], 1e-9 * expected.length);
+        }
+    }
+
+    /**
+     * Applies the given transform to the sequence of the given length,
+     * starting at the given offset with the given stride, in place,
+     * with an O(n^2) evaluation of the defining sum
+     */
+    private static void transform(TrigPlan.Type type,
+        double data[], int offset, int stride, int n)
+    {
+        double x[] = new double[n];
+        for (int j = 0; j < n; j++)
+        {
+            x[j] = data[offset + j * stride];
+        }
+        for (int k = 0; k < n; k++)
+        {
+            data[offset + k * stride] = sum(type, x, k);
+        }
+    }
+
+    /**
+     * Returns the output element k of the given transform of x
+     */
+    private static double sum(TrigPlan.Type type, double x[], int k)
+    {
+        int n = x.length;
+        double result = 0;
+        switch (type)
+        {
+            case DCT_I:
+                result = x[0] + (k % 2 == 0 ? 1 : -1) * x[n - 1];
+                for (int j = 1; j < n - 1; j++)
+                {
+                    result += 2 * x[j] * Math.cos(Math.PI * j * k / (n - 1));
+                }
+                return result;
+            case DCT_II:
+                for (int j = 0; j < n; j++)
+                {
+                    result += 2 * x[j] * Math.cos(Math.PI * (j + 0.5) * k / n);
+                }
+                return result;
+            case DCT_III:
+                result = x[0];
+                for (int j = 1; j < n; j++)
+                {
+                    result += 2 * x[j] * Math.cos(Math.PI * j * (k + 0.5) / n);
+                }
+                return result;
+            case DCT_IV:
+                for (int j = 0; j < n; j++)
+                {
+                    result += 2 * x[j] *
+                        Math.cos(Math.PI * (j + 0.5) * (k + 0.5) / n);
+                }
+                return result;
+            case DST_I:
+                for (int j = 0; j < n; j++)
+                {
+                    result += 2 * x[j] *
+                        Math.sin(Math.PI * (j + 1) * (k + 1) / (n + 1));
+                }
+                return result;
+            case DST_II:
+                for (int j = 0; j < n; j++)
+                {
+                    result += 2 * x[j] *
+                        Math.sin(Math.PI * (j + 0.5) * (k + 1) / n);
+                }
+                return result;
+            case DST_III:
+                result = (k % 2 == 0 ? 1 : -1) * x[n - 1];
+                for (int j = 0; j < n - 1; j++)
+                {
+                    result += 2 * x[j] *
+                        Math.sin(Math.PI * (j + 1) * (k + 0.5) / n);
+                }
+                return result;
+            case DST_IV:
+                for (int j = 0; j < n; j++)
+                {
+                    result += 2 * x[j] *
+                        Math.sin(Math.PI * (j + 0.5) * (k + 0.5) / n);
+                }
+                return result;
+            default:
+                throw new AssertionError("Unknown type " + type);
+        }
+    }
+
+    private double[] randomDoubles(int n)
+    {
+        double result[] = new double[n];
+        for (int i = 0; i < n; i++)
+        {
+            result[i] = random.nextDouble() - 0.5;
+        }
+        return result;
+    }
+}